@@ -0,0 +1,76 @@
+#include <random>
+#include <vector>
+
+#include "../include/map.hpp"
+#include "bench.hpp"
+
+// Compara a aplicação de lotes mistos (inserções, atribuições e remoções,
+// ~10k operações cada) um a um com `apply_batch`, em mapas de vários
+// tamanhos.
+
+using IntMap = Map<int, int>;
+
+constexpr int batches = 50;
+constexpr std::size_t batch_size = 10000;
+
+IntMap filled(int n, int key_range) {
+  IntMap map;
+  std::mt19937 rng(3);
+  for (int i = 0; i < n; ++i) map.insert_or_assign(rng() % key_range, i);
+  return map;
+}
+
+std::vector<std::vector<IntMap::BatchOp>> make_batches(int key_range) {
+  std::mt19937 rng(17);
+  std::vector<std::vector<IntMap::BatchOp>> result(batches);
+  for (auto& ops : result) {
+    for (std::size_t i = 0; i < batch_size; ++i) {
+      int key = static_cast<int>(rng() % key_range);
+      BatchKind kind = static_cast<BatchKind>(rng() % 3);
+      ops.push_back({kind, key, static_cast<int>(i)});
+    }
+  }
+  return result;
+}
+
+int main() {
+  std::printf("%d lotes de %zu operações (tempos em ms)\n", batches,
+              batch_size);
+  std::printf("%-10s %12s %12s %10s\n", "n", "uma a uma", "apply_batch",
+              "Mops/s");
+  for (int n : {10000, 100000, 1000000, 4000000}) {
+    int key_range = 2 * n;
+    auto all = make_batches(key_range);
+
+    IntMap one_by_one = filled(n, key_range);
+    double loop_ms = bench::time_ms([&] {
+      std::size_t changed = 0;
+      for (const auto& ops : all) {
+        for (const IntMap::BatchOp& op : ops) {
+          if (op.kind == BatchKind::insert) {
+            changed += one_by_one.try_emplace(op.key, op.value).second;
+          } else if (op.kind == BatchKind::assign) {
+            changed += one_by_one.insert_or_assign(op.key, op.value);
+          } else {
+            changed += one_by_one.remove(op.key);
+          }
+        }
+      }
+      bench::do_not_optimize(changed);
+    });
+
+    IntMap batched = filled(n, key_range);
+    double batch_ms = bench::time_ms([&] {
+      std::size_t changed = 0;
+      for (const auto& ops : all) {
+        std::vector<bool> results = batched.apply_batch(ops);
+        changed += results.size();
+      }
+      bench::do_not_optimize(changed);
+    });
+
+    double ops = static_cast<double>(batches) * batch_size;
+    std::printf("%-10d %12.1f %12.1f %10.2f\n", n, loop_ms, batch_ms,
+                ops / batch_ms / 1000.0);
+  }
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Matriz de políticas de balanceamento por proporção de leituras: `Set`
+// com AVL, rubro-negra, WAVL e treap, começando com n chaves aleatórias
+// (padrão 1M, ou o primeiro argumento). As escritas alternam inserções e
+// remoções de chaves aleatórias, então o tamanho fica estável; metade das
+// leituras não encontra a chave.
+
+constexpr std::size_t operations = 2000000;
+const int read_percents[] = {0, 50, 90, 99};
+
+struct Op {
+  int kind;  // 0 busca, 1 inserção, 2 remoção
+  int key;
+};
+
+template <template <class...> class Tree>
+void run(const char* name, const std::vector<int>& keys,
+         const std::vector<std::vector<Op>>& workloads) {
+  std::printf("%-8s", name);
+  for (const std::vector<Op>& ops : workloads) {
+    Set<int, Tree> set;
+    for (int key : keys) set.insert(key);
+    std::size_t hits = 0;
+    double ms = bench::time_ms([&] {
+      for (const Op& op : ops) {
+        if (op.kind == 0) {
+          hits += set.search(op.key);
+        } else if (op.kind == 1) {
+          hits += set.insert(op.key);
+        } else {
+          hits += set.remove(op.key);
+        }
+      }
+    });
+    bench::do_not_optimize(hits);
+    std::printf(" %12.1f", ms * 1e6 / ops.size());
+  }
+  std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+  std::size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+  std::mt19937 rng(42);
+  std::vector<int> keys(n);
+  for (int& key : keys) key = static_cast<int>(rng() % (4 * n));
+
+  std::vector<std::vector<Op>> workloads;
+  for (int percent : read_percents) {
+    std::vector<Op> ops(operations);
+    bool insert = true;
+    for (Op& op : ops) {
+      op.key = static_cast<int>(rng() % (4 * n));
+      if (static_cast<int>(rng() % 100) < percent) {
+        op.kind = 0;
+      } else {
+        op.kind = insert ? 1 : 2;
+        insert = !insert;
+      }
+    }
+    workloads.push_back(std::move(ops));
+  }
+
+  std::printf("%zu chaves, ns por operação\n%-8s", n, "leituras");
+  for (int percent : read_percents) std::printf(" %11d%%", percent);
+  std::printf("\n");
+  run<AVL>("AVL", keys, workloads);
+  run<RedBlackTree>("RB", keys, workloads);
+  run<WAVLTree>("WAVL", keys, workloads);
+  run<Treap>("Treap", keys, workloads);
+}
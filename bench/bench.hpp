@@ -0,0 +1,37 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <utility>
+
+/**
+ * @brief Utilitários simples para os benchmarks.
+ *
+ * Os benchmarks são executáveis independentes (não fazem parte do `ctest`).
+ * Para números representativos, configure com
+ * `cmake -DCMAKE_BUILD_TYPE=Release`.
+ */
+namespace bench {
+
+/**
+ * @brief Mede o tempo de execução de uma função.
+ *
+ * @param fn Função a ser executada uma vez.
+ * @return Tempo decorrido em milissegundos.
+ */
+template <class F>
+double time_ms(F&& fn) {
+  auto start = std::chrono::steady_clock::now();
+  std::forward<F>(fn)();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+/**
+ * @brief Impede que o compilador elimine o cálculo de `value`.
+ */
+template <class T>
+void do_not_optimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}  // namespace bench
@@ -0,0 +1,62 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Compara `Set` com `AVL` (um nó por chave) e com `BTree` (nós de 256
+// bytes, 60 inteiros cada) em inserções, buscas e remoções aleatórias.
+// Os tamanhos vêm da linha de comando (padrão: 1M, 10M e 100M chaves); com
+// 100M chaves a `AVL` sozinha ocupa cerca de 5 GB.
+
+// Executa a carga em `set` e imprime o custo médio de cada fase em ns.
+template <class S>
+void run(const char* name, const std::vector<int>& keys,
+         const std::vector<int>& probes) {
+  S set;
+  double n = static_cast<double>(keys.size());
+  double insert_ms = bench::time_ms([&] {
+    for (int key : keys) set.insert(key);
+  });
+  std::size_t hits = 0;
+  double search_ms = bench::time_ms([&] {
+    for (int probe : probes) hits += set.search(probe);
+  });
+  bench::do_not_optimize(hits);
+  long long sum = 0;
+  double scan_ms = bench::time_ms([&] {
+    for (int key : set) sum += key;
+  });
+  bench::do_not_optimize(sum);
+  double remove_ms = bench::time_ms([&] {
+    for (std::size_t i = 0; i < keys.size(); i += 2) set.remove(keys[i]);
+  });
+  std::printf("%-6s %10.1f %10.1f %10.2f %10.1f\n", name,
+              insert_ms * 1e6 / n, search_ms * 1e6 / probes.size(),
+              scan_ms * 1e6 / n, remove_ms * 2e6 / n);
+}
+
+int main(int argc, char** argv) {
+  std::vector<long> sizes;
+  for (int i = 1; i < argc; ++i) sizes.push_back(std::atol(argv[i]));
+  if (sizes.empty()) sizes = {1000000, 10000000, 100000000};
+
+  for (long n : sizes) {
+    // Chaves distintas em ordem aleatória; metade das buscas não encontra
+    std::mt19937 rng(42);
+    std::vector<int> keys(n);
+    for (long i = 0; i < n; ++i) keys[i] = static_cast<int>(2 * i);
+    std::shuffle(keys.begin(), keys.end(), rng);
+    std::vector<int> probes(std::min<long>(n, 10000000));
+    for (int& probe : probes) probe = static_cast<int>(rng() % (2 * n));
+
+    std::printf("n = %ld (ns por operação)\n", n);
+    std::printf("%-6s %10s %10s %10s %10s\n", "", "insert", "search",
+                "scan", "remove");
+    run<Set<int>>("AVL", keys, probes);
+    run<Set<int, BTree>>("BTree", keys, probes);
+    std::printf("\n");
+  }
+}
@@ -0,0 +1,42 @@
+#include <numeric>
+#include <vector>
+
+#include "../include/map.hpp"
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Compara a carga de um snapshot ordenado com uma sequência de insert com a
+// construção direta por assign_sorted.
+
+int main() {
+  for (int n : {100000, 1000000, 4000000}) {
+    std::vector<int> keys(n);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::vector<std::pair<int, int>> rows(n);
+    for (int i = 0; i < n; ++i) rows[i] = {i, i};
+
+    double set_insert_ms = bench::time_ms([&] {
+      Set<int> set;
+      for (int key : keys) set.insert(key);
+      bench::do_not_optimize(set);
+    });
+    double set_bulk_ms = bench::time_ms([&] {
+      Set<int> set(keys.begin(), keys.end());
+      bench::do_not_optimize(set);
+    });
+    double map_insert_ms = bench::time_ms([&] {
+      Map<int, int> map;
+      for (const auto& [key, value] : rows) map.try_emplace(key, value);
+      bench::do_not_optimize(map);
+    });
+    double map_bulk_ms = bench::time_ms([&] {
+      Map<int, int> map(rows.begin(), rows.end());
+      bench::do_not_optimize(map);
+    });
+
+    std::printf("n = %d (tempos em ms, incluindo a destruição)\n", n);
+    std::printf("%-6s %12s %14s\n", "", "insert", "assign_sorted");
+    std::printf("%-6s %12.1f %14.1f\n", "Set", set_insert_ms, set_bulk_ms);
+    std::printf("%-6s %12.1f %14.1f\n\n", "Map", map_insert_ms, map_bulk_ms);
+  }
+}
@@ -0,0 +1,64 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Memória por elemento e custo de buscas de `Set<uint32_t>` com `AVL` (nós
+// com três ponteiros, tamanho e altura) e com `CompactAVL` (nós de 12 bytes
+// numa arena, 5 por linha de cache). A memória é medida pelo crescimento do
+// conjunto residente do processo; o tamanho vem da linha de comando
+// (padrão: 10M chaves).
+
+// Páginas residentes do processo, em bytes (Linux).
+std::size_t resident_bytes() {
+  long pages = 0, resident = 0;
+  if (FILE* statm = std::fopen("/proc/self/statm", "r")) {
+    if (std::fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    std::fclose(statm);
+  }
+  return static_cast<std::size_t>(resident) * 4096;
+}
+
+template <template <class...> class Tree>
+void run(const char* name, const std::vector<std::uint32_t>& keys,
+         const std::vector<std::uint32_t>& probes) {
+  double n = static_cast<double>(keys.size());
+  std::size_t before = resident_bytes();
+  auto* set = new Set<std::uint32_t, Tree>();
+  double insert_ms = bench::time_ms([&] {
+    for (std::uint32_t key : keys) set->insert(key);
+  });
+  std::size_t after = resident_bytes();
+  std::size_t hits = 0;
+  double search_ms = bench::time_ms([&] {
+    for (std::uint32_t probe : probes) hits += set->search(probe);
+  });
+  bench::do_not_optimize(hits);
+  std::printf("%-10s %12.1f %12.1f %12.1f\n", name, (after - before) / n,
+              insert_ms * 1e6 / n, search_ms * 1e6 / probes.size());
+  delete set;
+}
+
+int main(int argc, char** argv) {
+  std::size_t n = argc > 1 ? std::atol(argv[1]) : 10000000;
+  std::mt19937 rng(42);
+  std::vector<std::uint32_t> keys(n);
+  for (std::size_t i = 0; i < n; ++i) keys[i] = static_cast<std::uint32_t>(2 * i);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::vector<std::uint32_t> probes(4000000);
+  for (std::uint32_t& probe : probes) {
+    probe = static_cast<std::uint32_t>(rng() % (2 * n));
+  }
+
+  std::printf("%zu chaves uint32_t\n", n);
+  std::printf("%-10s %12s %12s %12s\n", "árvore", "bytes/elem", "ns/inserção",
+              "ns/busca");
+  // A compacta primeiro: a memória devolvida pela `AVL` seria reaproveitada
+  run<CompactAVL>("CompactAVL", keys, probes);
+  run<AVL>("AVL", keys, probes);
+}
@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/concurrent_set.hpp"
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Vazão de cargas com muitas leituras (95/5 e 99/1 leituras/escritas) com
+// 1, 2, 4, ... threads: `Set` protegido por um mutex global contra
+// `ConcurrentSet`, cujos leitores não usam travas.
+
+// `Set` com um mutex global, como o serviço usa hoje.
+struct LockedSet {
+  bool contain(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return set.search(key);
+  }
+  void insert(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    set.insert(key);
+  }
+  void remove(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    set.remove(key);
+  }
+
+  Set<int> set;
+  std::mutex mutex;
+};
+
+constexpr int key_range = 1 << 20;
+constexpr std::size_t ops_per_thread = 400000;
+
+// Executa a carga em `threads` threads e retorna milhões de operações/s.
+template <class S>
+double run(S& set, unsigned threads, unsigned write_percent) {
+  std::atomic<bool> go(false);
+  std::vector<std::thread> workers;
+  double ms = bench::time_ms([&] {
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        std::mt19937 rng(t + 1);
+        std::size_t hits = 0;
+        while (!go) std::this_thread::yield();
+        for (std::size_t i = 0; i < ops_per_thread; ++i) {
+          int key = static_cast<int>(rng() % key_range);
+          unsigned dice = rng() % 100;
+          if (dice >= write_percent) {
+            hits += set.contain(key);
+          } else if (dice % 2 == 0) {
+            set.insert(key);
+          } else {
+            set.remove(key);
+          }
+        }
+        bench::do_not_optimize(hits);
+      });
+    }
+    go = true;
+    for (std::thread& worker : workers) worker.join();
+  });
+  return threads * ops_per_thread / ms / 1000.0;
+}
+
+template <class S>
+void fill(S& set) {
+  std::mt19937 rng(7);
+  for (int i = 0; i < key_range / 2; ++i) set.insert(rng() % key_range);
+}
+
+int main() {
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("%u chaves em [0, %d) (vazão em Mops/s)\n", key_range / 2,
+              key_range);
+  std::printf("%-8s %-8s %12s %12s\n", "mix", "threads", "Set+mutex",
+              "Concurrent");
+  for (unsigned write_percent : {5u, 1u}) {
+    for (unsigned threads = 1; threads <= std::max(8u, max_threads);
+         threads *= 2) {
+      LockedSet locked;
+      ConcurrentSet<int> concurrent;
+      fill(locked);
+      fill(concurrent);
+      double a = run(locked, threads, write_percent);
+      double b = run(concurrent, threads, write_percent);
+      std::printf("%2u/%-5u %-8u %12.2f %12.2f\n", 100 - write_percent,
+                  write_percent, threads, a, b);
+    }
+  }
+}
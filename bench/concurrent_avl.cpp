@@ -0,0 +1,95 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/avl.hpp"
+#include "../include/concurrent_avl.hpp"
+#include "bench.hpp"
+
+// Vazão de cargas com muitas escritas (50% inserções e remoções, 50%
+// buscas) com 1, 2, 4, ..., 64 threads: `AVL` protegida por um mutex global
+// contra `ConcurrentAVL`, em que escritores em partes diferentes da árvore
+// não se bloqueiam.
+
+// `AVL` com um mutex global.
+struct LockedAVL {
+  bool contain(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return tree.search(key) != nullptr;
+  }
+  void insert(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tree.insert(key);
+  }
+  void remove(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    tree.remove(key);
+  }
+
+  AVL<int> tree;
+  std::mutex mutex;
+};
+
+constexpr int key_range = 1 << 20;
+constexpr std::size_t total_ops = 1 << 22;
+
+// Executa a carga dividida entre `threads` threads e retorna milhões de
+// operações/s.
+template <class S>
+double run(S& set, unsigned threads, unsigned write_percent) {
+  std::atomic<bool> go(false);
+  std::vector<std::thread> workers;
+  std::size_t ops_per_thread = total_ops / threads;
+  double ms = bench::time_ms([&] {
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        std::mt19937 rng(t + 1);
+        std::size_t hits = 0;
+        while (!go) std::this_thread::yield();
+        for (std::size_t i = 0; i < ops_per_thread; ++i) {
+          int key = static_cast<int>(rng() % key_range);
+          unsigned dice = rng() % 100;
+          if (dice >= write_percent) {
+            hits += set.contain(key);
+          } else if (dice % 2 == 0) {
+            set.insert(key);
+          } else {
+            set.remove(key);
+          }
+        }
+        bench::do_not_optimize(hits);
+      });
+    }
+    go = true;
+    for (std::thread& worker : workers) worker.join();
+  });
+  return threads * ops_per_thread / ms / 1000.0;
+}
+
+template <class S>
+void fill(S& set) {
+  std::mt19937 rng(7);
+  for (int i = 0; i < key_range / 2; ++i) set.insert(rng() % key_range);
+}
+
+int main() {
+  std::printf("%u chaves em [0, %d), %u threads de hardware (vazão em Mops/s)\n",
+              key_range / 2, key_range, std::thread::hardware_concurrency());
+  std::printf("%-8s %-8s %12s %12s\n", "mix", "threads", "AVL+mutex",
+              "Concurrent");
+  for (unsigned write_percent : {50u, 90u}) {
+    for (unsigned threads = 1; threads <= 64; threads *= 2) {
+      LockedAVL locked;
+      ConcurrentAVL<int> concurrent;
+      fill(locked);
+      fill(concurrent);
+      double a = run(locked, threads, write_percent);
+      double b = run(concurrent, threads, write_percent);
+      std::printf("%2u/%-5u %-8u %12.2f %12.2f\n", 100 - write_percent,
+                  write_percent, threads, a, b);
+    }
+  }
+}
@@ -0,0 +1,46 @@
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Buscas aleatórias (metade encontra) em `Set` (AVL) e no `FrozenSet` de
+// `Set::freeze()`, com conjuntos de 1M a 32M chaves: os maiores passam de
+// 100 MB e não cabem no último nível de cache.
+
+constexpr std::size_t probe_count = 4000000;
+
+template <class K>
+void run(const char* type) {
+  std::printf("Set<%s> (ns por busca)\n", type);
+  std::printf("%-10s %10s %10s\n", "n", "AVL", "Frozen");
+  for (std::size_t n : {std::size_t(1) << 20, std::size_t(1) << 23,
+                        std::size_t(1) << 25}) {
+    std::vector<K> keys(n);
+    for (std::size_t i = 0; i < n; ++i) keys[i] = static_cast<K>(2 * i);
+    Set<K> set(keys.begin(), keys.end());
+    FrozenSet<K> frozen = set.freeze();
+
+    std::mt19937_64 rng(1);
+    std::vector<K> probes(probe_count);
+    for (K& probe : probes) probe = static_cast<K>(rng() % (2 * n));
+
+    std::size_t hits = 0;
+    double avl_ms = bench::time_ms([&] {
+      for (K probe : probes) hits += set.search(probe);
+    });
+    double frozen_ms = bench::time_ms([&] {
+      for (K probe : probes) hits += frozen.search(probe);
+    });
+    bench::do_not_optimize(hits);
+    std::printf("%-10zu %10.1f %10.1f\n", n, avl_ms * 1e6 / probe_count,
+                frozen_ms * 1e6 / probe_count);
+  }
+  std::printf("\n");
+}
+
+int main() {
+  run<std::uint32_t>("uint32_t");
+  run<std::int64_t>("int64_t");
+}
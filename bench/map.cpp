@@ -0,0 +1,32 @@
+#include "../include/map.hpp"
+
+#include "bench.hpp"
+
+// Inserção de chaves em ordem crescente (timestamps, IDs sequenciais).
+// Com BST o tempo por operação cresce linearmente com n; com AVL cresce
+// como log n.
+
+template <template <class...> class Tree>
+double sorted_insert_ns(int n) {
+  Map<int, int, Tree> map;
+  double ms = bench::time_ms([&] {
+    for (int i = 0; i < n; ++i) {
+      map[i] = i;
+    }
+  });
+  bench::do_not_optimize(map[n - 1]);
+  return ms * 1e6 / n;
+}
+
+int main() {
+  std::printf("%10s %14s %14s\n", "n", "BST (ns/op)", "AVL (ns/op)");
+  for (int n = 1000; n <= 1000000; n *= 2) {
+    double avl = sorted_insert_ns<AVL>(n);
+    // A BST degenerada é quadrática (e recursiva); limita o tamanho.
+    if (n <= 16000) {
+      std::printf("%10d %14.1f %14.1f\n", n, sorted_insert_ns<BST>(n), avl);
+    } else {
+      std::printf("%10d %14s %14.1f\n", n, "-", avl);
+    }
+  }
+}
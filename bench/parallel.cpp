@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/avl.hpp"
+#include "../include/fork_join.hpp"
+#include "bench.hpp"
+
+// Escalabilidade das operações de conjunto paralelas da AVL: união,
+// interseção e diferença de duas árvores grandes com 1, 2, 4, ... threads.
+// A versão sequencial serve de referência e o resultado de cada execução
+// paralela é comparado com ela.
+
+using Tree = AVL<int>;
+
+static std::vector<int> random_keys(std::size_t n, std::mt19937& rng) {
+  std::vector<int> keys(n);
+  for (int& key : keys) key = static_cast<int>(rng() % (4 * n));
+  std::sort(keys.begin(), keys.end());
+  keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+  return keys;
+}
+
+// Mede apenas a operação; a montagem das árvores fica fora da medição.
+template <class Op>
+double run(const std::vector<int>& a, const std::vector<int>& b,
+           std::vector<int>& result, Op op) {
+  Tree left, right;
+  left.assign_sorted(a.begin(), a.end());
+  right.assign_sorted(b.begin(), b.end());
+  double ms = bench::time_ms([&] { op(left, right); });
+  result = left.in_order();
+  return ms;
+}
+
+int main() {
+  std::mt19937 rng(42);
+  const std::size_t n = 4000000;
+  std::vector<int> a = random_keys(n, rng), b = random_keys(n, rng);
+
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("|A| = %zu, |B| = %zu (tempos em ms)\n", a.size(), b.size());
+  std::printf("%-8s %10s %10s %10s\n", "threads", "union", "intersect",
+              "difference");
+
+  std::vector<int> expected[3], result;
+  double serial[3] = {
+      run(a, b, expected[0], [](Tree& l, Tree& r) { l.union_with(r); }),
+      run(a, b, expected[1], [](Tree& l, Tree& r) { l.intersect_with(r); }),
+      run(a, b, expected[2], [](Tree& l, Tree& r) { l.difference_with(r); })};
+  std::printf("%-8s %10.1f %10.1f %10.1f\n", "serial", serial[0], serial[1],
+              serial[2]);
+
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    ForkJoinPool pool(threads);
+    double ms[3];
+    bool same = true;
+    ms[0] = run(a, b, result,
+                [&](Tree& l, Tree& r) { l.union_with(r, pool); });
+    same = same && result == expected[0];
+    ms[1] = run(a, b, result,
+                [&](Tree& l, Tree& r) { l.intersect_with(r, pool); });
+    same = same && result == expected[1];
+    ms[2] = run(a, b, result,
+                [&](Tree& l, Tree& r) { l.difference_with(r, pool); });
+    same = same && result == expected[2];
+    std::printf("%-8u %10.1f %10.1f %10.1f%s\n", threads, ms[0], ms[1], ms[2],
+                same ? "" : "  (RESULTADO DIFERENTE!)");
+  }
+}
@@ -0,0 +1,52 @@
+#include "../include/pool.hpp"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "../include/avl.hpp"
+#include "../include/set.hpp"
+#include "bench.hpp"
+
+// Compara o alocador global com o PoolAllocator em uma AVL com muitos nós
+// pequenos: inserção, remoção de metade e reinserção (reuso da lista livre)
+// e destruição.
+
+template <class Alloc>
+void run(const char* name, const std::vector<int>& keys) {
+  double insert_ms = 0, churn_ms = 0, lookup_ms = 0, destroy_ms = 0;
+  {
+    auto* tree = new AVL<int, std::less<int>, Alloc>();
+    insert_ms = bench::time_ms([&] {
+      for (int key : keys) tree->insert(key);
+    });
+    churn_ms = bench::time_ms([&] {
+      for (std::size_t i = 0; i < keys.size(); i += 2) tree->remove(keys[i]);
+      for (std::size_t i = 0; i < keys.size(); i += 2) tree->insert(keys[i]);
+    });
+    lookup_ms = bench::time_ms([&] {
+      std::size_t found = 0;
+      for (int key : keys) found += tree->contain(key);
+      bench::do_not_optimize(found);
+    });
+    destroy_ms = bench::time_ms([&] { delete tree; });
+  }
+  std::printf("%-16s %10.1f %10.1f %10.1f %10.1f\n", name, insert_ms,
+              churn_ms, lookup_ms, destroy_ms);
+}
+
+int main() {
+  std::mt19937 rng(42);
+  for (int n : {100000, 1000000, 4000000}) {
+    std::vector<int> keys(n);
+    for (int i = 0; i < n; ++i) keys[i] = i;
+    std::shuffle(keys.begin(), keys.end(), rng);
+
+    std::printf("n = %d (tempos em ms)\n", n);
+    std::printf("%-16s %10s %10s %10s %10s\n", "alocador", "insert",
+                "churn", "lookup", "destroy");
+    run<std::allocator<int>>("std::allocator", keys);
+    run<PoolAllocator<int>>("PoolAllocator", keys);
+    std::printf("\n");
+  }
+}
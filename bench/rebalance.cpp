@@ -0,0 +1,76 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "../include/avl.hpp"
+#include "bench.hpp"
+
+// Trabalho de rebalanceamento por operação, com e sem a parada antecipada
+// de `rebalance_path`: nós passados a `balance`, postos (na AVL, alturas)
+// recalculados e rotações, em n inserções de chaves aleatórias seguidas da
+// remoção de todas (padrão 1M, ou o primeiro argumento). A versão sem
+// parada ainda recalcula cada altura uma vez por nível; antes da parada
+// antecipada, a AVL recalculava duas (em `update` e de novo em `balance`).
+
+// A mesma política, mas sempre pedindo a correção do pai.
+template <class Policy>
+struct WithoutEarlyStop : Policy {
+  template <class Node>
+  static bool balance(Node*& node) {
+    Policy::balance(node);
+    return true;
+  }
+};
+
+// Árvore que conta o trabalho da política em `BalanceStats`
+template <class Policy>
+using Tree =
+    AVL<int, std::less<int>, std::allocator<int>, CountingBalance<Policy>>;
+
+void print(const char* phase, const BalanceStats& stats, double ms,
+           std::size_t n) {
+  double ops = static_cast<double>(n);
+  std::printf("  %-9s %10.2f %10.2f %10.3f %10.1f\n", phase,
+              stats.fixups / ops, stats.rank_updates / ops,
+              stats.rotations / ops, ms * 1e6 / ops);
+}
+
+template <class Policy>
+void run(const char* name, const std::vector<int>& keys,
+         const std::vector<int>& order) {
+  std::printf("%s\n  %-9s %10s %10s %10s %10s\n", name, "", "balance",
+              "postos", "rotações", "ns");
+  Tree<Policy> tree;
+  BalanceStats& stats = BalanceStats::current();
+  stats = BalanceStats();
+  double insert_ms = bench::time_ms([&] {
+    for (int key : keys) tree.insert(key);
+  });
+  print("inserção", stats, insert_ms, keys.size());
+  stats = BalanceStats();
+  double remove_ms = bench::time_ms([&] {
+    for (int key : order) tree.remove(key);
+  });
+  print("remoção", stats, remove_ms, order.size());
+}
+
+int main(int argc, char** argv) {
+  std::size_t n = argc > 1 ? std::atol(argv[1]) : 1000000;
+  std::mt19937 rng(42);
+  std::vector<int> keys(n);
+  for (std::size_t i = 0; i < n; ++i) keys[i] = static_cast<int>(i);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  std::vector<int> order(keys);
+  std::shuffle(order.begin(), order.end(), rng);
+
+  std::printf("%zu chaves, média por operação\n\n", n);
+  run<AVLBalance>("AVL", keys, order);
+  run<WithoutEarlyStop<AVLBalance>>("AVL sem parada", keys, order);
+  run<RedBlackBalance>("RB", keys, order);
+  run<WithoutEarlyStop<RedBlackBalance>>("RB sem parada", keys, order);
+  run<WAVLBalance>("WAVL", keys, order);
+  run<WithoutEarlyStop<WAVLBalance>>("WAVL sem parada", keys, order);
+  run<TreapBalance>("Treap", keys, order);
+  run<WithoutEarlyStop<TreapBalance>>("Treap sem parada", keys, order);
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../include/map.hpp"
+#include "../include/sharded_map.hpp"
+#include "bench.hpp"
+
+// Vazão de uma carga mista (buscas, incrementos com `operator[]` e
+// remoções) com 1, 2, 4, ... threads: um `Map` protegido por um mutex
+// global contra `ShardedMap` com 64 partes.
+
+// `Map` com um mutex global.
+struct LockedMap {
+  bool contain(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return map.contain(key);
+  }
+  void increment(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++map[key];
+  }
+  void remove(int key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    map.remove(key);
+  }
+
+  Map<int, long> map;
+  std::mutex mutex;
+};
+
+struct Sharded {
+  bool contain(int key) { return map.contain(key); }
+  void increment(int key) { ++map[key].get(); }
+  void remove(int key) { map.remove(key); }
+
+  ShardedMap<int, long, 64> map;
+};
+
+constexpr int key_range = 1 << 18;
+constexpr std::size_t ops_per_thread = 400000;
+
+// Executa a carga em `threads` threads e retorna milhões de operações/s.
+template <class M>
+double run(M& map, unsigned threads, unsigned write_percent) {
+  std::atomic<bool> go(false);
+  std::vector<std::thread> workers;
+  double ms = bench::time_ms([&] {
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        std::mt19937 rng(t + 1);
+        std::size_t hits = 0;
+        while (!go) std::this_thread::yield();
+        for (std::size_t i = 0; i < ops_per_thread; ++i) {
+          int key = static_cast<int>(rng() % key_range);
+          unsigned dice = rng() % 100;
+          if (dice >= write_percent) {
+            hits += map.contain(key);
+          } else if (dice % 4 != 0) {
+            map.increment(key);
+          } else {
+            map.remove(key);
+          }
+        }
+        bench::do_not_optimize(hits);
+      });
+    }
+    go = true;
+    for (std::thread& worker : workers) worker.join();
+  });
+  return threads * ops_per_thread / ms / 1000.0;
+}
+
+int main() {
+  unsigned max_threads = std::max(1u, std::thread::hardware_concurrency());
+  std::printf("chaves em [0, %d) (vazão em Mops/s)\n", key_range);
+  std::printf("%-8s %-8s %12s %12s\n", "mix", "threads", "Map+mutex",
+              "Sharded");
+  for (unsigned write_percent : {20u, 80u}) {
+    for (unsigned threads = 1; threads <= std::max(8u, max_threads);
+         threads *= 2) {
+      LockedMap locked;
+      Sharded sharded;
+      double a = run(locked, threads, write_percent);
+      double b = run(sharded, threads, write_percent);
+      std::printf("%2u/%-5u %-8u %12.2f %12.2f\n", 100 - write_percent,
+                  write_percent, threads, a, b);
+    }
+  }
+}
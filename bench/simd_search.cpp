@@ -0,0 +1,131 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "../include/btree.hpp"
+#include "../include/map.hpp"
+#include "../include/set.hpp"
+#include "../include/simd_search.hpp"
+#include "bench.hpp"
+
+// 1) Busca dentro de um bloco ordenado do tamanho de um nó de `BTree` (60
+//    inteiros de 32 bits ou 30 de 64): busca binária contra
+//    `simd::count_less`.
+// 2) Buscas aleatórias em conjuntos de 1M chaves: `Set` (AVL, um nó por
+//    chave), `BTree` com busca binária nos nós (um comparador próprio
+//    desliga a busca vetorial) e `BTree` com `simd::count_less`.
+// 3) O mesmo com pares chave-valor: `Map` (AVL), uma `BTree` de pares com
+//    busca binária e `Map<T, T, BTree>`, que busca na cópia contígua das
+//    chaves de cada nó.
+
+// Ordem padrão, mas de outro tipo que `std::less`: força a busca escalar.
+template <class T>
+struct PlainLess {
+  bool operator()(const T& a, const T& b) const { return a < b; }
+};
+
+// Ordena pares pela chave sem expô-la à árvore: força a busca escalar.
+template <class T>
+struct FirstLess {
+  using is_transparent = void;
+  bool operator()(const std::pair<T, T>& a, const std::pair<T, T>& b) const {
+    return a.first < b.first;
+  }
+  bool operator()(const std::pair<T, T>& a, T key) const {
+    return a.first < key;
+  }
+  bool operator()(T key, const std::pair<T, T>& b) const {
+    return key < b.first;
+  }
+};
+
+constexpr std::size_t block_probes = 20000000;
+constexpr std::size_t set_size = 1 << 20;
+constexpr std::size_t set_probes = 4000000;
+
+template <class T>
+void run(const char* type) {
+  std::mt19937_64 rng(3);
+  constexpr std::size_t block_size = 240 / sizeof(T);
+  std::vector<T> block(block_size);
+  for (T& key : block) key = static_cast<T>(rng() % 1000000);
+  std::sort(block.begin(), block.end());
+  std::vector<T> probes(1024);
+  for (T& probe : probes) probe = static_cast<T>(rng() % 1000000);
+
+  std::size_t sum = 0;
+  double scalar_ms = bench::time_ms([&] {
+    for (std::size_t i = 0; i < block_probes; ++i) {
+      sum += simd::count_less_scalar(block.data(), block_size,
+                                     probes[i % probes.size()]);
+    }
+  });
+  double vector_ms = bench::time_ms([&] {
+    for (std::size_t i = 0; i < block_probes; ++i) {
+      sum += simd::count_less(block.data(), block_size,
+                              probes[i % probes.size()]);
+    }
+  });
+
+  std::vector<T> keys(set_size);
+  for (std::size_t i = 0; i < set_size; ++i) keys[i] = static_cast<T>(2 * i);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  Set<T> avl;
+  BTree<T, PlainLess<T>> scalar_tree;
+  BTree<T> vector_tree;
+  Map<T, T> avl_map;
+  BTree<std::pair<T, T>, FirstLess<T>> scalar_map;
+  Map<T, T, BTree> vector_map;
+  for (T key : keys) {
+    avl.insert(key);
+    scalar_tree.insert(key);
+    vector_tree.insert(key);
+    avl_map.insert_or_assign(key, key);
+    scalar_map.insert({key, key});
+    vector_map.insert_or_assign(key, key);
+  }
+  std::vector<T> lookups(set_probes);
+  for (T& lookup : lookups) lookup = static_cast<T>(rng() % (2 * set_size));
+  double avl_ms = bench::time_ms([&] {
+    for (T lookup : lookups) sum += avl.search(lookup);
+  });
+  double scalar_tree_ms = bench::time_ms([&] {
+    for (T lookup : lookups) sum += scalar_tree.contain(lookup);
+  });
+  double vector_tree_ms = bench::time_ms([&] {
+    for (T lookup : lookups) sum += vector_tree.contain(lookup);
+  });
+  double avl_map_ms = bench::time_ms([&] {
+    for (T lookup : lookups) sum += avl_map.contain(lookup);
+  });
+  double scalar_map_ms = bench::time_ms([&] {
+    for (T lookup : lookups) sum += scalar_map.contain(lookup);
+  });
+  double vector_map_ms = bench::time_ms([&] {
+    for (T lookup : lookups) sum += vector_map.contain(lookup);
+  });
+  bench::do_not_optimize(sum);
+
+  std::printf("%s (ns por busca, AVX2 %s)\n", type,
+              simd::has_avx2 ? "sim" : "não");
+  std::printf("  bloco de %zu: binária %6.2f  vetorial %6.2f\n", block_size,
+              scalar_ms * 1e6 / block_probes, vector_ms * 1e6 / block_probes);
+  std::printf("  %zu chaves: AVL %6.1f  BTree binária %6.1f  BTree vetorial "
+              "%6.1f\n",
+              set_size, avl_ms * 1e6 / set_probes,
+              scalar_tree_ms * 1e6 / set_probes,
+              vector_tree_ms * 1e6 / set_probes);
+  std::printf("  %zu pares: Map AVL %6.1f  BTree binária %6.1f  Map BTree "
+              "vetorial %6.1f\n\n",
+              set_size, avl_map_ms * 1e6 / set_probes,
+              scalar_map_ms * 1e6 / set_probes,
+              vector_map_ms * 1e6 / set_probes);
+}
+
+int main() {
+  run<std::int32_t>("int32_t");
+  run<std::int64_t>("int64_t");
+  run<std::uint64_t>("uint64_t");
+}
@@ -1,9 +1,41 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 #include<cmath>
 #include <cstdlib>
 
+#include "balance.hpp"
+#include "fork_join.hpp"
+
+/**
+ * @brief Tipo de uma operação de `apply_batch`.
+ */
+enum class BatchKind {
+  insert,  ///< Insere se a chave não existir (como `insert`).
+  assign,  ///< Insere ou substitui o elemento equivalente.
+  erase    ///< Remove o elemento equivalente, se existir.
+};
+
+/**
+ * @brief Operação de um lote de `apply_batch`.
+ *
+ * Em `BatchKind::erase`, só a chave de `value` é usada.
+ */
+template <class T>
+struct BatchOp {
+  BatchKind kind;  ///< O que fazer.
+  T value;         ///< Valor a inserir ou atribuir, ou chave a remover.
+};
+
 /**
  * @brief Classe que representa uma Árvore Binária de Busca (BST).
  *
@@ -11,8 +43,19 @@
  * inserção e remoção.
  *
  * @tparam T Tipo dos elementos armazenados na árvore.
+ * @tparam Compare Comparador que define a ordem dos elementos. Se for
+ * transparente (define `is_transparent`), as buscas aceitam qualquer tipo
+ * comparável com `T`, sem construir um `T` temporário.
+ * @tparam Alloc Alocador usado para os nós (via rebind), por exemplo
+ * `PoolAllocator<T>`.
+ * @tparam Balance Política de balanceamento (veja `balance.hpp`): AVL por
+ * padrão, ou `RedBlackBalance`, `WAVLBalance` e `TreapBalance`, que fazem
+ * menos rotações por atualização em troca de uma árvore um pouco mais alta.
+ * Os apelidos `RedBlackTree`, `WAVLTree` e `Treap` servem de árvore para
+ * `Set` e `Map`.
  */
-template <class T>
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>, class Balance = AVLBalance>
 class AVL {
  private:
   /**
@@ -22,7 +65,12 @@ class AVL {
     T data;           ///< Valor armazenado no nó.
     TreeNode* left;   ///< Ponteiro para o filho à esquerda.
     TreeNode* right;  ///< Ponteiro para o filho à direita.
-    int height;  ///< Altura do nó na árvore. Usada para balanceamento da AVL.
+    TreeNode* parent;  ///< Ponteiro para o pai (nullptr na raiz).
+    std::size_t size;  ///< Quantidade de nós na subárvore (incluindo este).
+    int rank;  ///< Posto usado pela política de balanceamento (na AVL, a altura).
+
+    /// Se o trabalho de balanceamento é contado (veja `CountingBalance`).
+    static constexpr bool count_balance = Balance::counting;
 
     /**
      * @brief Construtor que inicializa o nó com um valor.
@@ -32,9 +80,13 @@ class AVL {
     TreeNode(const T& value);
 
     /**
-     * @brief Destrutor do nó, libera recursivamente seus filhos.
+     * @brief Construtor que constrói o valor do nó no próprio lugar.
+     *
+     * @param args Argumentos repassados ao construtor de `T`.
      */
-    ~TreeNode();
+    template <class... Args>
+    explicit TreeNode(std::in_place_t, Args&&... args);
+
 
     /**
      * @brief Retorna o nó com o maior valor da subárvore.
@@ -51,44 +103,206 @@ class AVL {
     TreeNode* min();
   };
 
+ public:
+  /**
+   * @brief Iterador bidirecional que percorre a árvore em ordem (in-order).
+   *
+   * Caminha pelos ponteiros `parent` dos nós, sem copiar elementos e sem
+   * memória extra. Os elementos são somente leitura, pois alterá-los
+   * quebraria a ordenação. Inserções não invalidam iteradores; uma remoção
+   * invalida os iteradores do elemento removido.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() : node(nullptr), tree(nullptr) {}
+
+    reference operator*() const { return node->data; }
+    pointer operator->() const { return &node->data; }
+
+    /**
+     * @brief Avança para o sucessor: o menor da subárvore direita ou, se não
+     * houver, o primeiro ancestral do qual viemos pela esquerda.
+     */
+    const_iterator& operator++() {
+      if (node->right) {
+        node = node->right;
+        while (node->left) node = node->left;
+      } else {
+        const TreeNode* parent = node->parent;
+        while (parent && node == parent->right) {
+          node = parent;
+          parent = parent->parent;
+        }
+        node = parent;
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Volta para o predecessor. A partir de `end()`, vai ao maior
+     * elemento.
+     */
+    const_iterator& operator--() {
+      if (!node) {
+        node = tree->root;
+        while (node && node->right) node = node->right;
+      } else if (node->left) {
+        node = node->left;
+        while (node->right) node = node->right;
+      } else {
+        const TreeNode* parent = node->parent;
+        while (parent && node == parent->left) {
+          node = parent;
+          parent = parent->parent;
+        }
+        node = parent;
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    const_iterator operator--(int) {
+      const_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return node == other.node;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return node != other.node;
+    }
+
+   private:
+    friend class AVL;
+
+    const_iterator(const TreeNode* node, const AVL* tree)
+        : node(node), tree(tree) {}
+
+    const TreeNode* node;  ///< Nó atual (nullptr em `end()`).
+    const AVL* tree;  ///< Árvore percorrida, usada para voltar de `end()`.
+  };
+
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = reverse_iterator;
+
+ private:
+  /**
+   * @brief Recalcula o tamanho de um nó a partir dos filhos.
+   *
+   * @param node Nó a ser atualizado (não nulo).
+   */
+  void update(TreeNode* node);
+
+  /**
+   * @brief Limite para a altura da árvore.
+   *
+   * A altura de uma AVL com n nós é no máximo ~1,44 log2(n), ou seja, menos
+   * de 100 mesmo para 2^64 nós (cada política define o seu limite). Por
+   * isso as operações iterativas guardam o caminho percorrido em um vetor
+   * de tamanho fixo na pilha (veja `Path`).
+   */
+  static constexpr int max_height = Balance::max_height;
+
   /**
-   * @brief Retorna a altura de um nó da árvore.
+   * @brief Ligações (ponteiros para os ponteiros de filho) visitadas na
+   * descida, da raiz até o nó mais fundo.
    *
-   * @param node Ponteiro para o nó.
-   * @return Altura do nó se não for nulo, ou -1 caso seja nullptr.
+   * As `max_height` primeiras ficam num vetor na pilha; o resto vai para um
+   * `std::vector`, que só é usado se a árvore passar do limite (a `Treap`
+   * não tem altura máxima garantida).
    */
-  int height(TreeNode* node) const;
+  class Path {
+   public:
+    /// Acrescenta uma ligação. Só lança `std::bad_alloc`, e antes de mudar
+    /// o caminho.
+    void push(TreeNode** link) {
+      if (depth < max_height) {
+        links[depth] = link;
+      } else {
+        spill.push_back(link);
+      }
+      ++depth;
+    }
+
+    TreeNode**& operator[](int i) {
+      return i < max_height ? links[i] : spill[i - max_height];
+    }
+
+    /// Quantidade de ligações no caminho.
+    int size() const { return depth; }
+
+   private:
+    TreeNode** links[max_height];
+    std::vector<TreeNode**> spill;
+    int depth = 0;
+  };
 
   /**
-   * @brief Atualiza o balanceamento da árvore AVL a partir de um nó.
+   * @brief Recalcula os tamanhos e rebalanceia os nós de um caminho, de baixo
+   * para cima, com `Balance::balance`.
    *
-   * Recalcula a altura do nó, verifica o fator de balanceamento
-   * e realiza rotações simples ou duplas conforme necessário para
-   * manter as propriedades da AVL.
+   * O rebalanceamento para no primeiro nó cuja subárvore não muda de posto
+   * (na AVL, de altura); dali para cima só o tamanho de cada nó muda, em
+   * uma unidade.
    *
-   * @param node Referência para o ponteiro do nó a ser balanceado.
+   * @param path Ligações visitadas na descida.
+   * @param grew `true` depois de uma inserção, `false` depois de uma remoção.
    */
-  void balance(TreeNode*& node);
+  void rebalance_path(Path& path, bool grew);
 
   /**
-   * @brief Insere um valor na árvore recursivamente.
+   * @brief Insere um valor na árvore iterativamente.
+   *
+   * O nó só é obtido (por `make`) depois que a descida confirma que o valor
+   * não existe, então um valor repetido não é copiado nem movido.
    *
    * @param node Ponteiro de referência para o nó atual.
-   * @param value Valor a ser inserido.
+   * @param value Valor a ser inserido, usado nas comparações.
+   * @param make Função que retorna o nó a ser ligado na árvore.
    * @return `true` se a inserção foi bem-sucedida, `false` se o valor já
    * existia.
    */
-  bool insert(TreeNode*& node, const T& value);
+  template <class Make>
+  bool insert(TreeNode*& node, const T& value, Make&& make);
+
+  /**
+   * @brief Busca `key` a partir de `node` e, se não achar, insere um valor
+   * construído com `args` na mesma descida.
+   *
+   * @param node Ponteiro de referência para o nó atual.
+   * @param found Recebe o endereço do valor encontrado ou inserido.
+   * @param key Chave comparável com `T` através do operador `<`.
+   * @param args Argumentos para construir o novo valor.
+   * @return `true` se houve inserção, `false` se a chave já existia.
+   */
+  template <class Key, class... Args>
+  bool try_emplace(TreeNode*& node, T*& found, const Key& key,
+                   Args&&... args);
 
   /**
-   * @brief Remove um valor da árvore recursivamente.
+   * @brief Remove um valor da árvore iterativamente.
    *
    * @param node Ponteiro de referência para o nó atual.
    * @param value Valor a ser removido.
    * @return `true` se a remoção foi bem-sucedida, `false` se o valor não foi
    * encontrado.
    */
-  bool remove(TreeNode*& node, const T& value);
+  template <class Key>
+  bool remove(TreeNode*& node, const Key& value);
 
   /**
    * @brief Verifica se a árvore contém um valor específico.
@@ -97,360 +311,2287 @@ class AVL {
    * @param value Valor a ser buscado.
    * @return `true` se o valor estiver na árvore, `false` caso contrário.
    */
-  bool contain(const TreeNode* const node, const T& value) const;
+  template <class Key>
+  bool contain(const TreeNode* const node, const Key& value) const;
+
+  /**
+   * @brief Chama `fn(value)` e diz se a travessia deve continuar.
+   *
+   * Funções que retornam `void` nunca interrompem a travessia.
+   *
+   * @return `false` se `fn` retornou `false`, `true` caso contrário.
+   */
+  template <class F>
+  static bool visit(F& fn, const T& value);
 
   /**
-   * @brief Executa a travessia in-order recursiva.
+   * @brief Executa a travessia in-order na subárvore de `node`.
    *
    * Visita a subárvore esquerda, depois o nó atual e em seguida a subárvore
-   * direita. Os valores visitados são armazenados em `result`.
+   * direita, chamando `fn` para cada valor. Caminha pelos ponteiros `parent`,
+   * sem recursão e sem alocar memória.
    *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @param node Raiz da subárvore.
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
    */
-  void in_order(const TreeNode* const node, std::vector<T>& result) const;
+  template <class F>
+  bool in_order(const TreeNode* const node, F& fn) const;
 
   /**
-   * @brief Executa a travessia pre-order recursiva.
+   * @brief Executa a travessia pre-order na subárvore de `node`.
    *
-   * Visita o nó atual, em seguida a subárvore esquerda e depois a direita.
-   * Os valores visitados são armazenados em `result`.
+   * Visita o nó atual, em seguida a subárvore esquerda e depois a direita,
+   * chamando `fn` para cada valor, sem recursão e sem alocar memória.
    *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @param node Raiz da subárvore.
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
    */
-  void pre_order(const TreeNode* const node, std::vector<T>& result) const;
+  template <class F>
+  bool pre_order(const TreeNode* const node, F& fn) const;
 
   /**
-   * @brief Executa a travessia post-order recursiva.
+   * @brief Executa a travessia post-order na subárvore de `node`.
    *
-   * Visita a subárvore esquerda, depois a direita e por último o nó atual.
-   * Os valores visitados são armazenados em `result`.
+   * Visita a subárvore esquerda, depois a direita e por último o nó atual,
+   * chamando `fn` para cada valor, sem recursão e sem alocar memória.
    *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @param node Raiz da subárvore.
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
    */
-  void post_order(const TreeNode* const node, std::vector<T>& result) const;
+  template <class F>
+  bool post_order(const TreeNode* const node, F& fn) const;
 
- public:
   /**
-   * @brief Construtor da árvore (inicialmente vazia).
+   * @brief Busca o nó que contém um valor.
+   *
+   * @param node Ponteiro para o nó atual.
+   * @param value Valor a ser buscado.
+   * @return Ponteiro para o nó ou nullptr se o valor não estiver na árvore.
    */
-  AVL();
+  template <class Key>
+  TreeNode* find_node(TreeNode* node, const Key& value) const;
 
   /**
-   * @brief Destrutor da árvore, libera todos os nós.
+   * @brief Tamanho da subárvore de um nó (0 para nullptr).
    */
-  ~AVL();
+  static std::size_t subtree_size(const TreeNode* node) {
+    return node ? node->size : 0;
+  }
 
   /**
-   * @brief Insere um novo valor na árvore.
+   * @brief Conta os valores menores que `value` na árvore.
    *
-   * @param value Valor a ser inserido.
-   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   * @param value Valor (ou chave comparável) de referência.
+   * @return Quantidade de valores estritamente menores.
    */
-  bool insert(const T& value);
+  template <class Key>
+  std::size_t rank_of(const Key& value) const;
 
   /**
-   * @brief Remove um valor da árvore.
+   * @brief Busca o nó do k-ésimo menor valor (a partir de 0).
    *
-   * @param value Valor a ser removido.
-   * @return `true` se o valor foi removido, `false` se não estava presente.
+   * @param k Posição em ordem crescente.
+   * @return Ponteiro para o nó ou nullptr se `k >= size()`.
    */
-  bool remove(const T& value);
+  const TreeNode* select_node(std::size_t k) const;
 
   /**
-   * @brief Verifica se um valor está presente na árvore.
+   * @brief Constrói, de cima para baixo, a subárvore com `values[lo, hi)`.
    *
-   * @param value Valor a ser verificado.
-   * @return `true` se presente, `false` caso contrário.
+   * O elemento do meio vira a raiz da subárvore; o nó é ligado a `link`
+   * antes dos filhos, então uma exceção no meio deixa uma árvore válida
+   * (incompleta) que pode ser liberada por `clear`.
    */
-  bool contain(const T& value) const;
+  void build_sorted(std::vector<T>& values, std::size_t lo, std::size_t hi,
+                    TreeNode* parent, TreeNode*& link);
 
   /**
-   * @brief Retorna os valores da árvore em ordem (in-order).
+   * @brief Busca o primeiro nó cujo valor não é menor que `value`.
    *
-   * Visita a subárvore esquerda, o nó atual e a subárvore direita.
-   *
-   * @return Vetor com os valores em ordem.
+   * @param value Valor (ou chave comparável) de referência.
+   * @return Ponteiro para o nó ou nullptr se todos forem menores.
    */
-  std::vector<T> in_order() const;
+  template <class Key>
+  const TreeNode* lower_bound_node(const Key& value) const;
 
   /**
-   * @brief Retorna os valores da árvore em pré-ordem (pre-order).
-   *
-   * Visita o nó atual, depois a subárvore esquerda e depois a direita.
+   * @brief Busca o primeiro nó cujo valor é maior que `value`.
    *
-   * @return Vetor com os valores em pré-ordem.
+   * @param value Valor (ou chave comparável) de referência.
+   * @return Ponteiro para o nó ou nullptr se nenhum for maior.
    */
-  std::vector<T> pre_order() const;
+  template <class Key>
+  const TreeNode* upper_bound_node(const Key& value) const;
 
   /**
-   * @brief Retorna os valores da árvore em pós-ordem (post-order).
-   *
-   * Visita a subárvore esquerda, depois a direita e por fim o nó atual.
+   * @brief Busca o último nó cujo valor é menor (ou menor ou igual) a `value`.
    *
-   * @return Vetor com os valores em pós-ordem.
+   * @param value Valor (ou chave comparável) de referência.
+   * @param inclusive Se `true`, aceita um valor equivalente a `value`.
+   * @return Ponteiro para o nó ou nullptr se não houver.
    */
-  std::vector<T> post_order() const;
+  template <class Key>
+  const TreeNode* below_node(const Key& value, bool inclusive) const;
 
   /**
-   * @brief Verifica se a árvore está balanceada (propriedade da AVL).
-   *
-   * @return `true` se todos os nós estão balanceados, `false` caso contrário.
+   * @brief Implementação de `split`.
    */
-  bool is_balanced() const { return is_balanced(root).first; }
+  template <class Key>
+  bool split_into(const Key& key, AVL& left, AVL& right);
 
   /**
-   * @brief Verifica recursivamente se a subárvore está balanceada e retorna sua
-   * altura.
-   *
-   * @param node Nó atual.
-   * @return Par (está_balanceada, altura).
+   * @brief Percorre em ordem os valores do intervalo [lo, hi).
    */
-  std::pair<bool, int> is_balanced(TreeNode* node) const {
-    if (!node) return {true, -1};
+  template <class Key, class F>
+  bool range_of(const Key& lo, const Key& hi, F& fn) const;
 
-    auto left = is_balanced(node->left);
-    auto right = is_balanced(node->right);
+  /**
+   * @brief Retorna o valor de um nó, ou nullptr se o nó for nulo.
+   */
+  static const T* value_of(const TreeNode* node) {
+    return node ? &node->data : nullptr;
+  }
 
-    bool balanced =
-        left.first && right.first && std::abs(left.second - right.second) <= 1;
-    int node_height = 1 + std::max(left.second, right.second);
+  /**
+   * @brief Junta duas subárvores balanceadas e um nó pivô em uma única
+   * árvore, com `Balance::join`.
+   *
+   * Todos os valores de `left` devem ser menores que o do pivô e os de
+   * `right` maiores. Desce apenas pela espinha da subárvore mais alta, então
+   * custa O(|altura(left) - altura(right)| + 1).
+   *
+   * @return Raiz da árvore resultante (o `parent` dela não é definido).
+   */
+  TreeNode* join_nodes(TreeNode* left, TreeNode* pivot, TreeNode* right);
 
-    return {balanced, node_height};
-  }
+  /**
+   * @brief Junta duas subárvores sem pivô (valores de `left` menores que os
+   * de `right`), usando o menor nó de `right` como pivô.
+   */
+  TreeNode* join2(TreeNode* left, TreeNode* right);
 
- private:
-  TreeNode* root;  ///< Ponteiro para a raiz da árvore.
-};
+  /**
+   * @brief Remove o menor nó da subárvore `node`.
+   *
+   * @param node Raiz da subárvore (não nula).
+   * @param rest Recebe a subárvore restante, já balanceada.
+   * @return O nó removido, sem filhos.
+   */
+  TreeNode* pop_min(TreeNode* node, TreeNode*& rest);
 
+  /**
+   * @brief Divide a subárvore `node` em torno de `key`, em O(log n).
+   *
+   * @param left Recebe a AVL com os valores menores que `key`.
+   * @param right Recebe a AVL com os valores maiores que `key`.
+   * @return O nó equivalente a `key`, desligado e sem filhos, ou nullptr.
+   */
+  template <class Key>
+  TreeNode* split_nodes(TreeNode* node, const Key& key, TreeNode*& left,
+                        TreeNode*& right);
 
-template <class T>
-int AVL<T>::height(TreeNode* node) const { //a altura de um nó é a quantidade de arestas no caminho mais longo até a folha 
-  return node ? node->height : -1;
-}
+  /**
+   * @brief Operações de conjunto entre as subárvores `a` e `b`.
+   *
+   * Consomem as duas entradas: cada nó é religado no resultado ou liberado.
+   * Dividem `b` (ou `a`) pela raiz da outra e resolvem as duas metades
+   * recursivamente, em O(m log(n/m + 1)) para tamanhos m <= n. Em valores
+   * repetidos, o nó de `a` é o que permanece.
+   *
+   * As duas chamadas recursivas são independentes (atuam em subárvores
+   * disjuntas) e são disparadas por `ctx.fork`; os nós que sobram são
+   * entregues a `ctx.discard_node`/`ctx.discard_tree`.
+   *
+   * @param ctx `SerialContext` ou `ParallelContext`.
+   * @return Raiz do resultado (o `parent` dela não é definido).
+   */
+  template <class Ctx>
+  TreeNode* union_nodes(TreeNode* a, TreeNode* b, Ctx& ctx);
+  template <class Ctx>
+  TreeNode* intersect_nodes(TreeNode* a, TreeNode* b, Ctx& ctx);
+  template <class Ctx>
+  TreeNode* difference_nodes(TreeNode* a, TreeNode* b, Ctx& ctx);
+  template <class Ctx>
+  TreeNode* symmetric_difference_nodes(TreeNode* a, TreeNode* b, Ctx& ctx);
 
-template <class T>
-void AVL<T>::balance(TreeNode*& node) { //calcula o FB = altura da esquerda - altura da direita, tem q ser [-1, 0, 1]
-    if (!node) return;
-
-    int balance_factor = height(node->left) - height(node->right);
-
-    if (balance_factor > 1) { 
-        if (height(node->left->left) >= height(node->left->right)) {
-            TreeNode* L = node->left;
-            node->left = L->right;
-            L->right = node;
-            node = L;
-        } else {
-            TreeNode* L = node->left;
-            TreeNode* LR = L->right;
-            L->right = LR->left;
-            LR->left = L;
-            node->left = LR->right;
-            LR->right = node;
-            node = LR;
-        }
-    } else if (balance_factor < -1) {
-        if (height(node->right->right) >= height(node->right->left)) {
-            TreeNode* R = node->right;
-            node->right = R->left;
-            R->left = node;
-            node = R;
-        } else {
-            TreeNode* R = node->right;
-            TreeNode* RL = R->left;
-            R->left = RL->right;
-            RL->right = R;
-            node->right = RL->left;
-            RL->left = node;
-            node = RL;
-        }
+  /**
+   * @brief Estado de um `apply_batch`: as operações agrupadas por chave,
+   * os nós já alocados e os resultados.
+   */
+  template <class Op, class KeyOf>
+  struct BatchPlan {
+    static constexpr std::size_t original = static_cast<std::size_t>(-1);
+
+    const std::vector<Op>& ops;
+    KeyOf& key_of;
+    std::vector<std::size_t> order;   ///< Índices das operações, por chave.
+    std::vector<std::size_t> groups;  ///< Início de cada grupo em `order`.
+    std::vector<TreeNode*> made;      ///< Nó alocado para cada operação.
+    std::vector<bool> results;        ///< Resultado de cada operação.
+
+    decltype(auto) key(std::size_t group) const {
+      return key_of(ops[order[groups[group]]]);
     }
-    
-   //atualizar a altura 
-    node->height = 1 + std::max(height(node->left), height(node->right));
-}
 
+    /**
+     * @brief Aplica, na ordem do lote, as operações de um grupo a uma chave
+     * inicialmente presente ou ausente.
+     *
+     * @param source Recebe a operação que forneceu o valor final, ou
+     * `original` se o valor presente no início foi mantido.
+     * @param record Se `true`, grava os resultados das operações.
+     * @return Se a chave termina presente.
+     */
+    bool settle(std::size_t group, bool present, std::size_t& source,
+                bool record);
+  };
 
+  /**
+   * @brief Aplica os grupos `[lo, hi)` de `plan` à subárvore `node`.
+   *
+   * Os grupos são divididos pelo valor de `node` e cada lado é resolvido
+   * recursivamente; depois o nó (mantido, trocado ou removido) junta os
+   * dois lados com `join_nodes` ou `join2`. Só os caminhos que têm
+   * operações são visitados, e cada subárvore tocada é rebalanceada uma
+   * única vez, na junção. Com `node` nulo, o grupo do meio faz o papel do
+   * nó, o que constrói uma subárvore balanceada com as inserções.
+   *
+   * Não aloca nem constrói elementos: os nós novos já estão em `plan.made`.
+   *
+   * @return Raiz do resultado (o `parent` dela não é definido).
+   */
+  template <class Op, class KeyOf>
+  TreeNode* apply_groups(TreeNode* node, std::size_t lo, std::size_t hi,
+                         BatchPlan<Op, KeyOf>& plan);
 
-template <class T>
-AVL<T>::TreeNode::TreeNode(const T& value) : data (value), left(nullptr), right(nullptr), height(0){} //sempre que inserimos um novo valor, altura 0 pq ele nao tem filho 
-  
+  /// Operações de conjunto disponíveis em `combine`.
+  enum class SetOperation { Union, Intersection, Difference, SymmetricDifference };
 
+  /**
+   * @brief Execução sequencial das operações de conjunto: os nós que sobram
+   * são liberados na hora.
+   */
+  struct SerialContext {
+    AVL& tree;
 
-template <class T>
-AVL<T>::TreeNode::~TreeNode() { //se o filho tiver outros filhos, o destrutor daquele filho erá chamado automaticamente. Garante que toda a árvore seja deletada
-  delete left;
-  delete right;
-}
+    template <class F, class G>
+    void fork(std::size_t, F&& f, G&& g) {
+      f();
+      g();
+    }
+    void discard_node(TreeNode* node) { tree.destroy_node(node); }
+    void discard_tree(TreeNode* node) { tree.clear(node); }
+    void release() {}
+  };
 
-template <class T>
-typename AVL<T>::TreeNode* AVL<T>::TreeNode::max() { //encontra o nó com o valor maior em uma subárvore, o maior sempre a direita 
- TreeNode* current = this;
- while (current ->right != nullptr){
-  current = current->right;
- }
- return current;
-} 
+  /**
+   * @brief Execução das operações de conjunto em um `ForkJoinPool`.
+   *
+   * Ramos com mais de `grain` nós rodam em paralelo. Com `std::allocator`
+   * os nós que sobram são liberados na hora. Com outros alocadores (que
+   * podem não ser thread-safe, como o `PoolAllocator`) eles são encadeados
+   * pelo campo `parent` em uma pilha sem trava e liberados por `release`
+   * ao final, na thread que chamou.
+   */
+  struct ParallelContext {
+    AVL& tree;
+    ForkJoinPool& pool;
+    std::size_t grain;
+    std::atomic<TreeNode*> garbage{nullptr};  ///< Subárvores a liberar.
+
+    template <class F, class G>
+    void fork(std::size_t work, F&& f, G&& g) {
+      if (work > grain) {
+        pool.fork_join(f, g);
+      } else {
+        f();
+        g();
+      }
+    }
+    /// `std::allocator` pode ser usado por várias threads ao mesmo tempo.
+    static constexpr bool shared_alloc() {
+      return std::is_same_v<NodeAlloc, std::allocator<TreeNode>>;
+    }
 
-template <class T>
-typename AVL<T>::TreeNode* AVL<T>::TreeNode::min() { //encontra o  valor menor na subárvore, menor sempre a esquerda 
-  TreeNode* current = this;
-  while (current ->left!=nullptr){
-    current = current->left;
-  }
-  return current;
-}
-template <class T>
-AVL<T>::AVL(): root(nullptr) {}
+    void discard_node(TreeNode* node) {
+      if constexpr (shared_alloc()) {
+        tree.destroy_node(node);
+      } else {
+        node->left = node->right = nullptr; //os filhos continuam em uso
+        discard_tree(node);
+      }
+    }
+    void discard_tree(TreeNode* node) {
+      if (!node) return;
+      if constexpr (shared_alloc()) {
+        tree.clear(node);
+        return;
+      }
+      node->parent = garbage.load(std::memory_order_relaxed);
+      while (!garbage.compare_exchange_weak(node->parent, node,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+      }
+    }
+    void release() {
+      TreeNode* node = garbage.exchange(nullptr, std::memory_order_acquire);
+      while (node) {
+        TreeNode* next = node->parent;
+        tree.clear(node);
+        node = next;
+      }
+    }
+  };
 
-template <class T>
-AVL<T>::~AVL() {
-   delete root;
-}
+  /**
+   * @brief Aplica `op` entre esta árvore e `other` (que é consumida).
+   */
+  template <class Ctx>
+  void combine(AVL& other, SetOperation op, Ctx& ctx);
 
-template <class T>
-bool AVL<T>::insert(const T& value) {
-  return insert(root, value);
-}
+  /**
+   * @brief Toma todos os nós de `other`, que fica vazia.
+   *
+   * Se os alocadores forem diferentes, os valores são copiados para nós
+   * alocados por esta árvore e os nós de `other` são liberados. Se a cópia
+   * falhar, `other` não é alterada.
+   *
+   * @return Raiz da subárvore tomada.
+   */
+  TreeNode* adopt(AVL& other);
 
-template <class T>
-bool AVL<T>::remove(const T& value) {
-  return remove(root, value);
-}
+  /**
+   * @brief Primeira metade de `adopt`: retorna os nós de `other` (se os
+   * alocadores forem iguais) ou uma cópia deles alocada por esta árvore,
+   * sem alterar `other`.
+   */
+  TreeNode* borrow(const AVL& other);
 
-template <class T>
-bool AVL<T>::contain(const T& value) const {
-   return contain(root, value);
-}
+  /**
+   * @brief Cópia balanceada dos valores da subárvore `node` (de qualquer
+   * árvore), alocada por esta árvore. Se falhar, nada fica alocado.
+   */
+  TreeNode* copy_values(const TreeNode* node);
 
-template <class T>
-bool AVL<T>::insert(TreeNode*& node, const T& value) {
-  if(!node){
-    node = new TreeNode(value); //cria um novo nó com o valor 
-    return true;
+  /**
+   * @brief Segunda metade de `adopt`: esvazia `other`, liberando os nós dela
+   * se `borrow` os copiou.
+   */
+  void release(AVL& other) noexcept;
 
-  }
+  /**
+   * @brief Primeira metade de `hand_over`: retorna `node` (se `other` usar
+   * um alocador igual) ou uma cópia dele alocada por `other`, sem alterar
+   * nenhuma das árvores.
+   */
+  TreeNode* lend(TreeNode* node, AVL& other);
 
-  if (value==node->data){//se for o mesmo número 
-    return false;
-  }
+  /**
+   * @brief Entrega a subárvore `node` (desta árvore) para `other`, cujo
+   * conteúdo anterior é descartado. O inverso de `adopt`.
+   *
+   * @param lent Resultado de `lend(node, other)`; se for uma cópia, `node`
+   * é liberado.
+   */
+  void hand_over(TreeNode* node, TreeNode* lent, AVL& other) noexcept;
 
-  bool result = false; //se inseriu ou não
-  if (value < node->data){ //se for menor, vai para a esquerda 
-    result = insert(node->left, value);
-    
-  }else {
-    result = insert(node->right, value); //se for maior vai para a direita 
+  /**
+   * @brief Define a raiz da árvore, ajustando o `parent` dela.
+   */
+  void set_root(TreeNode* node) {
+    root = node;
+    if (root) root->parent = nullptr;
   }
 
-  if(result){
-    node->height = 1 + std::max(height(node->left), height(node->right)); //atualiza a altura do nó 
-    balance(node); //faz o balanceamento 
-  }
+  /**
+   * @brief Clona a subárvore `source`, com nós alocados por esta árvore.
+   *
+   * Percorre a origem em pré-ordem pelos ponteiros `parent`, sem recursão.
+   * Se uma alocação falhar, o que já foi copiado é liberado.
+   *
+   * @return Raiz da cópia (com `parent` nulo).
+   */
+  TreeNode* clone(const TreeNode* source);
 
-  return result;
-}
+  /**
+   * @brief Cria a cópia de um único nó (sem os filhos).
+   */
+  TreeNode* copy_node(const TreeNode* source, TreeNode* parent);
 
-template <class T>
-bool AVL<T>::contain(const TreeNode* const node, const T& value) const {
-  if(!node) return false; //árvore vazia 
+  /// Alocador dos nós, obtido de `Alloc` por rebind.
+  using NodeAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<TreeNode>;
+  using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
 
-   if (value == node->data) return true; //achou o valor 
+  /**
+   * @brief Aloca e constrói um nó com o alocador da árvore.
+   *
+   * @param args Argumentos repassados ao construtor de `TreeNode`.
+   * @return Ponteiro para o novo nó.
+   */
+  template <class... Args>
+  TreeNode* create_node(Args&&... args);
 
-   if(value < node->data){
-    return contain(node->left, value); //busca a esquerda 
+  /**
+   * @brief Destrói e libera um único nó (os filhos não são tocados).
+   *
+   * @param node Nó a ser liberado.
+   */
+  void destroy_node(TreeNode* node);
 
-   }else {
-    return contain(node->right, value); //busca a direita 
-   }
-}
+  /**
+   * @brief Libera todos os nós de uma subárvore, sem recursão.
+   *
+   * @param node Raiz da subárvore.
+   */
+  void clear(TreeNode* node);
 
-template <class T>
-bool AVL<T>::remove(TreeNode*& node, const T& value) {
-  if (!node) return false;  // não achou
+ public:
+  /**
+   * @brief Construtor da árvore (inicialmente vazia).
+   */
+  AVL();
 
-    bool result = false;
-    if (value < node->data) { //se for menor, busca na esquerda
-        result = remove(node->left, value);
-    } else if (value > node->data) { //se for maior, verifica na direita 
-        result = remove(node->right, value);
-    } else {  // achou!
-        result = true;
-
-        if (!node->left) { //caso tenha só filho a direita ou nenhum
-            TreeNode* temp = node;
-            node = node->right;
-            temp->left = temp->right = nullptr;  // evita deletar subárvores
-            delete temp;
-        } else if (!node->right) {//caso só tenha filho na esquerda 
-            TreeNode* temp = node;
-            node = node->left;
-            temp->left = temp->right = nullptr;
-            delete temp;
-        } else {  // dois filhos
-            TreeNode* minRight = node->right->min();
-            node->data = minRight->data;  // copia o valor do sucessor
-            remove(node->right, minRight->data);  // remove o sucessor
-        }
+  /**
+   * @brief Construtor da árvore vazia com um alocador específico.
+   *
+   * Árvores que recebem cópias do mesmo `PoolAllocator` compartilham a mesma
+   * reserva de nós.
+   *
+   * @param alloc Alocador usado para os nós.
+   */
+  explicit AVL(const Alloc& alloc);
+
+  /**
+   * @brief Destrutor da árvore, libera todos os nós.
+   */
+  ~AVL();
+
+  /**
+   * @brief Construtor de cópia: clona a estrutura de `other` em O(n).
+   *
+   * Cada nó é copiado com os mesmos filhos, altura e tamanho, sem
+   * comparações e sem rebalanceamento. Os nós são alocados em pré-ordem, de
+   * forma que com um alocador de slabs (`PoolAllocator`) a cópia fica
+   * contígua na memória.
+   */
+  AVL(const AVL& other);
+
+  /**
+   * @brief Construtor de movimento, em O(1): toma os nós de `other`, que
+   * fica vazia (e continua utilizável).
+   */
+  AVL(AVL&& other) noexcept;
+
+  /**
+   * @brief Atribuição por cópia, com o mesmo clone estrutural do construtor
+   * de cópia. Se a cópia falhar, a árvore não é alterada.
+   */
+  AVL& operator=(const AVL& other);
+
+  /**
+   * @brief Atribuição por movimento.
+   *
+   * Em O(1) quando o alocador se propaga na atribuição por movimento ou é
+   * igual ao de `other`; caso contrário os nós de `other` são clonados com o
+   * alocador desta árvore.
+   */
+  AVL& operator=(AVL&& other) noexcept(
+      NodeAllocTraits::propagate_on_container_move_assignment::value ||
+      NodeAllocTraits::is_always_equal::value);
+
+  /**
+   * @brief Troca o conteúdo com `other` em O(1).
+   */
+  void swap(AVL& other) noexcept;
+
+  friend void swap(AVL& a, AVL& b) noexcept { a.swap(b); }
+
+  /**
+   * @brief Insere um novo valor na árvore.
+   *
+   * @param value Valor a ser inserido.
+   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   */
+  bool insert(const T& value);
+
+  /**
+   * @brief Insere um valor, movendo-o para o novo nó.
+   *
+   * @param value Valor a ser inserido; só é movido se for inserido.
+   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   */
+  bool insert(T&& value);
+
+  /**
+   * @brief Constrói um valor diretamente no nó, a partir de `args`.
+   *
+   * Como a posição depende do valor, o nó é construído antes da descida e
+   * liberado se um valor equivalente já existir.
+   *
+   * @param args Argumentos repassados ao construtor de `T`.
+   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   */
+  template <class... Args>
+  bool emplace(Args&&... args);
+
+  /**
+   * @brief Insere um valor construído no lugar, caso `key` não exista.
+   *
+   * A busca e a inserção são feitas em uma única descida. O valor só é
+   * construído (a partir de `args`) quando a chave não está na árvore.
+   *
+   * @param key Chave a ser buscada; deve ser comparável com `T` pelo
+   * operador `<` nos dois sentidos.
+   * @param args Argumentos repassados ao construtor de `T`.
+   * @return Par (ponteiro para o valor encontrado ou inserido, `true` se
+   * houve inserção).
+   */
+  template <class Key, class... Args>
+  std::pair<T*, bool> try_emplace(const Key& key, Args&&... args);
+
+  /**
+   * @brief Remove um valor da árvore.
+   *
+   * @param value Valor a ser removido.
+   * @return `true` se o valor foi removido, `false` se não estava presente.
+   */
+  bool remove(const T& value);
+
+  /**
+   * @brief Remove o valor equivalente a uma chave de outro tipo.
+   *
+   * Disponível apenas com comparador transparente.
+   *
+   * @param key Chave comparável com `T` pelo comparador.
+   * @return `true` se o valor foi removido, `false` se não estava presente.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool remove(const Key& key) {
+    return remove(root, key);
+  }
+
+  /**
+   * @brief Verifica se um valor está presente na árvore.
+   *
+   * @param value Valor a ser verificado.
+   * @return `true` se presente, `false` caso contrário.
+   */
+  bool contain(const T& value) const;
+
+  /**
+   * @brief Verifica se há um valor equivalente a uma chave de outro tipo.
+   *
+   * Disponível apenas com comparador transparente.
+   *
+   * @param key Chave comparável com `T` pelo comparador.
+   * @return `true` se presente, `false` caso contrário.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    return contain(root, key);
+  }
+
+  /**
+   * @brief Retorna os valores da árvore em ordem (in-order).
+   *
+   * Visita a subárvore esquerda, o nó atual e a subárvore direita.
+   *
+   * @return Vetor com os valores em ordem.
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Retorna os valores da árvore em pré-ordem (pre-order).
+   *
+   * Visita o nó atual, depois a subárvore esquerda e depois a direita.
+   *
+   * @return Vetor com os valores em pré-ordem.
+   */
+  std::vector<T> pre_order() const;
+
+  /**
+   * @brief Retorna os valores da árvore em pós-ordem (post-order).
+   *
+   * Visita a subárvore esquerda, depois a direita e por fim o nó atual.
+   *
+   * @return Vetor com os valores em pós-ordem.
+   */
+  std::vector<T> post_order() const;
+
+  /**
+   * @brief Substitui o conteúdo da árvore pelos valores de [first, last).
+   *
+   * Se a entrada já estiver ordenada e sem repetições, a árvore perfeitamente balanceada
+   * é montada em O(n), sem comparações nem rotações além da verificação da
+   * ordem. Caso contrário os valores são ordenados (de forma estável) e as
+   * repetições descartadas, mantendo a primeira ocorrência, como faria uma
+   * sequência de `insert`.
+   *
+   * @param first Início da sequência de valores.
+   * @param last Fim da sequência de valores.
+   */
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  /**
+   * @brief Variante de `assign_sorted` que recebe os valores em um vetor,
+   * de onde são movidos para os nós sem cópia intermediária.
+   */
+  void assign_sorted(std::vector<T> values);
+
+  /**
+   * @brief Retorna uma cópia do alocador (do tipo `Alloc`) usado pela árvore.
+   */
+  Alloc get_allocator() const { return Alloc(alloc); }
+
+  /**
+   * @brief Substitui o conteúdo da árvore por `left`, `pivot` e `right`.
+   *
+   * Os nós de `left` e `right` são religados sem cópia (se usarem um
+   * alocador igual ao desta árvore), e as duas ficam vazias. Esta árvore
+   * pode ser uma delas. Custa O(|altura(left) - altura(right)| + 1). Se
+   * uma alocação falhar, as três árvores não são alteradas.
+   *
+   * @param left Árvore com valores menores que `pivot`.
+   * @param pivot Valor intermediário, inserido no resultado.
+   * @param right Árvore com valores maiores que `pivot`.
+   * @throw std::invalid_argument se a ordem acima não for respeitada.
+   */
+  void join(AVL& left, const T& pivot, AVL& right);
+
+  /**
+   * @brief Divide a árvore em torno de `key`, em O(log n).
+   *
+   * Os valores menores que `key` vão para `left` e os maiores para `right`
+   * (o conteúdo anterior delas é descartado); esta árvore fica vazia,
+   * exceto se for uma das duas. O valor equivalente a `key`, se existir, é
+   * removido. Se uma alocação falhar, esta árvore mantém os seus valores e
+   * `left` e `right` não são alteradas.
+   *
+   * @param key Valor (ou chave comparável) de referência.
+   * @param left Recebe os valores menores.
+   * @param right Recebe os valores maiores; deve ser diferente de `left`.
+   * @return `true` se havia um valor equivalente a `key`.
+   */
+  bool split(const T& key, AVL& left, AVL& right) {
+    return split_into(key, left, right);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool split(const Key& key, AVL& left, AVL& right) {
+    return split_into(key, left, right);
+  }
+
+  /**
+   * @brief Operações de conjunto que consomem `other`.
+   *
+   * O resultado fica nesta árvore e `other` fica vazia: os nós de `other`
+   * que sobram são religados aqui (sem cópia, se os alocadores forem
+   * iguais) e os demais são liberados. Baseadas em `split` e `join`, custam
+   * O(m log(n/m + 1)) para tamanhos m <= n, bem menos que m buscas
+   * independentes quando um lado é pequeno.
+   *
+   * - `union_with`: valores presentes em qualquer uma das árvores.
+   * - `intersect_with`: valores presentes nas duas.
+   * - `difference_with`: valores desta árvore que não estão em `other`.
+   * - `symmetric_difference_with`: valores presentes em exatamente uma.
+   *
+   * @param other Segunda árvore; pode ser esta mesma.
+   */
+  void union_with(AVL& other);
+  void intersect_with(AVL& other);
+  void difference_with(AVL& other);
+  void symmetric_difference_with(AVL& other);
+
+  /// Tamanho mínimo (em nós) de um ramo para que ele rode em outra thread.
+  static constexpr std::size_t default_grain = 4096;
+
+  /**
+   * @brief Versões paralelas das operações de conjunto.
+   *
+   * Depois de dividir as árvores pela raiz de uma delas, as duas metades são
+   * resolvidas em paralelo com `pool.fork_join`, recursivamente, enquanto
+   * tiverem mais de `grain` nós. O resultado é idêntico ao da versão
+   * sequencial (inclusive quais nós permanecem). Todas as alocações e
+   * liberações acontecem na thread que chama.
+   *
+   * @param other Segunda árvore, consumida como na versão sequencial.
+   * @param pool Pool de threads que executa os ramos.
+   * @param grain Abaixo deste tamanho um ramo roda sequencialmente; valores
+   * maiores reduzem a sincronização, menores expõem mais paralelismo.
+   */
+  void union_with(AVL& other, ForkJoinPool& pool,
+                  std::size_t grain = default_grain);
+  void intersect_with(AVL& other, ForkJoinPool& pool,
+                      std::size_t grain = default_grain);
+  void difference_with(AVL& other, ForkJoinPool& pool,
+                       std::size_t grain = default_grain);
+  void symmetric_difference_with(AVL& other, ForkJoinPool& pool,
+                                 std::size_t grain = default_grain);
+
+  /**
+   * @brief Insere ou remove um lote de valores de uma vez.
+   *
+   * O lote vira uma AVL (via `assign_sorted`, em O(k) se já estiver
+   * ordenado) e é combinado com esta árvore por `union_with` ou
+   * `difference_with`, em O(k log(n/k + 1)) em vez de k descidas
+   * independentes. Valores já presentes em `insert_batch` não são
+   * substituídos, como em `insert`.
+   *
+   * @param first Início do lote.
+   * @param last Fim do lote.
+   */
+  template <class InputIt>
+  void insert_batch(InputIt first, InputIt last);
+  template <class InputIt>
+  void erase_batch(InputIt first, InputIt last);
+
+  /**
+   * @brief Versões paralelas de `insert_batch` e `erase_batch` (veja as
+   * versões paralelas de `union_with`).
+   */
+  template <class InputIt>
+  void insert_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                    std::size_t grain = default_grain);
+  template <class InputIt>
+  void erase_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                   std::size_t grain = default_grain);
+
+  /**
+   * @brief Aplica um lote misto de inserções, atribuições e remoções em uma
+   * única passada pela árvore.
+   *
+   * O lote é ordenado por chave (operações sobre a mesma chave mantêm a
+   * ordem do lote e são aplicadas em sequência) e intercalado com a árvore
+   * recursivamente, como nas operações de conjunto: em O(k log(n/k + 1)),
+   * em vez de k descidas e k rebalanceamentos independentes.
+   *
+   * Todos os nós novos são alocados antes de a árvore ser alterada; se uma
+   * alocação (ou a construção de um valor) lançar exceção, a árvore fica
+   * como estava. Um elemento substituído (por `BatchKind::assign`, ou
+   * removido e inserido de novo) ocupa um nó novo, então iteradores para
+   * ele são invalidados.
+   *
+   * @param ops Operações, na ordem em que devem ser aplicadas.
+   * @return Resultado de cada operação, na ordem de `ops`: em `insert`, se
+   * houve inserção; em `assign`, se houve inserção (`false` se substituiu);
+   * em `erase`, se havia o que remover.
+   */
+  std::vector<bool> apply_batch(const std::vector<BatchOp<T>>& ops) {
+    return apply_batch(
+        ops, [](const BatchOp<T>& op) -> const T& { return op.value; },
+        [](const BatchOp<T>& op) -> const T& { return op.value; });
+  }
+
+  /**
+   * @brief Versão genérica de `apply_batch`, usada por `Map`.
+   *
+   * Cada operação tem um campo `kind`; `key_of(op)` retorna a sua chave
+   * (comparável com `T` e consigo mesma por `Compare`) e `make(op)` o valor
+   * a inserir ou atribuir.
+   */
+  template <class Op, class KeyOf, class Make>
+  std::vector<bool> apply_batch(const std::vector<Op>& ops, KeyOf key_of,
+                                Make make);
+
+  /**
+   * @brief Quantidade de elementos na árvore, em O(1).
+   */
+  std::size_t size() const { return subtree_size(root); }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return root == nullptr; }
+
+  /**
+   * @brief Posição que `value` ocupa (ou ocuparia) em ordem crescente.
+   *
+   * Usa os tamanhos das subárvores, percorrendo um único caminho.
+   *
+   * @param value Valor de referência (não precisa estar na árvore).
+   * @return Quantidade de elementos estritamente menores que `value`.
+   */
+  std::size_t rank(const T& value) const { return rank_of(value); }
+
+  /**
+   * @brief `rank` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  std::size_t rank(const Key& key) const {
+    return rank_of(key);
+  }
+
+  /**
+   * @brief Retorna o k-ésimo menor elemento (a partir de 0).
+   *
+   * @param k Posição em ordem crescente.
+   * @return Referência constante ao elemento.
+   * @throw std::out_of_range se `k >= size()`.
+   */
+  const T& select(std::size_t k) const;
+
+  /**
+   * @brief Iterador para o k-ésimo menor elemento (a partir de 0).
+   *
+   * Permite continuar a varredura a partir de uma posição, como em
+   * percentis ("os 10 seguintes ao p90").
+   *
+   * @param k Posição em ordem crescente.
+   * @return Iterador para o elemento ou `end()` se `k >= size()`.
+   */
+  const_iterator nth(std::size_t k) const {
+    return const_iterator(select_node(k), this);
+  }
+
+  /**
+   * @brief Iterador para o primeiro elemento que não é menor que `value`.
+   *
+   * @param value Valor de referência (não precisa estar na árvore).
+   * @return Iterador para o elemento ou `end()` se todos forem menores.
+   */
+  const_iterator lower_bound(const T& value) const {
+    return const_iterator(lower_bound_node(value), this);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key& key) const {
+    return const_iterator(lower_bound_node(key), this);
+  }
+
+  /**
+   * @brief Iterador para o primeiro elemento maior que `value`.
+   *
+   * @param value Valor de referência (não precisa estar na árvore).
+   * @return Iterador para o elemento ou `end()` se nenhum for maior.
+   */
+  const_iterator upper_bound(const T& value) const {
+    return const_iterator(upper_bound_node(value), this);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key& key) const {
+    return const_iterator(upper_bound_node(key), this);
+  }
+
+  /**
+   * @brief Maior elemento menor ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* floor(const T& value) const {
+    return value_of(below_node(value, true));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* floor(const Key& key) const {
+    return value_of(below_node(key, true));
+  }
+
+  /**
+   * @brief Menor elemento maior ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* ceiling(const T& value) const {
+    return value_of(lower_bound_node(value));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* ceiling(const Key& key) const {
+    return value_of(lower_bound_node(key));
+  }
+
+  /**
+   * @brief Maior elemento estritamente menor que `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* predecessor(const T& value) const {
+    return value_of(below_node(value, false));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* predecessor(const Key& key) const {
+    return value_of(below_node(key, false));
+  }
+
+  /**
+   * @brief Menor elemento estritamente maior que `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* successor(const T& value) const {
+    return value_of(upper_bound_node(value));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* successor(const Key& key) const {
+    return value_of(upper_bound_node(key));
+  }
+
+  /**
+   * @brief Percorre em ordem os elementos do intervalo [lo, hi).
+   *
+   * Desce até `lo` em O(log n) e segue pelo sucessor de cada nó, então o
+   * custo é O(log n + k) para k elementos visitados.
+   *
+   * @param lo Limite inferior (inclusivo).
+   * @param hi Limite superior (exclusivo).
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se o intervalo foi percorrido até o fim, `false` se `fn`
+   * interrompeu a varredura.
+   */
+  template <class F>
+  bool range(const T& lo, const T& hi, F&& fn) const {
+    return range_of(lo, hi, fn);
+  }
+  template <class Key, class F, class C = Compare,
+            class = typename C::is_transparent>
+  bool range(const Key& lo, const Key& hi, F&& fn) const {
+    return range_of(lo, hi, fn);
+  }
+
+  /**
+   * @brief Quantidade de elementos no intervalo [lo, hi), em O(log n).
+   *
+   * Calculada como a diferença entre os ranks dos limites; retorna 0 se
+   * `hi` não for maior que `lo`.
+   */
+  std::size_t count_range(const T& lo, const T& hi) const {
+    std::size_t a = rank_of(lo), b = rank_of(hi);
+    return b > a ? b - a : 0;
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  std::size_t count_range(const Key& lo, const Key& hi) const {
+    std::size_t a = rank_of(lo), b = rank_of(hi);
+    return b > a ? b - a : 0;
+  }
+
+  /**
+   * @brief Percorre a árvore em ordem, chamando `fn` para cada valor.
+   *
+   * Os valores são passados por referência constante, sem cópias e sem
+   * alocação. Se `fn` retornar `false`, a travessia para ali.
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se todos os valores foram visitados, `false` se a
+   * travessia foi interrompida.
+   */
+  template <class F>
+  bool for_each_in_order(F&& fn) const {
+    return in_order(root, fn);
+  }
+
+  /**
+   * @brief Percorre a árvore em pré-ordem, chamando `fn` para cada valor.
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se todos os valores foram visitados, `false` se a
+   * travessia foi interrompida.
+   */
+  template <class F>
+  bool for_each_pre_order(F&& fn) const {
+    return pre_order(root, fn);
+  }
+
+  /**
+   * @brief Percorre a árvore em pós-ordem, chamando `fn` para cada valor.
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se todos os valores foram visitados, `false` se a
+   * travessia foi interrompida.
+   */
+  template <class F>
+  bool for_each_post_order(F&& fn) const {
+    return post_order(root, fn);
+  }
+
+  /**
+   * @brief Iterador para o menor elemento (ou `end()` se vazia).
+   */
+  const_iterator begin() const;
+
+  /**
+   * @brief Iterador para a posição após o maior elemento.
+   */
+  const_iterator end() const { return const_iterator(nullptr, this); }
+
+  /**
+   * @brief Iteradores para percorrer a árvore do maior para o menor.
+   */
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+  /**
+   * @brief Busca um valor na árvore.
+   *
+   * @param value Valor a ser buscado.
+   * @return Ponteiro para o valor armazenado ou nullptr se não estiver na
+   * árvore.
+   */
+  T* search(const T& value);
+  const T* search(const T& value) const;
+
+  /**
+   * @brief Busca por uma chave de outro tipo (comparador transparente).
+   *
+   * @param key Chave comparável com `T` pelo comparador.
+   * @return Ponteiro para o valor ou nullptr se não estiver na árvore.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  T* search(const Key& key) {
+    TreeNode* node = find_node(root, key);
+    return node ? &node->data : nullptr;
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* search(const Key& key) const {
+    const TreeNode* node = find_node(root, key);
+    return node ? &node->data : nullptr;
+  }
+
+  /**
+   * @brief Verifica se a árvore está balanceada (invariante da política
+   * `Balance`, que na AVL é a propriedade da AVL).
+   *
+   * @return `true` se todos os nós estão balanceados, `false` caso contrário.
+   */
+  bool is_balanced() const { return is_balanced(root).first; }
+
+  /**
+   * @brief Verifica recursivamente se a subárvore está balanceada e retorna sua
+   * altura.
+   *
+   * @param node Nó atual.
+   * @return Par (está_balanceada, altura).
+   */
+  std::pair<bool, int> is_balanced(TreeNode* node) const {
+    if (!node) return {true, -1};
+
+    auto left = is_balanced(node->left);
+    auto right = is_balanced(node->right);
+
+    bool balanced = left.first && right.first && Balance::valid(node);
+    int node_height = 1 + std::max(left.second, right.second);
+
+    return {balanced, node_height};
+  }
+
+ private:
+  TreeNode* root;  ///< Ponteiro para a raiz da árvore.
+  Compare comp;    ///< Comparador que define a ordem dos elementos.
+  NodeAlloc alloc;  ///< Alocador dos nós.
+};
+
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::update(TreeNode* node) {
+  node->size = 1 + subtree_size(node->left) + subtree_size(node->right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>::TreeNode::TreeNode(const T& value) : data (value), left(nullptr), right(nullptr), parent(nullptr), size(1), rank(Balance::initial_rank()){} //sempre que inserimos um novo valor, ele é uma folha 
+  
+
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class... Args>
+AVL<T, Compare, Alloc, Balance>::TreeNode::TreeNode(std::in_place_t, Args&&... args)
+    : data(std::forward<Args>(args)...), left(nullptr), right(nullptr),
+      parent(nullptr), size(1), rank(Balance::initial_rank()) {}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::TreeNode::max() { //encontra o nó com o valor maior em uma subárvore, o maior sempre a direita 
+ TreeNode* current = this;
+ while (current ->right != nullptr){
+  current = current->right;
+ }
+ return current;
+} 
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::TreeNode::min() { //encontra o  valor menor na subárvore, menor sempre a esquerda 
+  TreeNode* current = this;
+  while (current ->left!=nullptr){
+    current = current->left;
+  }
+  return current;
+}
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>::AVL(): root(nullptr), comp(), alloc() {}
+
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>::AVL(const Alloc& alloc)
+    : root(nullptr), comp(), alloc(alloc) {}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class... Args>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::create_node(
+    Args&&... args) {
+  TreeNode* node = NodeAllocTraits::allocate(alloc, 1);
+  try {
+    NodeAllocTraits::construct(alloc, node, std::forward<Args>(args)...);
+  } catch (...) {
+    NodeAllocTraits::deallocate(alloc, node, 1);
+    throw;
+  }
+  return node;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::destroy_node(TreeNode* node) {
+  NodeAllocTraits::destroy(alloc, node);
+  NodeAllocTraits::deallocate(alloc, node, 1);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::clear(TreeNode* node) {
+  // Desmonta a árvore com rotações à direita, em espaço constante na pilha
+  while (node) {
+    if (node->left) {
+      TreeNode* left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
+    } else {
+      TreeNode* right = node->right;
+      destroy_node(node);
+      node = right;
     }
+  }
+}
 
-    if (node) {
-        node->height = 1 + std::max(height(node->left), height(node->right));
-        balance(node);
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::rebalance_path(Path& path, bool grew) {
+  int i = path.size() - 1;
+  while (i >= 0) { //sobe do nó mais fundo até a raiz
+    TreeNode*& node = *path[i--];
+    update(node); //atualiza o tamanho do nó
+    Balance::template count<TreeNode>(&BalanceStats::fixups);
+    if (!Balance::balance(node)) break; //a subárvore não mudou: acima, só os tamanhos
+  }
+  for (; i >= 0; --i) {
+    TreeNode* node = *path[i];
+    if (grew) {
+      ++node->size;
+    } else {
+      --node->size;
     }
+  }
+}
 
-    return result;
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>::~AVL() {
+  clear(root);
 }
 
-template <class T>
-void AVL<T>::in_order(const TreeNode* const node,
-                      std::vector<T>& result) const {
-                         if (!node) return;
-    in_order(node->left, result); 
-    result.push_back(node->data);
-    in_order(node->right, result);
-                      }
+template <class T, class Compare, class Alloc, class Balance>
+bool AVL<T, Compare, Alloc, Balance>::insert(const T& value) {
+  return insert(root, value, [&] { return create_node(value); });
+}
 
-template <class T>
-std::vector<T> AVL<T>::in_order() const {
-   std::vector<T> result;
-  in_order(root, result);  
-  return result; 
+template <class T, class Compare, class Alloc, class Balance>
+bool AVL<T, Compare, Alloc, Balance>::insert(T&& value) {
+  return insert(root, value,
+                [&] { return create_node(std::in_place, std::move(value)); });
 }
 
-template <class T>
-void AVL<T>::pre_order(const TreeNode* const node,
-                       std::vector<T>& result) const {
-if (!node) return; 
+template <class T, class Compare, class Alloc, class Balance>
+template <class... Args>
+bool AVL<T, Compare, Alloc, Balance>::emplace(Args&&... args) {
+  TreeNode* fresh = create_node(std::in_place, std::forward<Args>(args)...);
+  bool inserted;
+  try {
+    inserted = insert(root, fresh->data, [fresh] { return fresh; });
+  } catch (...) {
+    //o comparador (ou a pilha do caminho) falhou antes de ligar o nó
+    destroy_node(fresh);
+    throw;
+  }
+  if (!inserted) destroy_node(fresh);
+  return inserted;
+}
 
-  result.push_back(node->data);
-  pre_order(node->left, result);
-  pre_order(node->right, result);
-                       }
+template <class T, class Compare, class Alloc, class Balance>
+bool AVL<T, Compare, Alloc, Balance>::remove(const T& value) {
+  return remove(root, value);
+}
 
-template <class T>
-std::vector<T> AVL<T>::pre_order() const {
-  std::vector<T> result; 
-  pre_order(root, result);
+template <class T, class Compare, class Alloc, class Balance>
+bool AVL<T, Compare, Alloc, Balance>::contain(const T& value) const {
+   return contain(root, value);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Make>
+bool AVL<T, Compare, Alloc, Balance>::insert(TreeNode*& node, const T& value, Make&& make) {
+  Path path; //ligações visitadas na descida
+
+  TreeNode** link = &node;
+  TreeNode* parent = nullptr;
+  while (*link) {
+    path.push(link);
+    parent = *link;
+    if (comp(value, (*link)->data)) { //se for menor, vai para a esquerda
+      link = &(*link)->left;
+    } else if (comp((*link)->data, value)) { //se for maior vai para a direita
+      link = &(*link)->right;
+    } else { //se for o mesmo número
+      return false;
+    }
+  }
+
+  *link = make(); //cria (ou obtém) o nó com o valor
+  (*link)->parent = parent;
+  rebalance_path(path, true);
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key, class... Args>
+std::pair<T*, bool> AVL<T, Compare, Alloc, Balance>::try_emplace(const Key& key, Args&&... args) {
+  T* found = nullptr;
+  bool inserted = try_emplace(root, found, key, std::forward<Args>(args)...);
+  return {found, inserted};
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key, class... Args>
+bool AVL<T, Compare, Alloc, Balance>::try_emplace(TreeNode*& node, T*& found, const Key& key,
+                         Args&&... args) {
+  Path path;
+
+  TreeNode** link = &node;
+  TreeNode* parent = nullptr;
+  while (*link) {
+    path.push(link);
+    parent = *link;
+    if (comp(key, (*link)->data)) {
+      link = &(*link)->left;
+    } else if (comp((*link)->data, key)) {
+      link = &(*link)->right;
+    } else {
+      found = &(*link)->data; //já existe, nada a construir
+      return false;
+    }
+  }
+
+  *link = create_node(std::in_place, std::forward<Args>(args)...);
+  (*link)->parent = parent;
+  found = &(*link)->data; //as rotações não movem o valor, o endereço continua válido
+  rebalance_path(path, true);
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+bool AVL<T, Compare, Alloc, Balance>::contain(const TreeNode* const node, const Key& value) const {
+  const TreeNode* current = node;
+  while (current) {
+    if (comp(value, current->data)) {
+      current = current->left; //busca a esquerda
+    } else if (comp(current->data, value)) {
+      current = current->right; //busca a direita
+    } else {
+      return true; //achou o valor
+    }
+  }
+  return false;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+bool AVL<T, Compare, Alloc, Balance>::remove(TreeNode*& node, const Key& value) {
+  Path path;
+
+  TreeNode** link = &node;
+  while (*link) {
+    if (comp(value, (*link)->data)) { //se for menor, busca na esquerda
+      path.push(link);
+      link = &(*link)->left;
+    } else if (comp((*link)->data, value)) { //se for maior, verifica na direita
+      path.push(link);
+      link = &(*link)->right;
+    } else { // achou!
+      break;
+    }
+  }
+
+  TreeNode* target = *link;
+  if (!target) return false; // não achou
+
+  if (!target->left || !target->right) { //no máximo um filho, que sobe para o lugar do nó
+    TreeNode* child = target->left ? target->left : target->right;
+    if (child) child->parent = target->parent;
+    *link = child;
+    destroy_node(target);
+  } else { // dois filhos: o sucessor é retirado e religado no lugar do nó
+    int target_depth = path.size();
+    path.push(link);
+    TreeNode** successor_link = &target->right;
+    while ((*successor_link)->left) {
+      path.push(successor_link);
+      successor_link = &(*successor_link)->left;
+    }
+    TreeNode* successor = *successor_link;
+    *successor_link = successor->right;
+    if (successor->right) successor->right->parent = successor->parent;
+
+    successor->left = target->left;
+    successor->right = target->right;
+    successor->parent = target->parent;
+    successor->rank = target->rank;
+    successor->size = target->size;
+    if (successor->left) successor->left->parent = successor;
+    if (successor->right) successor->right->parent = successor;
+    *link = successor;
+    // o caminho passava por `target->right`, que agora é `successor->right`
+    if (path.size() > target_depth + 1) path[target_depth + 1] = &successor->right;
+    destroy_node(target);
+  }
+
+  rebalance_path(path, false);
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class F>
+bool AVL<T, Compare, Alloc, Balance>::visit(F& fn, const T& value) {
+  if constexpr (std::is_void_v<std::invoke_result_t<F&, const T&>>) {
+    fn(value);
+    return true;
+  } else {
+    return static_cast<bool>(fn(value));
+  }
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class F>
+bool AVL<T, Compare, Alloc, Balance>::in_order(const TreeNode* const node, F& fn) const {
+  if (node == nullptr) return true;
+
+  const TreeNode* current = node;
+  while (current->left != nullptr) current = current->left;
+  while (current != nullptr) {
+    if (!visit(fn, current->data)) return false;
+    if (current->right != nullptr) {
+      // o sucessor é o menor da subárvore direita
+      current = current->right;
+      while (current->left != nullptr) current = current->left;
+    } else {
+      // sobe enquanto viermos da direita; ao voltar para `node`, acabou
+      while (current != node && current == current->parent->right) {
+        current = current->parent;
+      }
+      current = current == node ? nullptr : current->parent;
+    }
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+std::vector<T> AVL<T, Compare, Alloc, Balance>::in_order() const {
+  std::vector<T> result;
+  auto push = [&result](const T& value) { result.push_back(value); };
+  in_order(root, push);
   return result;
 }
 
-template <class T>
-void AVL<T>::post_order(const TreeNode* const node,
-                        std::vector<T>& result) const {
-if(!node) return;
+template <class T, class Compare, class Alloc, class Balance>
+template <class F>
+bool AVL<T, Compare, Alloc, Balance>::pre_order(const TreeNode* const node, F& fn) const {
+  const TreeNode* current = node;
+  while (current != nullptr) {
+    if (!visit(fn, current->data)) return false;
+    if (current->left != nullptr) {
+      current = current->left;
+    } else if (current->right != nullptr) {
+      current = current->right;
+    } else {
+      // sobe até um ancestral cuja subárvore direita ainda não foi visitada
+      while (current != node) {
+        const TreeNode* parent = current->parent;
+        if (current == parent->left && parent->right != nullptr) {
+          current = parent->right;
+          break;
+        }
+        current = parent;
+      }
+      if (current == node) return true;
+    }
+  }
+  return true;
+}
 
-  post_order(node->left, result);
-  post_order(node->right, result);
-  result.push_back(node->data);
- }
+template <class T, class Compare, class Alloc, class Balance>
+std::vector<T> AVL<T, Compare, Alloc, Balance>::pre_order() const {
+  std::vector<T> result;
+  auto push = [&result](const T& value) { result.push_back(value); };
+  pre_order(root, push);
+  return result;
+}
 
-template <class T>
-std::vector<T> AVL<T>::post_order() const {
-  std::vector<T> result; 
-  post_order(root, result); 
+template <class T, class Compare, class Alloc, class Balance>
+template <class F>
+bool AVL<T, Compare, Alloc, Balance>::post_order(const TreeNode* const node, F& fn) const {
+  if (node == nullptr) return true;
+
+  // desce sempre pela esquerda (ou pela direita, se não houver esquerda)
+  auto deepest = [](const TreeNode* current) {
+    while (current->left != nullptr || current->right != nullptr) {
+      current = current->left != nullptr ? current->left : current->right;
+    }
+    return current;
+  };
+
+  const TreeNode* current = deepest(node);
+  while (true) {
+    if (!visit(fn, current->data)) return false;
+    if (current == node) return true;
+    const TreeNode* parent = current->parent;
+    if (current == parent->left && parent->right != nullptr) {
+      current = deepest(parent->right);
+    } else {
+      current = parent;
+    }
+  }
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+std::vector<T> AVL<T, Compare, Alloc, Balance>::post_order() const {
+  std::vector<T> result;
+  auto push = [&result](const T& value) { result.push_back(value); };
+  post_order(root, push);
   return result;
 }
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::find_node(
+    TreeNode* node, const Key& value) const {
+  while (node) {
+    if (comp(value, node->data)) {
+      node = node->left;
+    } else if (comp(node->data, value)) {
+      node = node->right;
+    } else {
+      return node;
+    }
+  }
+  return nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+T* AVL<T, Compare, Alloc, Balance>::search(const T& value) {
+  TreeNode* node = find_node(root, value);
+  return node ? &node->data : nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+const T* AVL<T, Compare, Alloc, Balance>::search(const T& value) const {
+  TreeNode* node = find_node(root, value);
+  return node ? &node->data : nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::const_iterator AVL<T, Compare, Alloc, Balance>::begin() const {
+  return const_iterator(root ? root->min() : nullptr, this);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+std::size_t AVL<T, Compare, Alloc, Balance>::rank_of(const Key& value) const {
+  std::size_t rank = 0;
+  const TreeNode* node = root;
+  while (node) {
+    if (comp(node->data, value)) {
+      rank += subtree_size(node->left) + 1; //o nó e toda a sua esquerda são menores
+      node = node->right;
+    } else {
+      node = node->left;
+    }
+  }
+  return rank;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+const typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::select_node(std::size_t k) const {
+  const TreeNode* node = root;
+  while (node) {
+    std::size_t left_size = subtree_size(node->left);
+    if (k < left_size) {
+      node = node->left;
+    } else if (k == left_size) {
+      return node;
+    } else {
+      k -= left_size + 1;
+      node = node->right;
+    }
+  }
+  return nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+const T& AVL<T, Compare, Alloc, Balance>::select(std::size_t k) const {
+  const TreeNode* node = select_node(k);
+  if (!node) throw std::out_of_range("select: position out of range");
+  return node->data;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+const typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::lower_bound_node(const Key& value) const {
+  const TreeNode* node = root;
+  const TreeNode* best = nullptr;
+  while (node) {
+    if (comp(node->data, value)) {
+      node = node->right;
+    } else {
+      best = node; //candidato; procura um menor à esquerda
+      node = node->left;
+    }
+  }
+  return best;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+const typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::upper_bound_node(const Key& value) const {
+  const TreeNode* node = root;
+  const TreeNode* best = nullptr;
+  while (node) {
+    if (comp(value, node->data)) {
+      best = node;
+      node = node->left;
+    } else {
+      node = node->right;
+    }
+  }
+  return best;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+const typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::below_node(const Key& value,
+                                             bool inclusive) const {
+  const TreeNode* node = root;
+  const TreeNode* best = nullptr;
+  while (node) {
+    bool below = inclusive ? !comp(value, node->data) : comp(node->data, value);
+    if (below) {
+      best = node; //candidato; procura um maior à direita
+      node = node->right;
+    } else {
+      node = node->left;
+    }
+  }
+  return best;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key, class F>
+bool AVL<T, Compare, Alloc, Balance>::range_of(const Key& lo, const Key& hi, F& fn) const {
+  for (const_iterator it(lower_bound_node(lo), this); it != end() && comp(*it, hi);
+       ++it) {
+    if (!visit(fn, *it)) return false;
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class InputIt>
+void AVL<T, Compare, Alloc, Balance>::assign_sorted(InputIt first, InputIt last) {
+  assign_sorted(std::vector<T>(first, last));
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::assign_sorted(std::vector<T> values) {
+  auto out_of_order = [this](const T& a, const T& b) { return !comp(a, b); };
+  if (std::adjacent_find(values.begin(), values.end(), out_of_order) !=
+      values.end()) {
+    std::stable_sort(values.begin(), values.end(), comp);
+    auto equivalent = [this](const T& a, const T& b) {
+      return !comp(a, b) && !comp(b, a);
+    };
+    values.erase(std::unique(values.begin(), values.end(), equivalent),
+                 values.end());
+  }
+
+  clear(root);
+  root = nullptr;
+  try {
+    build_sorted(values, 0, values.size(), nullptr, root);
+  } catch (...) {
+    clear(root);
+    root = nullptr;
+    throw;
+  }
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::build_sorted(std::vector<T>& values, std::size_t lo,
+                        std::size_t hi, TreeNode* parent, TreeNode*& link) {
+  if (lo == hi) return;
+  std::size_t mid = lo + (hi - lo) / 2;
+  TreeNode* node = create_node(std::in_place, std::move(values[mid]));
+  node->parent = parent;
+  link = node;
+  build_sorted(values, lo, mid, node, node->left);
+  build_sorted(values, mid + 1, hi, node, node->right);
+  update(node);
+  Balance::build(node);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::join_nodes(TreeNode* left, TreeNode* pivot,
+                                            TreeNode* right) {
+  return Balance::join(left, pivot, right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::join2(TreeNode* left, TreeNode* right) {
+  if (!left) return right;
+  if (!right) return left;
+  TreeNode* rest;
+  TreeNode* pivot = pop_min(right, rest);
+  return join_nodes(left, pivot, rest);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::pop_min(TreeNode* node, TreeNode*& rest) {
+  if (!node->left) {
+    rest = node->right;
+    node->right = nullptr;
+    update(node);
+    return node;
+  }
+  TreeNode* left_rest;
+  TreeNode* min = pop_min(node->left, left_rest);
+  rest = join_nodes(left_rest, node, node->right);
+  return min;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::split_nodes(TreeNode* node, const Key& key,
+                                          TreeNode*& left, TreeNode*& right) {
+  if (!node) {
+    left = right = nullptr;
+    return nullptr;
+  }
+  TreeNode* node_left = node->left;
+  TreeNode* node_right = node->right;
+  TreeNode* found;
+  if (comp(key, node->data)) {
+    //a chave está à esquerda: o nó e sua direita ficam do lado maior
+    TreeNode* middle;
+    found = split_nodes(node_left, key, left, middle);
+    right = join_nodes(middle, node, node_right);
+  } else if (comp(node->data, key)) {
+    TreeNode* middle;
+    found = split_nodes(node_right, key, middle, right);
+    left = join_nodes(node_left, node, middle);
+  } else {
+    left = node_left;
+    right = node_right;
+    node->left = node->right = nullptr;
+    update(node);
+    found = node;
+  }
+  return found;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::borrow(const AVL& other) {
+  if (&other == this || alloc == other.alloc) return other.root;
+  //alocadores diferentes: copia os valores para nós desta árvore
+  return copy_values(other.root);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::copy_values(const TreeNode* node) {
+  std::vector<T> values;
+  values.reserve(subtree_size(node));
+  auto append = [&values](const T& value) { values.push_back(value); };
+  in_order(node, append);
+  TreeNode* copy = nullptr;
+  try {
+    build_sorted(values, 0, values.size(), nullptr, copy);
+  } catch (...) {
+    clear(copy);
+    throw;
+  }
+  return copy;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::release(AVL& other) noexcept {
+  if (&other != this && alloc != other.alloc) other.clear(other.root);
+  other.root = nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::adopt(AVL& other) {
+  TreeNode* node = borrow(other);
+  release(other);
+  return node;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::lend(TreeNode* node, AVL& other) {
+  if (&other == this || alloc == other.alloc) return node;
+  return other.copy_values(node);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::hand_over(TreeNode* node, TreeNode* lent, AVL& other) noexcept {
+  if (lent != node) clear(node);
+  if (&other != this) other.clear(other.root);
+  if (lent) lent->parent = nullptr;
+  other.root = lent;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::join(AVL& left, const T& pivot, AVL& right) {
+  if ((left.root && !comp(left.root->max()->data, pivot)) ||
+      (right.root && !comp(pivot, right.root->min()->data))) {
+    throw std::invalid_argument("join: values out of order");
+  }
+  //as duas árvores só são esvaziadas depois de todas as alocações; se uma
+  //falhar, as cópias já feitas são descartadas
+  auto discard = [this](const AVL& from, TreeNode* taken) {
+    if (&from != this && alloc != from.alloc) clear(taken);
+  };
+  TreeNode* left_root = borrow(left);
+  TreeNode* right_root;
+  TreeNode* node;
+  try {
+    right_root = borrow(right);
+  } catch (...) {
+    discard(left, left_root);
+    throw;
+  }
+  try {
+    node = create_node(pivot);
+  } catch (...) {
+    discard(left, left_root);
+    discard(right, right_root);
+    throw;
+  }
+  release(left);
+  release(right);
+  clear(root); //vazia se esta árvore for `left` ou `right`
+  set_root(join_nodes(left_root, node, right_root));
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Key>
+bool AVL<T, Compare, Alloc, Balance>::split_into(const Key& key, AVL& left, AVL& right) {
+  TreeNode* left_root;
+  TreeNode* right_root;
+  TreeNode* found = split_nodes(root, key, left_root, right_root);
+  //as cópias para alocadores diferentes são feitas antes de esvaziar
+  //qualquer árvore; se uma falhar, as metades são juntadas de volta
+  TreeNode* left_lent = nullptr;
+  TreeNode* right_lent;
+  try {
+    left_lent = lend(left_root, left);
+    right_lent = lend(right_root, right);
+  } catch (...) {
+    if (left_lent != left_root) left.clear(left_lent);
+    set_root(found ? join_nodes(left_root, found, right_root)
+                   : join2(left_root, right_root));
+    throw;
+  }
+  if (found) destroy_node(found);
+  root = nullptr;
+  hand_over(left_root, left_lent, left);
+  hand_over(right_root, right_lent, right);
+  return found != nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Ctx>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::union_nodes(TreeNode* a, TreeNode* b, Ctx& ctx) {
+  if (!a) return b;
+  if (!b) return a;
+  std::size_t work = subtree_size(a) + subtree_size(b);
+  TreeNode* b_left;
+  TreeNode* b_right;
+  TreeNode* duplicate = split_nodes(b, a->data, b_left, b_right);
+  if (duplicate) ctx.discard_node(duplicate);
+  TreeNode* a_left = a->left;
+  TreeNode* a_right = a->right;
+  TreeNode* left;
+  TreeNode* right;
+  ctx.fork(work, [&] { left = union_nodes(a_left, b_left, ctx); },
+           [&] { right = union_nodes(a_right, b_right, ctx); });
+  return join_nodes(left, a, right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Ctx>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::intersect_nodes(TreeNode* a, TreeNode* b,
+                                              Ctx& ctx) {
+  if (!a || !b) {
+    ctx.discard_tree(a);
+    ctx.discard_tree(b);
+    return nullptr;
+  }
+  std::size_t work = subtree_size(a) + subtree_size(b);
+  TreeNode* b_left;
+  TreeNode* b_right;
+  TreeNode* duplicate = split_nodes(b, a->data, b_left, b_right);
+  TreeNode* a_left = a->left;
+  TreeNode* a_right = a->right;
+  TreeNode* left;
+  TreeNode* right;
+  ctx.fork(work, [&] { left = intersect_nodes(a_left, b_left, ctx); },
+           [&] { right = intersect_nodes(a_right, b_right, ctx); });
+  if (duplicate) {
+    ctx.discard_node(duplicate);
+    return join_nodes(left, a, right);
+  }
+  ctx.discard_node(a);
+  return join2(left, right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Ctx>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::difference_nodes(TreeNode* a, TreeNode* b,
+                                               Ctx& ctx) {
+  if (!a || !b) {
+    ctx.discard_tree(b);
+    return a;
+  }
+  std::size_t work = subtree_size(a) + subtree_size(b);
+  TreeNode* a_left;
+  TreeNode* a_right;
+  TreeNode* duplicate = split_nodes(a, b->data, a_left, a_right);
+  TreeNode* b_left = b->left;
+  TreeNode* b_right = b->right;
+  ctx.discard_node(b);
+  if (duplicate) ctx.discard_node(duplicate);
+  TreeNode* left;
+  TreeNode* right;
+  ctx.fork(work, [&] { left = difference_nodes(a_left, b_left, ctx); },
+           [&] { right = difference_nodes(a_right, b_right, ctx); });
+  return join2(left, right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Ctx>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::symmetric_difference_nodes(TreeNode* a,
+                                                         TreeNode* b,
+                                                         Ctx& ctx) {
+  if (!a) return b;
+  if (!b) return a;
+  std::size_t work = subtree_size(a) + subtree_size(b);
+  TreeNode* b_left;
+  TreeNode* b_right;
+  TreeNode* duplicate = split_nodes(b, a->data, b_left, b_right);
+  TreeNode* a_left = a->left;
+  TreeNode* a_right = a->right;
+  TreeNode* left;
+  TreeNode* right;
+  ctx.fork(work,
+           [&] { left = symmetric_difference_nodes(a_left, b_left, ctx); },
+           [&] { right = symmetric_difference_nodes(a_right, b_right, ctx); });
+  if (duplicate) {
+    ctx.discard_node(duplicate);
+    ctx.discard_node(a);
+    return join2(left, right);
+  }
+  return join_nodes(left, a, right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Ctx>
+void AVL<T, Compare, Alloc, Balance>::combine(AVL& other, SetOperation op, Ctx& ctx) {
+  if (&other == this) {
+    //A ∪ A = A ∩ A = A; A - A = A ∆ A = ∅
+    if (op == SetOperation::Difference ||
+        op == SetOperation::SymmetricDifference) {
+      clear(root);
+      root = nullptr;
+    }
+    return;
+  }
+  TreeNode* other_root = adopt(other);
+  TreeNode* result = nullptr;
+  switch (op) {
+    case SetOperation::Union:
+      result = union_nodes(root, other_root, ctx);
+      break;
+    case SetOperation::Intersection:
+      result = intersect_nodes(root, other_root, ctx);
+      break;
+    case SetOperation::Difference:
+      result = difference_nodes(root, other_root, ctx);
+      break;
+    case SetOperation::SymmetricDifference:
+      result = symmetric_difference_nodes(root, other_root, ctx);
+      break;
+  }
+  set_root(result);
+  ctx.release();
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::union_with(AVL& other) {
+  SerialContext ctx{*this};
+  combine(other, SetOperation::Union, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::intersect_with(AVL& other) {
+  SerialContext ctx{*this};
+  combine(other, SetOperation::Intersection, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::difference_with(AVL& other) {
+  SerialContext ctx{*this};
+  combine(other, SetOperation::Difference, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::symmetric_difference_with(AVL& other) {
+  SerialContext ctx{*this};
+  combine(other, SetOperation::SymmetricDifference, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::union_with(AVL& other, ForkJoinPool& pool,
+                            std::size_t grain) {
+  if (pool.size() == 1) {
+    SerialContext ctx{*this};
+    combine(other, SetOperation::Union, ctx);
+    return;
+  }
+  ParallelContext ctx{*this, pool, grain};
+  combine(other, SetOperation::Union, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::intersect_with(AVL& other, ForkJoinPool& pool,
+                            std::size_t grain) {
+  if (pool.size() == 1) {
+    SerialContext ctx{*this};
+    combine(other, SetOperation::Intersection, ctx);
+    return;
+  }
+  ParallelContext ctx{*this, pool, grain};
+  combine(other, SetOperation::Intersection, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::difference_with(AVL& other, ForkJoinPool& pool,
+                            std::size_t grain) {
+  if (pool.size() == 1) {
+    SerialContext ctx{*this};
+    combine(other, SetOperation::Difference, ctx);
+    return;
+  }
+  ParallelContext ctx{*this, pool, grain};
+  combine(other, SetOperation::Difference, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::symmetric_difference_with(AVL& other, ForkJoinPool& pool,
+                            std::size_t grain) {
+  if (pool.size() == 1) {
+    SerialContext ctx{*this};
+    combine(other, SetOperation::SymmetricDifference, ctx);
+    return;
+  }
+  ParallelContext ctx{*this, pool, grain};
+  combine(other, SetOperation::SymmetricDifference, ctx);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class InputIt>
+void AVL<T, Compare, Alloc, Balance>::insert_batch(InputIt first, InputIt last) {
+  AVL batch(get_allocator());
+  batch.assign_sorted(first, last);
+  union_with(batch);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class InputIt>
+void AVL<T, Compare, Alloc, Balance>::erase_batch(InputIt first, InputIt last) {
+  AVL batch(get_allocator());
+  batch.assign_sorted(first, last);
+  difference_with(batch);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class InputIt>
+void AVL<T, Compare, Alloc, Balance>::insert_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                         std::size_t grain) {
+  AVL batch(get_allocator());
+  batch.assign_sorted(first, last);
+  union_with(batch, pool, grain);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class InputIt>
+void AVL<T, Compare, Alloc, Balance>::erase_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                         std::size_t grain) {
+  AVL batch(get_allocator());
+  batch.assign_sorted(first, last);
+  difference_with(batch, pool, grain);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Op, class KeyOf>
+bool AVL<T, Compare, Alloc, Balance>::BatchPlan<Op, KeyOf>::settle(std::size_t group,
+                                                          bool present,
+                                                          std::size_t& source,
+                                                          bool record) {
+  source = original;
+  for (std::size_t i = groups[group]; i < groups[group + 1]; ++i) {
+    std::size_t k = order[i];
+    bool result = false;
+    switch (ops[k].kind) {
+      case BatchKind::insert:
+        result = !present;
+        if (!present) source = k;
+        present = true;
+        break;
+      case BatchKind::assign:
+        result = !present;
+        present = true;
+        source = k;
+        break;
+      case BatchKind::erase:
+        result = present;
+        present = false;
+        break;
+    }
+    if (record) results[k] = result;
+  }
+  return present;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Op, class KeyOf, class Make>
+std::vector<bool> AVL<T, Compare, Alloc, Balance>::apply_batch(
+    const std::vector<Op>& ops, KeyOf key_of, Make make) {
+  using Plan = BatchPlan<Op, KeyOf>;
+  Plan plan{ops, key_of, {}, {}, {}, std::vector<bool>(ops.size())};
+  if (ops.empty()) return std::move(plan.results);
+
+  plan.order.resize(ops.size());
+  for (std::size_t i = 0; i < ops.size(); ++i) plan.order[i] = i;
+  std::stable_sort(plan.order.begin(), plan.order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return comp(key_of(ops[a]), key_of(ops[b]));
+                   });
+  plan.groups.push_back(0);
+  for (std::size_t i = 1; i < plan.order.size(); ++i) {
+    if (comp(key_of(ops[plan.order[i - 1]]), key_of(ops[plan.order[i]]))) {
+      plan.groups.push_back(i);
+    }
+  }
+  std::size_t group_count = plan.groups.size();
+  plan.groups.push_back(plan.order.size());
+
+  // Aloca os nós que cada grupo pode precisar (com a chave ausente ou
+  // presente na árvore) antes de alterar qualquer coisa
+  plan.made.assign(ops.size(), nullptr);
+  try {
+    for (std::size_t g = 0; g < group_count; ++g) {
+      for (bool present : {false, true}) {
+        std::size_t source;
+        if (plan.settle(g, present, source, false) &&
+            source != Plan::original && !plan.made[source]) {
+          plan.made[source] = create_node(std::in_place, make(ops[source]));
+        }
+      }
+    }
+  } catch (...) {
+    for (TreeNode* node : plan.made) {
+      if (node) destroy_node(node);
+    }
+    throw;
+  }
+
+  set_root(apply_groups(root, 0, group_count, plan));
+  for (TreeNode* node : plan.made) {
+    if (node) destroy_node(node);  // Preparado para o caso que não ocorreu
+  }
+  return std::move(plan.results);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+template <class Op, class KeyOf>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::apply_groups(
+    TreeNode* node, std::size_t lo, std::size_t hi, BatchPlan<Op, KeyOf>& plan) {
+  if (lo == hi) return node;
+  TreeNode* left = nullptr;
+  TreeNode* right = nullptr;
+  std::size_t mid_lo = lo + (hi - lo) / 2;
+  std::size_t mid_hi = mid_lo + 1;
+  if (node) {
+    left = node->left;
+    right = node->right;
+    //primeiro grupo não menor que o nó; no máximo um grupo é equivalente
+    std::size_t a = lo, b = hi;
+    while (a < b) {
+      std::size_t m = a + (b - a) / 2;
+      if (comp(plan.key(m), node->data)) {
+        a = m + 1;
+      } else {
+        b = m;
+      }
+    }
+    mid_lo = mid_hi = a;
+    if (a < hi && !comp(node->data, plan.key(a))) mid_hi = a + 1;
+  }
+  left = apply_groups(left, lo, mid_lo, plan);
+  right = apply_groups(right, mid_hi, hi, plan);
+
+  TreeNode* pivot = node;
+  if (mid_lo != mid_hi) {
+    std::size_t source;
+    bool present = plan.settle(mid_lo, node != nullptr, source, true);
+    if (!present || source != BatchPlan<Op, KeyOf>::original) {
+      if (node) destroy_node(node);
+      pivot = present ? plan.made[source] : nullptr;
+      if (present) plan.made[source] = nullptr;
+    }
+  }
+  return pivot ? join_nodes(left, pivot, right) : join2(left, right);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>::AVL(const AVL& other)
+    : root(nullptr),
+      comp(other.comp),
+      alloc(NodeAllocTraits::select_on_container_copy_construction(other.alloc)) {
+  root = clone(other.root);
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>::AVL(AVL&& other) noexcept
+    : root(other.root), comp(other.comp), alloc(other.alloc) {
+  // o alocador é copiado (não movido) para que `other` continue utilizável
+  other.root = nullptr;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>& AVL<T, Compare, Alloc, Balance>::operator=(const AVL& other) {
+  if (this == &other) return *this;
+  if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
+    if (alloc != other.alloc) {
+      // a cópia é feita com o alocador de `other` numa árvore temporária; os
+      // nós atuais só são liberados (pelo alocador antigo) se ela der certo
+      AVL copy{Alloc(other.alloc)};
+      copy.root = copy.clone(other.root);
+      clear(root);
+      root = copy.root;
+      copy.root = nullptr;
+      alloc = other.alloc;
+      comp = other.comp;
+      return *this;
+    }
+    alloc = other.alloc;
+  }
+  TreeNode* copy = clone(other.root);
+  clear(root);
+  root = copy;
+  comp = other.comp;
+  return *this;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+AVL<T, Compare, Alloc, Balance>& AVL<T, Compare, Alloc, Balance>::operator=(AVL&& other) noexcept(
+    NodeAllocTraits::propagate_on_container_move_assignment::value ||
+    NodeAllocTraits::is_always_equal::value) {
+  if (this == &other) return *this;
+  if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+    clear(root);
+    alloc = other.alloc;
+  } else if (!NodeAllocTraits::is_always_equal::value && alloc != other.alloc) {
+    // alocadores diferentes que não se propagam: não dá para tomar os nós
+    TreeNode* copy = clone(other.root);
+    clear(root);
+    root = copy;
+    comp = other.comp;
+    other.clear(other.root);
+    other.root = nullptr;
+    return *this;
+  } else {
+    clear(root);
+  }
+  root = other.root;
+  other.root = nullptr;
+  comp = other.comp;
+  return *this;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+void AVL<T, Compare, Alloc, Balance>::swap(AVL& other) noexcept {
+  using std::swap;
+  swap(root, other.root);
+  swap(comp, other.comp);
+  if constexpr (NodeAllocTraits::propagate_on_container_swap::value) {
+    swap(alloc, other.alloc);
+  }
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::copy_node(const TreeNode* source,
+                                           TreeNode* parent) {
+  TreeNode* node = create_node(source->data);
+  node->parent = parent;
+  node->size = source->size;
+  node->rank = source->rank;
+  return node;
+}
+
+template <class T, class Compare, class Alloc, class Balance>
+typename AVL<T, Compare, Alloc, Balance>::TreeNode* AVL<T, Compare, Alloc, Balance>::clone(const TreeNode* source) {
+  if (!source) return nullptr;
+  TreeNode* copy = copy_node(source, nullptr);
+  try {
+    const TreeNode* from = source;
+    TreeNode* to = copy;
+    while (true) {
+      if (from->left && !to->left) {
+        to->left = copy_node(from->left, to);
+        from = from->left;
+        to = to->left;
+      } else if (from->right && !to->right) {
+        to->right = copy_node(from->right, to);
+        from = from->right;
+        to = to->right;
+      } else if (from == source) {
+        break; //voltou à raiz: os dois lados já foram copiados
+      } else {
+        from = from->parent;
+        to = to->parent;
+      }
+    }
+  } catch (...) {
+    clear(copy);
+    throw;
+  }
+  return copy;
+}
+
+/// Árvore rubro-negra: `AVL` com `RedBlackBalance`.
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
+using RedBlackTree = AVL<T, Compare, Alloc, RedBlackBalance>;
+
+/// Árvore weak AVL: `AVL` com `WAVLBalance`.
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
+using WAVLTree = AVL<T, Compare, Alloc, WAVLBalance>;
+
+/// Treap: `AVL` com `TreapBalance`.
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
+using Treap = AVL<T, Compare, Alloc, TreapBalance>;
@@ -0,0 +1,522 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief Contadores do trabalho de rebalanceamento, um conjunto por thread.
+ *
+ * Só são atualizados pelas árvores cuja política é `CountingBalance<P>`;
+ * nas demais, não custam nada.
+ */
+struct BalanceStats {
+  std::size_t fixups = 0;        ///< Nós passados a `balance`.
+  std::size_t rank_updates = 0;  ///< Postos (na AVL, alturas) recalculados.
+  std::size_t rotations = 0;     ///< Rotações simples (uma dupla conta 2).
+
+  /// Contadores da thread atual.
+  static BalanceStats& current() {
+    static thread_local BalanceStats stats;
+    return stats;
+  }
+};
+
+/**
+ * @brief Políticas de balanceamento da `AVL`.
+ *
+ * A árvore cuida da busca, dos tamanhos das subárvores e dos ponteiros
+ * `parent`; a política decide o que guardar no campo `rank` de cada nó e
+ * como restaurar seu invariante depois de uma alteração. Uma política
+ * oferece:
+ *
+ * - `max_height`: altura até a qual os caminhos ficam na pilha (acima dela,
+ *   a árvore passa a guardá-los no heap);
+ * - `initial_rank()`: posto de um nó novo (folha);
+ * - `balance(node)`: corrige `node` depois que uma de suas subárvores
+ *   mudou, com rotações que mantêm os tamanhos e os `parent`. É chamada de
+ *   baixo para cima no caminho de uma inserção ou remoção, com o `size` de
+ *   `node` já atualizado, e retorna se o pai também pode precisar de
+ *   correção. Quando retorna `false`, acima dali só os tamanhos mudam;
+ * - `join(left, pivot, right)`: junta duas subárvores e um pivô (base de
+ *   `split`, das operações de conjunto e dos lotes);
+ * - `build(node)`: posto de um nó da árvore perfeitamente balanceada de
+ *   `assign_sorted`, depois dos filhos;
+ * - `valid(node)`: verifica o invariante entre `node` e seus filhos;
+ * - `counting` e `count`, herdados de `BalanceBase` (ou de
+ *   `CountingBalance`, que conta o trabalho).
+ *
+ * Os nós precisam ter `left`, `right`, `parent`, `size` e `rank`, e a
+ * constante `count_balance` (o `counting` da política da árvore); uma
+ * subárvore vazia tem posto -1.
+ */
+struct BalanceBase {
+  /// Se o trabalho da política é contado em `BalanceStats`.
+  static constexpr bool counting = false;
+
+  /// Soma 1 ao contador `counter` se a árvore de `Node` conta o trabalho.
+  template <class Node>
+  static void count(std::size_t BalanceStats::*counter) {
+    if constexpr (Node::count_balance) ++(BalanceStats::current().*counter);
+  }
+
+ protected:
+  template <class Node>
+  static int rank(const Node* node) {
+    return node ? node->rank : -1;
+  }
+
+  template <class Node>
+  static std::size_t size(const Node* node) {
+    return node ? node->size : 0;
+  }
+
+  /// Filho direito se `right`, esquerdo caso contrário.
+  template <class Node>
+  static Node*& child(Node* node, bool right) {
+    return right ? node->right : node->left;
+  }
+
+  template <class Node>
+  static void set_rank(Node* node, int rank) {
+    count<Node>(&BalanceStats::rank_updates);
+    node->rank = rank;
+  }
+
+  /// Liga `left` e `right` como filhos de `node` e recalcula seu tamanho.
+  template <class Node>
+  static void attach(Node* node, Node* left, Node* right) {
+    node->left = left;
+    node->right = right;
+    if (left) left->parent = node;
+    if (right) right->parent = node;
+    node->size = 1 + size(left) + size(right);
+  }
+
+  /**
+   * @brief Rotação simples: o filho do lado `right` sobe para o lugar de
+   * `node`, com o mesmo pai. Os postos não mudam.
+   */
+  template <class Node>
+  static void rotate(Node*& node, bool right) {
+    count<Node>(&BalanceStats::rotations);
+    Node* top = child(node, right);
+    Node* parent = node->parent;
+    if (right) {
+      attach(node, node->left, top->left);
+      attach(top, node, top->right);
+    } else {
+      attach(node, top->right, node->right);
+      attach(top, top->left, node);
+    }
+    top->parent = parent;
+    node = top;
+  }
+
+  /**
+   * @brief `join` das políticas por posto: desce pela espinha da subárvore
+   * de maior posto até uma de posto compatível com a outra (diferença de
+   * no máximo `Policy::join_slack`), pendura ali o pivô e corrige a espinha
+   * de baixo para cima com `Policy::balance`. Custa O(diferença de postos).
+   */
+  template <class Policy, class Node>
+  static Node* join_by_rank(Node* left, Node* pivot, Node* right) {
+    // As raízes recebidas podem ter `parent` antigo; `balance` pode lê-lo
+    if (left) left->parent = nullptr;
+    if (right) right->parent = nullptr;
+    if (rank(left) > rank(right) + Policy::join_slack) {
+      return join_spine<Policy>(left, pivot, right, true);
+    }
+    if (rank(right) > rank(left) + Policy::join_slack) {
+      return join_spine<Policy>(right, pivot, left, false);
+    }
+    attach(pivot, left, right);
+    pivot->rank = std::max(rank(left), rank(right)) + 1;
+    return pivot;
+  }
+
+ private:
+  /// Desce por `child(tall, right)`; `other` fica do lado de fora do pivô.
+  template <class Policy, class Node>
+  static Node* join_spine(Node* tall, Node* pivot, Node* other, bool right) {
+    Node* inner = child(tall, right);
+    Node* joined;
+    if (rank(inner) <= rank(other) + Policy::join_slack) {
+      if (right) {
+        attach(pivot, inner, other);
+      } else {
+        attach(pivot, other, inner);
+      }
+      pivot->rank = std::max(rank(inner), rank(other)) + 1;
+      joined = pivot;
+    } else {
+      joined = join_spine<Policy>(inner, pivot, other, right);
+    }
+    if (right) {
+      attach(tall, tall->left, joined);
+    } else {
+      attach(tall, joined, tall->right);
+    }
+    Policy::balance(tall);
+    return tall;
+  }
+};
+
+/**
+ * @brief Balanceamento AVL: o posto é a altura e as alturas dos filhos
+ * diferem em no máximo 1. É a árvore mais baixa (altura até ~1,44 log2 n),
+ * mas uma remoção pode fazer uma rotação em cada nível.
+ */
+struct AVLBalance : BalanceBase {
+  static constexpr int max_height = 128;
+  static constexpr int join_slack = 1;
+
+  static int initial_rank() { return 0; }
+
+  /// Continua enquanto a altura da subárvore muda; numa inserção, isso
+  /// acaba na primeira rotação.
+  template <class Node>
+  static bool balance(Node*& node) {
+    int old_height = node->rank;
+    int factor = rank(node->left) - rank(node->right);
+    if (factor > 1 || factor < -1) {
+      bool right = factor < 0;
+      Node* taller = child(node, right);
+      bool twice = rank(child(taller, !right)) > rank(child(taller, right));
+      if (twice) rotate(child(node, right), !right);  // rotação dupla
+      rotate(node, right);
+      // Só os nós que desceram mudam de altura: o antigo `node` e, na
+      // rotação dupla, também `taller`
+      fix_height(child(node, !right));
+      if (twice) fix_height(child(node, right));
+    }
+    fix_height(node);
+    return node->rank != old_height;
+  }
+
+  template <class Node>
+  static Node* join(Node* left, Node* pivot, Node* right) {
+    return join_by_rank<AVLBalance>(left, pivot, right);
+  }
+
+  template <class Node>
+  static void build(Node* node) {
+    node->rank = 1 + std::max(rank(node->left), rank(node->right));
+  }
+
+  template <class Node>
+  static bool valid(const Node* node) {
+    int left = rank(node->left), right = rank(node->right);
+    return node->rank == 1 + std::max(left, right) && left - right <= 1 &&
+           right - left <= 1;
+  }
+
+ private:
+  template <class Node>
+  static void fix_height(Node* node) {
+    set_rank(node, 1 + std::max(rank(node->left), rank(node->right)));
+  }
+};
+
+/**
+ * @brief Balanceamento rubro-negro, descrito por postos: o posto é a altura
+ * preta, um filho com o mesmo posto do pai é vermelho e um filho vermelho
+ * não tem filhos vermelhos. A altura vai até 2 log2 n, mas cada inserção
+ * faz no máximo duas rotações e cada remoção no máximo três; o resto da
+ * correção só troca postos (cores).
+ */
+struct RedBlackBalance : BalanceBase {
+  static constexpr int max_height = 130;
+  static constexpr int join_slack = 0;
+
+  static int initial_rank() { return 0; }
+
+  /// Continua se o posto mudou ou se `node` tem um filho vermelho e também
+  /// é vermelho.
+  template <class Node>
+  static bool balance(Node*& node) {
+    int r = node->rank;
+    fix(node);
+    return node->rank != r ||
+           (node->parent && node->parent->rank == node->rank &&
+            (rank(node->left) == node->rank ||
+             rank(node->right) == node->rank));
+  }
+
+  template <class Node>
+  static Node* join(Node* left, Node* pivot, Node* right) {
+    return join_by_rank<RedBlackBalance>(left, pivot, right);
+  }
+
+  template <class Node>
+  static void build(Node* node) {
+    // Na árvore perfeitamente balanceada, floor(log2(n + 1)) - 1 separa
+    // os níveis completos (pretos) do último (vermelho)
+    int r = -1;
+    for (std::size_t s = node->size + 1; s > 1; s >>= 1) ++r;
+    node->rank = r;
+  }
+
+  template <class Node>
+  static bool valid(const Node* node) {
+    int r = node->rank;
+    if (r < 0) return false;
+    for (const Node* c : {node->left, node->right}) {
+      int diff = r - rank(c);
+      if (diff != 0 && diff != 1) return false;
+      if (diff == 0 && (rank(c->left) == r || rank(c->right) == r)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  template <class Node>
+  static void fix(Node*& node) {
+    int r = node->rank;
+    for (bool side : {false, true}) {
+      Node* red = child(node, side);
+      Node* sibling = child(node, !side);
+      if (red && red->rank == r &&
+          (rank(red->left) == r || rank(red->right) == r)) {
+        // Dois vermelhos seguidos (inserção)
+        if (rank(sibling) == r) {
+          set_rank(node, r + 1);  // Troca de cores; o problema pode subir
+          return;
+        }
+        if (rank(child(red, !side)) == r) rotate(child(node, side), !side);
+        rotate(node, side);
+        return;
+      }
+      if (rank(child(node, side)) == r - 2) {
+        // Subárvore com um preto a menos (remoção)
+        if (rank(sibling) == r) {
+          // Irmão vermelho: sobe, e o antigo pai (agora vermelho) é
+          // corrigido com um irmão preto
+          rotate(node, !side);
+          fix_short(child(node, side), side);
+        } else {
+          fix_short(node, side);
+        }
+        return;
+      }
+    }
+  }
+
+  /// `child(node, side)` tem um preto a menos e o irmão é preto.
+  template <class Node>
+  static void fix_short(Node*& node, bool side) {
+    int r = node->rank;
+    Node* sibling = child(node, !side);
+    Node* outer = child(sibling, !side);
+    Node* inner = child(sibling, side);
+    if (rank(outer) != r - 1 && rank(inner) != r - 1) {
+      set_rank(node, r - 1);  // O irmão fica vermelho; o problema pode subir
+      return;
+    }
+    if (rank(outer) != r - 1) rotate(child(node, !side), side);
+    rotate(node, !side);
+    set_rank(node, r);
+    set_rank(node->left, r - 1);
+    set_rank(node->right, r - 1);
+  }
+};
+
+/**
+ * @brief Balanceamento weak AVL (WAVL): as diferenças de posto entre pai e
+ * filho são 1 ou 2 e toda folha tem posto 0. Só com inserções é uma AVL;
+ * com remoções a altura vai até 2 log2 n, em troca de no máximo duas
+ * rotações por operação (e O(1) amortizado de mudanças de posto).
+ */
+struct WAVLBalance : BalanceBase {
+  static constexpr int max_height = 130;
+  static constexpr int join_slack = 1;
+
+  static int initial_rank() { return 0; }
+
+  /// Continua enquanto o posto da subárvore muda.
+  template <class Node>
+  static bool balance(Node*& node) {
+    int r = node->rank;
+    fix(node);
+    return node->rank != r;
+  }
+
+  template <class Node>
+  static Node* join(Node* left, Node* pivot, Node* right) {
+    return join_by_rank<WAVLBalance>(left, pivot, right);
+  }
+
+  template <class Node>
+  static void build(Node* node) {
+    node->rank = 1 + std::max(rank(node->left), rank(node->right));
+  }
+
+  template <class Node>
+  static bool valid(const Node* node) {
+    if (!node->left && !node->right) return node->rank == 0;
+    for (const Node* c : {node->left, node->right}) {
+      int diff = node->rank - rank(c);
+      if (diff != 1 && diff != 2) return false;
+    }
+    return true;
+  }
+
+ private:
+  template <class Node>
+  static void fix(Node*& node) {
+    int r = node->rank;
+    if (!node->left && !node->right) {
+      if (r != 0) set_rank(node, 0);  // Folha (2,2) depois de uma remoção
+      return;
+    }
+    for (bool side : {false, true}) {
+      Node* c = child(node, side);
+      Node* sibling = child(node, !side);
+      if (rank(c) == r) {
+        // Filho com diferença 0 (inserção)
+        if (rank(sibling) == r - 1) {
+          set_rank(node, r + 1);
+          return;
+        }
+        if (rank(child(c, side)) == r - 1) {
+          rotate(node, side);
+          set_rank(child(node, !side), r - 1);
+        } else {
+          rotate(child(node, side), !side);
+          rotate(node, side);
+          set_rank(node, r);
+          set_rank(node->left, r - 1);
+          set_rank(node->right, r - 1);
+        }
+        return;
+      }
+      if (rank(c) == r - 3) {
+        // Filho com diferença 3 (remoção)
+        if (rank(sibling) == r - 2) {
+          set_rank(node, r - 1);
+          return;
+        }
+        Node* outer = child(sibling, !side);
+        Node* inner = child(sibling, side);
+        if (rank(outer) == r - 3 && rank(inner) == r - 3) {
+          set_rank(node, r - 1);
+          set_rank(sibling, r - 2);
+          return;
+        }
+        if (rank(outer) == r - 2) {
+          rotate(node, !side);
+          Node* down = child(node, side);
+          set_rank(down, down->left || down->right ? r - 1 : 0);
+        } else {
+          rotate(child(node, !side), side);
+          rotate(node, !side);
+          set_rank(node->left, r - 2);
+          set_rank(node->right, r - 2);
+        }
+        set_rank(node, r);
+        return;
+      }
+    }
+  }
+};
+
+/**
+ * @brief Treap: o posto é uma prioridade aleatória e cada nó tem prioridade
+ * maior ou igual à dos filhos. A altura esperada é O(log n) (mas não há
+ * limite garantido); cada atualização faz em média menos de duas rotações e
+ * uma remoção não faz nenhuma.
+ */
+struct TreapBalance : BalanceBase {
+  /// Uma altura acima disso tem probabilidade desprezível para prioridades
+  /// aleatórias, mas não é impossível: caminhos mais fundos vão para o heap.
+  static constexpr int max_height = 256;
+
+  static int initial_rank() { return static_cast<int>(random() >> 33); }
+
+  /// Continua enquanto um nó sobe por rotações; numa remoção, para logo.
+  template <class Node>
+  static bool balance(Node*& node) {
+    if (rank(node->left) > node->rank) {
+      rotate(node, false);
+    } else if (rank(node->right) > node->rank) {
+      rotate(node, true);
+    } else {
+      return false;
+    }
+    return true;
+  }
+
+  /// Sobe o pivô até onde sua prioridade permite.
+  template <class Node>
+  static Node* join(Node* left, Node* pivot, Node* right) {
+    if (rank(left) > pivot->rank && rank(left) >= rank(right)) {
+      attach(left, left->left, join(left->right, pivot, right));
+      return left;
+    }
+    if (rank(right) > pivot->rank) {
+      attach(right, join(left, pivot, right->left), right->right);
+      return right;
+    }
+    attach(pivot, left, right);
+    return pivot;
+  }
+
+  /// Prioridade uniforme entre a maior dos filhos e o máximo.
+  template <class Node>
+  static void build(Node* node) {
+    std::uint64_t low =
+        static_cast<std::uint64_t>(std::max({rank(node->left),
+                                             rank(node->right), 0}));
+    node->rank = static_cast<int>(low + random() % (INT_MAX - low + 1));
+  }
+
+  template <class Node>
+  static bool valid(const Node* node) {
+    return node->rank >= 0 && rank(node->left) <= node->rank &&
+           rank(node->right) <= node->rank;
+  }
+
+ private:
+  /// xorshift64*, uma sequência por thread.
+  static std::uint64_t random() {
+    static thread_local std::uint64_t state = seed();
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return state * 0x2545f4914f6cdd1dull;
+  }
+
+  /// Semente de uma thread: uma semente do processo, tirada de
+  /// `std::random_device` (para que as prioridades não sejam previsíveis),
+  /// somada ao número da thread e misturada por splitmix64.
+  static std::uint64_t seed() {
+    static const std::uint64_t process = [] {
+      std::random_device device;
+      return static_cast<std::uint64_t>(device()) << 32 | device();
+    }();
+    static std::atomic<std::uint64_t> threads{0};
+    std::uint64_t z = process + ++threads * 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z ^= z >> 31;
+    return z ? z : 1;  // o xorshift não sai do zero
+  }
+};
+
+/**
+ * @brief A política `Policy`, contando seu trabalho em
+ * `BalanceStats::current()`.
+ *
+ * É um tipo diferente de `Policy`, então a árvore que conta e a que não
+ * conta são instâncias diferentes, e podem conviver no mesmo programa, por
+ * exemplo `AVL<int, std::less<int>, std::allocator<int>,
+ * CountingBalance<AVLBalance>>`.
+ */
+template <class Policy>
+struct CountingBalance : Policy {
+  static constexpr bool counting = true;
+};
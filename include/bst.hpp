@@ -1,4 +1,11 @@
 #pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -9,8 +16,14 @@
  * inserção e remoção.
  *
  * @tparam T Tipo dos elementos armazenados na árvore.
+ * @tparam Compare Comparador que define a ordem dos elementos. Se for
+ * transparente (define `is_transparent`), as buscas aceitam qualquer tipo
+ * comparável com `T`, sem construir um `T` temporário.
+ * @tparam Alloc Alocador usado para os nós (via rebind), por exemplo
+ * `PoolAllocator<T>`.
  */
-template <class T>
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
 class BST {
  public:
   /**
@@ -20,6 +33,8 @@ class BST {
     T data;           ///< Valor armazenado no nó.
     TreeNode* left;   ///< Ponteiro para o filho à esquerda.
     TreeNode* right;  ///< Ponteiro para o filho à direita.
+    TreeNode* parent;  ///< Ponteiro para o pai (nullptr na raiz).
+    std::size_t size;  ///< Quantidade de nós na subárvore (incluindo este).
 
     /**
      * @brief Construtor que inicializa o nó com um valor.
@@ -29,9 +44,13 @@ class BST {
     TreeNode(const T& value);
 
     /**
-     * @brief Destrutor do nó, libera recursivamente seus filhos.
+     * @brief Construtor que constrói o valor do nó no próprio lugar.
+     *
+     * @param args Argumentos repassados ao construtor de `T`.
      */
-    ~TreeNode();
+    template <class... Args>
+    explicit TreeNode(std::in_place_t, Args&&... args);
+
 
     /**
      * @brief Retorna o nó com o maior valor da subárvore.
@@ -48,94 +67,398 @@ class BST {
     TreeNode* min();
   };
 
+  /**
+   * @brief Iterador bidirecional que percorre a árvore em ordem (in-order).
+   *
+   * Caminha pelos ponteiros `parent` dos nós, sem copiar elementos e sem
+   * memória extra. Os elementos são somente leitura, pois alterá-los
+   * quebraria a ordenação. Inserções não invalidam iteradores; uma remoção
+   * invalida os iteradores do elemento removido.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() : node(nullptr), tree(nullptr) {}
+
+    reference operator*() const { return node->data; }
+    pointer operator->() const { return &node->data; }
+
+    /**
+     * @brief Avança para o sucessor: o menor da subárvore direita ou, se não
+     * houver, o primeiro ancestral do qual viemos pela esquerda.
+     */
+    const_iterator& operator++() {
+      if (node->right) {
+        node = node->right;
+        while (node->left) node = node->left;
+      } else {
+        const TreeNode* parent = node->parent;
+        while (parent && node == parent->right) {
+          node = parent;
+          parent = parent->parent;
+        }
+        node = parent;
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Volta para o predecessor. A partir de `end()`, vai ao maior
+     * elemento.
+     */
+    const_iterator& operator--() {
+      if (!node) {
+        node = tree->root;
+        while (node && node->right) node = node->right;
+      } else if (node->left) {
+        node = node->left;
+        while (node->right) node = node->right;
+      } else {
+        const TreeNode* parent = node->parent;
+        while (parent && node == parent->left) {
+          node = parent;
+          parent = parent->parent;
+        }
+        node = parent;
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    const_iterator operator--(int) {
+      const_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return node == other.node;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return node != other.node;
+    }
+
+   private:
+    friend class BST;
+
+    const_iterator(const TreeNode* node, const BST* tree)
+        : node(node), tree(tree) {}
+
+    const TreeNode* node;  ///< Nó atual (nullptr em `end()`).
+    const BST* tree;  ///< Árvore percorrida, usada para voltar de `end()`.
+  };
+
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = reverse_iterator;
+
  private:
   /**
-   * @brief Insere um valor na árvore recursivamente.
+   * @brief Insere um valor na árvore iterativamente.
+   *
+   * O nó só é obtido (por `make`) depois que a descida confirma que o valor
+   * não existe, então um valor repetido não é copiado nem movido.
    *
    * @param node Ponteiro de referência para o nó atual.
-   * @param value Valor a ser inserido.
+   * @param value Valor a ser inserido, usado nas comparações.
+   * @param make Função que retorna o nó a ser ligado na árvore.
    * @return `true` se a inserção foi bem-sucedida, `false` se o valor já
    * existia.
    */
-  bool insert(TreeNode*& node, const T& value);
+  template <class Make>
+  bool insert(TreeNode*& node, const T& value, Make&& make);
 
   /**
-   * @brief Remove um valor da árvore recursivamente.
+   * @brief Busca `key` a partir de `node` e, se não achar, insere um valor
+   * construído com `args` na mesma descida.
    *
    * @param node Ponteiro de referência para o nó atual.
-   * @param value Valor a ser removido.
+   * @param found Recebe o endereço do valor encontrado ou inserido.
+   * @param key Chave comparável com `T` através do operador `<`.
+   * @param args Argumentos para construir o novo valor.
+   * @return `true` se houve inserção, `false` se a chave já existia.
+   */
+  template <class Key, class... Args>
+  bool try_emplace(TreeNode*& node, T*& found, const Key& key,
+                   Args&&... args);
+
+  /**
+   * @brief Remove um valor da árvore iterativamente.
+   *
+   * @param node Ponteiro de referência para o nó atual.
+   * @param value Valor (ou chave comparável) a ser removido.
    * @return `true` se a remoção foi bem-sucedida, `false` se o valor não foi
    * encontrado.
    */
-  bool remove(TreeNode*& node, const T& value);
+  template <class Key>
+  bool remove(TreeNode*& node, const Key& value);
 
   /**
    * @brief Verifica se a árvore contém um valor específico.
    *
    * @param node Ponteiro para o nó atual.
-   * @param value Valor a ser buscado.
+   * @param value Valor (ou chave comparável) a ser buscado.
    * @return `true` se o valor estiver na árvore, `false` caso contrário.
    */
-  bool contain(const TreeNode* const node, const T& value) const;
+  template <class Key>
+  bool contain(const TreeNode* const node, const Key& value) const;
 
   /**
-   * @brief Executa a travessia in-order recursiva.
+   * @brief Chama `fn(value)` e diz se a travessia deve continuar.
+   *
+   * Funções que retornam `void` nunca interrompem a travessia.
+   *
+   * @return `false` se `fn` retornou `false`, `true` caso contrário.
+   */
+  template <class F>
+  static bool visit(F& fn, const T& value);
+
+  /**
+   * @brief Executa a travessia in-order na subárvore de `node`.
    *
    * Visita a subárvore esquerda, depois o nó atual e em seguida a subárvore
-   * direita. Os valores visitados são armazenados em `result`.
+   * direita, chamando `fn` para cada valor. Caminha pelos ponteiros `parent`,
+   * sem recursão e sem alocar memória.
    *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @param node Raiz da subárvore.
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
    */
-  void in_order(const TreeNode* const node, std::vector<T>& result) const;
+  template <class F>
+  bool in_order(const TreeNode* const node, F& fn) const;
 
   /**
-   * @brief Executa a travessia pre-order recursiva.
+   * @brief Executa a travessia pre-order na subárvore de `node`.
    *
-   * Visita o nó atual, em seguida a subárvore esquerda e depois a direita.
-   * Os valores visitados são armazenados em `result`.
+   * Visita o nó atual, em seguida a subárvore esquerda e depois a direita,
+   * chamando `fn` para cada valor, sem recursão e sem alocar memória.
    *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @param node Raiz da subárvore.
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
    */
-  void pre_order(const TreeNode* const node, std::vector<T>& result) const;
+  template <class F>
+  bool pre_order(const TreeNode* const node, F& fn) const;
 
   /**
-   * @brief Executa a travessia post-order recursiva.
+   * @brief Executa a travessia post-order na subárvore de `node`.
    *
-   * Visita a subárvore esquerda, depois a direita e por último o nó atual.
-   * Os valores visitados são armazenados em `result`.
+   * Visita a subárvore esquerda, depois a direita e por último o nó atual,
+   * chamando `fn` para cada valor, sem recursão e sem alocar memória.
    *
-   * @param node Ponteiro para o nó atual.
-   * @param result Vetor onde os valores visitados serão armazenados.
+   * @param node Raiz da subárvore.
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
    */
-  void post_order(const TreeNode* const node, std::vector<T>& result) const;
+  template <class F>
+  bool post_order(const TreeNode* const node, F& fn) const;
 
-  TreeNode* find_node(TreeNode* node, const T& value) const {
-    if (node == nullptr) {
-      return nullptr;
+  template <class Key>
+  TreeNode* find_node(TreeNode* node, const Key& value) const {
+    while (node != nullptr) {
+      if (comp(value, node->data)) {
+        node = node->left;
+      } else if (comp(node->data, value)) {
+        node = node->right;
+      } else {
+        return node;
+      }
     }
+    return nullptr;
+  }
 
-    if (value < node->data) {
-      return find_node(node->left, value);
-    } else if (node->data < value) {
-      return find_node(node->right, value);
-    } else {
-      return node;
-    }
+  /**
+   * @brief Tamanho da subárvore de um nó (0 para nullptr).
+   */
+  static std::size_t subtree_size(const TreeNode* node) {
+    return node ? node->size : 0;
   }
 
+  /**
+   * @brief Conta os valores menores que `value` na árvore.
+   *
+   * @param value Valor (ou chave comparável) de referência.
+   * @return Quantidade de valores estritamente menores.
+   */
+  template <class Key>
+  std::size_t rank_of(const Key& value) const;
+
+  /**
+   * @brief Busca o nó do k-ésimo menor valor (a partir de 0).
+   *
+   * @param k Posição em ordem crescente.
+   * @return Ponteiro para o nó ou nullptr se `k >= size()`.
+   */
+  const TreeNode* select_node(std::size_t k) const;
+
+  /**
+   * @brief Constrói, de cima para baixo, a subárvore com `values[lo, hi)`.
+   *
+   * O elemento do meio vira a raiz da subárvore; o nó é ligado a `link`
+   * antes dos filhos, então uma exceção no meio deixa uma árvore válida
+   * (incompleta) que pode ser liberada por `clear`.
+   */
+  void build_sorted(std::vector<T>& values, std::size_t lo, std::size_t hi,
+                    TreeNode* parent, TreeNode*& link);
+
+  /**
+   * @brief Busca o primeiro nó cujo valor não é menor que `value`.
+   *
+   * @param value Valor (ou chave comparável) de referência.
+   * @return Ponteiro para o nó ou nullptr se todos forem menores.
+   */
+  template <class Key>
+  const TreeNode* lower_bound_node(const Key& value) const;
+
+  /**
+   * @brief Busca o primeiro nó cujo valor é maior que `value`.
+   *
+   * @param value Valor (ou chave comparável) de referência.
+   * @return Ponteiro para o nó ou nullptr se nenhum for maior.
+   */
+  template <class Key>
+  const TreeNode* upper_bound_node(const Key& value) const;
+
+  /**
+   * @brief Busca o último nó cujo valor é menor (ou menor ou igual) a `value`.
+   *
+   * @param value Valor (ou chave comparável) de referência.
+   * @param inclusive Se `true`, aceita um valor equivalente a `value`.
+   * @return Ponteiro para o nó ou nullptr se não houver.
+   */
+  template <class Key>
+  const TreeNode* below_node(const Key& value, bool inclusive) const;
+
+  /**
+   * @brief Percorre em ordem os valores do intervalo [lo, hi).
+   */
+  template <class Key, class F>
+  bool range_of(const Key& lo, const Key& hi, F& fn) const;
+
+  /**
+   * @brief Retorna o valor de um nó, ou nullptr se o nó for nulo.
+   */
+  static const T* value_of(const TreeNode* node) {
+    return node ? &node->data : nullptr;
+  }
+
+  /**
+   * @brief Clona a subárvore `source`, com nós alocados por esta árvore.
+   *
+   * Percorre a origem em pré-ordem pelos ponteiros `parent`, sem recursão.
+   * Se uma alocação falhar, o que já foi copiado é liberado.
+   *
+   * @return Raiz da cópia (com `parent` nulo).
+   */
+  TreeNode* clone(const TreeNode* source);
+
+  /**
+   * @brief Cria a cópia de um único nó (sem os filhos).
+   */
+  TreeNode* copy_node(const TreeNode* source, TreeNode* parent);
+
+  /// Alocador dos nós, obtido de `Alloc` por rebind.
+  using NodeAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<TreeNode>;
+  using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+  /**
+   * @brief Aloca e constrói um nó com o alocador da árvore.
+   *
+   * @param args Argumentos repassados ao construtor de `TreeNode`.
+   * @return Ponteiro para o novo nó.
+   */
+  template <class... Args>
+  TreeNode* create_node(Args&&... args);
+
+  /**
+   * @brief Destrói e libera um único nó (os filhos não são tocados).
+   *
+   * @param node Nó a ser liberado.
+   */
+  void destroy_node(TreeNode* node);
+
+  /**
+   * @brief Libera todos os nós de uma subárvore, sem recursão.
+   *
+   * @param node Raiz da subárvore.
+   */
+  void clear(TreeNode* node);
+
  public:
   /**
    * @brief Construtor da árvore (inicialmente vazia).
    */
   BST();
 
+  /**
+   * @brief Construtor da árvore vazia com um alocador específico.
+   *
+   * Árvores que recebem cópias do mesmo `PoolAllocator` compartilham a mesma
+   * reserva de nós.
+   *
+   * @param alloc Alocador usado para os nós.
+   */
+  explicit BST(const Alloc& alloc);
+
   /**
    * @brief Destrutor da árvore, libera todos os nós.
    */
   ~BST();
 
+  /**
+   * @brief Construtor de cópia: clona a estrutura de `other` em O(n).
+   *
+   * Cada nó é copiado com os mesmos filhos e tamanho, sem
+   * comparações e sem rebalanceamento. Os nós são alocados em pré-ordem, de
+   * forma que com um alocador de slabs (`PoolAllocator`) a cópia fica
+   * contígua na memória.
+   */
+  BST(const BST& other);
+
+  /**
+   * @brief Construtor de movimento, em O(1): toma os nós de `other`, que
+   * fica vazia (e continua utilizável).
+   */
+  BST(BST&& other) noexcept;
+
+  /**
+   * @brief Atribuição por cópia, com o mesmo clone estrutural do construtor
+   * de cópia. Se a cópia falhar, a árvore não é alterada.
+   */
+  BST& operator=(const BST& other);
+
+  /**
+   * @brief Atribuição por movimento.
+   *
+   * Em O(1) quando o alocador se propaga na atribuição por movimento ou é
+   * igual ao de `other`; caso contrário os nós de `other` são clonados com o
+   * alocador desta árvore.
+   */
+  BST& operator=(BST&& other) noexcept(
+      NodeAllocTraits::propagate_on_container_move_assignment::value ||
+      NodeAllocTraits::is_always_equal::value);
+
+  /**
+   * @brief Troca o conteúdo com `other` em O(1).
+   */
+  void swap(BST& other) noexcept;
+
+  friend void swap(BST& a, BST& b) noexcept { a.swap(b); }
+
   /**
    * @brief Insere um novo valor na árvore.
    *
@@ -144,6 +467,41 @@ class BST {
    */
   bool insert(const T& value);
 
+  /**
+   * @brief Insere um valor, movendo-o para o novo nó.
+   *
+   * @param value Valor a ser inserido; só é movido se for inserido.
+   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   */
+  bool insert(T&& value);
+
+  /**
+   * @brief Constrói um valor diretamente no nó, a partir de `args`.
+   *
+   * Como a posição depende do valor, o nó é construído antes da descida e
+   * liberado se um valor equivalente já existir.
+   *
+   * @param args Argumentos repassados ao construtor de `T`.
+   * @return `true` se inserido com sucesso, `false` se o valor já existia.
+   */
+  template <class... Args>
+  bool emplace(Args&&... args);
+
+  /**
+   * @brief Insere um valor construído no lugar, caso `key` não exista.
+   *
+   * A busca e a inserção são feitas em uma única descida. O valor só é
+   * construído (a partir de `args`) quando a chave não está na árvore.
+   *
+   * @param key Chave a ser buscada; deve ser comparável com `T` pelo
+   * operador `<` nos dois sentidos.
+   * @param args Argumentos repassados ao construtor de `T`.
+   * @return Par (ponteiro para o valor encontrado ou inserido, `true` se
+   * houve inserção).
+   */
+  template <class Key, class... Args>
+  std::pair<T*, bool> try_emplace(const Key& key, Args&&... args);
+
   /**
    * @brief Remove um valor da árvore.
    *
@@ -152,6 +510,19 @@ class BST {
    */
   bool remove(const T& value);
 
+  /**
+   * @brief Remove o valor equivalente a uma chave de outro tipo.
+   *
+   * Disponível apenas com comparador transparente.
+   *
+   * @param key Chave comparável com `T` pelo comparador.
+   * @return `true` se o valor foi removido, `false` se não estava presente.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool remove(const Key& key) {
+    return remove(root, key);
+  }
+
   /**
    * @brief Verifica se um valor está presente na árvore.
    *
@@ -160,6 +531,19 @@ class BST {
    */
   bool contain(const T& value) const;
 
+  /**
+   * @brief Verifica se há um valor equivalente a uma chave de outro tipo.
+   *
+   * Disponível apenas com comparador transparente.
+   *
+   * @param key Chave comparável com `T` pelo comparador.
+   * @return `true` se presente, `false` caso contrário.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    return contain(root, key);
+  }
+
   /**
    * @brief Retorna os valores da árvore em ordem (in-order).
    *
@@ -187,6 +571,250 @@ class BST {
    */
   std::vector<T> post_order() const;
 
+  /**
+   * @brief Substitui o conteúdo da árvore pelos valores de [first, last).
+   *
+   * Se a entrada já estiver ordenada e sem repetições, a árvore de altura mínima
+   * é montada em O(n), sem comparações nem rotações além da verificação da
+   * ordem. Caso contrário os valores são ordenados (de forma estável) e as
+   * repetições descartadas, mantendo a primeira ocorrência, como faria uma
+   * sequência de `insert`.
+   *
+   * @param first Início da sequência de valores.
+   * @param last Fim da sequência de valores.
+   */
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
+  /**
+   * @brief Variante de `assign_sorted` que recebe os valores em um vetor,
+   * de onde são movidos para os nós sem cópia intermediária.
+   */
+  void assign_sorted(std::vector<T> values);
+
+  /**
+   * @brief Quantidade de elementos na árvore, em O(1).
+   */
+  std::size_t size() const { return subtree_size(root); }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return root == nullptr; }
+
+  /**
+   * @brief Posição que `value` ocupa (ou ocuparia) em ordem crescente.
+   *
+   * Usa os tamanhos das subárvores, percorrendo um único caminho.
+   *
+   * @param value Valor de referência (não precisa estar na árvore).
+   * @return Quantidade de elementos estritamente menores que `value`.
+   */
+  std::size_t rank(const T& value) const { return rank_of(value); }
+
+  /**
+   * @brief `rank` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  std::size_t rank(const Key& key) const {
+    return rank_of(key);
+  }
+
+  /**
+   * @brief Retorna o k-ésimo menor elemento (a partir de 0).
+   *
+   * @param k Posição em ordem crescente.
+   * @return Referência constante ao elemento.
+   * @throw std::out_of_range se `k >= size()`.
+   */
+  const T& select(std::size_t k) const;
+
+  /**
+   * @brief Iterador para o k-ésimo menor elemento (a partir de 0).
+   *
+   * Permite continuar a varredura a partir de uma posição, como em
+   * percentis ("os 10 seguintes ao p90").
+   *
+   * @param k Posição em ordem crescente.
+   * @return Iterador para o elemento ou `end()` se `k >= size()`.
+   */
+  const_iterator nth(std::size_t k) const {
+    return const_iterator(select_node(k), this);
+  }
+
+  /**
+   * @brief Iterador para o primeiro elemento que não é menor que `value`.
+   *
+   * @param value Valor de referência (não precisa estar na árvore).
+   * @return Iterador para o elemento ou `end()` se todos forem menores.
+   */
+  const_iterator lower_bound(const T& value) const {
+    return const_iterator(lower_bound_node(value), this);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key& key) const {
+    return const_iterator(lower_bound_node(key), this);
+  }
+
+  /**
+   * @brief Iterador para o primeiro elemento maior que `value`.
+   *
+   * @param value Valor de referência (não precisa estar na árvore).
+   * @return Iterador para o elemento ou `end()` se nenhum for maior.
+   */
+  const_iterator upper_bound(const T& value) const {
+    return const_iterator(upper_bound_node(value), this);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key& key) const {
+    return const_iterator(upper_bound_node(key), this);
+  }
+
+  /**
+   * @brief Maior elemento menor ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* floor(const T& value) const {
+    return value_of(below_node(value, true));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* floor(const Key& key) const {
+    return value_of(below_node(key, true));
+  }
+
+  /**
+   * @brief Menor elemento maior ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* ceiling(const T& value) const {
+    return value_of(lower_bound_node(value));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* ceiling(const Key& key) const {
+    return value_of(lower_bound_node(key));
+  }
+
+  /**
+   * @brief Maior elemento estritamente menor que `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* predecessor(const T& value) const {
+    return value_of(below_node(value, false));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* predecessor(const Key& key) const {
+    return value_of(below_node(key, false));
+  }
+
+  /**
+   * @brief Menor elemento estritamente maior que `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* successor(const T& value) const {
+    return value_of(upper_bound_node(value));
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* successor(const Key& key) const {
+    return value_of(upper_bound_node(key));
+  }
+
+  /**
+   * @brief Percorre em ordem os elementos do intervalo [lo, hi).
+   *
+   * Desce até `lo` em O(log n) e segue pelo sucessor de cada nó, então o
+   * custo é O(log n + k) para k elementos visitados.
+   *
+   * @param lo Limite inferior (inclusivo).
+   * @param hi Limite superior (exclusivo).
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se o intervalo foi percorrido até o fim, `false` se `fn`
+   * interrompeu a varredura.
+   */
+  template <class F>
+  bool range(const T& lo, const T& hi, F&& fn) const {
+    return range_of(lo, hi, fn);
+  }
+  template <class Key, class F, class C = Compare,
+            class = typename C::is_transparent>
+  bool range(const Key& lo, const Key& hi, F&& fn) const {
+    return range_of(lo, hi, fn);
+  }
+
+  /**
+   * @brief Quantidade de elementos no intervalo [lo, hi), em O(log n).
+   *
+   * Calculada como a diferença entre os ranks dos limites; retorna 0 se
+   * `hi` não for maior que `lo`.
+   */
+  std::size_t count_range(const T& lo, const T& hi) const {
+    std::size_t a = rank_of(lo), b = rank_of(hi);
+    return b > a ? b - a : 0;
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  std::size_t count_range(const Key& lo, const Key& hi) const {
+    std::size_t a = rank_of(lo), b = rank_of(hi);
+    return b > a ? b - a : 0;
+  }
+
+  /**
+   * @brief Percorre a árvore em ordem, chamando `fn` para cada valor.
+   *
+   * Os valores são passados por referência constante, sem cópias e sem
+   * alocação. Se `fn` retornar `false`, a travessia para ali.
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se todos os valores foram visitados, `false` se a
+   * travessia foi interrompida.
+   */
+  template <class F>
+  bool for_each_in_order(F&& fn) const {
+    return in_order(root, fn);
+  }
+
+  /**
+   * @brief Percorre a árvore em pré-ordem, chamando `fn` para cada valor.
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se todos os valores foram visitados, `false` se a
+   * travessia foi interrompida.
+   */
+  template <class F>
+  bool for_each_pre_order(F&& fn) const {
+    return pre_order(root, fn);
+  }
+
+  /**
+   * @brief Percorre a árvore em pós-ordem, chamando `fn` para cada valor.
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`.
+   * @return `true` se todos os valores foram visitados, `false` se a
+   * travessia foi interrompida.
+   */
+  template <class F>
+  bool for_each_post_order(F&& fn) const {
+    return post_order(root, fn);
+  }
+
+  /**
+   * @brief Iterador para o menor elemento (ou `end()` se vazia).
+   */
+  const_iterator begin() const;
+
+  /**
+   * @brief Iterador para a posição após o maior elemento.
+   */
+  const_iterator end() const { return const_iterator(nullptr, this); }
+
+  /**
+   * @brief Iteradores para percorrer a árvore do maior para o menor.
+   */
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+
   /**
    * @brief Retorna o ponteiro para o nodo contendo o valor.
    *
@@ -195,22 +823,41 @@ class BST {
   TreeNode* find_node(const T& value) const { return find_node(root, value); }
   T* search(const T& value);
   const T* search(const T& value) const;
+
+  /**
+   * @brief Busca por uma chave de outro tipo (comparador transparente).
+   *
+   * @param key Chave comparável com `T` pelo comparador.
+   * @return Ponteiro para o valor ou nullptr se não estiver na árvore.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  T* search(const Key& key) {
+    TreeNode* node = find_node(root, key);
+    return node ? &node->data : nullptr;
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* search(const Key& key) const {
+    const TreeNode* node = find_node(root, key);
+    return node ? &node->data : nullptr;
+  }
  private:
   TreeNode* root;  ///< Ponteiro para a raiz da árvore.
+  Compare comp;    ///< Comparador que define a ordem dos elementos.
+  NodeAlloc alloc;  ///< Alocador dos nós.
 };
 
-template <class T>
-BST<T>::TreeNode::TreeNode(const T& value) 
-: data{value}, left{nullptr}, right{nullptr} {}
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>::TreeNode::TreeNode(const T& value) 
+: data{value}, left{nullptr}, right{nullptr}, parent{nullptr}, size{1} {}
 
-template <class T>
-BST<T>::TreeNode::~TreeNode() {
-  delete left;
-    delete right;
-}
+template <class T, class Compare, class Alloc>
+template <class... Args>
+BST<T, Compare, Alloc>::TreeNode::TreeNode(std::in_place_t, Args&&... args)
+    : data(std::forward<Args>(args)...), left{nullptr}, right{nullptr},
+      parent{nullptr}, size{1} {}
 
-template <class T>
-typename BST<T>::TreeNode* BST<T>::TreeNode::max() {
+template <class T, class Compare, class Alloc>
+typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::TreeNode::max() {
  TreeNode* current = this;
  while (current->right != nullptr){
   current = current ->right;
@@ -218,166 +865,604 @@ typename BST<T>::TreeNode* BST<T>::TreeNode::max() {
  return current;
 }
 
-template <class T>
-typename BST<T>::TreeNode* BST<T>::TreeNode::min() {
+template <class T, class Compare, class Alloc>
+typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::TreeNode::min() {
      TreeNode* current = this;
  while (current->left != nullptr){
   current = current ->left;
  }
  return current;
 }
-template <class T>
-BST<T>::BST(): root{nullptr} {}
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>::BST(): root{nullptr}, comp{}, alloc() {}
+
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>::BST(const Alloc& alloc)
+    : root(nullptr), comp(), alloc(alloc) {}
 
-template <class T>
-BST<T>::~BST() {
-   delete root;
+template <class T, class Compare, class Alloc>
+template <class... Args>
+typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::create_node(
+    Args&&... args) {
+  TreeNode* node = NodeAllocTraits::allocate(alloc, 1);
+  try {
+    NodeAllocTraits::construct(alloc, node, std::forward<Args>(args)...);
+  } catch (...) {
+    NodeAllocTraits::deallocate(alloc, node, 1);
+    throw;
+  }
+  return node;
 }
 
-template <class T>
-bool BST<T>::insert(const T& value) {
-   return insert(root, value);
+template <class T, class Compare, class Alloc>
+void BST<T, Compare, Alloc>::destroy_node(TreeNode* node) {
+  NodeAllocTraits::destroy(alloc, node);
+  NodeAllocTraits::deallocate(alloc, node, 1);
 }
 
-template <class T>
-bool BST<T>::remove(const T& value) {
+template <class T, class Compare, class Alloc>
+void BST<T, Compare, Alloc>::clear(TreeNode* node) {
+  // Desmonta a árvore com rotações à direita: enquanto houver filho à
+  // esquerda, ele sobe; quando não houver, o nó é liberado e seguimos para a
+  // direita. Usa espaço constante na pilha, qualquer que seja a altura.
+  while (node) {
+    if (node->left) {
+      TreeNode* left = node->left;
+      node->left = left->right;
+      left->right = node;
+      node = left;
+    } else {
+      TreeNode* right = node->right;
+      destroy_node(node);
+      node = right;
+    }
+  }
+}
+
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>::~BST() {
+  clear(root);
+}
+
+template <class T, class Compare, class Alloc>
+bool BST<T, Compare, Alloc>::insert(const T& value) {
+  return insert(root, value, [&] { return create_node(value); });
+}
+
+template <class T, class Compare, class Alloc>
+bool BST<T, Compare, Alloc>::insert(T&& value) {
+  return insert(root, value,
+                [&] { return create_node(std::in_place, std::move(value)); });
+}
+
+template <class T, class Compare, class Alloc>
+template <class... Args>
+bool BST<T, Compare, Alloc>::emplace(Args&&... args) {
+  TreeNode* fresh = create_node(std::in_place, std::forward<Args>(args)...);
+  bool inserted;
+  try {
+    inserted = insert(root, fresh->data, [fresh] { return fresh; });
+  } catch (...) {
+    //o comparador (ou a pilha do caminho) falhou antes de ligar o nó
+    destroy_node(fresh);
+    throw;
+  }
+  if (!inserted) destroy_node(fresh);
+  return inserted;
+}
+
+template <class T, class Compare, class Alloc>
+bool BST<T, Compare, Alloc>::remove(const T& value) {
   return remove(root, value); 
 }
 
-template <class T>
-bool BST<T>::contain(const T& value) const {
+template <class T, class Compare, class Alloc>
+bool BST<T, Compare, Alloc>::contain(const T& value) const {
    return contain(root, value);
 }
 
-template <class T>
-bool BST<T>::insert(TreeNode*& node, const T& value) {
-  if (node == nullptr){
-    node = new TreeNode(value);
-    return true;
+template <class T, class Compare, class Alloc>
+template <class Make>
+bool BST<T, Compare, Alloc>::insert(TreeNode*& node, const T& value, Make&& make) {
+  TreeNode** link = &node;
+  TreeNode* parent = nullptr;
+  while (*link != nullptr) {
+    parent = *link;
+    if (comp(value, (*link)->data))
+      link = &(*link)->left;
+    else if (comp((*link)->data, value))
+      link = &(*link)->right;
+    else
+      return false;
+  }
+
+  *link = make();
+  (*link)->parent = parent;
+  for (TreeNode* p = parent; p != nullptr; p = p->parent) ++p->size;
+  return true;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key, class... Args>
+std::pair<T*, bool> BST<T, Compare, Alloc>::try_emplace(const Key& key, Args&&... args) {
+  T* found = nullptr;
+  bool inserted = try_emplace(root, found, key, std::forward<Args>(args)...);
+  return {found, inserted};
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key, class... Args>
+bool BST<T, Compare, Alloc>::try_emplace(TreeNode*& node, T*& found, const Key& key,
+                         Args&&... args) {
+  TreeNode** link = &node;
+  TreeNode* parent = nullptr;
+  while (*link != nullptr) {
+    parent = *link;
+    if (comp(key, (*link)->data)) {
+      link = &(*link)->left;
+    } else if (comp((*link)->data, key)) {
+      link = &(*link)->right;
+    } else {
+      found = &(*link)->data;
+      return false;
+    }
   }
 
-  if (value < node->data)
-   return insert(node->left, value); 
-  else if (node->data < value)
-   return insert(node->right, value); 
-  else
-   return false; 
+  *link = create_node(std::in_place, std::forward<Args>(args)...);
+  (*link)->parent = parent;
+  for (TreeNode* p = parent; p != nullptr; p = p->parent) ++p->size;
+  found = &(*link)->data;
+  return true;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+bool BST<T, Compare, Alloc>::contain(const TreeNode* const node, const Key& value) const {
+  const TreeNode* current = node;
+  while (current != nullptr) {
+    if (comp(value, current->data)) {
+      current = current->left;
+    } else if (comp(current->data, value)) {
+      current = current->right; //procura na subárvore da direita
+    } else {
+      return true;
+    }
+  }
+  return false;
 }
 
-template <class T>
-bool BST<T>::contain(const TreeNode* const node, const T& value) const {
-if (node == nullptr) {
+template <class T, class Compare, class Alloc>
+template <class Key>
+bool BST<T, Compare, Alloc>::remove(TreeNode*& node, const Key& value) {
+  TreeNode** link = &node;
+  while (*link != nullptr) {
+    if (comp(value, (*link)->data)) {
+      link = &(*link)->left;
+    } else if (comp((*link)->data, value)) {
+      link = &(*link)->right;
+    } else {
+      break;
+    }
+  }
+
+  TreeNode* target = *link;
+  if (target == nullptr) {
     return false;
   }
 
-  if (value < node->data){
-    return contain(node->left, value);
-  } else if (node->data < value){
-    return contain(node->right, value); //procura na subárvore da direita 
-  }else{
+  // Casos 1, 2 e 3: no máximo um filho, que ocupa o lugar do nó
+  if (target->left == nullptr || target->right == nullptr) {
+    TreeNode* child = target->left ? target->left : target->right;
+    if (child != nullptr) child->parent = target->parent;
+    *link = child;
+    for (TreeNode* p = target->parent; p != nullptr; p = p->parent) --p->size;
+    destroy_node(target);
+  }
+  // Caso 4: dois filhos, o sucessor (sem filho à esquerda) é retirado de
+  // onde está e religado no lugar do nó, sem copiar o valor
+  else {
+    TreeNode** successor_link = &target->right;
+    while ((*successor_link)->left != nullptr) {
+      successor_link = &(*successor_link)->left;
+    }
+    TreeNode* successor = *successor_link;
+    *successor_link = successor->right;
+    if (successor->right != nullptr) successor->right->parent = successor->parent;
+    for (TreeNode* p = successor->parent; p != nullptr; p = p->parent) --p->size;
+
+    successor->left = target->left;
+    successor->right = target->right;
+    successor->parent = target->parent;
+    successor->size = target->size;
+    if (successor->left != nullptr) successor->left->parent = successor;
+    if (successor->right != nullptr) successor->right->parent = successor;
+    *link = successor;
+    destroy_node(target);
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc>
+template <class F>
+bool BST<T, Compare, Alloc>::visit(F& fn, const T& value) {
+  if constexpr (std::is_void_v<std::invoke_result_t<F&, const T&>>) {
+    fn(value);
     return true;
+  } else {
+    return static_cast<bool>(fn(value));
   }
 }
-template <class T>
-bool BST<T>::remove(TreeNode*& node, const T& value) {
- if (node == nullptr) {
-    return false; 
+
+template <class T, class Compare, class Alloc>
+template <class F>
+bool BST<T, Compare, Alloc>::in_order(const TreeNode* const node, F& fn) const {
+  if (node == nullptr) return true;
+
+  const TreeNode* current = node;
+  while (current->left != nullptr) current = current->left;
+  while (current != nullptr) {
+    if (!visit(fn, current->data)) return false;
+    if (current->right != nullptr) {
+      // o sucessor é o menor da subárvore direita
+      current = current->right;
+      while (current->left != nullptr) current = current->left;
+    } else {
+      // sobe enquanto viermos da direita; ao voltar para `node`, acabou
+      while (current != node && current == current->parent->right) {
+        current = current->parent;
+      }
+      current = current == node ? nullptr : current->parent;
+    }
   }
+  return true;
+}
 
-  if (value < node->data) {
-    return remove(node->left, value); 
-  } else if (node->data < value) {
-    return remove(node->right, value); 
-  } else {
-   
+template <class T, class Compare, class Alloc>
+std::vector<T> BST<T, Compare, Alloc>::in_order() const {
+  std::vector<T> result;
+  auto push = [&result](const T& value) { result.push_back(value); };
+  in_order(root, push);
+  return result;
+}
+
+template <class T, class Compare, class Alloc>
+template <class F>
+bool BST<T, Compare, Alloc>::pre_order(const TreeNode* const node, F& fn) const {
+  const TreeNode* current = node;
+  while (current != nullptr) {
+    if (!visit(fn, current->data)) return false;
+    if (current->left != nullptr) {
+      current = current->left;
+    } else if (current->right != nullptr) {
+      current = current->right;
+    } else {
+      // sobe até um ancestral cuja subárvore direita ainda não foi visitada
+      while (current != node) {
+        const TreeNode* parent = current->parent;
+        if (current == parent->left && parent->right != nullptr) {
+          current = parent->right;
+          break;
+        }
+        current = parent;
+      }
+      if (current == node) return true;
+    }
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc>
+std::vector<T> BST<T, Compare, Alloc>::pre_order() const {
+  std::vector<T> result;
+  auto push = [&result](const T& value) { result.push_back(value); };
+  pre_order(root, push);
+  return result;
+}
 
-    // Caso 1: sem filhos (folha)
-    if (node->left == nullptr && node->right == nullptr) {
-      delete node;
-      node = nullptr;
+template <class T, class Compare, class Alloc>
+template <class F>
+bool BST<T, Compare, Alloc>::post_order(const TreeNode* const node, F& fn) const {
+  if (node == nullptr) return true;
+
+  // desce sempre pela esquerda (ou pela direita, se não houver esquerda)
+  auto deepest = [](const TreeNode* current) {
+    while (current->left != nullptr || current->right != nullptr) {
+      current = current->left != nullptr ? current->left : current->right;
     }
-    // Caso 2: só tem filho à direita
-    else if (node->left == nullptr) {
-      TreeNode* temp = node;
+    return current;
+  };
+
+  const TreeNode* current = deepest(node);
+  while (true) {
+    if (!visit(fn, current->data)) return false;
+    if (current == node) return true;
+    const TreeNode* parent = current->parent;
+    if (current == parent->left && parent->right != nullptr) {
+      current = deepest(parent->right);
+    } else {
+      current = parent;
+    }
+  }
+}
+
+template <class T, class Compare, class Alloc>
+std::vector<T> BST<T, Compare, Alloc>::post_order() const {
+  std::vector<T> result;
+  auto push = [&result](const T& value) { result.push_back(value); };
+  post_order(root, push);
+  return result;
+}
+template <class T, class Compare, class Alloc>
+T* BST<T, Compare, Alloc>::search(const T& value) {
+  typename BST<T, Compare, Alloc>::TreeNode* node = find_node(root, value);
+  return node ? &node->data : nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+const T* BST<T, Compare, Alloc>::search(const T& value) const {
+  typename BST<T, Compare, Alloc>::TreeNode* node = find_node(root, value);
+  return node ? &node->data : nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+typename BST<T, Compare, Alloc>::const_iterator BST<T, Compare, Alloc>::begin() const {
+  return const_iterator(root ? root->min() : nullptr, this);
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+std::size_t BST<T, Compare, Alloc>::rank_of(const Key& value) const {
+  std::size_t rank = 0;
+  const TreeNode* node = root;
+  while (node) {
+    if (comp(node->data, value)) {
+      rank += subtree_size(node->left) + 1; //o nó e toda a sua esquerda são menores
       node = node->right;
-      temp->right = nullptr;
-      delete temp;
+    } else {
+      node = node->left;
     }
-    // Caso 3: só tem filho à esquerda
-    else if (node->right == nullptr) {
-      TreeNode* temp = node;
+  }
+  return rank;
+}
+
+template <class T, class Compare, class Alloc>
+const typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::select_node(std::size_t k) const {
+  const TreeNode* node = root;
+  while (node) {
+    std::size_t left_size = subtree_size(node->left);
+    if (k < left_size) {
       node = node->left;
-      temp->left = nullptr;
-      delete temp;
+    } else if (k == left_size) {
+      return node;
+    } else {
+      k -= left_size + 1;
+      node = node->right;
     }
-    // Caso 4: dois filhos
-    else {
-      TreeNode* successor = node->right->min(); 
-      node->data = successor->data;            
-      remove(node->right, successor->data);    
+  }
+  return nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+const T& BST<T, Compare, Alloc>::select(std::size_t k) const {
+  const TreeNode* node = select_node(k);
+  if (!node) throw std::out_of_range("select: position out of range");
+  return node->data;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+const typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::lower_bound_node(const Key& value) const {
+  const TreeNode* node = root;
+  const TreeNode* best = nullptr;
+  while (node) {
+    if (comp(node->data, value)) {
+      node = node->right;
+    } else {
+      best = node; //candidato; procura um menor à esquerda
+      node = node->left;
     }
-    return true;
   }
+  return best;
 }
 
-template <class T>
-void BST<T>::in_order(const TreeNode* const node,
-                      std::vector<T>& result) const {
- if (node == nullptr) return;
+template <class T, class Compare, class Alloc>
+template <class Key>
+const typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::upper_bound_node(const Key& value) const {
+  const TreeNode* node = root;
+  const TreeNode* best = nullptr;
+  while (node) {
+    if (comp(value, node->data)) {
+      best = node;
+      node = node->left;
+    } else {
+      node = node->right;
+    }
+  }
+  return best;
+}
 
-  in_order(node->left, result);  
-  result.push_back(node->data); 
-  in_order(node->right, result); 
-   }
+template <class T, class Compare, class Alloc>
+template <class Key>
+const typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::below_node(const Key& value,
+                                             bool inclusive) const {
+  const TreeNode* node = root;
+  const TreeNode* best = nullptr;
+  while (node) {
+    bool below = inclusive ? !comp(value, node->data) : comp(node->data, value);
+    if (below) {
+      best = node; //candidato; procura um maior à direita
+      node = node->right;
+    } else {
+      node = node->left;
+    }
+  }
+  return best;
+}
 
-template <class T>
-std::vector<T> BST<T>::in_order() const {
-  std::vector<T> result;
-    in_order(root, result);
-    return result;
+template <class T, class Compare, class Alloc>
+template <class Key, class F>
+bool BST<T, Compare, Alloc>::range_of(const Key& lo, const Key& hi, F& fn) const {
+  for (const_iterator it(lower_bound_node(lo), this); it != end() && comp(*it, hi);
+       ++it) {
+    if (!visit(fn, *it)) return false;
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc>
+template <class InputIt>
+void BST<T, Compare, Alloc>::assign_sorted(InputIt first, InputIt last) {
+  assign_sorted(std::vector<T>(first, last));
+}
 
+template <class T, class Compare, class Alloc>
+void BST<T, Compare, Alloc>::assign_sorted(std::vector<T> values) {
+  auto out_of_order = [this](const T& a, const T& b) { return !comp(a, b); };
+  if (std::adjacent_find(values.begin(), values.end(), out_of_order) !=
+      values.end()) {
+    std::stable_sort(values.begin(), values.end(), comp);
+    auto equivalent = [this](const T& a, const T& b) {
+      return !comp(a, b) && !comp(b, a);
+    };
+    values.erase(std::unique(values.begin(), values.end(), equivalent),
+                 values.end());
+  }
+
+  clear(root);
+  root = nullptr;
+  try {
+    build_sorted(values, 0, values.size(), nullptr, root);
+  } catch (...) {
+    clear(root);
+    root = nullptr;
+    throw;
+  }
 }
 
-template <class T>
-void BST<T>::pre_order(const TreeNode* const node,
-                       std::vector<T>& result) const {
-if (node == nullptr) return;
-    result.push_back(node->data);
-    pre_order(node->left, result);
-    pre_order(node->right, result);
+template <class T, class Compare, class Alloc>
+void BST<T, Compare, Alloc>::build_sorted(std::vector<T>& values, std::size_t lo,
+                        std::size_t hi, TreeNode* parent, TreeNode*& link) {
+  if (lo == hi) return;
+  std::size_t mid = lo + (hi - lo) / 2;
+  TreeNode* node = create_node(std::in_place, std::move(values[mid]));
+  node->parent = parent;
+  link = node;
+  build_sorted(values, lo, mid, node, node->left);
+  build_sorted(values, mid + 1, hi, node, node->right);
+  node->size = hi - lo;
 }
 
-template <class T>
-std::vector<T> BST<T>::pre_order() const {
-   std::vector<T> result;
-    pre_order(root, result);
-    return result;
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>::BST(const BST& other)
+    : root(nullptr),
+      comp(other.comp),
+      alloc(NodeAllocTraits::select_on_container_copy_construction(other.alloc)) {
+  root = clone(other.root);
 }
 
-template <class T>
-void BST<T>::post_order(const TreeNode* const node,
-                        std::vector<T>& result) const {
- if (node == nullptr) return;
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>::BST(BST&& other) noexcept
+    : root(other.root), comp(other.comp), alloc(other.alloc) {
+  // o alocador é copiado (não movido) para que `other` continue utilizável
+  other.root = nullptr;
+}
 
-    post_order(node->left, result);
-    post_order(node->right, result);
-    result.push_back(node->data);                          
- }
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>& BST<T, Compare, Alloc>::operator=(const BST& other) {
+  if (this == &other) return *this;
+  if constexpr (NodeAllocTraits::propagate_on_container_copy_assignment::value) {
+    if (alloc != other.alloc) {
+      // a cópia é feita com o alocador de `other` numa árvore temporária; os
+      // nós atuais só são liberados (pelo alocador antigo) se ela der certo
+      BST copy{Alloc(other.alloc)};
+      copy.root = copy.clone(other.root);
+      clear(root);
+      root = copy.root;
+      copy.root = nullptr;
+      alloc = other.alloc;
+      comp = other.comp;
+      return *this;
+    }
+    alloc = other.alloc;
+  }
+  TreeNode* copy = clone(other.root);
+  clear(root);
+  root = copy;
+  comp = other.comp;
+  return *this;
+}
 
-template <class T>
-std::vector<T> BST<T>::post_order() const {
-    std::vector<T> result;
-    post_order(root, result);
-    return result;
+template <class T, class Compare, class Alloc>
+BST<T, Compare, Alloc>& BST<T, Compare, Alloc>::operator=(BST&& other) noexcept(
+    NodeAllocTraits::propagate_on_container_move_assignment::value ||
+    NodeAllocTraits::is_always_equal::value) {
+  if (this == &other) return *this;
+  if constexpr (NodeAllocTraits::propagate_on_container_move_assignment::value) {
+    clear(root);
+    alloc = other.alloc;
+  } else if (!NodeAllocTraits::is_always_equal::value && alloc != other.alloc) {
+    // alocadores diferentes que não se propagam: não dá para tomar os nós
+    TreeNode* copy = clone(other.root);
+    clear(root);
+    root = copy;
+    comp = other.comp;
+    other.clear(other.root);
+    other.root = nullptr;
+    return *this;
+  } else {
+    clear(root);
+  }
+  root = other.root;
+  other.root = nullptr;
+  comp = other.comp;
+  return *this;
 }
-template <class T>
-T* BST<T>::search(const T& value) {
-  typename BST<T>::TreeNode* node = find_node(root, value);
-  return node ? &node->data : nullptr;
+
+template <class T, class Compare, class Alloc>
+void BST<T, Compare, Alloc>::swap(BST& other) noexcept {
+  using std::swap;
+  swap(root, other.root);
+  swap(comp, other.comp);
+  if constexpr (NodeAllocTraits::propagate_on_container_swap::value) {
+    swap(alloc, other.alloc);
+  }
 }
 
-template <class T>
-const T* BST<T>::search(const T& value) const {
-  typename BST<T>::TreeNode* node = find_node(root, value);
-  return node ? &node->data : nullptr;
+template <class T, class Compare, class Alloc>
+typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::copy_node(const TreeNode* source,
+                                           TreeNode* parent) {
+  TreeNode* node = create_node(source->data);
+  node->parent = parent;
+  node->size = source->size;
+  return node;
+}
+
+template <class T, class Compare, class Alloc>
+typename BST<T, Compare, Alloc>::TreeNode* BST<T, Compare, Alloc>::clone(const TreeNode* source) {
+  if (!source) return nullptr;
+  TreeNode* copy = copy_node(source, nullptr);
+  try {
+    const TreeNode* from = source;
+    TreeNode* to = copy;
+    while (true) {
+      if (from->left && !to->left) {
+        to->left = copy_node(from->left, to);
+        from = from->left;
+        to = to->left;
+      } else if (from->right && !to->right) {
+        to->right = copy_node(from->right, to);
+        from = from->right;
+        to = to->right;
+      } else if (from == source) {
+        break; //voltou à raiz: os dois lados já foram copiados
+      } else {
+        from = from->parent;
+        to = to->parent;
+      }
+    }
+  } catch (...) {
+    clear(copy);
+    throw;
+  }
+  return copy;
 }
@@ -0,0 +1,1268 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "simd_search.hpp"
+
+/**
+ * @brief Tamanho alvo, em bytes, de um nó de `BTree`.
+ *
+ * Deve ser um múltiplo de 64, o tamanho de uma linha de cache: os nós são
+ * alinhados a linhas de cache, então uma busca dentro de um nó toca no
+ * máximo `Bytes / 64` linhas.
+ */
+template <std::size_t Bytes = 256>
+struct BTreeNodeSize {
+  static_assert(Bytes >= 64 && Bytes % 64 == 0,
+                "o nó deve ocupar linhas de cache inteiras");
+  static constexpr std::size_t bytes = Bytes;
+};
+
+/**
+ * @brief Classe que representa uma Árvore B.
+ *
+ * Cada nó guarda vários elementos ordenados em um vetor contíguo, e os nós
+ * internos guardam também os ponteiros para os filhos entre esses elementos.
+ * Uma busca visita O(log_B n) nós, com B elementos por nó, e dentro de cada
+ * nó faz uma busca binária em memória contígua, em vez de um nó (e uma falta
+ * de cache) por elemento como nas árvores binárias. Todas as folhas ficam na
+ * mesma profundidade.
+ *
+ * Tem a mesma interface básica de `AVL` (`insert`, `remove`, `contain`,
+ * `search`, `try_emplace`, `in_order`, iteradores, `lower_bound` e
+ * `upper_bound`) e pode ser usada como árvore de `Set` e `Map`. Não guarda
+ * tamanhos de subárvore, então não oferece `rank`, `select`, `nth` e
+ * `count_range`, nem as operações de conjunto e de lote da `AVL`.
+ *
+ * Com elementos inteiros de 32 ou 64 bits e a ordem padrão, a busca dentro
+ * de cada nó usa instruções vetoriais (veja `simd::count_less`). O mesmo vale
+ * para elementos com chave inteira de 32 ou 64 bits, quando `Compare` expõe
+ * a chave (`key_type` e `static key(const T&)`), como em
+ * `Map<std::uint64_t, V, BTree>`: cada nó guarda também uma cópia contígua
+ * das chaves, ao custo de menos elementos por nó. As buscas precisam usar o
+ * tipo exato da chave (ou do elemento); outros tipos comparáveis, e as
+ * árvores binárias como a `AVL` padrão de `Set` e `Map`, usam a busca
+ * escalar.
+ *
+ * Diferente da `AVL`, os elementos mudam de lugar quando os nós são divididos
+ * ou fundidos: qualquer inserção ou remoção invalida iteradores e ponteiros.
+ * Os movimentos de `T` não devem lançar exceções.
+ *
+ * @tparam T Tipo dos elementos armazenados na árvore.
+ * @tparam Compare Comparador que define a ordem dos elementos. Se for
+ * transparente (define `is_transparent`), as buscas aceitam qualquer tipo
+ * comparável com `T`, sem construir um `T` temporário.
+ * @tparam Alloc Alocador usado para os nós (via rebind). Como os nós são
+ * alinhados a linhas de cache, `PoolAllocator` repassa a alocação ao
+ * alocador padrão.
+ * @tparam NodeSize Tamanho alvo dos nós, como `BTreeNodeSize<512>`. Para
+ * usar outro tamanho em `Set` ou `Map`, que passam só os três primeiros
+ * parâmetros, basta um alias, por exemplo
+ * `template <class T, class C, class A> using BTree512 =
+ * BTree<T, C, A, BTreeNodeSize<512>>;`.
+ */
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>, class NodeSize = BTreeNodeSize<>>
+class BTree {
+ private:
+  /**
+   * @brief Tipo da chave dos elementos, se `Compare` a expõe com
+   * `key_type` e `static key(const T&)`, ordenando os elementos por
+   * `key(a) < key(b)` (como o comparador de `Map`); senão `void`.
+   * `simd_bytes` é o tamanho da chave se ela tem busca vetorial, senão 0.
+   */
+  template <class C, class = void>
+  struct key_of {
+    using type = void;
+    static constexpr std::size_t simd_bytes = 0;
+  };
+  template <class C>
+  struct key_of<C, std::void_t<typename C::key_type,
+                               decltype(C::key(std::declval<const T&>()))>> {
+    using type = typename C::key_type;
+    static constexpr std::size_t simd_bytes =
+        simd::is_key<type> ? sizeof(type) : 0;
+  };
+
+  using KeyType = typename key_of<Compare>::type;
+
+  /// Bytes da cópia da chave de cada elemento (veja `mirror_keys`).
+  static constexpr std::size_t key_bytes = key_of<Compare>::simd_bytes;
+
+  /// Verdadeiro se cada nó guarda também uma cópia contígua das chaves dos
+  /// seus elementos, para buscá-las com `simd::count_less`.
+  static constexpr bool mirror_keys = key_bytes != 0;
+
+  /// Bytes do cabeçalho de um nó (pai, posição, quantidade e tipo), mais o
+  /// preenchimento que pode haver entre as chaves e o ponteiro ao pai.
+  static constexpr std::size_t header_bytes =
+      (sizeof(void*) + 2 * sizeof(std::uint16_t) + 1 +
+       (alignof(void*) - key_bytes % alignof(void*)) % alignof(void*) +
+       alignof(T) - 1) /
+      alignof(T) * alignof(T);
+
+ public:
+  /// Elementos por nó: quantos cabem em `NodeSize::bytes` depois do
+  /// cabeçalho, e no mínimo 3.
+  static constexpr std::size_t capacity = std::max<std::size_t>(
+      3, NodeSize::bytes > header_bytes
+             ? (NodeSize::bytes - header_bytes) / (sizeof(T) + key_bytes)
+             : 0);
+
+  /// Mínimo de elementos em um nó que não é a raiz.
+  static constexpr std::size_t min_count = (capacity - 1) / 2;
+
+  static_assert(capacity < UINT16_MAX, "nó grande demais");
+
+ private:
+  struct InnerNode;
+
+  /**
+   * @brief Cópia das chaves dos elementos de um nó, em `keys[0, count)`.
+   * Vazia (e sem ocupar espaço no nó) sem `mirror_keys`.
+   */
+  template <bool Mirror, class = void>
+  struct NodeKeys {};
+  template <class Unused>
+  struct NodeKeys<true, Unused> {
+    KeyType keys[capacity];  ///< Chaves, na ordem dos elementos.
+  };
+
+  /**
+   * @brief Nó folha. Também é o começo de todo nó interno.
+   *
+   * Os elementos ficam em `slots`, dos quais só os `count` primeiros estão
+   * construídos, em ordem crescente.
+   */
+  struct alignas(64) LeafNode : NodeKeys<mirror_keys> {
+    InnerNode* parent;       ///< Pai (nullptr na raiz).
+    std::uint16_t position;  ///< Índice deste nó em `parent->children`.
+    std::uint16_t count;     ///< Quantidade de elementos no nó.
+    bool leaf;               ///< `true` se o nó não tem filhos.
+    typename std::aligned_storage<sizeof(T), alignof(T)>::type
+        slots[capacity];  ///< Elementos.
+
+    T& value(std::size_t i) {
+      return *std::launder(reinterpret_cast<T*>(&slots[i]));
+    }
+    const T& value(std::size_t i) const {
+      return *std::launder(reinterpret_cast<const T*>(&slots[i]));
+    }
+  };
+
+  /**
+   * @brief Nó interno: `count` elementos e `count + 1` filhos. Os elementos
+   * de `children[i]` são menores que `value(i)`, e os de `children[i + 1]`,
+   * maiores.
+   */
+  struct InnerNode : LeafNode {
+    LeafNode* children[capacity + 1];  ///< Filhos.
+  };
+
+  static_assert(capacity == 3 || sizeof(LeafNode) <= NodeSize::bytes,
+                "a folha deve caber no tamanho alvo");
+
+  using LeafAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<LeafNode>;
+  using LeafAllocTraits = std::allocator_traits<LeafAlloc>;
+  using InnerAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<InnerNode>;
+  using InnerAllocTraits = std::allocator_traits<InnerAlloc>;
+
+  /// Espaço para um elemento fora dos nós, durante uma divisão.
+  using Slot = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+ public:
+  /**
+   * @brief Iterador bidirecional que percorre a árvore em ordem (in-order).
+   *
+   * Uma posição é um nó e um índice dentro dele; a travessia sobe pelos
+   * ponteiros `parent`, sem memória extra. Os elementos são somente leitura,
+   * pois alterá-los quebraria a ordenação. Qualquer inserção ou remoção
+   * invalida os iteradores.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() : node(nullptr), index(0), tree(nullptr) {}
+
+    reference operator*() const { return node->value(index); }
+    pointer operator->() const { return &node->value(index); }
+
+    /**
+     * @brief Avança para o sucessor: o menor da subárvore à direita do
+     * elemento ou, numa folha, o próximo do nó ou do primeiro ancestral do
+     * qual viemos por um filho que não é o último.
+     */
+    const_iterator& operator++() {
+      if (!node->leaf) {
+        node = child(node, index + 1);
+        while (!node->leaf) node = child(node, 0);
+        index = 0;
+      } else if (++index == node->count) {
+        while (node->parent && node->position == node->parent->count) {
+          node = node->parent;
+        }
+        index = node->position;
+        node = node->parent;
+        if (!node) index = 0;
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Volta para o predecessor. A partir de `end()`, vai ao maior
+     * elemento.
+     */
+    const_iterator& operator--() {
+      if (!node) {
+        node = tree->root;
+        while (!node->leaf) node = child(node, node->count);
+        index = node->count - 1;
+      } else if (!node->leaf) {
+        node = child(node, index);
+        while (!node->leaf) node = child(node, node->count);
+        index = node->count - 1;
+      } else if (index > 0) {
+        --index;
+      } else {
+        while (node->position == 0) node = node->parent;
+        index = node->position - 1;
+        node = node->parent;
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    const_iterator operator--(int) {
+      const_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return node == other.node && index == other.index;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class BTree;
+
+    const_iterator(const LeafNode* node, std::size_t index, const BTree* tree)
+        : node(node), index(index), tree(tree) {}
+
+    const LeafNode* node;  ///< Nó atual (nullptr em `end()`).
+    std::size_t index;     ///< Índice do elemento em `node`.
+    const BTree* tree;     ///< Árvore percorrida, para `--end()`.
+  };
+
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = reverse_iterator;
+
+  /**
+   * @brief Construtor padrão. Cria uma árvore vazia.
+   */
+  BTree() : alloc(), root(nullptr), elements(0) {}
+
+  /**
+   * @brief Cria uma árvore vazia que aloca seus nós com `alloc`.
+   *
+   * @param alloc Alocador dos nós.
+   */
+  explicit BTree(const Alloc& alloc)
+      : alloc(alloc), root(nullptr), elements(0) {}
+
+  /**
+   * @brief Construtor de cópia: clona a estrutura nó a nó, em O(n).
+   */
+  BTree(const BTree& other);
+
+  /**
+   * @brief Construtor de movimento, em O(1).
+   */
+  BTree(BTree&& other) noexcept
+      : alloc(std::move(other.alloc)),
+        comp(std::move(other.comp)),
+        root(other.root),
+        elements(other.elements) {
+    other.root = nullptr;
+    other.elements = 0;
+  }
+
+  BTree& operator=(const BTree& other);
+
+  BTree& operator=(BTree&& other) noexcept {
+    if (this != &other) {
+      clear();
+      swap(other);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Destrutor. Libera todos os nós.
+   */
+  ~BTree() { clear(); }
+
+  /**
+   * @brief Troca o conteúdo com `other` em O(1).
+   */
+  void swap(BTree& other) noexcept {
+    using std::swap;
+    swap(alloc, other.alloc);
+    swap(comp, other.comp);
+    swap(root, other.root);
+    swap(elements, other.elements);
+  }
+
+  friend void swap(BTree& a, BTree& b) noexcept { a.swap(b); }
+
+  /**
+   * @brief Insere um valor na árvore.
+   *
+   * @param value Valor a ser inserido.
+   * @return `true` se o valor foi inserido, `false` se já existia.
+   */
+  bool insert(const T& value) { return try_emplace(value, value).second; }
+
+  /**
+   * @brief Insere um valor na árvore, movendo-o se ele não existir.
+   */
+  bool insert(T&& value) { return try_emplace(value, std::move(value)).second; }
+
+  /**
+   * @brief Constrói um valor a partir de `args` e o insere se não existir.
+   *
+   * @return `true` se o valor foi inserido.
+   */
+  template <class... Args>
+  bool emplace(Args&&... args);
+
+  /**
+   * @brief Procura `key` e, se não existir, insere um `T` construído a
+   * partir de `args`, que deve ser equivalente a `key`.
+   *
+   * @return Ponteiro para o elemento (válido até a próxima alteração) e
+   * `true` se ele foi inserido.
+   */
+  template <class Key, class... Args>
+  std::pair<T*, bool> try_emplace(const Key& key, Args&&... args);
+
+  /**
+   * @brief Remove um valor da árvore.
+   *
+   * @param value Valor a ser removido.
+   * @return `true` se o valor existia.
+   */
+  bool remove(const T& value) { return erase(value); }
+
+  /**
+   * @brief Remove o elemento equivalente a `key`, sem construir um `T`.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool remove(const Key& key) {
+    return erase(key);
+  }
+
+  /**
+   * @brief Verifica se um valor está presente na árvore.
+   */
+  bool contain(const T& value) const { return locate(value).first; }
+
+  /**
+   * @brief Verifica se há um elemento equivalente a `key`.
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    return locate(key).first;
+  }
+
+  /**
+   * @brief Procura um valor na árvore.
+   *
+   * @return Ponteiro para o elemento encontrado (válido até a próxima
+   * alteração) ou nullptr.
+   */
+  T* search(const T& value) { return find(value); }
+  const T* search(const T& value) const { return find(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  T* search(const Key& key) {
+    return find(key);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* search(const Key& key) const {
+    return find(key);
+  }
+
+  /**
+   * @brief Retorna os elementos em ordem crescente.
+   */
+  std::vector<T> in_order() const {
+    return std::vector<T>(begin(), end());
+  }
+
+  /**
+   * @brief Substitui o conteúdo da árvore pelos valores de [first, last).
+   *
+   * Como em `AVL::assign_sorted`, a entrada fora de ordem é ordenada (de
+   * forma estável) e as repetições são descartadas, mantendo a primeira.
+   * Os valores ordenados são acrescentados sempre na folha mais à direita,
+   * sem buscas.
+   */
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    assign_sorted(std::vector<T>(first, last));
+  }
+
+  /**
+   * @brief Variante de `assign_sorted` que move os valores de um vetor.
+   */
+  void assign_sorted(std::vector<T> values);
+
+  /**
+   * @brief Remove todos os elementos.
+   */
+  void clear() {
+    clear(root);
+    root = nullptr;
+    elements = 0;
+  }
+
+  /**
+   * @brief Retorna uma cópia do alocador (do tipo `Alloc`) usado pela árvore.
+   */
+  Alloc get_allocator() const { return Alloc(alloc); }
+
+  /**
+   * @brief Quantidade de elementos, em O(1).
+   */
+  std::size_t size() const { return elements; }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return elements == 0; }
+
+  /**
+   * @brief Altura da árvore: 0 para uma só folha, -1 se vazia.
+   */
+  int height() const;
+
+  /**
+   * @brief Primeiro elemento que não é menor que `value`.
+   *
+   * @return Iterador para o elemento ou `end()` se não houver.
+   */
+  const_iterator lower_bound(const T& value) const { return lower(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key& key) const {
+    return lower(key);
+  }
+
+  /**
+   * @brief Primeiro elemento maior que `value`.
+   *
+   * @return Iterador para o elemento ou `end()` se não houver.
+   */
+  const_iterator upper_bound(const T& value) const { return upper(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key& key) const {
+    return upper(key);
+  }
+
+  /**
+   * @brief Maior elemento menor ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* floor(const T& value) const { return before(upper(value)); }
+
+  /**
+   * @brief Menor elemento maior ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* ceiling(const T& value) const { return at(lower(value)); }
+
+  /**
+   * @brief Maior elemento estritamente menor que `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* predecessor(const T& value) const { return before(lower(value)); }
+
+  /**
+   * @brief Menor elemento estritamente maior que `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* successor(const T& value) const { return at(upper(value)); }
+
+  /**
+   * @brief Iteradores que percorrem a árvore em ordem crescente.
+   */
+  const_iterator begin() const;
+  const_iterator end() const { return const_iterator(nullptr, 0, this); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+  /**
+   * @brief Verifica as invariantes da Árvore B: folhas na mesma
+   * profundidade, entre `min_count` e `capacity` elementos por nó (a raiz
+   * pode ter menos), elementos em ordem, ponteiros `parent` e `position`
+   * coerentes, cópia das chaves (se houver) igual às chaves dos elementos e
+   * `size()` correto.
+   */
+  bool is_balanced() const;
+
+ private:
+  static LeafNode* child(LeafNode* node, std::size_t i) {
+    return static_cast<InnerNode*>(node)->children[i];
+  }
+  static const LeafNode* child(const LeafNode* node, std::size_t i) {
+    return static_cast<const InnerNode*>(node)->children[i];
+  }
+
+  /**
+   * @brief Coloca `node` como filho `i` de `parent`.
+   */
+  static void set_child(LeafNode* parent, std::size_t i, LeafNode* node) {
+    static_cast<InnerNode*>(parent)->children[i] = node;
+    node->parent = static_cast<InnerNode*>(parent);
+    node->position = static_cast<std::uint16_t>(i);
+  }
+
+  /**
+   * @brief Move o elemento de `from` para o espaço livre `to` e destrói o
+   * original.
+   */
+  static void relocate(T& from, void* to) noexcept {
+    ::new (to) T(std::move(from));
+    from.~T();
+  }
+
+  /**
+   * @brief Verdadeiro se as buscas por `Key` nos nós podem usar
+   * `simd::count_less`: elementos inteiros de 32 ou 64 bits na ordem
+   * crescente padrão, procurados pelo próprio tipo.
+   */
+  template <class Key>
+  static constexpr bool simd_search =
+      simd::is_key<T> && std::is_same_v<Key, T> &&
+      (std::is_same_v<Compare, std::less<T>> ||
+       std::is_same_v<Compare, std::less<>>);
+
+  /**
+   * @brief Verdadeiro se as buscas por `Key` podem usar `simd::count_less`
+   * na cópia das chaves do nó: com `mirror_keys`, procurando uma chave
+   * (`KeyType`) ou um elemento.
+   */
+  template <class Key>
+  static constexpr bool simd_key_search =
+      mirror_keys &&
+      (std::is_same_v<Key, KeyType> || std::is_same_v<Key, T>);
+
+  /**
+   * @brief Copia as chaves dos elementos de `node` para `node->keys`. Chamada
+   * depois de cada mudança nos elementos de um nó; não faz nada sem
+   * `mirror_keys`.
+   */
+  static void store_keys(LeafNode* node) {
+    if constexpr (mirror_keys) {
+      for (std::size_t i = 0; i < node->count; ++i) {
+        node->keys[i] = Compare::key(node->value(i));
+      }
+    }
+  }
+
+  /**
+   * @brief Primeiro índice de `node` cujo elemento não é menor que `key`.
+   *
+   * Com `simd_search` ou `simd_key_search`, compara vários elementos por
+   * instrução; senão faz uma busca binária.
+   */
+  template <class Key>
+  std::size_t lower_index(const LeafNode* node, const Key& key) const;
+
+  /**
+   * @brief Verdadeiro se o elemento `i` de `node`, que não é menor que
+   * `key`, é equivalente a `key`. Com `simd_key_search`, compara a cópia da
+   * chave, sem ler o elemento.
+   */
+  template <class Key>
+  bool matches(const LeafNode* node, std::size_t i, const Key& key) const {
+    if constexpr (simd_key_search<Key>) {
+      if constexpr (std::is_same_v<Key, T>) {
+        return node->keys[i] == Compare::key(key);
+      } else {
+        return node->keys[i] == key;
+      }
+    } else {
+      return !comp(key, node->value(i));
+    }
+  }
+
+  /**
+   * @brief Primeiro índice de `node` cujo elemento é maior que `key`.
+   */
+  template <class Key>
+  std::size_t upper_index(const LeafNode* node, const Key& key) const;
+
+  /**
+   * @brief Procura `key` descendo a partir da raiz.
+   *
+   * @return `true` e a posição do elemento, se existir; senão `false`, a
+   * folha e o índice em que ele entraria.
+   */
+  template <class Key>
+  std::pair<bool, std::pair<LeafNode*, std::size_t>> locate(
+      const Key& key) const;
+
+  template <class Key>
+  T* find(const Key& key) const {
+    auto [found, at] = locate(key);
+    return found ? &at.first->value(at.second) : nullptr;
+  }
+
+  template <class Key>
+  const_iterator lower(const Key& key) const;
+
+  template <class Key>
+  const_iterator upper(const Key& key) const;
+
+  const T* at(const_iterator it) const { return it == end() ? nullptr : &*it; }
+
+  const T* before(const_iterator it) const {
+    return it == begin() ? nullptr : &*--it;
+  }
+
+  /**
+   * @brief Insere `value` na posição `index` da folha `leaf`, dividindo os
+   * nós cheios do caminho até a raiz.
+   *
+   * Os nós novos são alocados antes de qualquer mudança, então uma falha de
+   * alocação deixa a árvore intacta.
+   *
+   * @return Ponteiro para o elemento inserido.
+   */
+  T* insert_at(LeafNode* leaf, std::size_t index, T& value);
+
+  /**
+   * @brief Insere em um nó que não está cheio o elemento `value`, na
+   * posição `i`, e (em nós internos) o filho `right` logo à sua direita.
+   */
+  void insert_into(LeafNode* node, std::size_t i, T& value, LeafNode* right);
+
+  /**
+   * @brief Remove o elemento equivalente a `key`, se existir.
+   */
+  template <class Key>
+  bool erase(const Key& key);
+
+  /**
+   * @brief Restaura o mínimo de elementos de `node` e dos ancestrais depois
+   * de uma remoção, emprestando de um irmão ou fundindo com ele.
+   */
+  void rebalance(LeafNode* node);
+
+  /**
+   * @brief Passa o último elemento de `children[k]` para o pai e o elemento
+   * `k` do pai para o começo de `children[k + 1]`.
+   */
+  void rotate_right(LeafNode* parent, std::size_t k);
+
+  /**
+   * @brief Passa o primeiro elemento de `children[k + 1]` para o pai e o
+   * elemento `k` do pai para o fim de `children[k]`.
+   */
+  void rotate_left(LeafNode* parent, std::size_t k);
+
+  /**
+   * @brief Junta `children[k]`, o elemento `k` do pai e `children[k + 1]`
+   * em `children[k]`, liberando `children[k + 1]`.
+   */
+  void merge(LeafNode* parent, std::size_t k);
+
+  LeafNode* create_leaf();
+  InnerNode* create_inner();
+
+  /**
+   * @brief Destrói os elementos de um nó e libera sua memória (sem tocar
+   * nos filhos).
+   */
+  void destroy_node(LeafNode* node);
+
+  /**
+   * @brief Libera uma subárvore inteira.
+   */
+  void clear(LeafNode* node);
+
+  /**
+   * @brief Copia a subárvore `source`.
+   */
+  LeafNode* clone(const LeafNode* source);
+
+  /**
+   * @brief Verifica a subárvore de `node`, cujas folhas devem estar na
+   * profundidade `leaf_depth`, e soma os elementos em `total`.
+   */
+  bool is_balanced(const LeafNode* node, int depth, int leaf_depth,
+                   std::size_t& total) const;
+
+  LeafAlloc alloc;       ///< Alocador dos nós.
+  Compare comp;          ///< Ordem dos elementos.
+  LeafNode* root;        ///< Raiz da árvore (nullptr se vazia).
+  std::size_t elements;  ///< Quantidade de elementos.
+};
+
+template <class T, class Compare, class Alloc, class NodeSize>
+BTree<T, Compare, Alloc, NodeSize>::BTree(const BTree& other)
+    : alloc(LeafAllocTraits::select_on_container_copy_construction(
+          other.alloc)),
+      comp(other.comp),
+      root(nullptr),
+      elements(0) {
+  if (other.root) root = clone(other.root);
+  elements = other.elements;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+BTree<T, Compare, Alloc, NodeSize>& BTree<T, Compare, Alloc, NodeSize>::
+operator=(const BTree& other) {
+  if (this != &other) {
+    BTree copy(other);
+    swap(copy);
+  }
+  return *this;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class... Args>
+bool BTree<T, Compare, Alloc, NodeSize>::emplace(Args&&... args) {
+  T value(std::forward<Args>(args)...);
+  auto [found, at] = locate(value);
+  if (found) return false;
+  insert_at(at.first, at.second, value);
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key, class... Args>
+std::pair<T*, bool> BTree<T, Compare, Alloc, NodeSize>::try_emplace(
+    const Key& key, Args&&... args) {
+  auto [found, at] = locate(key);
+  if (found) return {&at.first->value(at.second), false};
+  T value(std::forward<Args>(args)...);
+  return {insert_at(at.first, at.second, value), true};
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::assign_sorted(std::vector<T> values) {
+  auto out_of_order = [this](const T& a, const T& b) { return !comp(a, b); };
+  if (std::adjacent_find(values.begin(), values.end(), out_of_order) !=
+      values.end()) {
+    std::stable_sort(values.begin(), values.end(), comp);
+    auto equivalent = [this](const T& a, const T& b) {
+      return !comp(a, b) && !comp(b, a);
+    };
+    values.erase(std::unique(values.begin(), values.end(), equivalent),
+                 values.end());
+  }
+
+  clear();
+  try {
+    for (T& value : values) {
+      LeafNode* leaf = root;
+      while (leaf && !leaf->leaf) leaf = child(leaf, leaf->count);
+      insert_at(leaf, leaf ? leaf->count : 0, value);
+    }
+  } catch (...) {
+    clear();
+    throw;
+  }
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+int BTree<T, Compare, Alloc, NodeSize>::height() const {
+  int h = -1;
+  for (const LeafNode* node = root; node;
+       node = node->leaf ? nullptr : child(node, 0)) {
+    ++h;
+  }
+  return h;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+typename BTree<T, Compare, Alloc, NodeSize>::const_iterator
+BTree<T, Compare, Alloc, NodeSize>::begin() const {
+  if (!root) return end();
+  const LeafNode* node = root;
+  while (!node->leaf) node = child(node, 0);
+  return const_iterator(node, 0, this);
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+bool BTree<T, Compare, Alloc, NodeSize>::is_balanced() const {
+  if (!root) return elements == 0;
+  if (root->parent || root->count == 0) return false;
+  std::size_t total = 0;
+  if (!is_balanced(root, 0, height(), total) || total != elements) {
+    return false;
+  }
+  return std::adjacent_find(begin(), end(), [this](const T& a, const T& b) {
+           return !comp(a, b);
+         }) == end();
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+bool BTree<T, Compare, Alloc, NodeSize>::is_balanced(
+    const LeafNode* node, int depth, int leaf_depth,
+    std::size_t& total) const {
+  if (node != root && (node->count < min_count || node->count > capacity)) {
+    return false;
+  }
+  if constexpr (mirror_keys) {
+    for (std::size_t i = 0; i < node->count; ++i) {
+      if (node->keys[i] != Compare::key(node->value(i))) return false;
+    }
+  }
+  total += node->count;
+  if (node->leaf) return depth == leaf_depth;
+  for (std::size_t i = 0; i <= node->count; ++i) {
+    const LeafNode* c = child(node, i);
+    if (c->parent != node || c->position != i ||
+        !is_balanced(c, depth + 1, leaf_depth, total)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key>
+std::size_t BTree<T, Compare, Alloc, NodeSize>::lower_index(
+    const LeafNode* node, const Key& key) const {
+  if constexpr (simd_search<Key>) {
+    return simd::count_less(&node->value(0), node->count, key);
+  } else if constexpr (simd_key_search<Key>) {
+    if constexpr (std::is_same_v<Key, T>) {
+      return simd::count_less(node->keys, node->count, Compare::key(key));
+    } else {
+      return simd::count_less(node->keys, node->count, key);
+    }
+  }
+  std::size_t lo = 0, hi = node->count;
+  while (lo < hi) {
+    std::size_t mid = (lo + hi) / 2;
+    if (comp(node->value(mid), key)) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key>
+std::size_t BTree<T, Compare, Alloc, NodeSize>::upper_index(
+    const LeafNode* node, const Key& key) const {
+  std::size_t lo = 0, hi = node->count;
+  while (lo < hi) {
+    std::size_t mid = (lo + hi) / 2;
+    if (comp(key, node->value(mid))) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key>
+std::pair<bool, std::pair<typename BTree<T, Compare, Alloc, NodeSize>::LeafNode*,
+                          std::size_t>>
+BTree<T, Compare, Alloc, NodeSize>::locate(const Key& key) const {
+  LeafNode* node = root;
+  while (node) {
+    std::size_t i = lower_index(node, key);
+    if (i < node->count && matches(node, i, key)) {
+      return {true, {node, i}};
+    }
+    if (node->leaf) return {false, {node, i}};
+    node = child(node, i);
+  }
+  return {false, {nullptr, 0}};
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key>
+typename BTree<T, Compare, Alloc, NodeSize>::const_iterator
+BTree<T, Compare, Alloc, NodeSize>::lower(const Key& key) const {
+  // O candidato de cada nível é o primeiro elemento do nó que não é menor
+  // que `key`; os de níveis mais fundos ficam antes dele.
+  const_iterator result = end();
+  const LeafNode* node = root;
+  while (node) {
+    std::size_t i = lower_index(node, key);
+    if (i < node->count) {
+      result = const_iterator(node, i, this);
+      if (matches(node, i, key)) break;
+    }
+    node = node->leaf ? nullptr : child(node, i);
+  }
+  return result;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key>
+typename BTree<T, Compare, Alloc, NodeSize>::const_iterator
+BTree<T, Compare, Alloc, NodeSize>::upper(const Key& key) const {
+  const_iterator result = end();
+  const LeafNode* node = root;
+  while (node) {
+    std::size_t i = upper_index(node, key);
+    if (i < node->count) result = const_iterator(node, i, this);
+    node = node->leaf ? nullptr : child(node, i);
+  }
+  return result;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+T* BTree<T, Compare, Alloc, NodeSize>::insert_at(LeafNode* leaf,
+                                                 std::size_t index, T& value) {
+  if (!root) {
+    root = create_leaf();
+    insert_into(root, 0, value, nullptr);
+    ++elements;
+    return &root->value(0);
+  }
+
+  // Uma folha cheia se divide, e cada divisão sobe um elemento para o pai,
+  // que pode estar cheio também; a raiz cheia ganha uma raiz nova acima.
+  std::size_t splits = 0;
+  bool new_root = false;
+  for (LeafNode* node = leaf; node->count == capacity; node = node->parent) {
+    ++splits;
+    if (!node->parent) {
+      new_root = true;
+      break;
+    }
+  }
+  LeafNode* spare_leaf = nullptr;
+  std::vector<InnerNode*> spare_inner;
+  if (splits > 0) {
+    try {
+      spare_leaf = create_leaf();
+      spare_inner.reserve(splits - 1 + new_root);
+      for (std::size_t i = 1; i < splits + new_root; ++i) {
+        spare_inner.push_back(create_inner());
+      }
+    } catch (...) {
+      if (spare_leaf) destroy_node(spare_leaf);
+      for (InnerNode* node : spare_inner) destroy_node(node);
+      throw;
+    }
+  }
+
+  // Daqui em diante nada lança exceções
+  ++elements;
+  T* inserted = nullptr;
+  Slot carry, median;
+  T* pending = &value;  // Elemento a inserir no nível atual
+  LeafNode* right = nullptr;
+  LeafNode* node = leaf;
+  std::size_t i = index;
+  while (true) {
+    if (node->count < capacity) {
+      insert_into(node, i, *pending, right);
+      if (!inserted) inserted = &node->value(i);
+      break;
+    }
+
+    // Divide o nó: fica com a metade esquerda, o elemento do meio sobe e a
+    // metade direita vai para `sibling`
+    LeafNode* sibling = node->leaf ? spare_leaf : spare_inner.back();
+    if (!node->leaf) spare_inner.pop_back();
+    const std::size_t half = capacity / 2;
+    for (std::size_t j = half + 1; j < capacity; ++j) {
+      relocate(node->value(j), &sibling->slots[j - half - 1]);
+    }
+    if (!node->leaf) {
+      for (std::size_t j = half + 1; j <= capacity; ++j) {
+        set_child(sibling, j - half - 1, child(node, j));
+      }
+    }
+    sibling->count = static_cast<std::uint16_t>(capacity - half - 1);
+    relocate(node->value(half), &median);
+    node->count = static_cast<std::uint16_t>(half);
+
+    LeafNode* target = i <= half ? node : sibling;
+    std::size_t at = i <= half ? i : i - half - 1;
+    insert_into(target, at, *pending, right);
+    store_keys(i <= half ? sibling : node);
+    if (!inserted) inserted = &target->value(at);
+    if (pending != &value) pending->~T();
+
+    // O elemento do meio sobe, com `sibling` à sua direita
+    T& up = *std::launder(reinterpret_cast<T*>(&median));
+    relocate(up, &carry);
+    pending = std::launder(reinterpret_cast<T*>(&carry));
+    right = sibling;
+    if (!node->parent) {
+      InnerNode* top = spare_inner.back();
+      spare_inner.pop_back();
+      relocate(*pending, &top->slots[0]);
+      top->count = 1;
+      store_keys(top);
+      set_child(top, 0, node);
+      set_child(top, 1, sibling);
+      root = top;
+      return inserted;
+    }
+    i = node->position;
+    node = node->parent;
+  }
+  if (pending != &value) pending->~T();
+  return inserted;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::insert_into(LeafNode* node,
+                                                     std::size_t i, T& value,
+                                                     LeafNode* right) {
+  for (std::size_t j = node->count; j > i; --j) {
+    relocate(node->value(j - 1), &node->slots[j]);
+  }
+  ::new (&node->slots[i]) T(std::move(value));
+  if (!node->leaf) {
+    for (std::size_t j = node->count + 1; j > i + 1; --j) {
+      set_child(node, j, child(node, j - 1));
+    }
+    set_child(node, i + 1, right);
+  }
+  ++node->count;
+  store_keys(node);
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+template <class Key>
+bool BTree<T, Compare, Alloc, NodeSize>::erase(const Key& key) {
+  auto [found, at] = locate(key);
+  if (!found) return false;
+  auto [node, i] = at;
+  node->value(i).~T();
+  if (!node->leaf) {
+    // Troca pelo predecessor, que está numa folha
+    LeafNode* leaf = child(node, i);
+    while (!leaf->leaf) leaf = child(leaf, leaf->count);
+    relocate(leaf->value(leaf->count - 1), &node->slots[i]);
+    --leaf->count;
+    store_keys(node);
+    node = leaf;
+  } else {
+    for (std::size_t j = i + 1; j < node->count; ++j) {
+      relocate(node->value(j), &node->slots[j - 1]);
+    }
+    --node->count;
+    store_keys(node);
+  }
+  --elements;
+  rebalance(node);
+  return true;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::rebalance(LeafNode* node) {
+  while (node != root && node->count < min_count) {
+    LeafNode* parent = node->parent;
+    std::size_t pos = node->position;
+    if (pos > 0 && child(parent, pos - 1)->count > min_count) {
+      rotate_right(parent, pos - 1);
+      return;
+    }
+    if (pos < parent->count && child(parent, pos + 1)->count > min_count) {
+      rotate_left(parent, pos);
+      return;
+    }
+    merge(parent, pos > 0 ? pos - 1 : pos);
+    node = parent;
+  }
+  if (root->count == 0) {
+    LeafNode* old = root;
+    root = old->leaf ? nullptr : child(old, 0);
+    if (root) {
+      root->parent = nullptr;
+      root->position = 0;
+    }
+    destroy_node(old);
+  }
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::rotate_right(LeafNode* parent,
+                                                      std::size_t k) {
+  LeafNode* left = child(parent, k);
+  LeafNode* right = child(parent, k + 1);
+  for (std::size_t j = right->count; j > 0; --j) {
+    relocate(right->value(j - 1), &right->slots[j]);
+  }
+  relocate(parent->value(k), &right->slots[0]);
+  relocate(left->value(left->count - 1), &parent->slots[k]);
+  if (!left->leaf) {
+    for (std::size_t j = right->count + 1; j > 0; --j) {
+      set_child(right, j, child(right, j - 1));
+    }
+    set_child(right, 0, child(left, left->count));
+  }
+  --left->count;
+  ++right->count;
+  store_keys(parent);
+  store_keys(right);
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::rotate_left(LeafNode* parent,
+                                                     std::size_t k) {
+  LeafNode* left = child(parent, k);
+  LeafNode* right = child(parent, k + 1);
+  relocate(parent->value(k), &left->slots[left->count]);
+  relocate(right->value(0), &parent->slots[k]);
+  for (std::size_t j = 1; j < right->count; ++j) {
+    relocate(right->value(j), &right->slots[j - 1]);
+  }
+  if (!left->leaf) {
+    set_child(left, left->count + 1, child(right, 0));
+    for (std::size_t j = 1; j <= right->count; ++j) {
+      set_child(right, j - 1, child(right, j));
+    }
+  }
+  ++left->count;
+  --right->count;
+  store_keys(parent);
+  store_keys(left);
+  store_keys(right);
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::merge(LeafNode* parent,
+                                               std::size_t k) {
+  LeafNode* left = child(parent, k);
+  LeafNode* right = child(parent, k + 1);
+  std::size_t base = left->count;
+  relocate(parent->value(k), &left->slots[base]);
+  for (std::size_t j = 0; j < right->count; ++j) {
+    relocate(right->value(j), &left->slots[base + 1 + j]);
+  }
+  if (!left->leaf) {
+    for (std::size_t j = 0; j <= right->count; ++j) {
+      set_child(left, base + 1 + j, child(right, j));
+    }
+  }
+  left->count = static_cast<std::uint16_t>(base + 1 + right->count);
+  right->count = 0;
+  destroy_node(right);
+
+  for (std::size_t j = k + 1; j < parent->count; ++j) {
+    relocate(parent->value(j), &parent->slots[j - 1]);
+    set_child(parent, j, child(parent, j + 1));
+  }
+  --parent->count;
+  store_keys(left);
+  store_keys(parent);
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+typename BTree<T, Compare, Alloc, NodeSize>::LeafNode*
+BTree<T, Compare, Alloc, NodeSize>::create_leaf() {
+  LeafNode* node = LeafAllocTraits::allocate(alloc, 1);
+  ::new (static_cast<void*>(node)) LeafNode;
+  node->parent = nullptr;
+  node->position = 0;
+  node->count = 0;
+  node->leaf = true;
+  return node;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+typename BTree<T, Compare, Alloc, NodeSize>::InnerNode*
+BTree<T, Compare, Alloc, NodeSize>::create_inner() {
+  InnerAlloc inner_alloc(alloc);
+  InnerNode* node = InnerAllocTraits::allocate(inner_alloc, 1);
+  ::new (static_cast<void*>(node)) InnerNode;
+  node->parent = nullptr;
+  node->position = 0;
+  node->count = 0;
+  node->leaf = false;
+  return node;
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::destroy_node(LeafNode* node) {
+  for (std::size_t i = 0; i < node->count; ++i) node->value(i).~T();
+  if (node->leaf) {
+    LeafAllocTraits::deallocate(alloc, node, 1);
+  } else {
+    InnerAlloc inner_alloc(alloc);
+    InnerAllocTraits::deallocate(inner_alloc, static_cast<InnerNode*>(node),
+                                 1);
+  }
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+void BTree<T, Compare, Alloc, NodeSize>::clear(LeafNode* node) {
+  if (!node) return;
+  if (!node->leaf) {
+    for (std::size_t i = 0; i <= node->count; ++i) clear(child(node, i));
+  }
+  destroy_node(node);
+}
+
+template <class T, class Compare, class Alloc, class NodeSize>
+typename BTree<T, Compare, Alloc, NodeSize>::LeafNode*
+BTree<T, Compare, Alloc, NodeSize>::clone(const LeafNode* source) {
+  LeafNode* node = source->leaf ? create_leaf() : create_inner();
+  std::size_t children = 0;
+  try {
+    for (std::size_t i = 0; i < source->count; ++i) {
+      ::new (&node->slots[i]) T(source->value(i));
+      ++node->count;
+    }
+    store_keys(node);
+    if (!source->leaf) {
+      for (; children <= source->count; ++children) {
+        set_child(node, children, clone(child(source, children)));
+      }
+    }
+  } catch (...) {
+    for (std::size_t i = 0; i < children; ++i) clear(child(node, i));
+    destroy_node(node);
+    throw;
+  }
+  return node;
+}
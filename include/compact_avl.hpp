@@ -0,0 +1,990 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Árvore AVL com nós compactos, para conjuntos muito grandes de
+ * elementos pequenos.
+ *
+ * Cada nó da `AVL` guarda, além do elemento, três ponteiros de 64 bits, o
+ * tamanho da subárvore e a altura: mais de 40 bytes por elemento. Aqui
+ * o nó tem só o elemento e dois índices de 32 bits:
+ *
+ * - Os filhos são índices numa arena própria da árvore, não ponteiros. Os
+ *   nós ficam em blocos que dobram de tamanho, então a árvore comporta até
+ *   2^30 - 1 elementos sem realocar (nem mover) nós já criados.
+ * - No lugar da altura, o fator de balanço (-1, 0 ou +1) ocupa os 2 bits
+ *   altos do índice do filho esquerdo, e o balanceamento é feito só com ele.
+ * - Não há ponteiro para o pai nem tamanho de subárvore: os iteradores
+ *   guardam o caminho desde a raiz, e não há `rank`/`select`.
+ * - A arena é dividida em linhas de 64 bytes com tantos nós inteiros quantos
+ *   couberem, e nenhum nó fica dividido entre duas linhas de cache.
+ *
+ * Para `uint32_t`, o nó ocupa 12 bytes (5 por linha de cache); para
+ * `uint64_t`, 16 bytes (4 por linha).
+ *
+ * @tparam T Tipo dos elementos armazenados na árvore.
+ * @tparam Compare Comparador que define a ordem dos elementos. Se for
+ * transparente (define `is_transparent`), as buscas aceitam qualquer tipo
+ * comparável com `T`, sem construir um `T` temporário.
+ * @tparam Alloc Alocador dos blocos da arena (via rebind).
+ */
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
+class CompactAVL {
+ private:
+  /// Índice que representa a ausência de nó.
+  static constexpr std::uint32_t null = 0;
+  /// Bits do índice do filho esquerdo; os 2 bits altos são o balanço.
+  static constexpr std::uint32_t index_mask = (std::uint32_t(1) << 30) - 1;
+  static constexpr unsigned balance_shift = 30;
+
+  /**
+   * @brief Nó da árvore.
+   */
+  struct Node {
+    T data;                  ///< Valor armazenado no nó.
+    std::uint32_t left_bits;  ///< Filho esquerdo e (nos 2 bits altos) o
+                              ///< fator de balanço + 1.
+    std::uint32_t right;      ///< Filho direito.
+
+    template <class... Args>
+    explicit Node(std::in_place_t, Args&&... args)
+        : data(std::forward<Args>(args)...),
+          left_bits(std::uint32_t(1) << balance_shift),
+          right(null) {}
+  };
+
+  /// Nós por linha de cache.
+  static constexpr std::size_t per_line =
+      sizeof(Node) >= 64 ? 1 : 64 / sizeof(Node);
+
+  /**
+   * @brief Uma linha de cache da arena, com espaço para `per_line` nós.
+   */
+  struct alignas(64) Line {
+    typename std::aligned_storage<sizeof(Node), alignof(Node)>::type
+        slots[per_line];
+  };
+
+  /// Linhas do primeiro bloco; o bloco k tem `first_lines << k` linhas.
+  static constexpr std::size_t first_lines = 16;
+  static constexpr std::size_t first_nodes = first_lines * per_line;
+
+  using LineAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<Line>;
+  using LineAllocTraits = std::allocator_traits<LineAlloc>;
+
+ public:
+  /**
+   * @brief Iterador bidirecional que percorre a árvore em ordem (in-order).
+   *
+   * Como os nós não apontam para o pai, guarda os índices do caminho desde a
+   * raiz (no máximo ~1,44 log2 n deles). Os elementos são somente leitura.
+   * Como as rotações mudam os caminhos, qualquer inserção ou remoção
+   * invalida os iteradores.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() : tree(nullptr) {}
+
+    reference operator*() const { return tree->node(path.back()).data; }
+    pointer operator->() const { return &tree->node(path.back()).data; }
+
+    /**
+     * @brief Avança para o sucessor: o menor da subárvore direita ou, se não
+     * houver, o primeiro ancestral do qual viemos pela esquerda.
+     */
+    const_iterator& operator++() {
+      std::uint32_t current = path.back();
+      if (std::uint32_t right = tree->node(current).right) {
+        path.push_back(right);
+        tree->descend(path, true);
+      } else {
+        do {
+          current = path.back();
+          path.pop_back();
+        } while (!path.empty() && tree->node(path.back()).right == current);
+      }
+      return *this;
+    }
+
+    /**
+     * @brief Volta para o predecessor. A partir de `end()`, vai ao maior
+     * elemento.
+     */
+    const_iterator& operator--() {
+      if (path.empty()) {
+        path.push_back(tree->root);
+        tree->descend(path, false);
+      } else if (std::uint32_t left = tree->left(path.back())) {
+        path.push_back(left);
+        tree->descend(path, false);
+      } else {
+        std::uint32_t current;
+        do {
+          current = path.back();
+          path.pop_back();
+        } while (!path.empty() && tree->left(path.back()) == current);
+      }
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    const_iterator operator--(int) {
+      const_iterator old = *this;
+      --*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return path.empty() ? other.path.empty()
+                          : !other.path.empty() && path.back() == other.path.back();
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class CompactAVL;
+
+    explicit const_iterator(const CompactAVL* tree) : tree(tree) {}
+
+    const CompactAVL* tree;            ///< Árvore percorrida.
+    std::vector<std::uint32_t> path;  ///< Caminho da raiz até o elemento.
+  };
+
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = reverse_iterator;
+
+  /**
+   * @brief Construtor padrão. Cria uma árvore vazia.
+   */
+  CompactAVL() = default;
+
+  /**
+   * @brief Cria uma árvore vazia que aloca sua arena com `alloc`.
+   */
+  explicit CompactAVL(const Alloc& alloc) : alloc(alloc) {}
+
+  /**
+   * @brief Construtor de cópia: reconstrói a árvore, em O(n), a partir dos
+   * elementos em ordem.
+   */
+  CompactAVL(const CompactAVL& other)
+      : alloc(LineAllocTraits::select_on_container_copy_construction(
+            other.alloc)),
+        comp(other.comp) {
+    assign_sorted(other.begin(), other.end());
+  }
+
+  /**
+   * @brief Construtor de movimento, em O(1).
+   */
+  CompactAVL(CompactAVL&& other) noexcept
+      : alloc(std::move(other.alloc)), comp(std::move(other.comp)) {
+    steal(other);
+  }
+
+  CompactAVL& operator=(const CompactAVL& other) {
+    if (this != &other) {
+      CompactAVL copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  CompactAVL& operator=(CompactAVL&& other) noexcept {
+    if (this != &other) {
+      CompactAVL old(std::move(*this));
+      swap(other);
+    }
+    return *this;
+  }
+
+  /**
+   * @brief Destrutor. Destrói os elementos e libera a arena.
+   */
+  ~CompactAVL() { release(); }
+
+  /**
+   * @brief Troca o conteúdo com `other` em O(1).
+   */
+  void swap(CompactAVL& other) noexcept {
+    using std::swap;
+    swap(alloc, other.alloc);
+    swap(comp, other.comp);
+    swap(chunks, other.chunks);
+    swap(root, other.root);
+    swap(next_index, other.next_index);
+    swap(free_head, other.free_head);
+    swap(elements, other.elements);
+  }
+
+  friend void swap(CompactAVL& a, CompactAVL& b) noexcept { a.swap(b); }
+
+  /**
+   * @brief Insere um valor na árvore.
+   *
+   * @return `true` se o valor foi inserido, `false` se já existia.
+   */
+  bool insert(const T& value) { return try_emplace(value, value).second; }
+
+  /**
+   * @brief Insere um valor na árvore, movendo-o se ele não existir.
+   */
+  bool insert(T&& value) { return try_emplace(value, std::move(value)).second; }
+
+  /**
+   * @brief Constrói um valor a partir de `args` e o insere se não existir.
+   */
+  template <class... Args>
+  bool emplace(Args&&... args) {
+    T value(std::forward<Args>(args)...);
+    return try_emplace(value, std::move(value)).second;
+  }
+
+  /**
+   * @brief Procura `key` e, se não existir, insere um `T` construído a
+   * partir de `args`, que deve ser equivalente a `key`.
+   *
+   * @return Ponteiro para o elemento e `true` se ele foi inserido.
+   */
+  template <class Key, class... Args>
+  std::pair<T*, bool> try_emplace(const Key& key, Args&&... args);
+
+  /**
+   * @brief Remove um valor da árvore.
+   *
+   * @return `true` se o valor existia.
+   */
+  bool remove(const T& value) { return erase(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool remove(const Key& key) {
+    return erase(key);
+  }
+
+  /**
+   * @brief Verifica se um valor está presente na árvore.
+   */
+  bool contain(const T& value) const { return find(value) != nullptr; }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    return find(key) != nullptr;
+  }
+
+  /**
+   * @brief Procura um valor na árvore.
+   *
+   * @return Ponteiro para o elemento encontrado ou nullptr.
+   */
+  T* search(const T& value) { return find(value); }
+  const T* search(const T& value) const { return find(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  T* search(const Key& key) {
+    return find(key);
+  }
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* search(const Key& key) const {
+    return find(key);
+  }
+
+  /**
+   * @brief Retorna os elementos em ordem crescente.
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Substitui o conteúdo da árvore pelos valores de [first, last).
+   *
+   * Como em `AVL::assign_sorted`, a entrada fora de ordem é ordenada (de
+   * forma estável) e as repetições são descartadas, mantendo a primeira.
+   * A árvore é montada em O(n) com os nós em pré-ordem na arena, de modo
+   * que um nó e o filho esquerdo costumam dividir a mesma linha de cache.
+   */
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last) {
+    assign_sorted(std::vector<T>(first, last));
+  }
+
+  /**
+   * @brief Variante de `assign_sorted` que move os valores de um vetor.
+   */
+  void assign_sorted(std::vector<T> values);
+
+  /**
+   * @brief Remove todos os elementos e libera a arena.
+   */
+  void clear() { release(); }
+
+  /**
+   * @brief Retorna uma cópia do alocador (do tipo `Alloc`) usado pela árvore.
+   */
+  Alloc get_allocator() const { return Alloc(alloc); }
+
+  /**
+   * @brief Quantidade de elementos, em O(1).
+   */
+  std::size_t size() const { return elements; }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return elements == 0; }
+
+  /**
+   * @brief Bytes ocupados pela árvore: a arena inteira (inclusive espaços
+   * livres e a folga do último bloco) e a tabela de blocos.
+   */
+  std::size_t memory_usage() const;
+
+  /**
+   * @brief Primeiro elemento que não é menor que `value`.
+   */
+  const_iterator lower_bound(const T& value) const { return lower(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator lower_bound(const Key& key) const {
+    return lower(key);
+  }
+
+  /**
+   * @brief Primeiro elemento maior que `value`.
+   */
+  const_iterator upper_bound(const T& value) const { return upper(value); }
+
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const_iterator upper_bound(const Key& key) const {
+    return upper(key);
+  }
+
+  /**
+   * @brief Iteradores que percorrem a árvore em ordem crescente.
+   */
+  const_iterator begin() const {
+    const_iterator it(this);
+    if (root) {
+      it.path.push_back(root);
+      descend(it.path, true);
+    }
+    return it;
+  }
+  const_iterator end() const { return const_iterator(this); }
+  reverse_iterator rbegin() const { return reverse_iterator(end()); }
+  reverse_iterator rend() const { return reverse_iterator(begin()); }
+
+  /**
+   * @brief Verifica se a árvore está balanceada e se os fatores de balanço
+   * guardados batem com as alturas reais.
+   */
+  bool is_balanced() const {
+    std::size_t total = 0;
+    return checked_height(root, total) >= -1 && total == elements;
+  }
+
+ private:
+  Node& node(std::uint32_t index) const {
+    return *std::launder(reinterpret_cast<Node*>(slot(index)));
+  }
+
+  /**
+   * @brief Endereço do espaço do índice `index` na arena.
+   *
+   * O bloco k começa no índice `first_nodes * (2^k - 1)`.
+   */
+  void* slot(std::uint32_t index) const;
+
+  std::uint32_t left(std::uint32_t index) const {
+    return node(index).left_bits & index_mask;
+  }
+  void set_left(std::uint32_t index, std::uint32_t child) {
+    Node& n = node(index);
+    n.left_bits = (n.left_bits & ~index_mask) | child;
+  }
+  std::uint32_t right(std::uint32_t index) const { return node(index).right; }
+  void set_right(std::uint32_t index, std::uint32_t child) {
+    node(index).right = child;
+  }
+
+  /**
+   * @brief Fator de balanço: altura da direita menos altura da esquerda.
+   */
+  int balance(std::uint32_t index) const {
+    return static_cast<int>(node(index).left_bits >> balance_shift) - 1;
+  }
+  void set_balance(std::uint32_t index, int balance) {
+    Node& n = node(index);
+    n.left_bits = (n.left_bits & index_mask) |
+                  (static_cast<std::uint32_t>(balance + 1) << balance_shift);
+  }
+
+  /**
+   * @brief Estende `path` descendo sempre à esquerda (`leftmost`) ou sempre
+   * à direita.
+   */
+  void descend(std::vector<std::uint32_t>& path, bool leftmost) const {
+    while (std::uint32_t next = leftmost ? left(path.back())
+                                         : right(path.back())) {
+      path.push_back(next);
+    }
+  }
+
+  template <class Key>
+  T* find(const Key& key) const;
+
+  template <class Key>
+  const_iterator lower(const Key& key) const;
+
+  template <class Key>
+  const_iterator upper(const Key& key) const;
+
+  /**
+   * @brief Insere na subárvore de `link`, se `key` não existir.
+   *
+   * @param link Raiz da subárvore; atualizada se ela mudar.
+   * @param found Recebe o índice do elemento encontrado ou criado.
+   * @param make Cria o nó novo e retorna seu índice.
+   * @return `true` se a altura da subárvore aumentou.
+   */
+  template <class Key, class Make>
+  bool insert(std::uint32_t& link, const Key& key, std::uint32_t& found,
+              bool& inserted, Make& make);
+
+  template <class Key>
+  bool erase(const Key& key) {
+    bool removed = false;
+    erase(root, key, removed);
+    if (removed) --elements;
+    return removed;
+  }
+
+  /**
+   * @brief Remove `key` da subárvore de `link`, se existir.
+   *
+   * @return `true` se a altura da subárvore diminuiu.
+   */
+  template <class Key>
+  bool erase(std::uint32_t& link, const Key& key, bool& removed);
+
+  /**
+   * @brief Remove o menor nó da subárvore de `link`, movendo seu elemento
+   * para o nó `target`.
+   *
+   * @return `true` se a altura da subárvore diminuiu.
+   */
+  bool erase_min(std::uint32_t& link, std::uint32_t target);
+
+  /**
+   * @brief Ajusta o balanço de `link` depois que a subárvore esquerda
+   * diminuiu, rotacionando se preciso.
+   *
+   * @return `true` se a altura de `link` diminuiu.
+   */
+  bool left_shrunk(std::uint32_t& link);
+
+  /**
+   * @brief Simétrico de `left_shrunk`.
+   */
+  bool right_shrunk(std::uint32_t& link);
+
+  /**
+   * @brief Rebalanceia `a`, com fator -2 (pesado à esquerda), por uma
+   * rotação simples ou dupla.
+   *
+   * @return A nova raiz da subárvore.
+   */
+  std::uint32_t fix_left(std::uint32_t a);
+
+  /**
+   * @brief Simétrico de `fix_left`, para fator +2.
+   */
+  std::uint32_t fix_right(std::uint32_t a);
+
+  /**
+   * @brief Reserva um índice livre na arena, criando um bloco se preciso.
+   */
+  std::uint32_t allocate_index();
+
+  template <class... Args>
+  std::uint32_t create_node(Args&&... args);
+
+  void destroy_node(std::uint32_t index);
+
+  std::uint32_t build_sorted(std::vector<T>& values, std::size_t lo,
+                             std::size_t hi, int& height);
+
+  /**
+   * @brief Destrói os nós da subárvore de `index`, com uma pilha explícita.
+   */
+  void destroy_subtree(std::uint32_t index);
+
+  /**
+   * @brief Destrói todos os elementos e libera os blocos da arena.
+   */
+  void release();
+
+  void steal(CompactAVL& other) {
+    chunks = std::move(other.chunks);
+    root = other.root;
+    next_index = other.next_index;
+    free_head = other.free_head;
+    elements = other.elements;
+    other.chunks.clear();
+    other.root = null;
+    other.next_index = 1;
+    other.free_head = null;
+    other.elements = 0;
+  }
+
+  /**
+   * @brief Altura da subárvore de `index`, ou -2 se alguma invariante
+   * falhar. Soma os nós em `total`.
+   */
+  int checked_height(std::uint32_t index, std::size_t& total) const;
+
+  LineAlloc alloc;                   ///< Alocador dos blocos.
+  Compare comp;                      ///< Ordem dos elementos.
+  std::vector<Line*> chunks;         ///< Blocos da arena.
+  std::uint32_t root = null;         ///< Raiz da árvore.
+  std::uint32_t next_index = 1;      ///< Próximo índice nunca usado (o 0
+                                     ///< representa a ausência de nó).
+  std::uint32_t free_head = null;    ///< Lista de índices liberados.
+  std::size_t elements = 0;          ///< Quantidade de elementos.
+};
+
+template <class T, class Compare, class Alloc>
+void* CompactAVL<T, Compare, Alloc>::slot(std::uint32_t index) const {
+  std::size_t block = index / first_nodes + 1;
+  unsigned k = 0;
+#if defined(__GNUC__)
+  k = 63 - __builtin_clzll(block);
+#else
+  while (block >> (k + 1)) ++k;
+#endif
+  std::size_t offset = index - first_nodes * ((std::size_t(1) << k) - 1);
+  return &chunks[k][offset / per_line].slots[offset % per_line];
+}
+
+template <class T, class Compare, class Alloc>
+std::size_t CompactAVL<T, Compare, Alloc>::memory_usage() const {
+  std::size_t lines = first_lines * ((std::size_t(1) << chunks.size()) - 1);
+  return lines * sizeof(Line) + chunks.capacity() * sizeof(Line*);
+}
+
+template <class T, class Compare, class Alloc>
+std::vector<T> CompactAVL<T, Compare, Alloc>::in_order() const {
+  std::vector<T> values;
+  values.reserve(elements);
+  for (const T& value : *this) values.push_back(value);
+  return values;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+T* CompactAVL<T, Compare, Alloc>::find(const Key& key) const {
+  std::uint32_t current = root;
+  while (current) {
+    Node& n = node(current);
+    if (comp(key, n.data)) {
+      current = n.left_bits & index_mask;
+    } else if (comp(n.data, key)) {
+      current = n.right;
+    } else {
+      return &n.data;
+    }
+  }
+  return nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+typename CompactAVL<T, Compare, Alloc>::const_iterator
+CompactAVL<T, Compare, Alloc>::lower(const Key& key) const {
+  // O caminho até o resultado é um prefixo do caminho da busca
+  const_iterator it(this);
+  std::size_t best = 0;
+  for (std::uint32_t current = root; current;) {
+    it.path.push_back(current);
+    if (comp(node(current).data, key)) {
+      current = right(current);
+    } else {
+      best = it.path.size();
+      current = left(current);
+    }
+  }
+  it.path.resize(best);
+  return it;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+typename CompactAVL<T, Compare, Alloc>::const_iterator
+CompactAVL<T, Compare, Alloc>::upper(const Key& key) const {
+  const_iterator it(this);
+  std::size_t best = 0;
+  for (std::uint32_t current = root; current;) {
+    it.path.push_back(current);
+    if (comp(key, node(current).data)) {
+      best = it.path.size();
+      current = left(current);
+    } else {
+      current = right(current);
+    }
+  }
+  it.path.resize(best);
+  return it;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key, class... Args>
+std::pair<T*, bool> CompactAVL<T, Compare, Alloc>::try_emplace(
+    const Key& key, Args&&... args) {
+  std::uint32_t found = null;
+  bool inserted = false;
+  auto make = [&] { return create_node(std::forward<Args>(args)...); };
+  insert(root, key, found, inserted, make);
+  if (inserted) ++elements;
+  return {&node(found).data, inserted};
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key, class Make>
+bool CompactAVL<T, Compare, Alloc>::insert(std::uint32_t& link,
+                                           const Key& key,
+                                           std::uint32_t& found,
+                                           bool& inserted, Make& make) {
+  if (!link) {
+    link = found = make();
+    inserted = true;
+    return true;
+  }
+  if (comp(key, node(link).data)) {
+    std::uint32_t child = left(link);
+    bool grew = insert(child, key, found, inserted, make);
+    set_left(link, child);
+    if (!grew) return false;
+    switch (balance(link)) {
+      case 1:
+        set_balance(link, 0);
+        return false;
+      case 0:
+        set_balance(link, -1);
+        return true;
+      default:
+        link = fix_left(link);
+        return false;
+    }
+  }
+  if (comp(node(link).data, key)) {
+    std::uint32_t child = right(link);
+    bool grew = insert(child, key, found, inserted, make);
+    set_right(link, child);
+    if (!grew) return false;
+    switch (balance(link)) {
+      case -1:
+        set_balance(link, 0);
+        return false;
+      case 0:
+        set_balance(link, 1);
+        return true;
+      default:
+        link = fix_right(link);
+        return false;
+    }
+  }
+  found = link;
+  return false;
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+bool CompactAVL<T, Compare, Alloc>::erase(std::uint32_t& link, const Key& key,
+                                          bool& removed) {
+  if (!link) return false;
+  if (comp(key, node(link).data)) {
+    std::uint32_t child = left(link);
+    bool shrunk = erase(child, key, removed);
+    set_left(link, child);
+    return shrunk && left_shrunk(link);
+  }
+  if (comp(node(link).data, key)) {
+    std::uint32_t child = right(link);
+    bool shrunk = erase(child, key, removed);
+    set_right(link, child);
+    return shrunk && right_shrunk(link);
+  }
+
+  removed = true;
+  if (!left(link) || !right(link)) {
+    std::uint32_t old = link;
+    link = left(old) ? left(old) : right(old);
+    destroy_node(old);
+    return true;
+  }
+  // Dois filhos: o sucessor (menor da direita) toma o lugar do elemento
+  std::uint32_t child = right(link);
+  bool shrunk = erase_min(child, link);
+  set_right(link, child);
+  return shrunk && right_shrunk(link);
+}
+
+template <class T, class Compare, class Alloc>
+bool CompactAVL<T, Compare, Alloc>::erase_min(std::uint32_t& link,
+                                              std::uint32_t target) {
+  if (!left(link)) {
+    std::uint32_t old = link;
+    node(target).data = std::move(node(old).data);
+    link = right(old);
+    destroy_node(old);
+    return true;
+  }
+  std::uint32_t child = left(link);
+  bool shrunk = erase_min(child, target);
+  set_left(link, child);
+  return shrunk && left_shrunk(link);
+}
+
+template <class T, class Compare, class Alloc>
+bool CompactAVL<T, Compare, Alloc>::left_shrunk(std::uint32_t& link) {
+  switch (balance(link)) {
+    case -1:
+      set_balance(link, 0);
+      return true;
+    case 0:
+      set_balance(link, 1);
+      return false;
+    default: {
+      // Uma rotação sobre um filho balanceado não reduz a altura
+      bool reduced = balance(right(link)) != 0;
+      link = fix_right(link);
+      return reduced;
+    }
+  }
+}
+
+template <class T, class Compare, class Alloc>
+bool CompactAVL<T, Compare, Alloc>::right_shrunk(std::uint32_t& link) {
+  switch (balance(link)) {
+    case 1:
+      set_balance(link, 0);
+      return true;
+    case 0:
+      set_balance(link, -1);
+      return false;
+    default: {
+      bool reduced = balance(left(link)) != 0;
+      link = fix_left(link);
+      return reduced;
+    }
+  }
+}
+
+template <class T, class Compare, class Alloc>
+std::uint32_t CompactAVL<T, Compare, Alloc>::fix_left(std::uint32_t a) {
+  std::uint32_t b = left(a);
+  int b_balance = balance(b);
+  if (b_balance <= 0) {
+    // Rotação à direita
+    set_left(a, right(b));
+    set_right(b, a);
+    set_balance(a, b_balance == 0 ? -1 : 0);
+    set_balance(b, b_balance == 0 ? 1 : 0);
+    return b;
+  }
+  // Rotação dupla esquerda-direita
+  std::uint32_t c = right(b);
+  int c_balance = balance(c);
+  set_right(b, left(c));
+  set_left(a, right(c));
+  set_left(c, b);
+  set_right(c, a);
+  set_balance(a, c_balance == -1 ? 1 : 0);
+  set_balance(b, c_balance == 1 ? -1 : 0);
+  set_balance(c, 0);
+  return c;
+}
+
+template <class T, class Compare, class Alloc>
+std::uint32_t CompactAVL<T, Compare, Alloc>::fix_right(std::uint32_t a) {
+  std::uint32_t b = right(a);
+  int b_balance = balance(b);
+  if (b_balance >= 0) {
+    // Rotação à esquerda
+    set_right(a, left(b));
+    set_left(b, a);
+    set_balance(a, b_balance == 0 ? 1 : 0);
+    set_balance(b, b_balance == 0 ? -1 : 0);
+    return b;
+  }
+  // Rotação dupla direita-esquerda
+  std::uint32_t c = left(b);
+  int c_balance = balance(c);
+  set_left(b, right(c));
+  set_right(a, left(c));
+  set_right(c, b);
+  set_left(c, a);
+  set_balance(a, c_balance == 1 ? -1 : 0);
+  set_balance(b, c_balance == -1 ? 1 : 0);
+  set_balance(c, 0);
+  return c;
+}
+
+template <class T, class Compare, class Alloc>
+std::uint32_t CompactAVL<T, Compare, Alloc>::allocate_index() {
+  if (free_head) {
+    std::uint32_t index = free_head;
+    free_head = *std::launder(reinterpret_cast<std::uint32_t*>(slot(index)));
+    return index;
+  }
+  if (next_index > index_mask) {
+    throw std::length_error("CompactAVL: limite de 2^30 - 1 elementos");
+  }
+  std::size_t capacity = first_nodes * ((std::size_t(1) << chunks.size()) - 1);
+  if (next_index >= capacity) {
+    chunks.reserve(chunks.size() + 1);
+    chunks.push_back(
+        LineAllocTraits::allocate(alloc, first_lines << chunks.size()));
+  }
+  return next_index++;
+}
+
+template <class T, class Compare, class Alloc>
+template <class... Args>
+std::uint32_t CompactAVL<T, Compare, Alloc>::create_node(Args&&... args) {
+  std::uint32_t index = allocate_index();
+  try {
+    ::new (slot(index)) Node(std::in_place, std::forward<Args>(args)...);
+  } catch (...) {
+    ::new (slot(index)) std::uint32_t(free_head);
+    free_head = index;
+    throw;
+  }
+  return index;
+}
+
+template <class T, class Compare, class Alloc>
+void CompactAVL<T, Compare, Alloc>::destroy_node(std::uint32_t index) {
+  node(index).~Node();
+  ::new (slot(index)) std::uint32_t(free_head);
+  free_head = index;
+}
+
+template <class T, class Compare, class Alloc>
+void CompactAVL<T, Compare, Alloc>::assign_sorted(std::vector<T> values) {
+  auto out_of_order = [this](const T& a, const T& b) { return !comp(a, b); };
+  if (std::adjacent_find(values.begin(), values.end(), out_of_order) !=
+      values.end()) {
+    std::stable_sort(values.begin(), values.end(), comp);
+    auto equivalent = [this](const T& a, const T& b) {
+      return !comp(a, b) && !comp(b, a);
+    };
+    values.erase(std::unique(values.begin(), values.end(), equivalent),
+                 values.end());
+  }
+  if (values.size() > index_mask - 1) {
+    throw std::length_error("CompactAVL: limite de 2^30 - 1 elementos");
+  }
+
+  release();
+  try {
+    int height;
+    root = build_sorted(values, 0, values.size(), height);
+    elements = values.size();
+  } catch (...) {
+    release();
+    throw;
+  }
+}
+
+template <class T, class Compare, class Alloc>
+std::uint32_t CompactAVL<T, Compare, Alloc>::build_sorted(
+    std::vector<T>& values, std::size_t lo, std::size_t hi, int& height) {
+  if (lo == hi) {
+    height = -1;
+    return null;
+  }
+  std::size_t mid = lo + (hi - lo) / 2;
+  // Pré-ordem: o nó antes dos filhos
+  std::uint32_t index = create_node(std::move(values[mid]));
+  int left_height, right_height;
+  try {
+    set_left(index, build_sorted(values, lo, mid, left_height));
+    set_right(index, build_sorted(values, mid + 1, hi, right_height));
+  } catch (...) {
+    // A parte que falhou já se desfez; resta o nó e a subárvore esquerda
+    destroy_subtree(index);
+    throw;
+  }
+  set_balance(index, right_height - left_height);
+  height = 1 + std::max(left_height, right_height);
+  return index;
+}
+
+template <class T, class Compare, class Alloc>
+void CompactAVL<T, Compare, Alloc>::destroy_subtree(std::uint32_t index) {
+  if (!index) return;
+  std::vector<std::uint32_t> stack = {index};
+  while (!stack.empty()) {
+    index = stack.back();
+    stack.pop_back();
+    if (left(index)) stack.push_back(left(index));
+    if (right(index)) stack.push_back(right(index));
+    destroy_node(index);
+  }
+}
+
+template <class T, class Compare, class Alloc>
+void CompactAVL<T, Compare, Alloc>::release() {
+  if (!std::is_trivially_destructible<T>::value) destroy_subtree(root);
+  for (std::size_t k = 0; k < chunks.size(); ++k) {
+    LineAllocTraits::deallocate(alloc, chunks[k], first_lines << k);
+  }
+  chunks.clear();
+  root = null;
+  next_index = 1;
+  free_head = null;
+  elements = 0;
+}
+
+template <class T, class Compare, class Alloc>
+int CompactAVL<T, Compare, Alloc>::checked_height(std::uint32_t index,
+                                                  std::size_t& total) const {
+  if (!index) return -1;
+  ++total;
+  std::uint32_t l = left(index), r = right(index);
+  if ((l && !comp(node(l).data, node(index).data)) ||
+      (r && !comp(node(index).data, node(r).data))) {
+    return -2;
+  }
+  int left_height = checked_height(l, total);
+  int right_height = checked_height(r, total);
+  if (left_height < -1 || right_height < -1 ||
+      right_height - left_height != balance(index)) {
+    return -2;
+  }
+  return 1 + std::max(left_height, right_height);
+}
@@ -0,0 +1,999 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "epoch.hpp"
+
+/**
+ * @brief Árvore AVL concorrente com validação otimista e travas por nó.
+ *
+ * Segue o algoritmo de Bronson, Casper, Chafi e Olukotun ("A Practical
+ * Concurrent Binary Search Tree", PPoPP 2010). Vários escritores trabalham
+ * ao mesmo tempo em partes diferentes da árvore:
+ *
+ * - Cada nó tem uma trava e uma versão. Uma rotação marca como "encolhendo"
+ *   o nó cuja subárvore perde chaves e incrementa sua versão ao terminar.
+ * - Buscas não usam travas: descem de nó em nó lendo a versão do filho
+ *   antes de usá-lo e conferindo, depois, que a versão do pai não mudou (a
+ *   validação "mão sobre mão"). Se mudou, a busca volta um nível.
+ * - Inserções e remoções fazem a mesma descida otimista e só travam o nó
+ *   alterado (e o pai, quando um nó é desligado).
+ * - Remover um nó com dois filhos só o marca como ausente; ele continua na
+ *   árvore como nó de roteamento e é desligado quando ficar com um filho.
+ * - O balanceamento é relaxado: depois de cada alteração, a thread sobe
+ *   corrigindo alturas e fazendo rotações, travando só pai, nó e filho.
+ *   Quando as operações param, a árvore respeita o balanceamento AVL.
+ *
+ * Nós desligados são entregues a um `EpochDomain` e só são liberados quando
+ * nenhuma operação que poderia estar neles continua ativa.
+ *
+ * As travas são sempre tomadas de cima para baixo na forma atual da árvore
+ * (pai, nó, filho, neto), e cada uma só depois de conferir, com a trava de
+ * cima já segura, que o nó ainda está embaixo dela; como um nó só muda de
+ * pai com a trava do pai, essa ordem não forma ciclos. Depois de uma
+ * rotação, porém, o antigo filho é pai, e o detector de impasses do
+ * ThreadSanitizer, que lembra a ordem de cada par de travas, acusa uma
+ * inversão. Essas acusações (em `rebalance*` e `rotate*`) são suprimidas
+ * por `test/tsan.supp`.
+ *
+ * Os nós são alocados com `new`, então não há parâmetro de alocador.
+ *
+ * @tparam T Tipo dos elementos armazenados.
+ * @tparam Compare Comparador que define a ordem dos elementos. Se for
+ * transparente, as buscas aceitam qualquer tipo comparável com `T`.
+ */
+template <class T, class Compare = std::less<T>>
+class ConcurrentAVL {
+ public:
+  /**
+   * @brief Construtor padrão. Cria uma árvore vazia.
+   */
+  ConcurrentAVL() : holder(nullptr), count(0), comp() {
+    holder.present.store(false);
+  }
+
+  ConcurrentAVL(const ConcurrentAVL&) = delete;
+  ConcurrentAVL& operator=(const ConcurrentAVL&) = delete;
+
+  /**
+   * @brief Destrutor. Não pode haver operações em andamento.
+   */
+  ~ConcurrentAVL();
+
+  /**
+   * @brief Insere um valor.
+   *
+   * @return `true` se o valor foi inserido, `false` se já existia.
+   */
+  bool insert(const T& value);
+
+  /**
+   * @brief Remove um valor.
+   *
+   * @return `true` se o valor foi removido, `false` se não existia.
+   */
+  bool remove(const T& value) { return remove_key(value); }
+
+  /**
+   * @brief `remove` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool remove(const Key& key) {
+    return remove_key(key);
+  }
+
+  /**
+   * @brief Verifica se a árvore contém um valor. Não usa travas.
+   */
+  bool contain(const T& value) const { return contain_key(value); }
+
+  /**
+   * @brief `contain` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    return contain_key(key);
+  }
+
+  /**
+   * @brief Quantidade de elementos.
+   *
+   * Exata quando não há operações em andamento; durante elas, reflete as
+   * que já terminaram.
+   */
+  std::size_t size() const { return count.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Verifica se a árvore está vazia.
+   */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * @brief Retorna os elementos em ordem crescente.
+   *
+   * Deve ser chamado sem operações em andamento.
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Verifica o balanceamento AVL e as alturas guardadas nos nós.
+   *
+   * Deve ser chamado sem operações em andamento, quando todo o
+   * rebalanceamento pendente já foi feito.
+   */
+  bool is_balanced() const { return check(holder.right.load()).first; }
+
+ private:
+  /**
+   * @brief Parte estrutural de um nó. A sentinela acima da raiz só tem esta
+   * parte.
+   */
+  struct TreeNode {
+    std::atomic<TreeNode*> left;    ///< Filho à esquerda.
+    std::atomic<TreeNode*> right;   ///< Filho à direita.
+    std::atomic<TreeNode*> parent;  ///< Pai (nullptr na sentinela).
+    std::atomic<int> height;        ///< Altura (1 numa folha, 0 para nullptr).
+    std::atomic<std::uint64_t> version;  ///< Bits de estado e contador.
+    std::atomic<bool> present;  ///< `false` em nós de roteamento.
+    std::mutex mutex;           ///< Trava do nó.
+
+    explicit TreeNode(TreeNode* parent)
+        : left(nullptr),
+          right(nullptr),
+          parent(parent),
+          height(1),
+          version(0),
+          present(true) {}
+
+    /**
+     * @brief Filho na direção `dir` (negativa: esquerda; positiva: direita).
+     */
+    TreeNode* child(int dir) const { return dir < 0 ? left.load() : right.load(); }
+
+    void set_child(int dir, TreeNode* node) {
+      if (dir < 0) {
+        left.store(node);
+      } else {
+        right.store(node);
+      }
+    }
+  };
+
+  /**
+   * @brief Nó com um valor.
+   */
+  struct DataNode : TreeNode {
+    const T data;  ///< Valor armazenado no nó.
+
+    DataNode(TreeNode* parent, const T& value) : TreeNode(parent), data(value) {}
+  };
+
+  /// Resultado de uma tentativa de busca.
+  enum class Probe { absent, found, retry };
+
+  /// Resultado de uma tentativa de alteração.
+  enum class Outcome { unchanged, changed, retry };
+
+  /// Versão com uma rotação em andamento que encolhe a subárvore do nó.
+  static constexpr std::uint64_t shrinking = 1;
+  /// Versão de um nó desligado da árvore.
+  static constexpr std::uint64_t unlinked = 2;
+
+  /// Condições de `node_condition` (valores não negativos são alturas).
+  static constexpr int unlink_required = -1;
+  static constexpr int rebalance_required = -2;
+  static constexpr int nothing_required = -3;
+
+  static bool is_unlinked(std::uint64_t version) {
+    return (version & unlinked) != 0;
+  }
+  static bool is_changing(std::uint64_t version) {
+    return (version & (shrinking | unlinked)) != 0;
+  }
+  static std::uint64_t begin_change(std::uint64_t version) {
+    return version | shrinking;
+  }
+  static std::uint64_t end_change(std::uint64_t version) {
+    return (version | shrinking | unlinked) + 1;
+  }
+
+  /**
+   * @brief Trava `node`, se não for nulo.
+   */
+  static std::unique_lock<std::mutex> lock(TreeNode* node) {
+    if (!node) return std::unique_lock<std::mutex>();
+    return std::unique_lock<std::mutex>(node->mutex);
+  }
+
+  static int height(const TreeNode* node) {
+    return node ? node->height.load() : 0;
+  }
+
+  static const T& data_of(const TreeNode* node) {
+    return static_cast<const DataNode*>(node)->data;
+  }
+
+  /**
+   * @brief Direção de `key` em relação a `node`: -1, 0 ou 1.
+   */
+  template <class Key>
+  int direction(const Key& key, const TreeNode* node) const {
+    if (comp(key, data_of(node))) return -1;
+    if (comp(data_of(node), key)) return 1;
+    return 0;
+  }
+
+  /**
+   * @brief Espera terminar a rotação que encolhe `node`, se a sua versão
+   * ainda for `version`.
+   */
+  static void wait_until_shrink_completed(TreeNode* node,
+                                          std::uint64_t version);
+
+  template <class Key>
+  bool contain_key(const Key& key) const;
+
+  /**
+   * @brief Desce a partir de `node`, cuja versão lida era `version`.
+   *
+   * @return `Probe::retry` se `node` mudou e a descida deve recomeçar no
+   * nível de cima.
+   */
+  template <class Key>
+  Probe attempt_get(const Key& key, TreeNode* node, int dir,
+                    std::uint64_t version) const;
+
+  /**
+   * @brief Insere ou remove `key` a partir de `node`.
+   *
+   * @param value Valor a inserir (igual a `key`), ou nullptr para remover.
+   * @param parent Pai de `node`.
+   * @param version Versão de `node` lida ao chegar nele.
+   */
+  template <class Key>
+  Outcome attempt_update(const Key& key, const T* value, TreeNode* parent,
+                         TreeNode* node, std::uint64_t version);
+
+  /**
+   * @brief Altera `node`, que contém `key`.
+   */
+  Outcome attempt_node_update(bool insert, TreeNode* parent, TreeNode* node);
+
+  template <class Key>
+  bool remove_key(const Key& key);
+
+  /**
+   * @brief Desliga `node`, que tem no máximo um filho, de `parent`.
+   * Requer as travas dos dois.
+   *
+   * @return `false` se a árvore mudou e o desligamento não é mais possível.
+   */
+  bool attempt_unlink(TreeNode* parent, TreeNode* node);
+
+  /**
+   * @brief Diagnostica `node`: precisa ser desligado, rebalanceado, ter a
+   * altura corrigida (retorna a altura nova) ou nada.
+   */
+  static int node_condition(TreeNode* node);
+
+  /**
+   * @brief Corrige a altura de `node`, se for só isso que ele precisa.
+   * Requer a trava de `node`.
+   *
+   * Depois de gravar a altura, relê a dos filhos e repete se alguma mudou.
+   * Quem mudou a altura de um filho grava antes de ler a do pai, então ou
+   * esta releitura vê a mudança, ou quem a fez vê a altura nova do pai e
+   * continua o conserto: nenhuma correção se perde.
+   *
+   * @return O próximo nó a consertar, ou nullptr.
+   */
+  static TreeNode* fix_height(TreeNode* node);
+
+  /**
+   * @brief Sobe a partir de `node` corrigindo alturas, desligando nós de
+   * roteamento e fazendo rotações, até não haver mais o que consertar.
+   */
+  void fix_height_and_rebalance(TreeNode* node);
+
+  /**
+   * @brief Conserta `node`. Requer as travas de `parent` e `node`.
+   *
+   * @param pending Recebe nós danificados além do retornado.
+   * @return O próximo nó a consertar, ou nullptr.
+   */
+  TreeNode* rebalance(TreeNode* parent, TreeNode* node,
+                      std::vector<TreeNode*>& pending);
+
+  TreeNode* rebalance_to_right(TreeNode* parent, TreeNode* node,
+                               TreeNode* left, int right_height,
+                               std::vector<TreeNode*>& pending);
+  TreeNode* rebalance_to_left(TreeNode* parent, TreeNode* node,
+                              TreeNode* right, int left_height,
+                              std::vector<TreeNode*>& pending);
+
+  /**
+   * @brief Rotações. As alturas são calculadas como em `fix_height`: lidas
+   * dos filhos depois de religar os nós e recalculadas até ficarem estáveis.
+   *
+   * O pai é sempre corrigido, pois o topo da subárvore mudou; se algum nó
+   * girado ficou danificado, ele é retornado e o conserto do pai continua
+   * depois, via `pending`.
+   */
+  TreeNode* rotate_right(TreeNode* parent, TreeNode* node, TreeNode* left,
+                         TreeNode* left_right,
+                         std::vector<TreeNode*>& pending);
+  TreeNode* rotate_left(TreeNode* parent, TreeNode* node, TreeNode* right,
+                        TreeNode* right_left, std::vector<TreeNode*>& pending);
+  TreeNode* rotate_right_over_left(TreeNode* parent, TreeNode* node,
+                                   TreeNode* left, TreeNode* left_right,
+                                   std::vector<TreeNode*>& pending);
+  TreeNode* rotate_left_over_right(TreeNode* parent, TreeNode* node,
+                                   TreeNode* right, TreeNode* right_left,
+                                   std::vector<TreeNode*>& pending);
+
+  /**
+   * @brief Escolhe o próximo nó a consertar depois de uma rotação: o
+   * danificado, se houver, deixando `next` em `pending`.
+   */
+  static TreeNode* defer(TreeNode* next, TreeNode* damaged,
+                         std::vector<TreeNode*>& pending) {
+    if (!damaged) return next;
+    if (next) pending.push_back(next);
+    return damaged;
+  }
+
+  /**
+   * @brief Verifica recursivamente balanceamento e alturas.
+   *
+   * @return Par (está_correta, altura).
+   */
+  std::pair<bool, int> check(const TreeNode* node) const;
+
+  mutable EpochDomain domain;       ///< Adia a liberação de nós desligados.
+  TreeNode holder;                  ///< Sentinela; a raiz é o filho direito.
+  std::atomic<std::size_t> count;   ///< Quantidade de elementos.
+  Compare comp;                     ///< Comparador dos elementos.
+};
+
+template <class T, class Compare>
+ConcurrentAVL<T, Compare>::~ConcurrentAVL() {
+  std::vector<TreeNode*> pending;
+  if (TreeNode* root = holder.right.load()) pending.push_back(root);
+  while (!pending.empty()) {
+    TreeNode* node = pending.back();
+    pending.pop_back();
+    if (TreeNode* left = node->left.load()) pending.push_back(left);
+    if (TreeNode* right = node->right.load()) pending.push_back(right);
+    delete static_cast<DataNode*>(node);
+  }
+}
+
+template <class T, class Compare>
+void ConcurrentAVL<T, Compare>::wait_until_shrink_completed(
+    TreeNode* node, std::uint64_t version) {
+  if (!(version & shrinking)) return;
+  for (int spin = 0; spin < 100; ++spin) {
+    if (node->version.load() != version) return;
+  }
+  while (node->version.load() == version) {
+    // A rotação segura a trava do nó: esperar por ela evita girar à toa
+    std::lock_guard<std::mutex> lock(node->mutex);
+  }
+}
+
+template <class T, class Compare>
+template <class Key>
+bool ConcurrentAVL<T, Compare>::contain_key(const Key& key) const {
+  EpochDomain::Guard guard(domain);
+  while (true) {
+    TreeNode* root = holder.right.load();
+    if (!root) return false;
+    int dir = direction(key, root);
+    if (dir == 0) return root->present.load();
+    std::uint64_t version = root->version.load();
+    if (is_changing(version)) {
+      wait_until_shrink_completed(root, version);
+    } else if (root == holder.right.load()) {
+      Probe probe = attempt_get(key, root, dir, version);
+      if (probe != Probe::retry) return probe == Probe::found;
+    }
+  }
+}
+
+template <class T, class Compare>
+template <class Key>
+typename ConcurrentAVL<T, Compare>::Probe
+ConcurrentAVL<T, Compare>::attempt_get(const Key& key, TreeNode* node, int dir,
+                                       std::uint64_t version) const {
+  while (true) {
+    TreeNode* child = node->child(dir);
+    if (!child) {
+      // O filho foi lido enquanto `node` era válido: a chave não existe
+      if (node->version.load() != version) return Probe::retry;
+      return Probe::absent;
+    }
+    int child_dir = direction(key, child);
+    if (child_dir == 0) {
+      return child->present.load() ? Probe::found : Probe::absent;
+    }
+    std::uint64_t child_version = child->version.load();
+    if (is_changing(child_version)) {
+      wait_until_shrink_completed(child, child_version);
+      if (node->version.load() != version) return Probe::retry;
+    } else if (child != node->child(dir)) {
+      if (node->version.load() != version) return Probe::retry;
+    } else {
+      // Confere que o caminho até `node` ainda vale antes de descer
+      if (node->version.load() != version) return Probe::retry;
+      Probe probe = attempt_get(key, child, child_dir, child_version);
+      if (probe != Probe::retry) return probe;
+    }
+  }
+}
+
+template <class T, class Compare>
+bool ConcurrentAVL<T, Compare>::insert(const T& value) {
+  EpochDomain::Guard guard(domain);
+  while (true) {
+    TreeNode* root = holder.right.load();
+    if (!root) {
+      std::lock_guard<std::mutex> lock(holder.mutex);
+      if (!holder.right.load()) {
+        holder.right.store(new DataNode(&holder, value));
+        count.fetch_add(1, std::memory_order_relaxed);
+        return true;
+      }
+      continue;
+    }
+    std::uint64_t version = root->version.load();
+    if (is_changing(version)) {
+      wait_until_shrink_completed(root, version);
+    } else if (root == holder.right.load()) {
+      Outcome outcome = attempt_update(value, &value, &holder, root, version);
+      if (outcome != Outcome::retry) {
+        if (outcome == Outcome::changed) {
+          count.fetch_add(1, std::memory_order_relaxed);
+        }
+        return outcome == Outcome::changed;
+      }
+    }
+  }
+}
+
+template <class T, class Compare>
+template <class Key>
+bool ConcurrentAVL<T, Compare>::remove_key(const Key& key) {
+  EpochDomain::Guard guard(domain);
+  while (true) {
+    TreeNode* root = holder.right.load();
+    if (!root) return false;
+    std::uint64_t version = root->version.load();
+    if (is_changing(version)) {
+      wait_until_shrink_completed(root, version);
+    } else if (root == holder.right.load()) {
+      Outcome outcome = attempt_update(key, nullptr, &holder, root, version);
+      if (outcome != Outcome::retry) {
+        if (outcome == Outcome::changed) {
+          count.fetch_sub(1, std::memory_order_relaxed);
+        }
+        return outcome == Outcome::changed;
+      }
+    }
+  }
+}
+
+template <class T, class Compare>
+template <class Key>
+typename ConcurrentAVL<T, Compare>::Outcome
+ConcurrentAVL<T, Compare>::attempt_update(const Key& key, const T* value,
+                                          TreeNode* parent, TreeNode* node,
+                                          std::uint64_t version) {
+  int dir = direction(key, node);
+  if (dir == 0) return attempt_node_update(value != nullptr, parent, node);
+
+  while (true) {
+    TreeNode* child = node->child(dir);
+    if (node->version.load() != version) return Outcome::retry;
+
+    if (!child) {
+      if (!value) return Outcome::unchanged;  // A chave não existe
+      TreeNode* damaged;
+      {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        // Com a trava, nenhuma rotação futura afeta `node`; basta validar
+        // as passadas
+        if (node->version.load() != version) return Outcome::retry;
+        if (node->child(dir)) continue;  // Outra inserção chegou antes
+        node->set_child(dir, new DataNode(node, *value));
+        damaged = fix_height(node);
+      }
+      fix_height_and_rebalance(damaged);
+      return Outcome::changed;
+    }
+
+    std::uint64_t child_version = child->version.load();
+    if (is_changing(child_version)) {
+      wait_until_shrink_completed(child, child_version);
+    } else if (child == node->child(dir)) {
+      // Confere que o caminho até `node` ainda vale antes de descer
+      if (node->version.load() != version) return Outcome::retry;
+      Outcome outcome = attempt_update(key, value, node, child, child_version);
+      if (outcome != Outcome::retry) return outcome;
+    }
+  }
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::Outcome
+ConcurrentAVL<T, Compare>::attempt_node_update(bool insert, TreeNode* parent,
+                                               TreeNode* node) {
+  if (!insert && !node->present.load()) return Outcome::unchanged;
+
+  if (!insert && (!node->left.load() || !node->right.load())) {
+    // Com no máximo um filho, o nó pode ser desligado: trava o pai também
+    TreeNode* damaged;
+    {
+      std::lock_guard<std::mutex> parent_lock(parent->mutex);
+      if (is_unlinked(parent->version.load()) ||
+          node->parent.load() != parent) {
+        return Outcome::retry;
+      }
+      std::lock_guard<std::mutex> lock(node->mutex);
+      if (!node->present.load()) return Outcome::unchanged;
+      if (!attempt_unlink(parent, node)) return Outcome::retry;
+      damaged = fix_height(parent);
+    }
+    fix_height_and_rebalance(damaged);
+    return Outcome::changed;
+  }
+
+  std::lock_guard<std::mutex> lock(node->mutex);
+  if (is_unlinked(node->version.load())) return Outcome::retry;
+  if (node->present.load() == insert) return Outcome::unchanged;
+  if (!insert && (!node->left.load() || !node->right.load())) {
+    return Outcome::retry;  // Agora dá para desligar: recomeça
+  }
+  // Inserção num nó de roteamento, ou remoção que deixa um
+  node->present.store(insert);
+  return Outcome::changed;
+}
+
+template <class T, class Compare>
+bool ConcurrentAVL<T, Compare>::attempt_unlink(TreeNode* parent,
+                                               TreeNode* node) {
+  TreeNode* parent_left = parent->left.load();
+  if (parent_left != node && parent->right.load() != node) return false;
+  TreeNode* left = node->left.load();
+  TreeNode* right = node->right.load();
+  if (left && right) return false;
+
+  TreeNode* splice = left ? left : right;
+  if (parent_left == node) {
+    parent->left.store(splice);
+  } else {
+    parent->right.store(splice);
+  }
+  if (splice) splice->parent.store(parent);
+  node->version.store(unlinked);
+  node->present.store(false);
+  domain.retire(static_cast<DataNode*>(node));
+  return true;
+}
+
+template <class T, class Compare>
+int ConcurrentAVL<T, Compare>::node_condition(TreeNode* node) {
+  TreeNode* left = node->left.load();
+  TreeNode* right = node->right.load();
+  if ((!left || !right) && !node->present.load()) return unlink_required;
+
+  int h = node->height.load();
+  int hL = height(left);
+  int hR = height(right);
+  // Mudanças depois destas leituras são consertadas por quem as fizer
+  int repaired = 1 + std::max(hL, hR);
+  int balance = hL - hR;
+  if (balance < -1 || balance > 1) return rebalance_required;
+  return h != repaired ? repaired : nothing_required;
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::fix_height(TreeNode* node) {
+  bool changed = false;
+  while (true) {
+    int condition = node_condition(node);
+    switch (condition) {
+      case rebalance_required:
+      case unlink_required:
+        return node;
+      case nothing_required:
+        return changed ? node->parent.load() : nullptr;
+      default:
+        node->height.store(condition);
+        changed = true;
+    }
+  }
+}
+
+template <class T, class Compare>
+void ConcurrentAVL<T, Compare>::fix_height_and_rebalance(TreeNode* node) {
+  // Uma rotação pode deixar mais de um nó por consertar; os outros esperam
+  // aqui
+  std::vector<TreeNode*> pending;
+  while (true) {
+    if (!node || !node->parent.load() || is_unlinked(node->version.load())) {
+      if (pending.empty()) return;
+      node = pending.back();
+      pending.pop_back();
+      continue;
+    }
+    int condition = node_condition(node);
+    if (condition == nothing_required) {
+      node = nullptr;
+    } else if (condition != unlink_required &&
+               condition != rebalance_required) {
+      std::lock_guard<std::mutex> lock(node->mutex);
+      // Um nó desligado no meio do caminho é descartado no início do laço
+      if (!is_unlinked(node->version.load())) node = fix_height(node);
+    } else {
+      TreeNode* parent = node->parent.load();
+      std::lock_guard<std::mutex> parent_lock(parent->mutex);
+      if (!is_unlinked(parent->version.load()) &&
+          node->parent.load() == parent) {
+        std::lock_guard<std::mutex> lock(node->mutex);
+        // Um nó desligado ainda aponta para o pai antigo: girá-lo
+        // corromperia a árvore
+        if (!is_unlinked(node->version.load())) {
+          node = rebalance(parent, node, pending);
+        }
+      }
+      // Senão, tenta de novo com o pai atual
+    }
+  }
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rebalance(TreeNode* parent, TreeNode* node,
+                                     std::vector<TreeNode*>& pending) {
+  TreeNode* left = node->left.load();
+  TreeNode* right = node->right.load();
+  if ((!left || !right) && !node->present.load()) {
+    // Nó de roteamento desnecessário
+    if (attempt_unlink(parent, node)) return fix_height(parent);
+    return node;
+  }
+
+  int hL = height(left);
+  int hR = height(right);
+  int balance = hL - hR;
+  if (balance > 1) return rebalance_to_right(parent, node, left, hR, pending);
+  if (balance < -1) return rebalance_to_left(parent, node, right, hL, pending);
+  // Só a altura: com a trava do pai, o conserto continua nele
+  TreeNode* next = fix_height(node);
+  return next == parent ? fix_height(parent) : next;
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rebalance_to_right(TreeNode* parent,
+                                              TreeNode* node, TreeNode* left,
+                                              int hR,
+                                              std::vector<TreeNode*>& pending) {
+  // A esquerda é alta demais: rotação à direita, precedida de uma à
+  // esquerda no filho se o neto interno for o mais alto
+  std::lock_guard<std::mutex> left_lock(left->mutex);
+  int hL = left->height.load();
+  if (hL - hR <= 1) return node;  // Mudou: tenta de novo
+  TreeNode* left_right = left->right.load();
+  int hLL = height(left->left.load());
+  std::unique_lock<std::mutex> left_right_lock = lock(left_right);
+  int hLR = height(left_right);
+  if (hLL >= hLR) return rotate_right(parent, node, left, left_right, pending);
+  int hLRL = height(left_right->left.load());
+  int balance = hLL - hLRL;
+  if (balance >= -1 && balance <= 1 &&
+      !((hLL == 0 || hLRL == 0) && !left->present.load())) {
+    // A rotação dupla não deve deixar o filho esquerdo danificado
+    return rotate_right_over_left(parent, node, left, left_right, pending);
+  }
+  // A rotação dupla danificaria o filho: gira só o filho agora (as travas
+  // necessárias já estão seguras) e `node` é rebalanceado em seguida
+  return rotate_left(node, left, left_right, left_right->left.load(),
+                     pending);
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rebalance_to_left(TreeNode* parent, TreeNode* node,
+                                             TreeNode* right, int hL,
+                                             std::vector<TreeNode*>& pending) {
+  std::lock_guard<std::mutex> right_lock(right->mutex);
+  int hR = right->height.load();
+  if (hL - hR >= -1) return node;  // Mudou: tenta de novo
+  TreeNode* right_left = right->left.load();
+  int hRR = height(right->right.load());
+  std::unique_lock<std::mutex> right_left_lock = lock(right_left);
+  int hRL = height(right_left);
+  if (hRR >= hRL) return rotate_left(parent, node, right, right_left, pending);
+  int hRLR = height(right_left->right.load());
+  int balance = hRR - hRLR;
+  if (balance >= -1 && balance <= 1 &&
+      !((hRR == 0 || hRLR == 0) && !right->present.load())) {
+    return rotate_left_over_right(parent, node, right, right_left, pending);
+  }
+  return rotate_right(node, right, right_left, right_left->right.load(),
+                      pending);
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rotate_right(TreeNode* parent, TreeNode* node,
+                                        TreeNode* left, TreeNode* left_right,
+                                        std::vector<TreeNode*>& pending) {
+  std::uint64_t version = node->version.load();
+  TreeNode* parent_left = parent->left.load();
+  node->version.store(begin_change(version));
+
+  node->left.store(left_right);
+  if (left_right) left_right->parent.store(node);
+  left->right.store(node);
+  node->parent.store(left);
+  if (parent_left == node) {
+    parent->left.store(left);
+  } else {
+    parent->right.store(left);
+  }
+  left->parent.store(parent);
+
+  TreeNode* left_left = left->left.load();
+  TreeNode* right = node->right.load();
+  int hLL, hLR, hR, hN;
+  do {
+    hLL = height(left_left);
+    hLR = height(left_right);
+    hR = height(right);
+    hN = 1 + std::max(hLR, hR);
+    node->height.store(hN);
+    left->height.store(1 + std::max(hLL, hN));
+  } while (hLL != height(left_left) || hLR != height(left_right) ||
+           hR != height(right));
+  node->version.store(end_change(version));
+
+  // O nó danificado mais baixo é consertado primeiro, enquanto as travas
+  // ainda valem; o conserto a partir do pai fica para depois
+  TreeNode* next = fix_height(parent);
+  TreeNode* damaged = nullptr;
+  int balance_left = hLL - hN;
+  if (balance_left < -1 || balance_left > 1 ||
+      (!left_left && !left->present.load())) {
+    damaged = left;
+  }
+  int balance_node = hLR - hR;
+  if (balance_node < -1 || balance_node > 1 ||
+      ((!left_right || !right) && !node->present.load())) {
+    damaged = node;
+  }
+  return defer(next, damaged, pending);
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rotate_left(TreeNode* parent, TreeNode* node,
+                                       TreeNode* right, TreeNode* right_left,
+                                       std::vector<TreeNode*>& pending) {
+  std::uint64_t version = node->version.load();
+  TreeNode* parent_left = parent->left.load();
+  node->version.store(begin_change(version));
+
+  node->right.store(right_left);
+  if (right_left) right_left->parent.store(node);
+  right->left.store(node);
+  node->parent.store(right);
+  if (parent_left == node) {
+    parent->left.store(right);
+  } else {
+    parent->right.store(right);
+  }
+  right->parent.store(parent);
+
+  TreeNode* right_right = right->right.load();
+  TreeNode* left = node->left.load();
+  int hRR, hRL, hL, hN;
+  do {
+    hRR = height(right_right);
+    hRL = height(right_left);
+    hL = height(left);
+    hN = 1 + std::max(hL, hRL);
+    node->height.store(hN);
+    right->height.store(1 + std::max(hN, hRR));
+  } while (hRR != height(right_right) || hRL != height(right_left) ||
+           hL != height(left));
+  node->version.store(end_change(version));
+
+  TreeNode* next = fix_height(parent);
+  TreeNode* damaged = nullptr;
+  int balance_right = hRR - hN;
+  if (balance_right < -1 || balance_right > 1 ||
+      (!right_right && !right->present.load())) {
+    damaged = right;
+  }
+  int balance_node = hRL - hL;
+  if (balance_node < -1 || balance_node > 1 ||
+      ((!right_left || !left) && !node->present.load())) {
+    damaged = node;
+  }
+  return defer(next, damaged, pending);
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rotate_right_over_left(
+    TreeNode* parent, TreeNode* node, TreeNode* left, TreeNode* left_right,
+    std::vector<TreeNode*>& pending) {
+  std::uint64_t version = node->version.load();
+  std::uint64_t left_version = left->version.load();
+  TreeNode* parent_left = parent->left.load();
+  TreeNode* left_right_left = left_right->left.load();
+  TreeNode* left_right_right = left_right->right.load();
+
+  node->version.store(begin_change(version));
+  left->version.store(begin_change(left_version));
+
+  // A ordem importa: buscas concorrentes precisam sempre achar um caminho
+  node->left.store(left_right_right);
+  if (left_right_right) left_right_right->parent.store(node);
+  left->right.store(left_right_left);
+  if (left_right_left) left_right_left->parent.store(left);
+  left_right->left.store(left);
+  left->parent.store(left_right);
+  left_right->right.store(node);
+  node->parent.store(left_right);
+  if (parent_left == node) {
+    parent->left.store(left_right);
+  } else {
+    parent->right.store(left_right);
+  }
+  left_right->parent.store(parent);
+
+  TreeNode* left_left = left->left.load();
+  TreeNode* right = node->right.load();
+  int hLL, hLRL, hLRR, hR, hLeft, hN;
+  do {
+    hLL = height(left_left);
+    hLRL = height(left_right_left);
+    hLRR = height(left_right_right);
+    hR = height(right);
+    hN = 1 + std::max(hLRR, hR);
+    node->height.store(hN);
+    hLeft = 1 + std::max(hLL, hLRL);
+    left->height.store(hLeft);
+    left_right->height.store(1 + std::max(hLeft, hN));
+  } while (hLL != height(left_left) || hLRL != height(left_right_left) ||
+           hLRR != height(left_right_right) || hR != height(right));
+
+  node->version.store(end_change(version));
+  left->version.store(end_change(left_version));
+
+  TreeNode* next = fix_height(parent);
+  TreeNode* damaged = nullptr;
+  int balance_top = hLeft - hN;
+  if (balance_top < -1 || balance_top > 1) damaged = left_right;
+  int balance_left = hLL - hLRL;
+  if (balance_left < -1 || balance_left > 1 ||
+      ((!left_left || !left_right_left) && !left->present.load())) {
+    if (damaged) pending.push_back(damaged);
+    damaged = left;
+  }
+  int balance_node = hLRR - hR;
+  if (balance_node < -1 || balance_node > 1 ||
+      ((!left_right_right || !right) && !node->present.load())) {
+    if (damaged) pending.push_back(damaged);
+    damaged = node;
+  }
+  return defer(next, damaged, pending);
+}
+
+template <class T, class Compare>
+typename ConcurrentAVL<T, Compare>::TreeNode*
+ConcurrentAVL<T, Compare>::rotate_left_over_right(
+    TreeNode* parent, TreeNode* node, TreeNode* right, TreeNode* right_left,
+    std::vector<TreeNode*>& pending) {
+  std::uint64_t version = node->version.load();
+  std::uint64_t right_version = right->version.load();
+  TreeNode* parent_left = parent->left.load();
+  TreeNode* right_left_left = right_left->left.load();
+  TreeNode* right_left_right = right_left->right.load();
+
+  node->version.store(begin_change(version));
+  right->version.store(begin_change(right_version));
+
+  node->right.store(right_left_left);
+  if (right_left_left) right_left_left->parent.store(node);
+  right->left.store(right_left_right);
+  if (right_left_right) right_left_right->parent.store(right);
+  right_left->right.store(right);
+  right->parent.store(right_left);
+  right_left->left.store(node);
+  node->parent.store(right_left);
+  if (parent_left == node) {
+    parent->left.store(right_left);
+  } else {
+    parent->right.store(right_left);
+  }
+  right_left->parent.store(parent);
+
+  TreeNode* right_right = right->right.load();
+  TreeNode* left = node->left.load();
+  int hRR, hRLR, hRLL, hL, hRight, hN;
+  do {
+    hRR = height(right_right);
+    hRLR = height(right_left_right);
+    hRLL = height(right_left_left);
+    hL = height(left);
+    hN = 1 + std::max(hL, hRLL);
+    node->height.store(hN);
+    hRight = 1 + std::max(hRLR, hRR);
+    right->height.store(hRight);
+    right_left->height.store(1 + std::max(hN, hRight));
+  } while (hRR != height(right_right) || hRLR != height(right_left_right) ||
+           hRLL != height(right_left_left) || hL != height(left));
+
+  node->version.store(end_change(version));
+  right->version.store(end_change(right_version));
+
+  TreeNode* next = fix_height(parent);
+  TreeNode* damaged = nullptr;
+  int balance_top = hRight - hN;
+  if (balance_top < -1 || balance_top > 1) damaged = right_left;
+  int balance_right = hRR - hRLR;
+  if (balance_right < -1 || balance_right > 1 ||
+      ((!right_right || !right_left_right) && !right->present.load())) {
+    if (damaged) pending.push_back(damaged);
+    damaged = right;
+  }
+  int balance_node = hRLL - hL;
+  if (balance_node < -1 || balance_node > 1 ||
+      ((!right_left_left || !left) && !node->present.load())) {
+    if (damaged) pending.push_back(damaged);
+    damaged = node;
+  }
+  return defer(next, damaged, pending);
+}
+
+template <class T, class Compare>
+std::vector<T> ConcurrentAVL<T, Compare>::in_order() const {
+  std::vector<T> result;
+  std::vector<const TreeNode*> path;
+  const TreeNode* node = holder.right.load();
+  while (node || !path.empty()) {
+    for (; node; node = node->left.load()) path.push_back(node);
+    node = path.back();
+    path.pop_back();
+    if (node->present.load()) result.push_back(data_of(node));
+    node = node->right.load();
+  }
+  return result;
+}
+
+template <class T, class Compare>
+std::pair<bool, int> ConcurrentAVL<T, Compare>::check(
+    const TreeNode* node) const {
+  if (!node) return {true, 0};
+
+  auto left = check(node->left.load());
+  auto right = check(node->right.load());
+
+  int node_height = 1 + std::max(left.second, right.second);
+  bool valid = left.first && right.first &&
+               std::abs(left.second - right.second) <= 1 &&
+               node->height.load() == node_height;
+  return {valid, node_height};
+}
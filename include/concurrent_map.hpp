@@ -0,0 +1,213 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+#include "epoch.hpp"
+#include "persistent_avl.hpp"
+
+/**
+ * @brief Mapa associativo para uso concorrente, com leitores sem trava.
+ *
+ * Funciona como `ConcurrentSet`: a versão atual é uma `PersistentAVL` de
+ * pares publicada por um ponteiro atômico, escritores são serializados por
+ * um mutex e publicam versões novas, e as versões substituídas são
+ * liberadas por um `EpochDomain` quando nenhum leitor antigo as usa mais.
+ *
+ * Como um valor pode ser substituído a qualquer momento, as buscas não
+ * retornam referências: `find` retorna uma cópia e `visit` chama uma função
+ * com o valor enquanto a versão lida está protegida.
+ *
+ * @tparam K Tipo da chave. Deve suportar o operador '<'.
+ * @tparam V Tipo do valor (copiável).
+ * @tparam Alloc Alocador dos nós (thread-safe).
+ */
+template <class K, class V, class Alloc = std::allocator<std::pair<const K, V>>>
+class ConcurrentMap {
+ private:
+  /**
+   * @brief Par chave-valor armazenado na árvore.
+   */
+  struct Pair {
+    K key;    ///< A chave única.
+    V value;  ///< O valor associado.
+
+    template <class... Args>
+    explicit Pair(const K& k, Args&&... args)
+        : key(k), value(std::forward<Args>(args)...) {}
+  };
+
+  /**
+   * @brief Comparador transparente: compara pares pela chave e também um
+   * par com uma chave isolada.
+   */
+  struct KeyCompare {
+    using is_transparent = void;
+
+    bool operator()(const Pair& a, const Pair& b) const { return a.key < b.key; }
+
+    template <class Q>
+    bool operator()(const Pair& a, const Q& key) const {
+      return a.key < key;
+    }
+
+    template <class Q>
+    bool operator()(const Q& key, const Pair& b) const {
+      return key < b.key;
+    }
+  };
+
+  /// Versão imutável do mapa.
+  using Tree = PersistentAVL<Pair, KeyCompare, Alloc>;
+
+ public:
+  /**
+   * @brief Construtor padrão. Cria um mapa vazio.
+   */
+  ConcurrentMap() : current(new Tree()) {}
+
+  /**
+   * @brief Cria um mapa vazio que aloca seus nós com `alloc`.
+   */
+  explicit ConcurrentMap(const Alloc& alloc) : current(new Tree(alloc)) {}
+
+  ConcurrentMap(const ConcurrentMap&) = delete;
+  ConcurrentMap& operator=(const ConcurrentMap&) = delete;
+
+  /**
+   * @brief Destrutor. Não pode haver operações em andamento.
+   */
+  ~ConcurrentMap() { delete current.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Insere o par ou, se a chave já existir, substitui o valor.
+   *
+   * @return `true` se houve inserção, `false` se houve substituição.
+   */
+  template <class M>
+  bool insert_or_assign(const K& key, M&& value) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    const Tree* old = current.load(std::memory_order_relaxed);
+    bool inserted = !old->contain(key);
+    publish(old, old->insert_or_assign(Pair(key, std::forward<M>(value))));
+    return inserted;
+  }
+
+  /**
+   * @brief Insere um valor construído com `args` se a chave não existir.
+   *
+   * @return `true` se houve inserção, `false` se a chave já existia (nesse
+   * caso `args` não é usado).
+   */
+  template <class... Args>
+  bool try_emplace(const K& key, Args&&... args) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    const Tree* old = current.load(std::memory_order_relaxed);
+    if (old->contain(key)) return false;
+    publish(old, old->insert(Pair(key, std::forward<Args>(args)...)));
+    return true;
+  }
+
+  /**
+   * @brief Remove a chave e o valor associado.
+   *
+   * @return `true` se a chave existia.
+   */
+  template <class Q>
+  bool remove(const Q& key) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    const Tree* old = current.load(std::memory_order_relaxed);
+    Tree next = old->remove(key);
+    if (next.size() == old->size()) return false;
+    publish(old, std::move(next));
+    return true;
+  }
+
+  /**
+   * @brief Verifica se a chave existe. Não usa travas.
+   */
+  template <class Q>
+  bool contain(const Q& key) const {
+    EpochDomain::Guard guard(domain);
+    return load().contain(key);
+  }
+
+  /**
+   * @brief Retorna uma cópia do valor associado à chave. Não usa travas.
+   *
+   * @return O valor, ou `std::nullopt` se a chave não existir.
+   */
+  template <class Q>
+  std::optional<V> find(const Q& key) const {
+    EpochDomain::Guard guard(domain);
+    const Pair* found = load().search(key);
+    if (!found) return std::nullopt;
+    return found->value;
+  }
+
+  /**
+   * @brief Chama `fn(value)` com o valor associado à chave, sem copiá-lo.
+   *
+   * O valor só pode ser usado dentro de `fn`.
+   *
+   * @return `true` se a chave existia (e `fn` foi chamada).
+   */
+  template <class Q, class F>
+  bool visit(const Q& key, F&& fn) const {
+    EpochDomain::Guard guard(domain);
+    const Pair* found = load().search(key);
+    if (!found) return false;
+    fn(static_cast<const V&>(found->value));
+    return true;
+  }
+
+  /**
+   * @brief Chama `fn(key, value)` para cada par da versão atual, em ordem
+   * crescente de chave.
+   *
+   * Toda a travessia vê a mesma versão, mesmo com escritas simultâneas.
+   */
+  template <class F>
+  void for_each(F&& fn) const {
+    EpochDomain::Guard guard(domain);
+    for (const Pair& pair : load()) {
+      fn(static_cast<const K&>(pair.key), static_cast<const V&>(pair.value));
+    }
+  }
+
+  /**
+   * @brief Quantidade de pares na versão atual.
+   */
+  std::size_t size() const {
+    EpochDomain::Guard guard(domain);
+    return load().size();
+  }
+
+  /**
+   * @brief Verifica se o mapa está vazio.
+   */
+  bool empty() const { return size() == 0; }
+
+ private:
+  /**
+   * @brief Versão atual. Só pode ser usada sob um `Guard` (ou pelo
+   * escritor, sob `write_mutex`).
+   */
+  const Tree& load() const { return *current.load(std::memory_order_seq_cst); }
+
+  /**
+   * @brief Publica `next` no lugar de `old` e retira `old`. Requer
+   * `write_mutex`.
+   */
+  void publish(const Tree* old, Tree next) {
+    current.store(new Tree(std::move(next)), std::memory_order_seq_cst);
+    domain.retire(const_cast<Tree*>(old));
+  }
+
+  mutable EpochDomain domain;        ///< Adia a liberação das versões.
+  std::atomic<const Tree*> current;  ///< Versão publicada.
+  std::mutex write_mutex;            ///< Serializa os escritores.
+};
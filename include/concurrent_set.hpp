@@ -0,0 +1,173 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "epoch.hpp"
+#include "persistent_avl.hpp"
+
+/**
+ * @brief Conjunto para uso concorrente, com leitores sem trava.
+ *
+ * A versão atual do conjunto é uma `PersistentAVL` publicada por um ponteiro
+ * atômico. Leitores carregam o ponteiro e percorrem a árvore sem travas e
+ * sem escrever em nada compartilhado além do seu slot de época. Escritores
+ * são serializados por um mutex: cada um cria uma nova versão (copiando só
+ * o caminho alterado) e a publica com uma única troca de ponteiro, então um
+ * leitor nunca vê uma árvore pela metade.
+ *
+ * A versão substituída não é liberada na hora, pois leitores podem estar
+ * percorrendo-a: ela é entregue a um `EpochDomain`, que a libera quando
+ * nenhum leitor antigo continua ativo. Os nós que ela compartilha com a
+ * versão nova continuam vivos; só os que ficaram sem uso são liberados.
+ *
+ * @tparam T Tipo dos elementos (copiável).
+ * @tparam Compare Comparador; se for transparente, as buscas aceitam
+ * qualquer tipo comparável com `T`.
+ * @tparam Alloc Alocador dos nós. Precisa ser thread-safe, pois versões
+ * podem ser liberadas fora da thread que as criou.
+ */
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
+class ConcurrentSet {
+ public:
+  /// Versão imutável do conjunto, obtida por `snapshot`.
+  using Snapshot = PersistentAVL<T, Compare, Alloc>;
+
+  /**
+   * @brief Construtor padrão. Cria um conjunto vazio.
+   */
+  ConcurrentSet() : current(new Snapshot()) {}
+
+  /**
+   * @brief Cria um conjunto vazio que aloca seus nós com `alloc`.
+   */
+  explicit ConcurrentSet(const Alloc& alloc) : current(new Snapshot(alloc)) {}
+
+  ConcurrentSet(const ConcurrentSet&) = delete;
+  ConcurrentSet& operator=(const ConcurrentSet&) = delete;
+
+  /**
+   * @brief Destrutor. Não pode haver operações em andamento.
+   */
+  ~ConcurrentSet() { delete current.load(std::memory_order_relaxed); }
+
+  /**
+   * @brief Insere um elemento.
+   *
+   * @return `true` se o elemento foi inserido, `false` se já existia.
+   */
+  bool insert(const T& value) {
+    return update([&](const Snapshot& tree) { return tree.insert(value); });
+  }
+
+  /**
+   * @brief Remove um elemento.
+   *
+   * @return `true` se o elemento foi removido, `false` se não existia.
+   */
+  bool remove(const T& value) {
+    return update([&](const Snapshot& tree) { return tree.remove(value); });
+  }
+
+  /**
+   * @brief `remove` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool remove(const Key& key) {
+    return update([&](const Snapshot& tree) { return tree.remove(key); });
+  }
+
+  /**
+   * @brief Verifica se o conjunto contém um elemento. Não usa travas.
+   */
+  bool contain(const T& value) const {
+    EpochDomain::Guard guard(domain);
+    return load().contain(value);
+  }
+
+  /**
+   * @brief `contain` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    EpochDomain::Guard guard(domain);
+    return load().contain(key);
+  }
+
+  /**
+   * @brief Sinônimo de `contain`, como em `Set`.
+   */
+  bool search(const T& value) const { return contain(value); }
+
+  /**
+   * @brief Quantidade de elementos na versão atual.
+   */
+  std::size_t size() const {
+    EpochDomain::Guard guard(domain);
+    return load().size();
+  }
+
+  /**
+   * @brief Verifica se o conjunto está vazio.
+   */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * @brief Retorna a versão atual, em O(1).
+   *
+   * O snapshot é independente do conjunto: pode ser percorrido à vontade e
+   * não muda com escritas posteriores.
+   */
+  Snapshot snapshot() const {
+    EpochDomain::Guard guard(domain);
+    return load();
+  }
+
+  /**
+   * @brief Chama `fn` para cada elemento da versão atual, em ordem.
+   *
+   * Toda a travessia vê a mesma versão, mesmo com escritas simultâneas.
+   *
+   * @return `false` se `fn` interrompeu a travessia.
+   */
+  template <class F>
+  bool for_each_in_order(F&& fn) const {
+    EpochDomain::Guard guard(domain);
+    return load().for_each_in_order(std::forward<F>(fn));
+  }
+
+ private:
+  /**
+   * @brief Versão atual. Só pode ser usada sob um `Guard` (ou pelo
+   * escritor, sob `write_mutex`).
+   */
+  const Snapshot& load() const {
+    return *current.load(std::memory_order_seq_cst);
+  }
+
+  /**
+   * @brief Cria uma versão nova com `change` e a publica, se ela diferir da
+   * atual.
+   *
+   * @param change Função que recebe a versão atual e retorna a nova.
+   * @return `true` se o conjunto mudou.
+   */
+  template <class Change>
+  bool update(Change&& change) {
+    std::lock_guard<std::mutex> lock(write_mutex);
+    const Snapshot* old = current.load(std::memory_order_relaxed);
+    Snapshot next = change(*old);
+    if (next.size() == old->size()) return false;
+    current.store(new Snapshot(std::move(next)), std::memory_order_seq_cst);
+    domain.retire(const_cast<Snapshot*>(old));
+    return true;
+  }
+
+  mutable EpochDomain domain;            ///< Adia a liberação das versões.
+  std::atomic<const Snapshot*> current;  ///< Versão publicada.
+  std::mutex write_mutex;                ///< Serializa os escritores.
+};
@@ -0,0 +1,271 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+/**
+ * @brief Recuperação de memória baseada em épocas (epoch-based reclamation).
+ *
+ * Estruturas com leitores sem trava não podem liberar um objeto assim que o
+ * desligam: um leitor pode ter lido o ponteiro antes e ainda estar usando o
+ * objeto. Com o domínio de épocas, o leitor protege a leitura com um
+ * `Guard`, e quem desliga o objeto o entrega a `retire` em vez de liberá-lo.
+ *
+ * Existe uma época global. Um `Guard` anuncia, em um slot próprio, a época
+ * em que o leitor entrou. A época só avança de `e` para `e + 1` quando todos
+ * os leitores ativos anunciaram `e`; um objeto retirado na época `r` é
+ * liberado quando a época chega a `r + 2`, momento em que nenhum leitor que
+ * poderia tê-lo visto continua ativo.
+ *
+ * Cada thread tem um slot próprio em cada domínio, registrado na primeira
+ * vez que ela entra nele e devolvido quando ela termina. Depois disso,
+ * entrar e sair de um `Guard` custa um store atômico no slot, sem laço de
+ * espera: os leitores são wait-free, qualquer que seja o número de threads.
+ * Só o registro (uma vez por thread e domínio) pode repetir um CAS. `Guard`s
+ * aninhados na mesma thread reaproveitam o anúncio do mais externo.
+ * `retire` é serializado por um mutex interno.
+ */
+class EpochDomain {
+  struct Slot;
+
+ public:
+  /**
+   * @brief Protege as leituras feitas durante a sua vida: nada retirado
+   * depois da sua criação é liberado antes da sua destruição.
+   */
+  class Guard {
+   public:
+    explicit Guard(EpochDomain& domain) : slot(domain.pin()) {}
+    ~Guard() {
+      if (--slot->depth == 0) slot->state.store(0, std::memory_order_release);
+    }
+
+    Guard(const Guard&) = delete;
+    Guard& operator=(const Guard&) = delete;
+
+   private:
+    Slot* slot;  ///< Slot em que a época do leitor foi anunciada.
+  };
+
+  EpochDomain()
+      : registry(std::make_shared<Registry>()),
+        epoch(0),
+        retired_since_advance(0) {}
+
+  EpochDomain(const EpochDomain&) = delete;
+  EpochDomain& operator=(const EpochDomain&) = delete;
+
+  /**
+   * @brief Destrutor, libera tudo que ainda aguarda.
+   *
+   * Não pode haver `Guard`s ativos deste domínio. Os slots continuam vivos
+   * até que as threads que os registraram os descartem.
+   */
+  ~EpochDomain() {
+    registry->closed.store(true, std::memory_order_release);
+    for (std::vector<Retired>& bucket : limbo) free_all(bucket);
+  }
+
+  /**
+   * @brief Agenda a liberação (com `delete`) de um objeto já desligado da
+   * estrutura.
+   *
+   * @param object Objeto que nenhum leitor novo consegue alcançar.
+   */
+  template <class T>
+  void retire(T* object) {
+    retire(object, [](void* p) { delete static_cast<T*>(p); });
+  }
+
+  /**
+   * @brief Agenda a liberação de um objeto com uma função própria.
+   *
+   * A cada `collect_threshold` objetos retirados, tenta avançar a época e
+   * liberar os que já não podem ser vistos.
+   */
+  void retire(void* object, void (*deleter)(void*)) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::uint64_t current = epoch.load(std::memory_order_seq_cst);
+    limbo[current % 3].push_back(Retired{object, deleter});
+    if (++retired_since_advance >= collect_threshold) {
+      retired_since_advance = 0;
+      try_advance();
+    }
+  }
+
+  /**
+   * @brief Tenta liberar tudo que foi retirado até agora.
+   *
+   * Sem leitores ativos, a época avança duas vezes e todos os objetos são
+   * liberados.
+   */
+  void collect() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (try_advance()) try_advance();
+  }
+
+  /**
+   * @brief Quantidade de objetos retirados que ainda não foram liberados.
+   */
+  std::size_t pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return limbo[0].size() + limbo[1].size() + limbo[2].size();
+  }
+
+ private:
+  /**
+   * @brief Objeto retirado e a função que o libera.
+   */
+  struct Retired {
+    void* object;
+    void (*deleter)(void*);
+  };
+
+  /**
+   * @brief Época anunciada por um leitor, em uma linha de cache própria.
+   */
+  struct alignas(64) Slot {
+    /// 0 se livre; senão, a época anunciada mais 1.
+    std::atomic<std::uint64_t> state{0};
+    /// Se alguma thread ocupa o slot.
+    std::atomic<bool> owned{true};
+    /// `Guard`s ativos da thread dona; só ela lê e escreve.
+    std::size_t depth = 0;
+    /// Próximo slot do domínio; fixo depois da publicação.
+    Slot* next = nullptr;
+  };
+
+  /**
+   * @brief Lista de slots de um domínio, compartilhada com as threads que
+   * os ocupam para que sobreviva ao domínio enquanto elas existirem.
+   */
+  struct Registry {
+    std::atomic<Slot*> head{nullptr};  ///< Slots, do mais novo ao mais antigo.
+    std::atomic<bool> closed{false};   ///< O domínio já foi destruído.
+
+    Registry() = default;
+    Registry(const Registry&) = delete;
+    Registry& operator=(const Registry&) = delete;
+
+    ~Registry() {
+      Slot* slot = head.load(std::memory_order_relaxed);
+      while (slot) {
+        Slot* next = slot->next;
+        delete slot;
+        slot = next;
+      }
+    }
+  };
+
+  /**
+   * @brief Slots ocupados por uma thread, um por domínio; devolvidos quando
+   * a thread termina.
+   */
+  struct ThreadSlots {
+    struct Entry {
+      std::shared_ptr<Registry> registry;
+      Slot* slot;
+    };
+    std::vector<Entry> entries;
+
+    ~ThreadSlots() {
+      for (const Entry& entry : entries) {
+        entry.slot->owned.store(false, std::memory_order_release);
+      }
+    }
+  };
+
+  /// Retiradas entre tentativas automáticas de avançar a época.
+  static constexpr std::size_t collect_threshold = 64;
+
+  /**
+   * @brief Anuncia a época atual no slot da thread (se não houver outro
+   * `Guard` ativo nela).
+   */
+  Slot* pin() {
+    Slot* slot = local_slot();
+    if (slot->depth++ == 0) {
+      std::uint64_t current = epoch.load(std::memory_order_seq_cst);
+      // seq_cst: o anúncio precede, na ordem total, as leituras protegidas
+      slot->state.store(current + 1, std::memory_order_seq_cst);
+    }
+    return slot;
+  }
+
+  /**
+   * @brief Slot desta thread neste domínio, registrado no primeiro uso.
+   */
+  Slot* local_slot() {
+    thread_local ThreadSlots local;
+    for (const ThreadSlots::Entry& entry : local.entries) {
+      if (entry.registry == registry) return entry.slot;
+    }
+
+    // Primeiro uso: descarta os slots de domínios já destruídos e reserva
+    // espaço antes de ocupar um slot, para não perdê-lo numa exceção
+    std::vector<ThreadSlots::Entry>& entries = local.entries;
+    entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                 [](const ThreadSlots::Entry& entry) {
+                                   return entry.registry->closed.load(
+                                       std::memory_order_acquire);
+                                 }),
+                  entries.end());
+    entries.reserve(entries.size() + 1);
+
+    Slot* slot = nullptr;
+    for (Slot* s = registry->head.load(std::memory_order_seq_cst); s;
+         s = s->next) {
+      bool expected = false;
+      if (s->owned.compare_exchange_strong(expected, true,
+                                           std::memory_order_acq_rel)) {
+        slot = s;
+        break;
+      }
+    }
+    if (!slot) {
+      slot = new Slot;
+      slot->next = registry->head.load(std::memory_order_relaxed);
+      // seq_cst: `try_advance` enxerga o slot antes do primeiro anúncio dele
+      while (!registry->head.compare_exchange_weak(
+          slot->next, slot, std::memory_order_seq_cst,
+          std::memory_order_relaxed)) {
+      }
+    }
+    entries.push_back(ThreadSlots::Entry{registry, slot});
+    return slot;
+  }
+
+  /**
+   * @brief Avança a época se todos os leitores ativos já estão nela, e
+   * libera os objetos retirados duas épocas atrás. Requer `mutex`.
+   *
+   * @return `true` se a época avançou.
+   */
+  bool try_advance() {
+    std::uint64_t current = epoch.load(std::memory_order_relaxed);
+    for (const Slot* slot = registry->head.load(std::memory_order_seq_cst);
+         slot; slot = slot->next) {
+      std::uint64_t state = slot->state.load(std::memory_order_seq_cst);
+      if (state != 0 && state != current + 1) return false;
+    }
+    epoch.store(current + 1, std::memory_order_seq_cst);
+    // Retirados na época `current - 1`; o balde será reusado em `current + 2`
+    free_all(limbo[(current + 2) % 3]);
+    return true;
+  }
+
+  static void free_all(std::vector<Retired>& bucket) {
+    for (const Retired& retired : bucket) retired.deleter(retired.object);
+    bucket.clear();
+  }
+
+  std::shared_ptr<Registry> registry;      ///< Slots dos leitores.
+  std::atomic<std::uint64_t> epoch;        ///< Época global.
+  mutable std::mutex mutex;                ///< Serializa retiradas e avanços.
+  std::vector<Retired> limbo[3];           ///< Retirados, por época mod 3.
+  std::size_t retired_since_advance;       ///< Retiradas desde o último avanço.
+};
@@ -0,0 +1,244 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Pool de threads para paralelismo fork-join com roubo de tarefas.
+ *
+ * Cada thread do pool tem uma fila própria. `fork_join(f, g)` publica `g`
+ * na fila da thread atual, executa `f` e depois retoma `g` se nenhuma outra
+ * thread a tiver roubado. Threads ociosas roubam as tarefas mais antigas
+ * (as maiores, em algoritmos de divisão e conquista) do início das filas
+ * das outras. Quem espera por uma tarefa roubada ajuda executando outras
+ * tarefas em vez de bloquear, então chamadas aninhadas não causam deadlock.
+ *
+ * A thread que chama `fork_join` de fora do pool também participa do
+ * trabalho, usando uma fila compartilhada.
+ */
+class ForkJoinPool {
+ public:
+  /**
+   * @brief Cria o pool.
+   *
+   * @param threads Quantidade total de threads que executam tarefas,
+   * incluindo a que chama `fork_join` (então `threads - 1` threads são
+   * criadas). Com 0 ou 1 tudo roda na thread que chama.
+   */
+  explicit ForkJoinPool(
+      unsigned threads = std::max(1u, std::thread::hardware_concurrency()))
+      : stopping(false), pending(0), sleeping(0) {
+    unsigned workers = threads > 1 ? threads - 1 : 0;
+    // Uma fila por thread do pool, mais a fila compartilhada (a última)
+    for (unsigned i = 0; i <= workers; ++i) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < workers; ++i) {
+      threads_.emplace_back([this, i] { work(i); });
+    }
+  }
+
+  ForkJoinPool(const ForkJoinPool&) = delete;
+  ForkJoinPool& operator=(const ForkJoinPool&) = delete;
+
+  /**
+   * @brief Destrutor, espera as threads terminarem.
+   *
+   * Não deve ser chamado enquanto houver um `fork_join` em andamento.
+   */
+  ~ForkJoinPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex);
+      stopping = true;
+    }
+    sleep_cv.notify_all();
+    for (std::thread& thread : threads_) thread.join();
+  }
+
+  /**
+   * @brief Quantidade total de threads que executam tarefas.
+   */
+  std::size_t size() const { return threads_.size() + 1; }
+
+  /**
+   * @brief Executa `f()` e `g()`, possivelmente em paralelo, e espera as duas.
+   *
+   * Se `f` ou `g` lançar uma exceção, ela é propagada depois que as duas
+   * terminarem (a de `f` tem prioridade).
+   *
+   * @param f Função executada na thread atual.
+   * @param g Função que pode ser roubada por outra thread.
+   */
+  template <class F, class G>
+  void fork_join(F&& f, G&& g) {
+    Queue& queue = local_queue();
+    Task task(&invoke<std::remove_reference_t<G>>, &g);
+    push(queue, &task);
+
+    std::exception_ptr error;
+    try {
+      f();
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    if (take(queue, &task)) {
+      // Ninguém roubou `g`: executa aqui mesmo
+      task.run();
+    } else {
+      while (!task.done.load(std::memory_order_acquire)) {
+        if (!run_one(queue)) std::this_thread::yield();
+      }
+    }
+    if (error) std::rethrow_exception(error);
+    if (task.error) std::rethrow_exception(task.error);
+  }
+
+ private:
+  /**
+   * @brief Tarefa publicada por `fork_join`, alocada na pilha de quem a
+   * publicou.
+   */
+  struct Task {
+    Task(void (*invoke)(void*), void* fn) : invoke(invoke), fn(fn) {}
+
+    void run() {
+      try {
+        invoke(fn);
+      } catch (...) {
+        error = std::current_exception();
+      }
+      done.store(true, std::memory_order_release);
+    }
+
+    void (*invoke)(void*);             ///< Chama a função apontada por `fn`.
+    void* fn;                          ///< Função a executar.
+    std::exception_ptr error;          ///< Exceção lançada pela função.
+    std::atomic<bool> done{false};     ///< A função terminou.
+  };
+
+  /**
+   * @brief Fila de tarefas de uma thread.
+   */
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task*> tasks;
+  };
+
+  /**
+   * @brief Identifica a thread atual: pool a que pertence e sua fila.
+   */
+  struct Slot {
+    const ForkJoinPool* pool = nullptr;
+    std::size_t index = 0;
+  };
+
+  static Slot& current() {
+    thread_local Slot slot;
+    return slot;
+  }
+
+  template <class G>
+  static void invoke(void* fn) {
+    (*static_cast<G*>(fn))();
+  }
+
+  /**
+   * @brief Fila da thread atual (a compartilhada, para threads de fora).
+   */
+  Queue& local_queue() {
+    const Slot& slot = current();
+    return slot.pool == this ? *queues[slot.index] : *queues.back();
+  }
+
+  void push(Queue& queue, Task* task) {
+    {
+      std::lock_guard<std::mutex> lock(queue.mutex);
+      queue.tasks.push_back(task);
+    }
+    // seq_cst em `pending` e `sleeping` (aqui e em `work`) impede que a
+    // tarefa seja publicada enquanto a thread decide dormir sem vê-la
+    pending.fetch_add(1);
+    if (sleeping.load() > 0) {
+      { std::lock_guard<std::mutex> lock(sleep_mutex); }
+      sleep_cv.notify_one();
+    }
+  }
+
+  /**
+   * @brief Retira `task` da fila, se ela ainda não tiver sido roubada.
+   */
+  bool take(Queue& queue, Task* task) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    auto it = std::find(queue.tasks.rbegin(), queue.tasks.rend(), task);
+    if (it == queue.tasks.rend()) return false;
+    queue.tasks.erase(std::next(it).base());
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+  }
+
+  /**
+   * @brief Executa uma tarefa: a mais recente da própria fila ou, se ela
+   * estiver vazia, a mais antiga de outra fila.
+   *
+   * @return `false` se não havia tarefa em nenhuma fila.
+   */
+  bool run_one(Queue& own) {
+    Task* task = nullptr;
+    {
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.tasks.empty()) {
+        task = own.tasks.back();
+        own.tasks.pop_back();
+      }
+    }
+    for (std::size_t i = 0; !task && i < queues.size(); ++i) {
+      Queue& victim = *queues[i];
+      if (&victim == &own) continue;
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.tasks.empty()) {
+        task = victim.tasks.front();
+        victim.tasks.pop_front();
+      }
+    }
+    if (!task) return false;
+    pending.fetch_sub(1, std::memory_order_relaxed);
+    task->run();
+    return true;
+  }
+
+  /**
+   * @brief Laço de uma thread do pool.
+   */
+  void work(std::size_t index) {
+    current() = Slot{this, index};
+    Queue& own = *queues[index];
+    while (true) {
+      if (run_one(own)) continue;
+      std::unique_lock<std::mutex> lock(sleep_mutex);
+      sleeping.fetch_add(1);
+      sleep_cv.wait(lock, [this] {
+        return stopping || pending.load() > 0;
+      });
+      sleeping.fetch_sub(1);
+      if (stopping) return;
+    }
+  }
+
+  std::vector<std::unique_ptr<Queue>> queues;  ///< Filas das threads.
+  std::vector<std::thread> threads_;           ///< Threads do pool.
+  std::mutex sleep_mutex;                      ///< Protege o sono das threads.
+  std::condition_variable sleep_cv;            ///< Acorda threads ociosas.
+  bool stopping;                               ///< O pool está sendo destruído.
+  std::atomic<std::size_t> pending;            ///< Tarefas nas filas.
+  std::atomic<int> sleeping;                   ///< Threads dormindo.
+};
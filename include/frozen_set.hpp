@@ -0,0 +1,181 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Conjunto imutável e compacto, criado por `Set::freeze()`.
+ *
+ * Os elementos ficam num único vetor em layout de Eytzinger: a ordem de uma
+ * busca em largura (BFS) da árvore binária de busca completa, com a raiz na
+ * posição 1 e os filhos de `k` em `2k` e `2k + 1`. Os primeiros níveis, que
+ * toda busca visita, ficam juntos no começo do vetor, e os descendentes de
+ * `k` a `d` níveis de distância são contíguos (de `k * 2^d` a
+ * `k * 2^d + 2^d - 1`).
+ *
+ * A busca não tem desvios que dependem dos dados: cada passo só escolhe o
+ * filho por aritmética. Em vez de esperar a memória a cada nível, ela pede
+ * (prefetch) a linha de cache com os descendentes alguns níveis abaixo, de
+ * modo que várias faltas de cache fiquem em andamento ao mesmo tempo.
+ *
+ * @tparam T Tipo dos elementos.
+ * @tparam Compare Comparador que define a ordem dos elementos.
+ */
+template <class T, class Compare = std::less<T>>
+class FrozenSet {
+ public:
+  /**
+   * @brief Cria um conjunto vazio.
+   */
+  FrozenSet() = default;
+
+  /**
+   * @brief Cria o conjunto a partir de valores em ordem crescente e sem
+   * repetições, como os de um `Set`.
+   *
+   * @param first Início da sequência ordenada.
+   * @param last Fim da sequência ordenada.
+   */
+  template <class InputIt>
+  FrozenSet(InputIt first, InputIt last);
+
+  /**
+   * @brief Verifica se um valor está presente, em O(log n).
+   */
+  bool search(const T& value) const {
+    std::size_t k = lower_index(value);
+    return k != 0 && !comp(value, values[k]);
+  }
+
+  /**
+   * @brief Menor elemento maior ou igual a `value`.
+   *
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* lower_bound(const T& value) const {
+    std::size_t k = lower_index(value);
+    return k != 0 ? &values[k] : nullptr;
+  }
+
+  /**
+   * @brief Quantidade de elementos.
+   */
+  std::size_t size() const { return count; }
+
+  /**
+   * @brief Verifica se o conjunto está vazio.
+   */
+  bool empty() const { return count == 0; }
+
+ private:
+  /**
+   * @brief Alocador que alinha o vetor a uma linha de cache, para que os
+   * descendentes pedidos por prefetch caiam numa única linha.
+   */
+  template <class U>
+  struct CacheLineAllocator {
+    using value_type = U;
+
+    CacheLineAllocator() = default;
+    template <class V>
+    CacheLineAllocator(const CacheLineAllocator<V>&) {}
+
+    U* allocate(std::size_t n) {
+      return static_cast<U*>(
+          ::operator new(n * sizeof(U), std::align_val_t(64)));
+    }
+    void deallocate(U* p, std::size_t) {
+      ::operator delete(p, std::align_val_t(64));
+    }
+
+    template <class V>
+    bool operator==(const CacheLineAllocator<V>&) const {
+      return true;
+    }
+    template <class V>
+    bool operator!=(const CacheLineAllocator<V>&) const {
+      return false;
+    }
+  };
+
+  /// Níveis de antecedência do prefetch: os descendentes de `k` nesse
+  /// nível ocupam uma linha de cache inteira (16 para 4 bytes, 8 para 8).
+  static constexpr unsigned prefetch_levels =
+      sizeof(T) >= 32 ? 1 : sizeof(T) >= 16 ? 2 : sizeof(T) >= 8 ? 3 : 4;
+
+  /**
+   * @brief Posição, no vetor, do primeiro elemento que não é menor que
+   * `value`, ou 0 se não houver.
+   *
+   * Desce sempre até passar das folhas; cada passo à direita acrescenta um
+   * bit 1 a `k`. No fim, o último passo à esquerda (o último bit 0) marca o
+   * ancestral procurado, que é recuperado descartando os bits 1 finais e
+   * mais um.
+   */
+  std::size_t lower_index(const T& value) const;
+
+  /**
+   * @brief Preenche as posições da subárvore de `k` com os próximos
+   * elementos em ordem.
+   */
+  void place(std::vector<std::size_t>& order, std::size_t& next,
+             std::size_t k) const;
+
+  /// Elementos em layout de Eytzinger; a posição 0 só completa o vetor.
+  std::vector<T, CacheLineAllocator<T>> values;
+  std::size_t count = 0;  ///< Quantidade de elementos.
+  Compare comp;           ///< Ordem dos elementos.
+};
+
+template <class T, class Compare>
+template <class InputIt>
+FrozenSet<T, Compare>::FrozenSet(InputIt first, InputIt last) {
+  std::vector<T> sorted(first, last);
+  count = sorted.size();
+  if (count == 0) return;
+
+  // order[k] = posição em `sorted` do elemento que fica na posição k
+  std::vector<std::size_t> order(count + 1);
+  std::size_t next = 0;
+  place(order, next, 1);
+  values.reserve(count + 1);
+  values.push_back(sorted[0]);
+  for (std::size_t k = 1; k <= count; ++k) {
+    values.push_back(std::move(sorted[order[k]]));
+  }
+}
+
+template <class T, class Compare>
+void FrozenSet<T, Compare>::place(std::vector<std::size_t>& order,
+                                  std::size_t& next, std::size_t k) const {
+  if (k > count) return;
+  place(order, next, 2 * k);
+  order[k] = next++;
+  place(order, next, 2 * k + 1);
+}
+
+template <class T, class Compare>
+std::size_t FrozenSet<T, Compare>::lower_index(const T& value) const {
+  const T* base = values.data();
+  std::size_t k = 1;
+  while (k <= count) {
+#if defined(__GNUC__)
+    // Só o endereço é calculado (como inteiro, pois pode passar do fim do
+    // vetor): o prefetch não falha nem altera nada
+    __builtin_prefetch(reinterpret_cast<const void*>(
+        reinterpret_cast<std::uintptr_t>(base) +
+        (k << prefetch_levels) * sizeof(T)));
+#endif
+    k = 2 * k + static_cast<std::size_t>(comp(base[k], value));
+  }
+  // Descarta os passos à direita finais e o último passo à esquerda
+#if defined(__GNUC__)
+  return k >> __builtin_ffsll(static_cast<long long>(~k));
+#else
+  while (k & 1) k >>= 1;
+  return k >> 1;
+#endif
+}
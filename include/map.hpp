@@ -1,16 +1,39 @@
 #pragma once
+#include "avl.hpp"
 #include "bst.hpp"
+#include "btree.hpp"
+#include <cstddef>
+#include <iterator>
+#include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
 /**
  * @brief Classe que representa um Mapa Associativo (Map).
  *
  * Armazena pares chave-valor, onde cada chave é única. A ordenação e
  * busca são garantidas pelo uso de uma Árvore Binária.
  *
+ * A árvore usada como backend é escolhida pelo parâmetro `Tree`. Por padrão
+ * é uma AVL, que se mantém balanceada mesmo quando as chaves chegam em ordem
+ * crescente (timestamps, IDs sequenciais), garantindo O(log n) por operação.
+ * `Map<K, V, BST>` continua disponível, mas degenera para O(n) nesse caso.
+ * `Map<K, V, BTree>` guarda vários pares por nó e faz menos acessos à
+ * memória em mapas grandes, mas invalida iteradores e referências aos
+ * valores a cada inserção ou remoção, e não oferece `rank`, `nth` e
+ * `count_range`.
+ *
  * @tparam K Tipo da chave. Deve suportar o operadores de comparação '<'.
  * @tparam V Tipo do valor associado à chave.
+ * @tparam Tree Template da árvore de busca que armazena os pares. Recebe o
+ * tipo do elemento e um comparador transparente, e deve oferecer
+ * `try_emplace`, `remove`, `contain` e `search` como `BST` e `AVL`.
+ * @tparam Alloc Alocador repassado à árvore (que faz rebind para o tipo do
+ * nó), por exemplo `PoolAllocator`.
  */
-template <class K, class V>
+template <class K, class V, template <class...> class Tree = AVL,
+          class Alloc = std::allocator<std::pair<const K, V>>>
 class Map {
  private:
   /**
@@ -24,9 +47,23 @@ class Map {
 
     /**
      * @brief Construtor do Pair com uma chave.
+     *
+     * O valor é construído no próprio lugar a partir de `args` (ou pelo
+     * construtor padrão de `V`, se `args` for vazio).
+     *
      * @param k A chave.
+     * @param args Argumentos repassados ao construtor de `V`.
      */
-    explicit Pair(const K& k) : key(k), value() {}
+    template <class... Args>
+    explicit Pair(const K& k, Args&&... args)
+        : key(k), value(std::forward<Args>(args)...) {}
+
+    /**
+     * @brief Construtor do Pair que move a chave.
+     */
+    template <class... Args>
+    explicit Pair(K&& k, Args&&... args)
+        : key(std::move(k)), value(std::forward<Args>(args)...) {}
 
     /**
      * @brief Operador de comparação 'menor que'.
@@ -44,13 +81,173 @@ class Map {
     }
   };
 
+  /**
+   * @brief Comparador transparente usado pela árvore interna.
+   *
+   * Compara Pairs entre si e também um Pair com uma chave isolada (`K` ou
+   * qualquer tipo comparável com `K`, como `std::string_view` para chaves
+   * `std::string`). Assim as buscas não constroem um Pair temporário, nem
+   * portanto um `V`.
+   */
+  struct KeyCompare {
+    using is_transparent = void;
+
+    /// Extrator da chave: a `BTree` o usa para guardar as chaves inteiras
+    /// de cada nó em um vetor contíguo e buscá-las com instruções vetoriais.
+    using key_type = K;
+    static const K& key(const Pair& p) { return p.key; }
+
+    bool operator()(const Pair& a, const Pair& b) const { return a < b; }
+
+    /// Ordena chaves entre si (usado para ordenar os lotes de `apply_batch`).
+    bool operator()(const K& a, const K& b) const { return a < b; }
+
+    template <class Q>
+    bool operator()(const Pair& a, const Q& key) const {
+      return a.key < key;
+    }
+
+    template <class Q>
+    bool operator()(const Q& key, const Pair& b) const {
+      return key < b.key;
+    }
+  };
+
+  /// Árvore que armazena os pares.
+  using TreeType = Tree<Pair, KeyCompare, Alloc>;
+
+  /**
+   * @brief Iterador bidirecional sobre os pares, em ordem crescente de chave.
+   *
+   * A desreferência produz um `std::pair<const K&, V&>` (ou
+   * `std::pair<const K&, const V&>` no iterador constante): a chave não pode
+   * ser alterada, o valor sim. Funciona com structured bindings
+   * (`for (auto [key, value] : map)`).
+   *
+   * @tparam Const `true` para o iterador constante.
+   */
+  template <bool Const>
+  class basic_iterator {
+    using ValueRef = std::conditional_t<Const, const V&, V&>;
+
+   public:
+    using iterator_category = std::bidirectional_iterator_tag;
+    using value_type = std::pair<const K, V>;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::pair<const K&, ValueRef>;
+
+    /**
+     * @brief Resultado de `operator->`: guarda o par de referências.
+     */
+    struct pointer {
+      reference ref;
+      const reference* operator->() const { return &ref; }
+    };
+
+    basic_iterator() = default;
+
+    /**
+     * @brief Conversão de `iterator` para `const_iterator`.
+     */
+    template <bool C = Const, class = std::enable_if_t<C>>
+    basic_iterator(const basic_iterator<false>& other) : it(other.it) {}
+
+    reference operator*() const {
+      const Pair& pair = *it;
+      // Os nós não são objetos constantes: só a chave precisa ser protegida
+      return {pair.key, const_cast<V&>(pair.value)};
+    }
+    pointer operator->() const { return pointer{**this}; }
+
+    basic_iterator& operator++() {
+      ++it;
+      return *this;
+    }
+    basic_iterator& operator--() {
+      --it;
+      return *this;
+    }
+    basic_iterator operator++(int) { return basic_iterator(it++); }
+    basic_iterator operator--(int) { return basic_iterator(it--); }
+
+    bool operator==(const basic_iterator& other) const {
+      return it == other.it;
+    }
+    bool operator!=(const basic_iterator& other) const {
+      return it != other.it;
+    }
+
+   private:
+    friend class Map;
+    template <bool>
+    friend class basic_iterator;
+
+    explicit basic_iterator(typename TreeType::const_iterator it) : it(it) {}
+
+    typename TreeType::const_iterator it;  ///< Posição na árvore.
+  };
+
  public:
+  using iterator = basic_iterator<false>;
+  using const_iterator = basic_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
   /**
    * @brief Construtor padrão.
    * Cria um mapa vazio.
    */
   Map();
 
+  /**
+   * @brief Cria um mapa vazio que aloca seus nós com `alloc`.
+   *
+   * @param alloc Alocador dos nós.
+   */
+  explicit Map(const Alloc& alloc);
+
+  /**
+   * @brief Cópias e movimentos delegam à árvore: a cópia é um clone
+   * estrutural em O(n) e o movimento é O(1).
+   */
+  Map(const Map&) = default;
+  Map(Map&&) noexcept = default;
+  Map& operator=(const Map&) = default;
+  Map& operator=(Map&&) = default;
+
+  /**
+   * @brief Troca o conteúdo com `other` em O(1).
+   */
+  void swap(Map& other) noexcept { data.swap(other.data); }
+
+  friend void swap(Map& a, Map& b) noexcept { a.swap(b); }
+
+  /**
+   * @brief Cria um mapa com os pares de [first, last).
+   *
+   * Equivale a `assign_sorted(first, last)`.
+   *
+   * @param first Início da sequência de pares (com `first` e `second`).
+   * @param last Fim da sequência de pares.
+   * @param alloc Alocador dos nós.
+   */
+  template <class InputIt>
+  Map(InputIt first, InputIt last, const Alloc& alloc = Alloc());
+
+  /**
+   * @brief Substitui o conteúdo do mapa pelos pares de [first, last).
+   *
+   * Se as chaves já vierem em ordem crescente e sem repetições, a árvore é
+   * montada diretamente em O(n). Caso contrário os pares são ordenados pela
+   * chave e, para chaves repetidas, vale o primeiro par (como em uma
+   * sequência de `try_emplace`).
+   *
+   * @param first Início da sequência de pares (com `first` e `second`).
+   * @param last Fim da sequência de pares.
+   */
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
   /**
    * @brief Acessa o valor associado a uma chave.
    *
@@ -63,6 +260,12 @@ class Map {
    */
   V& operator[](const K& key);
 
+  /**
+   * @brief Versão de `operator[]` que move a chave para o novo par (a chave
+   * só é movida se o par for inserido).
+   */
+  V& operator[](K&& key);
+
   /**
    * @brief Acessa o valor associado a uma chave (versão constante).
    *
@@ -79,42 +282,447 @@ class Map {
    *
    * Se a chave existir, o par é removido.
    *
-   * @param key A chave do elemento a ser removido.
+   * @param key A chave do elemento a ser removido (`K` ou um tipo comparável
+   * com `K`).
    * @return `true` se o elemento foi encontrado e removido, `false` caso
    * contrário.
    */
-  bool remove(const K& key);
+  template <class Q>
+  bool remove(const Q& key);
+
+  /**
+   * @brief Busca o valor associado a uma chave, sem inserir.
+   *
+   * Aceita `K` ou qualquer tipo comparável com `K` pelo operador `<` (por
+   * exemplo `std::string_view` para chaves `std::string`).
+   *
+   * @param key A chave a ser buscada.
+   * @return Ponteiro para o valor ou nullptr se a chave não existir.
+   */
+  template <class Q>
+  V* find(const Q& key);
+  template <class Q>
+  const V* find(const Q& key) const;
+
+  /**
+   * @brief Verifica se uma chave está presente no mapa.
+   *
+   * @param key A chave a ser buscada (`K` ou um tipo comparável com `K`).
+   * @return `true` se a chave existir, `false` caso contrário.
+   */
+  template <class Q>
+  bool contain(const Q& key) const;
+
+  /**
+   * @brief Insere um valor construído no lugar, caso a chave não exista.
+   *
+   * A busca e a inserção acontecem em uma única descida na árvore. Se a
+   * chave já existir, `args` não é usado e nenhum `V` é construído.
+   *
+   * @param key A chave a ser buscada ou inserida.
+   * @param args Argumentos repassados ao construtor de `V`.
+   * @return Par (ponteiro para o valor associado à chave, `true` se o par foi
+   * inserido).
+   */
+  template <class... Args>
+  std::pair<V*, bool> try_emplace(const K& key, Args&&... args);
+
+  /**
+   * @brief Versão de `try_emplace` que move a chave para o novo par.
+   */
+  template <class... Args>
+  std::pair<V*, bool> try_emplace(K&& key, Args&&... args);
+
+  /**
+   * @brief Insere o par ou, se a chave já existir, atribui o novo valor.
+   *
+   * @param key A chave.
+   * @param value Valor a ser inserido ou atribuído.
+   * @return `true` se o par foi inserido, `false` se houve atribuição.
+   */
+  template <class M>
+  bool insert_or_assign(const K& key, M&& value);
+
+  /**
+   * @brief Versão de `insert_or_assign` que move a chave para o novo par.
+   */
+  template <class M>
+  bool insert_or_assign(K&& key, M&& value);
+
+  /**
+   * @brief Atualiza o valor associado a uma chave com uma função.
+   *
+   * Se a chave não existir, o valor é antes construído pelo construtor padrão
+   * de `V`. Em ambos os casos `fn(valor)` é chamada, tudo em uma descida.
+   *
+   * @param key A chave.
+   * @param fn Função chamada com uma referência ao valor (`V&`).
+   * @return Uma referência ao valor associado à chave.
+   */
+  template <class F>
+  V& upsert(const K& key, F&& fn);
+
+  /**
+   * @brief Versão de `upsert` que move a chave para o novo par.
+   */
+  template <class F>
+  V& upsert(K&& key, F&& fn);
+
+  /**
+   * @brief Operação de um lote de `apply_batch`.
+   *
+   * `BatchKind::insert` funciona como `try_emplace(key, value)`,
+   * `BatchKind::assign` como `insert_or_assign` e `BatchKind::erase` como
+   * `remove(key)` (o valor é ignorado e pode ser omitido).
+   */
+  struct BatchOp {
+    BatchKind kind;  ///< O que fazer.
+    K key;           ///< Chave da operação.
+    V value = V();   ///< Valor a inserir ou atribuir.
+  };
+
+  /**
+   * @brief Aplica um lote misto de inserções, atribuições e remoções em uma
+   * única passada pela árvore (veja `AVL::apply_batch`).
+   *
+   * Um valor atribuído ocupa um nó novo: ponteiros e iteradores para o
+   * valor antigo são invalidados.
+   *
+   * @return Resultado de cada operação, na ordem do lote: em `insert` e
+   * `assign`, se houve inserção; em `erase`, se a chave existia.
+   */
+  std::vector<bool> apply_batch(const std::vector<BatchOp>& ops);
+
+  /**
+   * @brief Quantidade de pares no mapa, em O(1).
+   */
+  std::size_t size() const { return data.size(); }
+
+  /**
+   * @brief Verifica se o mapa está vazio.
+   */
+  bool empty() const { return data.empty(); }
+
+  /**
+   * @brief Quantidade de chaves menores que `key`.
+   *
+   * @param key Chave de referência (`K` ou um tipo comparável com `K`); não
+   * precisa estar no mapa.
+   */
+  template <class Q>
+  std::size_t rank(const Q& key) const {
+    return data.rank(key);
+  }
+
+  /**
+   * @brief Iterador para o par com a k-ésima menor chave (a partir de 0).
+   *
+   * @param k Posição em ordem crescente de chave.
+   * @return Iterador para o par ou `end()` se `k >= size()`.
+   */
+  iterator nth(std::size_t k) { return iterator(data.nth(k)); }
+  const_iterator nth(std::size_t k) const {
+    return const_iterator(data.nth(k));
+  }
+
+  /**
+   * @brief Iterador para o primeiro par cuja chave não é menor que `key`.
+   *
+   * @param key Chave de referência (`K` ou um tipo comparável com `K`).
+   * @return Iterador para o par ou `end()` se não houver.
+   */
+  template <class Q>
+  iterator lower_bound(const Q& key) {
+    return iterator(data.lower_bound(key));
+  }
+  template <class Q>
+  const_iterator lower_bound(const Q& key) const {
+    return const_iterator(data.lower_bound(key));
+  }
+
+  /**
+   * @brief Iterador para o primeiro par cuja chave é maior que `key`.
+   *
+   * @return Iterador para o par ou `end()` se não houver.
+   */
+  template <class Q>
+  iterator upper_bound(const Q& key) {
+    return iterator(data.upper_bound(key));
+  }
+  template <class Q>
+  const_iterator upper_bound(const Q& key) const {
+    return const_iterator(data.upper_bound(key));
+  }
+
+  /**
+   * @brief Par com a maior chave menor ou igual a `key`.
+   *
+   * @return Iterador para o par ou `end()` se não houver.
+   */
+  template <class Q>
+  iterator floor(const Q& key) {
+    return before(upper_bound(key));
+  }
+  template <class Q>
+  const_iterator floor(const Q& key) const {
+    return before(upper_bound(key));
+  }
+
+  /**
+   * @brief Par com a menor chave maior ou igual a `key`.
+   *
+   * @return Iterador para o par ou `end()` se não houver.
+   */
+  template <class Q>
+  iterator ceiling(const Q& key) {
+    return lower_bound(key);
+  }
+  template <class Q>
+  const_iterator ceiling(const Q& key) const {
+    return lower_bound(key);
+  }
+
+  /**
+   * @brief Par com a maior chave estritamente menor que `key`.
+   *
+   * @return Iterador para o par ou `end()` se não houver.
+   */
+  template <class Q>
+  iterator predecessor(const Q& key) {
+    return before(lower_bound(key));
+  }
+  template <class Q>
+  const_iterator predecessor(const Q& key) const {
+    return before(lower_bound(key));
+  }
+
+  /**
+   * @brief Par com a menor chave estritamente maior que `key`.
+   *
+   * @return Iterador para o par ou `end()` se não houver.
+   */
+  template <class Q>
+  iterator successor(const Q& key) {
+    return upper_bound(key);
+  }
+  template <class Q>
+  const_iterator successor(const Q& key) const {
+    return upper_bound(key);
+  }
+
+  /**
+   * @brief Percorre em ordem de chave os pares com chave em [lo, hi).
+   *
+   * Custa O(log n + k) para k pares visitados.
+   *
+   * @param lo Limite inferior (inclusivo).
+   * @param hi Limite superior (exclusivo).
+   * @param fn Função chamada com `(const K&, V&)` (ou `const V&` no mapa
+   * constante); pode retornar `bool` ou `void`.
+   * @return `true` se o intervalo foi percorrido até o fim, `false` se `fn`
+   * interrompeu a varredura.
+   */
+  template <class Q, class F>
+  bool range(const Q& lo, const Q& hi, F&& fn) {
+    return range_of(*this, lo, hi, fn);
+  }
+  template <class Q, class F>
+  bool range(const Q& lo, const Q& hi, F&& fn) const {
+    return range_of(*this, lo, hi, fn);
+  }
+
+  /**
+   * @brief Quantidade de pares com chave em [lo, hi), em O(log n).
+   */
+  template <class Q>
+  std::size_t count_range(const Q& lo, const Q& hi) const {
+    return data.count_range(lo, hi);
+  }
+
+  /**
+   * @brief Iteradores que percorrem os pares em ordem crescente de chave.
+   *
+   * Percorrem a árvore no próprio lugar, sem copiar os pares.
+   */
+  iterator begin() { return iterator(data.begin()); }
+  iterator end() { return iterator(data.end()); }
+  const_iterator begin() const { return const_iterator(data.begin()); }
+  const_iterator end() const { return const_iterator(data.end()); }
+
+  /**
+   * @brief Iteradores que percorrem os pares em ordem decrescente de chave.
+   */
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
 
  private:
-  BST<Pair> data;  ///< A Árvore Binária que armazena os pares chave-valor.
-};
+  /**
+   * @brief Iterador anterior a `it`, ou `end()` se `it` for o primeiro.
+   */
+  iterator before(iterator it) {
+    return it == begin() ? end() : std::prev(it);
+  }
+  const_iterator before(const_iterator it) const {
+    return it == begin() ? end() : std::prev(it);
+  }
 
-template <class K, class V>
-Map<K, V>::Map() {}
-
-template <class K, class V>
-V& Map<K, V>::operator[](const K& key) {
-// Busca o par na árvore
-    Pair* found = const_cast<Pair*>(data.search(Pair(key))); 
-    if (found) {
-        return found->value;
-    } else {
-        // Insere um novo Pair com valor padrão
-        data.insert(Pair(key));
-        // Busca novamente para retornar referência
-        found = const_cast<Pair*>(data.search(Pair(key)));
-        return found->value;
+  /**
+   * @brief Implementação de `range`, comum ao mapa constante e não constante.
+   */
+  template <class Self, class Q, class F>
+  static bool range_of(Self& self, const Q& lo, const Q& hi, F& fn) {
+    for (auto it = self.lower_bound(lo);
+         it != self.end() && it->first < hi; ++it) {
+      if constexpr (std::is_void_v<decltype(fn(it->first, it->second))>) {
+        fn(it->first, it->second);
+      } else if (!fn(it->first, it->second)) {
+        return false;
+      }
     }
+    return true;
+  }
+
+  TreeType data;  ///< A Árvore Binária que armazena os pares chave-valor.
+};
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+Map<K, V, Tree, Alloc>::Map() {}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+Map<K, V, Tree, Alloc>::Map(const Alloc& alloc) : data(alloc) {}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class InputIt>
+Map<K, V, Tree, Alloc>::Map(InputIt first, InputIt last, const Alloc& alloc) : data(alloc) {
+  assign_sorted(first, last);
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class InputIt>
+void Map<K, V, Tree, Alloc>::assign_sorted(InputIt first, InputIt last) {
+  std::vector<Pair> pairs;
+  using Category = typename std::iterator_traits<InputIt>::iterator_category;
+  if constexpr (std::is_base_of_v<std::forward_iterator_tag, Category>) {
+    pairs.reserve(std::distance(first, last));
+  }
+  for (; first != last; ++first) {
+    // com `std::move_iterator` a chave e o valor são movidos
+    auto&& kv = *first;
+    pairs.emplace_back(std::forward<decltype(kv)>(kv).first,
+                       std::forward<decltype(kv)>(kv).second);
+  }
+  data.assign_sorted(std::move(pairs));
 }
 
-template <class K, class V>
-const V& Map<K, V>::operator[](const K& key) const {
-     const Pair* found = data.search(Pair(key));
+template <class K, class V, template <class...> class Tree, class Alloc>
+V& Map<K, V, Tree, Alloc>::operator[](const K& key) {
+  // Busca e, se necessário, insere o par com valor padrão na mesma descida
+  return data.try_emplace(key, key).first->value;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+const V& Map<K, V, Tree, Alloc>::operator[](const K& key) const {
+     const Pair* found = data.search(key);
     if (!found) throw std::out_of_range("Key not found in Map");
     return found->value;
 }
 
-template <class K, class V>
-bool Map<K, V>::remove(const K& key) {
-  return data.remove(Pair(key));
-}
\ No newline at end of file
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class Q>
+bool Map<K, V, Tree, Alloc>::remove(const Q& key) {
+  return data.remove(key);
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class Q>
+V* Map<K, V, Tree, Alloc>::find(const Q& key) {
+  Pair* found = data.search(key);
+  return found ? &found->value : nullptr;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class Q>
+const V* Map<K, V, Tree, Alloc>::find(const Q& key) const {
+  const Pair* found = data.search(key);
+  return found ? &found->value : nullptr;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class Q>
+bool Map<K, V, Tree, Alloc>::contain(const Q& key) const {
+  return data.contain(key);
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class... Args>
+std::pair<V*, bool> Map<K, V, Tree, Alloc>::try_emplace(const K& key,
+                                                 Args&&... args) {
+  auto [pair, inserted] =
+      data.try_emplace(key, key, std::forward<Args>(args)...);
+  return {&pair->value, inserted};
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class M>
+bool Map<K, V, Tree, Alloc>::insert_or_assign(const K& key, M&& value) {
+  auto [pair, inserted] = data.try_emplace(key, key, std::forward<M>(value));
+  if (!inserted) {
+    pair->value = std::forward<M>(value);
+  }
+  return inserted;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class F>
+V& Map<K, V, Tree, Alloc>::upsert(const K& key, F&& fn) {
+  V& value = data.try_emplace(key, key).first->value;
+  std::forward<F>(fn)(value);
+  return value;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+V& Map<K, V, Tree, Alloc>::operator[](K&& key) {
+  // `key` só é usada nas comparações antes de ser movida para o novo nó
+  return data.try_emplace(key, std::move(key)).first->value;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class... Args>
+std::pair<V*, bool> Map<K, V, Tree, Alloc>::try_emplace(K&& key, Args&&... args) {
+  auto [pair, inserted] =
+      data.try_emplace(key, std::move(key), std::forward<Args>(args)...);
+  return {&pair->value, inserted};
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class M>
+bool Map<K, V, Tree, Alloc>::insert_or_assign(K&& key, M&& value) {
+  auto [pair, inserted] =
+      data.try_emplace(key, std::move(key), std::forward<M>(value));
+  if (!inserted) {
+    pair->value = std::forward<M>(value);
+  }
+  return inserted;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+template <class F>
+V& Map<K, V, Tree, Alloc>::upsert(K&& key, F&& fn) {
+  V& value = data.try_emplace(key, std::move(key)).first->value;
+  std::forward<F>(fn)(value);
+  return value;
+}
+
+template <class K, class V, template <class...> class Tree, class Alloc>
+std::vector<bool> Map<K, V, Tree, Alloc>::apply_batch(
+    const std::vector<BatchOp>& ops) {
+  return data.apply_batch(
+      ops, [](const BatchOp& op) -> const K& { return op.key; },
+      [](const BatchOp& op) { return Pair(op.key, op.value); });
+}
@@ -0,0 +1,775 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Árvore AVL persistente (imutável), com versões baratas.
+ *
+ * Cada objeto é uma versão da árvore. `insert` e `remove` não alteram a
+ * versão atual: copiam apenas os O(log n) nós do caminho até o valor e
+ * retornam uma nova versão que compartilha todo o resto com a original.
+ * Copiar uma versão (tirar um snapshot) é O(1).
+ *
+ * Os nós nunca mudam depois de construídos e têm um contador de referências
+ * atômico; um nó é liberado quando a última versão que o usa é destruída.
+ * Por isso uma versão pode ser lida por várias threads ao mesmo tempo, sem
+ * travas, enquanto outras threads criam versões novas a partir dela. Como em
+ * `std::shared_ptr`, o que não pode ser feito sem sincronização é alterar o
+ * mesmo objeto (atribuir a ele) enquanto outra thread o lê ou o copia.
+ *
+ * Se versões forem destruídas em threads diferentes, o alocador precisa ser
+ * thread-safe (`std::allocator` é; `PoolAllocator` não).
+ *
+ * @tparam T Tipo dos elementos armazenados (copiável).
+ * @tparam Compare Comparador que define a ordem dos elementos. Se for
+ * transparente (define `is_transparent`), as buscas aceitam qualquer tipo
+ * comparável com `T`.
+ * @tparam Alloc Alocador usado para os nós (via rebind).
+ */
+template <class T, class Compare = std::less<T>,
+          class Alloc = std::allocator<T>>
+class PersistentAVL {
+ private:
+  /**
+   * @brief Nó imutável, compartilhado entre versões.
+   */
+  struct TreeNode {
+    T data;                         ///< Valor armazenado no nó.
+    TreeNode* left;                 ///< Filho à esquerda.
+    TreeNode* right;                ///< Filho à direita.
+    std::size_t size;               ///< Quantidade de nós na subárvore.
+    int height;                     ///< Altura do nó (-1 para nullptr).
+    std::atomic<std::size_t> refs;  ///< Versões e nós pais que usam o nó.
+
+    /**
+     * @brief Constrói o nó, assumindo as referências de `left` e `right`.
+     *
+     * @param left Subárvore esquerda.
+     * @param right Subárvore direita.
+     * @param args Argumentos repassados ao construtor de `T`.
+     */
+    template <class... Args>
+    TreeNode(TreeNode* left, TreeNode* right, Args&&... args);
+  };
+
+ public:
+  /**
+   * @brief Iterador que percorre uma versão em ordem (in-order).
+   *
+   * Os nós não têm ponteiro para o pai (ele mudaria a cada versão), então o
+   * iterador guarda o caminho da raiz até o nó atual. Continua válido
+   * enquanto a versão percorrida existir.
+   */
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const_iterator() = default;
+
+    reference operator*() const { return path.back()->data; }
+    pointer operator->() const { return &path.back()->data; }
+
+    /**
+     * @brief Avança para o sucessor: o menor da subárvore direita ou, se não
+     * houver, o ancestral mais próximo que ainda não foi visitado.
+     */
+    const_iterator& operator++() {
+      const TreeNode* node = path.back();
+      path.pop_back();
+      for (node = node->right; node; node = node->left) path.push_back(node);
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator old = *this;
+      ++*this;
+      return old;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return current() == other.current();
+    }
+    bool operator!=(const const_iterator& other) const {
+      return current() != other.current();
+    }
+
+   private:
+    friend class PersistentAVL;
+
+    const TreeNode* current() const {
+      return path.empty() ? nullptr : path.back();
+    }
+
+    /**
+     * @brief Caminho pendente: o nó atual no fim e, antes dele, os
+     * ancestrais dos quais a descida foi pela esquerda.
+     */
+    std::vector<const TreeNode*> path;
+  };
+
+  using iterator = const_iterator;
+
+  /**
+   * @brief Construtor padrão. Cria uma árvore vazia.
+   */
+  PersistentAVL();
+
+  /**
+   * @brief Cria uma árvore vazia que usa `alloc` para os nós.
+   */
+  explicit PersistentAVL(const Alloc& alloc);
+
+  /**
+   * @brief Tira um snapshot de `other` em O(1): as duas versões
+   * compartilham todos os nós.
+   */
+  PersistentAVL(const PersistentAVL& other) noexcept;
+
+  /**
+   * @brief Toma a versão de `other` em O(1), deixando-o vazio.
+   */
+  PersistentAVL(PersistentAVL&& other) noexcept;
+
+  PersistentAVL& operator=(const PersistentAVL& other) noexcept;
+  PersistentAVL& operator=(PersistentAVL&& other) noexcept;
+
+  /**
+   * @brief Destrutor. Libera os nós que não são usados por outra versão.
+   */
+  ~PersistentAVL();
+
+  /**
+   * @brief Troca as versões em O(1).
+   */
+  void swap(PersistentAVL& other) noexcept;
+
+  friend void swap(PersistentAVL& a, PersistentAVL& b) noexcept { a.swap(b); }
+
+  /**
+   * @brief Retorna uma nova versão com `value` inserido.
+   *
+   * Copia apenas os nós do caminho até a posição de `value` (e os das
+   * rotações); o resto é compartilhado com esta versão, que não muda.
+   *
+   * @param value Valor a ser inserido.
+   * @return A nova versão, ou um snapshot desta se `value` já existia.
+   */
+  [[nodiscard]] PersistentAVL insert(const T& value) const;
+
+  /**
+   * @brief Retorna uma nova versão com `value` inserido ou, se já houver um
+   * elemento equivalente, com ele substituído por `value`.
+   *
+   * Útil quando só parte do elemento participa da comparação (como a chave
+   * de um par chave-valor).
+   */
+  [[nodiscard]] PersistentAVL insert_or_assign(const T& value) const;
+
+  /**
+   * @brief Retorna uma nova versão sem `value`.
+   *
+   * @param value Valor a ser removido.
+   * @return A nova versão, ou um snapshot desta se `value` não existia.
+   */
+  [[nodiscard]] PersistentAVL remove(const T& value) const;
+
+  /**
+   * @brief `remove` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  [[nodiscard]] PersistentAVL remove(const Key& key) const {
+    return remove_key(key);
+  }
+
+  /**
+   * @brief Verifica se a versão contém um valor.
+   */
+  bool contain(const T& value) const { return find_node(value) != nullptr; }
+
+  /**
+   * @brief `contain` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  bool contain(const Key& key) const {
+    return find_node(key) != nullptr;
+  }
+
+  /**
+   * @brief Busca um valor.
+   *
+   * @return Ponteiro para o elemento (válido enquanto a versão existir) ou
+   * nullptr se não houver.
+   */
+  const T* search(const T& value) const;
+
+  /**
+   * @brief `search` para uma chave de outro tipo (comparador transparente).
+   */
+  template <class Key, class C = Compare, class = typename C::is_transparent>
+  const T* search(const Key& key) const {
+    const TreeNode* node = find_node(key);
+    return node ? &node->data : nullptr;
+  }
+
+  /**
+   * @brief Quantidade de elementos, em O(1).
+   */
+  std::size_t size() const { return root ? root->size : 0; }
+
+  /**
+   * @brief Verifica se a versão está vazia.
+   */
+  bool empty() const { return root == nullptr; }
+
+  /**
+   * @brief Quantidade de elementos estritamente menores que `value`.
+   */
+  std::size_t rank(const T& value) const;
+
+  /**
+   * @brief Retorna o k-ésimo menor elemento (a partir de 0).
+   *
+   * @throw std::out_of_range se `k >= size()`.
+   */
+  const T& select(std::size_t k) const;
+
+  /**
+   * @brief Chama `fn` para cada elemento em ordem crescente.
+   *
+   * @param fn Função chamada com cada valor; se retornar `false`, a travessia
+   * é interrompida.
+   * @return `false` se a travessia foi interrompida, `true` caso contrário.
+   */
+  template <class F>
+  bool for_each_in_order(F&& fn) const;
+
+  /**
+   * @brief Retorna os elementos em ordem crescente.
+   */
+  std::vector<T> in_order() const;
+
+  /**
+   * @brief Retorna os elementos em pre-order (revela o formato da árvore).
+   */
+  std::vector<T> pre_order() const;
+
+  /**
+   * @brief Verifica se a versão respeita o balanceamento AVL e se as alturas
+   * e tamanhos guardados nos nós estão corretos.
+   */
+  bool is_balanced() const { return check(root).first; }
+
+  /**
+   * @brief Iterador para o menor elemento.
+   */
+  const_iterator begin() const;
+
+  /**
+   * @brief Iterador para a posição depois do maior elemento.
+   */
+  const_iterator end() const { return const_iterator(); }
+
+  /**
+   * @brief Retorna uma cópia do alocador.
+   */
+  Alloc get_allocator() const { return Alloc(alloc); }
+
+ private:
+  using NodeAlloc =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<TreeNode>;
+  using NodeAllocTraits = std::allocator_traits<NodeAlloc>;
+
+  /**
+   * @brief Versão com a mesma configuração (comparador e alocador) e
+   * nenhum nó, usada para construir o resultado de `insert` e `remove`.
+   */
+  PersistentAVL empty_version() const;
+
+  static int height(const TreeNode* node) { return node ? node->height : -1; }
+
+  static std::size_t subtree_size(const TreeNode* node) {
+    return node ? node->size : 0;
+  }
+
+  /**
+   * @brief Acrescenta uma referência a `node` (se não for nulo).
+   *
+   * @return O próprio `node`.
+   */
+  static TreeNode* retain(TreeNode* node);
+
+  /**
+   * @brief Remove uma referência de `node`, liberando-o (e, em cascata, os
+   * filhos) se era a última.
+   */
+  void release(TreeNode* node);
+
+  /**
+   * @brief Aloca um nó com uma referência, assumindo as de `left` e `right`.
+   *
+   * Se a construção falhar, as referências de `left` e `right` são
+   * devolvidas antes de a exceção ser propagada.
+   */
+  template <class... Args>
+  TreeNode* make(TreeNode* left, TreeNode* right, Args&&... args);
+
+  /**
+   * @brief Constrói um nó com `value` entre `left` e `right`, com uma
+   * rotação simples ou dupla se as alturas diferirem em 2.
+   *
+   * Assume as referências de `left` e `right` (também em caso de exceção).
+   * Os nós das rotações são copiados, nunca alterados.
+   *
+   * @return Nova subárvore balanceada, com uma referência.
+   */
+  TreeNode* balanced(TreeNode* left, const T& value, TreeNode* right);
+
+  /**
+   * @brief Copia o caminho até a posição de `value` e insere um nó novo.
+   *
+   * @param assign Se `true`, um elemento equivalente a `value` é
+   * substituído por ele.
+   * @return Nova subárvore com uma referência, ou nullptr se `value` já
+   * existia e `assign` é `false` (nesse caso nada é alocado).
+   */
+  TreeNode* insert_node(TreeNode* node, const T& value, bool assign);
+
+  /**
+   * @brief Copia o caminho até `key` e o remove.
+   *
+   * @param removed Recebe `true` se `key` foi encontrada.
+   * @return Nova subárvore com uma referência (significativa só se
+   * `removed`).
+   */
+  template <class Key>
+  TreeNode* remove_node(TreeNode* node, const Key& key, bool& removed);
+
+  /**
+   * @brief Copia o caminho até o menor nó de `node` e o remove.
+   *
+   * @param min Recebe o endereço do menor valor (no nó original, que continua
+   * vivo na versão de origem).
+   * @return Nova subárvore com uma referência.
+   */
+  TreeNode* remove_min(TreeNode* node, const T*& min);
+
+  template <class Key>
+  PersistentAVL remove_key(const Key& key) const;
+
+  template <class Key>
+  const TreeNode* find_node(const Key& key) const;
+
+  /**
+   * @brief Verifica recursivamente balanceamento, alturas e tamanhos.
+   *
+   * @return Par (está_correta, altura).
+   */
+  std::pair<bool, int> check(const TreeNode* node) const;
+
+  TreeNode* root;   ///< Raiz desta versão (uma referência própria).
+  Compare comp;     ///< Comparador que define a ordem dos elementos.
+  NodeAlloc alloc;  ///< Alocador dos nós.
+};
+
+template <class T, class Compare, class Alloc>
+template <class... Args>
+PersistentAVL<T, Compare, Alloc>::TreeNode::TreeNode(TreeNode* left,
+                                                     TreeNode* right,
+                                                     Args&&... args)
+    : data(std::forward<Args>(args)...),
+      left(left),
+      right(right),
+      size(1 + subtree_size(left) + subtree_size(right)),
+      height(1 + std::max(PersistentAVL::height(left),
+                          PersistentAVL::height(right))),
+      refs(1) {}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>::PersistentAVL()
+    : root(nullptr), comp(), alloc() {}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>::PersistentAVL(const Alloc& alloc)
+    : root(nullptr), comp(), alloc(alloc) {}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>::PersistentAVL(
+    const PersistentAVL& other) noexcept
+    : root(retain(other.root)), comp(other.comp), alloc(other.alloc) {}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>::PersistentAVL(PersistentAVL&& other) noexcept
+    : root(other.root), comp(other.comp), alloc(other.alloc) {
+  other.root = nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>& PersistentAVL<T, Compare, Alloc>::operator=(
+    const PersistentAVL& other) noexcept {
+  // Pega a referência nova antes de soltar a antiga (auto-atribuição)
+  TreeNode* old = root;
+  root = retain(other.root);
+  release(old);
+  comp = other.comp;
+  alloc = other.alloc;
+  return *this;
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>& PersistentAVL<T, Compare, Alloc>::operator=(
+    PersistentAVL&& other) noexcept {
+  if (this != &other) {
+    release(root);
+    root = other.root;
+    other.root = nullptr;
+    comp = other.comp;
+    alloc = other.alloc;
+  }
+  return *this;
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>::~PersistentAVL() {
+  release(root);
+}
+
+template <class T, class Compare, class Alloc>
+void PersistentAVL<T, Compare, Alloc>::swap(PersistentAVL& other) noexcept {
+  using std::swap;
+  swap(root, other.root);
+  swap(comp, other.comp);
+  swap(alloc, other.alloc);
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc> PersistentAVL<T, Compare, Alloc>::empty_version()
+    const {
+  PersistentAVL version(alloc);
+  version.comp = comp;
+  return version;
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc> PersistentAVL<T, Compare, Alloc>::insert(
+    const T& value) const {
+  PersistentAVL version = empty_version();
+  version.root = version.insert_node(root, value, false);
+  if (!version.root) return *this;  // Já existia: nada foi copiado
+  return version;
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc>
+PersistentAVL<T, Compare, Alloc>::insert_or_assign(const T& value) const {
+  PersistentAVL version = empty_version();
+  version.root = version.insert_node(root, value, true);
+  return version;
+}
+
+template <class T, class Compare, class Alloc>
+PersistentAVL<T, Compare, Alloc> PersistentAVL<T, Compare, Alloc>::remove(
+    const T& value) const {
+  return remove_key(value);
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+PersistentAVL<T, Compare, Alloc> PersistentAVL<T, Compare, Alloc>::remove_key(
+    const Key& key) const {
+  PersistentAVL version = empty_version();
+  bool removed = false;
+  version.root = version.remove_node(root, key, removed);
+  if (!removed) return *this;
+  return version;
+}
+
+template <class T, class Compare, class Alloc>
+typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::retain(TreeNode* node) {
+  // Quem já tem uma referência pode criar outra sem ordenar memória
+  if (node) node->refs.fetch_add(1, std::memory_order_relaxed);
+  return node;
+}
+
+template <class T, class Compare, class Alloc>
+void PersistentAVL<T, Compare, Alloc>::release(TreeNode* node) {
+  // A recursão desce no máximo a altura da árvore
+  while (node && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    TreeNode* left = node->left;
+    TreeNode* right = node->right;
+    NodeAllocTraits::destroy(alloc, node);
+    NodeAllocTraits::deallocate(alloc, node, 1);
+    release(left);
+    node = right;
+  }
+}
+
+template <class T, class Compare, class Alloc>
+template <class... Args>
+typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::make(TreeNode* left, TreeNode* right,
+                                       Args&&... args) {
+  TreeNode* node = nullptr;
+  try {
+    node = NodeAllocTraits::allocate(alloc, 1);
+    NodeAllocTraits::construct(alloc, node, left, right,
+                               std::forward<Args>(args)...);
+  } catch (...) {
+    if (node) NodeAllocTraits::deallocate(alloc, node, 1);
+    release(left);
+    release(right);
+    throw;
+  }
+  return node;
+}
+
+template <class T, class Compare, class Alloc>
+typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::balanced(TreeNode* left, const T& value,
+                                           TreeNode* right) {
+  if (height(left) > height(right) + 1) {
+    try {
+      TreeNode* top;
+      if (height(left->left) >= height(left->right)) {
+        // Rotação simples à direita
+        TreeNode* inner = make(retain(left->right), right, value);
+        top = make(retain(left->left), inner, left->data);
+      } else {
+        // Rotação dupla: esquerda no filho, direita no nó
+        TreeNode* pivot = left->right;
+        TreeNode* outer = make(retain(pivot->right), right, value);
+        TreeNode* inner;
+        try {
+          inner = make(retain(left->left), retain(pivot->left), left->data);
+        } catch (...) {
+          release(outer);
+          throw;
+        }
+        top = make(inner, outer, pivot->data);
+      }
+      release(left);
+      return top;
+    } catch (...) {
+      release(left);
+      throw;
+    }
+  }
+  if (height(right) > height(left) + 1) {
+    try {
+      TreeNode* top;
+      if (height(right->right) >= height(right->left)) {
+        // Rotação simples à esquerda
+        TreeNode* inner = make(left, retain(right->left), value);
+        top = make(inner, retain(right->right), right->data);
+      } else {
+        // Rotação dupla: direita no filho, esquerda no nó
+        TreeNode* pivot = right->left;
+        TreeNode* outer = make(left, retain(pivot->left), value);
+        TreeNode* inner;
+        try {
+          inner = make(retain(pivot->right), retain(right->right), right->data);
+        } catch (...) {
+          release(outer);
+          throw;
+        }
+        top = make(outer, inner, pivot->data);
+      }
+      release(right);
+      return top;
+    } catch (...) {
+      release(right);
+      throw;
+    }
+  }
+  return make(left, right, value);
+}
+
+template <class T, class Compare, class Alloc>
+typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::insert_node(TreeNode* node, const T& value,
+                                              bool assign) {
+  if (!node) return make(nullptr, nullptr, value);
+  if (comp(value, node->data)) {
+    TreeNode* left = insert_node(node->left, value, assign);
+    if (!left) return nullptr;
+    return balanced(left, node->data, retain(node->right));
+  }
+  if (comp(node->data, value)) {
+    TreeNode* right = insert_node(node->right, value, assign);
+    if (!right) return nullptr;
+    return balanced(retain(node->left), node->data, right);
+  }
+  if (assign) return make(retain(node->left), retain(node->right), value);
+  return nullptr;  // Valor já existe
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::remove_node(TreeNode* node, const Key& key,
+                                              bool& removed) {
+  if (!node) {
+    removed = false;
+    return nullptr;
+  }
+  if (comp(key, node->data)) {
+    TreeNode* left = remove_node(node->left, key, removed);
+    if (!removed) return nullptr;
+    return balanced(left, node->data, retain(node->right));
+  }
+  if (comp(node->data, key)) {
+    TreeNode* right = remove_node(node->right, key, removed);
+    if (!removed) return nullptr;
+    return balanced(retain(node->left), node->data, right);
+  }
+  removed = true;
+  if (!node->left) return retain(node->right);
+  if (!node->right) return retain(node->left);
+  // Dois filhos: o sucessor (copiado) ocupa o lugar do nó
+  const T* successor = nullptr;
+  TreeNode* right = remove_min(node->right, successor);
+  return balanced(retain(node->left), *successor, right);
+}
+
+template <class T, class Compare, class Alloc>
+typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::remove_min(TreeNode* node, const T*& min) {
+  if (!node->left) {
+    min = &node->data;
+    return retain(node->right);
+  }
+  TreeNode* left = remove_min(node->left, min);
+  return balanced(left, node->data, retain(node->right));
+}
+
+template <class T, class Compare, class Alloc>
+template <class Key>
+const typename PersistentAVL<T, Compare, Alloc>::TreeNode*
+PersistentAVL<T, Compare, Alloc>::find_node(const Key& key) const {
+  const TreeNode* current = root;
+  while (current) {
+    if (comp(key, current->data)) {
+      current = current->left;
+    } else if (comp(current->data, key)) {
+      current = current->right;
+    } else {
+      return current;
+    }
+  }
+  return nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+const T* PersistentAVL<T, Compare, Alloc>::search(const T& value) const {
+  const TreeNode* node = find_node(value);
+  return node ? &node->data : nullptr;
+}
+
+template <class T, class Compare, class Alloc>
+std::size_t PersistentAVL<T, Compare, Alloc>::rank(const T& value) const {
+  std::size_t smaller = 0;
+  const TreeNode* current = root;
+  while (current) {
+    if (comp(current->data, value)) {
+      smaller += subtree_size(current->left) + 1;
+      current = current->right;
+    } else {
+      current = current->left;
+    }
+  }
+  return smaller;
+}
+
+template <class T, class Compare, class Alloc>
+const T& PersistentAVL<T, Compare, Alloc>::select(std::size_t k) const {
+  if (k >= size()) throw std::out_of_range("PersistentAVL::select");
+  const TreeNode* current = root;
+  while (true) {
+    std::size_t left = subtree_size(current->left);
+    if (k < left) {
+      current = current->left;
+    } else if (k == left) {
+      return current->data;
+    } else {
+      k -= left + 1;
+      current = current->right;
+    }
+  }
+}
+
+template <class T, class Compare, class Alloc>
+template <class F>
+bool PersistentAVL<T, Compare, Alloc>::for_each_in_order(F&& fn) const {
+  for (const T& value : *this) {
+    if constexpr (std::is_same_v<decltype(fn(value)), void>) {
+      fn(value);
+    } else if (!fn(value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class T, class Compare, class Alloc>
+std::vector<T> PersistentAVL<T, Compare, Alloc>::in_order() const {
+  std::vector<T> result;
+  result.reserve(size());
+  for (const T& value : *this) result.push_back(value);
+  return result;
+}
+
+template <class T, class Compare, class Alloc>
+std::vector<T> PersistentAVL<T, Compare, Alloc>::pre_order() const {
+  std::vector<T> result;
+  result.reserve(size());
+  std::vector<const TreeNode*> pending;
+  if (root) pending.push_back(root);
+  while (!pending.empty()) {
+    const TreeNode* node = pending.back();
+    pending.pop_back();
+    result.push_back(node->data);
+    if (node->right) pending.push_back(node->right);
+    if (node->left) pending.push_back(node->left);
+  }
+  return result;
+}
+
+template <class T, class Compare, class Alloc>
+typename PersistentAVL<T, Compare, Alloc>::const_iterator
+PersistentAVL<T, Compare, Alloc>::begin() const {
+  const_iterator it;
+  for (const TreeNode* node = root; node; node = node->left) {
+    it.path.push_back(node);
+  }
+  return it;
+}
+
+template <class T, class Compare, class Alloc>
+std::pair<bool, int> PersistentAVL<T, Compare, Alloc>::check(
+    const TreeNode* node) const {
+  if (!node) return {true, -1};
+
+  auto left = check(node->left);
+  auto right = check(node->right);
+
+  int node_height = 1 + std::max(left.second, right.second);
+  bool valid = left.first && right.first &&
+               std::abs(left.second - right.second) <= 1 &&
+               node->height == node_height &&
+               node->size ==
+                   1 + subtree_size(node->left) + subtree_size(node->right);
+  return {valid, node_height};
+}
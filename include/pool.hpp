@@ -0,0 +1,226 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Reserva de memória para blocos de tamanho fixo (slab/arena).
+ *
+ * A memória é obtida do alocador global em slabs cada vez maiores, e cada
+ * slab é dividida em blocos de `block_size` bytes. Blocos liberados vão para
+ * uma lista livre e são reaproveitados pela próxima alocação. Todas as slabs
+ * são devolvidas de uma vez na destruição da reserva.
+ *
+ * Não é thread-safe.
+ */
+class NodePool {
+ public:
+  /**
+   * @brief Cria uma reserva vazia (nenhuma slab é alocada ainda).
+   *
+   * @param block_size Tamanho de cada bloco, em bytes.
+   */
+  explicit NodePool(std::size_t block_size)
+      : block_size_(round_up(block_size)),
+        next_slab_blocks(first_slab_blocks),
+        free_list(nullptr),
+        bump(nullptr),
+        bump_end(nullptr) {}
+
+  NodePool(const NodePool&) = delete;
+  NodePool& operator=(const NodePool&) = delete;
+
+  /**
+   * @brief Destrutor, devolve todas as slabs ao alocador global.
+   */
+  ~NodePool() {
+    for (void* slab : slabs) {
+      ::operator delete(slab);
+    }
+  }
+
+  /**
+   * @brief Retorna um bloco livre, reaproveitando a lista livre se possível.
+   */
+  void* allocate() {
+    if (free_list) {
+      FreeBlock* block = free_list;
+      free_list = block->next;
+      return block;
+    }
+    if (bump == bump_end) {
+      grow();
+    }
+    void* block = bump;
+    bump += block_size_;
+    return block;
+  }
+
+  /**
+   * @brief Devolve um bloco à lista livre.
+   *
+   * @param block Bloco obtido por `allocate` desta mesma reserva.
+   */
+  void deallocate(void* block) {
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    free_block->next = free_list;
+    free_list = free_block;
+  }
+
+  /**
+   * @brief Tamanho (já arredondado) de cada bloco.
+   */
+  std::size_t block_size() const { return block_size_; }
+
+  /**
+   * @brief Quantidade de slabs obtidas do alocador global até agora.
+   */
+  std::size_t slab_count() const { return slabs.size(); }
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static constexpr std::size_t first_slab_blocks = 64;
+  static constexpr std::size_t max_slab_blocks = 64 * 1024;
+
+  static std::size_t round_up(std::size_t size) {
+    constexpr std::size_t align = alignof(std::max_align_t);
+    if (size < sizeof(FreeBlock)) size = sizeof(FreeBlock);
+    return (size + align - 1) / align * align;
+  }
+
+  /**
+   * @brief Aloca uma nova slab, com o dobro de blocos da anterior.
+   */
+  void grow() {
+    std::size_t bytes = block_size_ * next_slab_blocks;
+    char* slab = static_cast<char*>(::operator new(bytes));
+    slabs.push_back(slab);
+    bump = slab;
+    bump_end = slab + bytes;
+    if (next_slab_blocks < max_slab_blocks) next_slab_blocks *= 2;
+  }
+
+  std::size_t block_size_;        ///< Tamanho de cada bloco.
+  std::size_t next_slab_blocks;   ///< Blocos da próxima slab.
+  FreeBlock* free_list;           ///< Blocos devolvidos, prontos para reuso.
+  char* bump;                     ///< Próximo bloco nunca usado da slab atual.
+  char* bump_end;                 ///< Fim da slab atual.
+  std::vector<void*> slabs;       ///< Todas as slabs alocadas.
+};
+
+/**
+ * @brief Conjunto de `NodePool`s, uma para cada tamanho de bloco pedido.
+ *
+ * É o estado compartilhado por todas as cópias (e rebinds) de um
+ * `PoolAllocator`.
+ */
+class PoolResource {
+ public:
+  /**
+   * @brief Aloca um bloco de `size` bytes.
+   */
+  void* allocate(std::size_t size) { return pool_for(size).allocate(); }
+
+  /**
+   * @brief Devolve um bloco de `size` bytes obtido por `allocate`.
+   */
+  void deallocate(void* block, std::size_t size) {
+    pool_for(size).deallocate(block);
+  }
+
+ private:
+  NodePool& pool_for(std::size_t size) {
+    // Uma árvore só pede um tamanho (o do nó), então a busca quase sempre
+    // termina na última reserva usada.
+    if (last && last_size == size) return *last;
+    for (auto& [pool_size, pool] : pools) {
+      if (pool_size == size) {
+        last = pool.get();
+        last_size = size;
+        return *last;
+      }
+    }
+    pools.emplace_back(size, std::make_unique<NodePool>(size));
+    last = pools.back().second.get();
+    last_size = size;
+    return *last;
+  }
+
+  std::vector<std::pair<std::size_t, std::unique_ptr<NodePool>>> pools;
+  NodePool* last = nullptr;
+  std::size_t last_size = 0;
+};
+
+/**
+ * @brief Alocador compatível com a STL que usa uma `PoolResource`.
+ *
+ * Feito para os nós de `BST`, `AVL`, `Set` e `Map`: cada alocação de um único
+ * objeto vem de uma slab, e a memória é reaproveitada por uma lista livre.
+ * Alocações de vários objetos (ou de tipos com alinhamento estendido) vão
+ * direto para o alocador global.
+ *
+ * Cópias e rebinds compartilham a mesma reserva; um `PoolAllocator`
+ * construído por padrão cria uma reserva nova. A memória é devolvida quando
+ * a última cópia é destruída.
+ *
+ * Não é thread-safe.
+ *
+ * @tparam T Tipo dos objetos alocados.
+ */
+template <class T>
+class PoolAllocator {
+ public:
+  using value_type = T;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  /**
+   * @brief Cria um alocador com uma reserva própria.
+   */
+  PoolAllocator() : resource(std::make_shared<PoolResource>()) {}
+
+  /**
+   * @brief Rebind: compartilha a reserva de um alocador de outro tipo.
+   */
+  template <class U>
+  PoolAllocator(const PoolAllocator<U>& other) noexcept
+      : resource(other.resource) {}
+
+  T* allocate(std::size_t n) {
+    if (n != 1 || !pooled) {
+      return std::allocator<T>().allocate(n);
+    }
+    return static_cast<T*>(resource->allocate(sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t n) {
+    if (n != 1 || !pooled) {
+      std::allocator<T>().deallocate(p, n);
+      return;
+    }
+    resource->deallocate(p, sizeof(T));
+  }
+
+  template <class U>
+  bool operator==(const PoolAllocator<U>& other) const {
+    return resource == other.resource;
+  }
+
+  template <class U>
+  bool operator!=(const PoolAllocator<U>& other) const {
+    return resource != other.resource;
+  }
+
+ private:
+  template <class U>
+  friend class PoolAllocator;
+
+  static constexpr bool pooled = alignof(T) <= alignof(std::max_align_t);
+
+  std::shared_ptr<PoolResource> resource;  ///< Reserva compartilhada.
+};
@@ -1,5 +1,14 @@
 #pragma once
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
 #include "avl.hpp"
+#include "btree.hpp"
+#include "compact_avl.hpp"
+#include "frozen_set.hpp"
 
 /**
  * @brief Classe que representa um Conjunto (Set) baseado em uma Árvore AVL.
@@ -10,16 +19,76 @@
  *
  * @tparam T Tipo dos elementos a serem armazenados no conjunto.
  * O tipo T deve suportar o operadores de '<'.
+ * @tparam Tree Template da árvore usada para armazenar os elementos (AVL por
+ * padrão), com os mesmos parâmetros que `Map` repassa à sua árvore. Com
+ * `BTree`, só as operações que ela oferece (sem `rank`, `select`, operações
+ * de conjunto e lotes) ficam disponíveis; o mesmo vale para `CompactAVL`,
+ * que gasta menos memória por elemento.
+ * @tparam Alloc Alocador dos nós, por exemplo `PoolAllocator<T>`.
  */
-template <class T>
+template <class T, template <class...> class Tree = AVL,
+          class Alloc = std::allocator<T>>
 class Set {
  public:
+  /// Iteradores em ordem crescente; os elementos são somente leitura.
+  using const_iterator =
+      typename Tree<T, std::less<T>, Alloc>::const_iterator;
+  using iterator = const_iterator;
+  using reverse_iterator = std::reverse_iterator<const_iterator>;
+  using const_reverse_iterator = reverse_iterator;
+
   /**
    * @brief Construtor padrão.
    * * Cria um conjunto vazio.
    */
   Set();
 
+  /**
+   * @brief Cria um conjunto vazio que aloca seus nós com `alloc`.
+   *
+   * @param alloc Alocador dos nós.
+   */
+  explicit Set(const Alloc& alloc);
+
+  /**
+   * @brief Cópias e movimentos delegam à árvore: a cópia é um clone
+   * estrutural em O(n) e o movimento é O(1).
+   */
+  Set(const Set&) = default;
+  Set(Set&&) noexcept = default;
+  Set& operator=(const Set&) = default;
+  Set& operator=(Set&&) = default;
+
+  /**
+   * @brief Troca o conteúdo com `other` em O(1).
+   */
+  void swap(Set& other) noexcept { data.swap(other.data); }
+
+  friend void swap(Set& a, Set& b) noexcept { a.swap(b); }
+
+  /**
+   * @brief Cria um conjunto com os elementos de [first, last).
+   *
+   * Equivale a `assign_sorted(first, last)`: O(n) se a entrada já estiver
+   * ordenada, caso contrário ela é ordenada e as repetições descartadas.
+   *
+   * @param first Início da sequência de elementos.
+   * @param last Fim da sequência de elementos.
+   * @param alloc Alocador dos nós.
+   */
+  template <class InputIt>
+  Set(InputIt first, InputIt last, const Alloc& alloc = Alloc());
+
+  /**
+   * @brief Substitui o conteúdo do conjunto pelos elementos de [first, last).
+   *
+   * Monta a árvore balanceada diretamente, em O(n), quando a entrada já
+   * está ordenada e sem repetições; caso contrário ordena e remove as
+   * repetições antes (mantendo a primeira ocorrência).
+   */
+  template <class InputIt>
+  void assign_sorted(InputIt first, InputIt last);
+
   /**
    * @brief Insere um elemento no conjunto.
    *
@@ -32,6 +101,22 @@ class Set {
    */
   bool insert(const T& value);
 
+  /**
+   * @brief Insere um elemento, movendo-o para o conjunto.
+   *
+   * @param value O valor a ser inserido; só é movido se for inserido.
+   * @return `true` se o elemento foi inserido, `false` se já existia.
+   */
+  bool insert(T&& value);
+
+  /**
+   * @brief Constrói um elemento no próprio conjunto, a partir de `args`.
+   *
+   * @return `true` se o elemento foi inserido, `false` se já existia.
+   */
+  template <class... Args>
+  bool emplace(Args&&... args);
+
   /**
    * @brief Remove um elemento do conjunto.
    *
@@ -53,30 +138,457 @@ class Set {
    */
   bool search(const T& value) const;
 
+  /**
+   * @brief Cria uma cópia imutável do conjunto, otimizada para buscas.
+   *
+   * Útil para conjuntos que deixam de mudar depois de carregados: o
+   * `FrozenSet` guarda os elementos num único vetor (layout de Eytzinger),
+   * sem ponteiros, e tem o mesmo `search`. Alterações posteriores no
+   * conjunto não o afetam. Custa O(n) tempo e memória.
+   */
+  FrozenSet<T> freeze() const;
+
+  /**
+   * @brief Operações de conjunto feitas no próprio conjunto.
+   *
+   * Implementadas com `split` e `join` da AVL (requerem `Tree = AVL`), em
+   * O(m log(n/m + 1)) para tamanhos m <= n.
+   *
+   * As versões que recebem `Set&&` consomem `other` (que fica vazio) e
+   * reaproveitam seus nós no resultado. As versões com `const Set&` copiam
+   * `other` antes, em O(m) adicional.
+   *
+   * - `union_with`: elementos presentes em qualquer um dos conjuntos.
+   * - `intersect_with`: elementos presentes nos dois.
+   * - `difference_with`: elementos deste conjunto que não estão em `other`.
+   * - `symmetric_difference_with`: elementos presentes em exatamente um.
+   *
+   * @param other O segundo conjunto.
+   */
+  void union_with(const Set& other);
+  void union_with(Set&& other);
+  void intersect_with(const Set& other);
+  void intersect_with(Set&& other);
+  void difference_with(const Set& other);
+  void difference_with(Set&& other);
+  void symmetric_difference_with(const Set& other);
+  void symmetric_difference_with(Set&& other);
+
+  /**
+   * @brief Versões paralelas das operações de conjunto, executadas em `pool`.
+   *
+   * Ramos da recursão com mais de `grain` elementos rodam em paralelo; o
+   * resultado é idêntico ao da versão sequencial.
+   */
+  void union_with(const Set& other, ForkJoinPool& pool,
+                  std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void union_with(Set&& other, ForkJoinPool& pool,
+                  std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void intersect_with(const Set& other, ForkJoinPool& pool,
+                      std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void intersect_with(Set&& other, ForkJoinPool& pool,
+                      std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void difference_with(const Set& other, ForkJoinPool& pool,
+                       std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void difference_with(Set&& other, ForkJoinPool& pool,
+                       std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void symmetric_difference_with(const Set& other, ForkJoinPool& pool,
+                                 std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  void symmetric_difference_with(Set&& other, ForkJoinPool& pool,
+                                 std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+
+  /**
+   * @brief Insere ou remove um lote de elementos de uma vez, combinando-o
+   * com o conjunto por `union_with`/`difference_with`.
+   *
+   * @param first Início do lote (não precisa estar ordenado).
+   * @param last Fim do lote.
+   */
+  template <class InputIt>
+  void insert_batch(InputIt first, InputIt last);
+  template <class InputIt>
+  void erase_batch(InputIt first, InputIt last);
+
+  /**
+   * @brief Versões paralelas de `insert_batch` e `erase_batch`.
+   */
+  template <class InputIt>
+  void insert_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                    std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+  template <class InputIt>
+  void erase_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                   std::size_t grain = Tree<T, std::less<T>, Alloc>::default_grain);
+
+  /**
+   * @brief Aplica um lote misto de inserções, atribuições e remoções em uma
+   * única passada pela árvore (veja `AVL::apply_batch`).
+   *
+   * @return Resultado de cada operação, na ordem do lote.
+   */
+  std::vector<bool> apply_batch(const std::vector<BatchOp<T>>& ops);
+
+  /**
+   * @brief Quantidade de elementos no conjunto, em O(1).
+   */
+  std::size_t size() const;
+
+  /**
+   * @brief Verifica se o conjunto está vazio.
+   */
+  bool empty() const;
+
+  /**
+   * @brief Quantidade de elementos menores que `value`.
+   *
+   * @param value Valor de referência (não precisa estar no conjunto).
+   */
+  std::size_t rank(const T& value) const;
+
+  /**
+   * @brief Retorna o k-ésimo menor elemento (a partir de 0).
+   *
+   * @throw std::out_of_range se `k >= size()`.
+   */
+  const T& select(std::size_t k) const;
+
+  /**
+   * @brief Iterador para o k-ésimo menor elemento, ou `end()` se `k >= size()`.
+   */
+  const_iterator nth(std::size_t k) const;
+
+  /**
+   * @brief Iterador para o primeiro elemento que não é menor que `value`,
+   * ou `end()` se não houver.
+   */
+  const_iterator lower_bound(const T& value) const;
+
+  /**
+   * @brief Iterador para o primeiro elemento maior que `value`, ou `end()` se
+   * não houver.
+   */
+  const_iterator upper_bound(const T& value) const;
+
+  /**
+   * @brief Vizinhos de `value` no conjunto, em O(log n).
+   *
+   * `floor` e `ceiling` aceitam o próprio `value`; `predecessor` e
+   * `successor` procuram um elemento estritamente menor/maior.
+   *
+   * @param value Valor de referência (não precisa estar no conjunto).
+   * @return Ponteiro para o elemento ou nullptr se não houver.
+   */
+  const T* floor(const T& value) const;
+  const T* ceiling(const T& value) const;
+  const T* predecessor(const T& value) const;
+  const T* successor(const T& value) const;
+
+  /**
+   * @brief Percorre em ordem os elementos do intervalo [lo, hi).
+   *
+   * @param fn Função chamada com `const T&`; pode retornar `bool` ou `void`
+   * (retornar `false` interrompe a varredura).
+   * @return `true` se o intervalo foi percorrido até o fim.
+   */
+  template <class F>
+  bool range(const T& lo, const T& hi, F&& fn) const;
+
+  /**
+   * @brief Quantidade de elementos no intervalo [lo, hi), em O(log n).
+   */
+  std::size_t count_range(const T& lo, const T& hi) const;
+
+  /**
+   * @brief Iteradores que percorrem o conjunto em ordem crescente.
+   *
+   * Percorrem a árvore no próprio lugar, sem copiar os elementos, então é
+   * possível parar no meio ou usar os algoritmos de `<algorithm>`.
+   */
+  const_iterator begin() const;
+  const_iterator end() const;
+
+  /**
+   * @brief Iteradores que percorrem o conjunto em ordem decrescente.
+   */
+  reverse_iterator rbegin() const;
+  reverse_iterator rend() const;
+
  private:
   /**
    * @brief A Árvore AVL utilizada para armazenar os dados do conjunto.
    * * A AVL garante a ordenação e o balanceamento, resultando em operações
    * eficientes.
    */
-  AVL<T> data;
+  Tree<T, std::less<T>, Alloc> data;
 };
 
-template <class T>
-Set<T>::Set() {}
+template <class T, template <class...> class Tree, class Alloc>
+Set<T, Tree, Alloc>::Set() {}
+
+template <class T, template <class...> class Tree, class Alloc>
+Set<T, Tree, Alloc>::Set(const Alloc& alloc) : data(alloc) {}
 
-template <class T>
-bool Set<T>::insert(const T& value) {
+template <class T, template <class...> class Tree, class Alloc>
+template <class InputIt>
+Set<T, Tree, Alloc>::Set(InputIt first, InputIt last, const Alloc& alloc) : data(alloc) {
+  data.assign_sorted(first, last);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class InputIt>
+void Set<T, Tree, Alloc>::assign_sorted(InputIt first, InputIt last) {
+  data.assign_sorted(first, last);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+bool Set<T, Tree, Alloc>::insert(const T& value) {
     return data.insert(value);
 }
 
-template <class T>
-bool Set<T>::remove(const T& value) {
+template <class T, template <class...> class Tree, class Alloc>
+bool Set<T, Tree, Alloc>::insert(T&& value) {
+  return data.insert(std::move(value));
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class... Args>
+bool Set<T, Tree, Alloc>::emplace(Args&&... args) {
+  return data.emplace(std::forward<Args>(args)...);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+bool Set<T, Tree, Alloc>::remove(const T& value) {
   
     return data.remove(value);
 }
 
-template <class T>
-bool Set<T>::search(const T& value) const {
+template <class T, template <class...> class Tree, class Alloc>
+bool Set<T, Tree, Alloc>::search(const T& value) const {
   return data.contain(value);
-}
\ No newline at end of file
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+FrozenSet<T> Set<T, Tree, Alloc>::freeze() const {
+  return FrozenSet<T>(begin(), end());
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::const_iterator Set<T, Tree, Alloc>::begin() const {
+  return data.begin();
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::const_iterator Set<T, Tree, Alloc>::end() const {
+  return data.end();
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::reverse_iterator Set<T, Tree, Alloc>::rbegin() const {
+  return data.rbegin();
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::reverse_iterator Set<T, Tree, Alloc>::rend() const {
+  return data.rend();
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+std::size_t Set<T, Tree, Alloc>::size() const {
+  return data.size();
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+bool Set<T, Tree, Alloc>::empty() const {
+  return data.empty();
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+std::size_t Set<T, Tree, Alloc>::rank(const T& value) const {
+  return data.rank(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+const T& Set<T, Tree, Alloc>::select(std::size_t k) const {
+  return data.select(k);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::const_iterator Set<T, Tree, Alloc>::nth(std::size_t k) const {
+  return data.nth(k);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::const_iterator Set<T, Tree, Alloc>::lower_bound(const T& value) const {
+  return data.lower_bound(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+typename Set<T, Tree, Alloc>::const_iterator Set<T, Tree, Alloc>::upper_bound(const T& value) const {
+  return data.upper_bound(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+const T* Set<T, Tree, Alloc>::floor(const T& value) const {
+  return data.floor(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+const T* Set<T, Tree, Alloc>::ceiling(const T& value) const {
+  return data.ceiling(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+const T* Set<T, Tree, Alloc>::predecessor(const T& value) const {
+  return data.predecessor(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+const T* Set<T, Tree, Alloc>::successor(const T& value) const {
+  return data.successor(value);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class F>
+bool Set<T, Tree, Alloc>::range(const T& lo, const T& hi, F&& fn) const {
+  return data.range(lo, hi, std::forward<F>(fn));
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+std::size_t Set<T, Tree, Alloc>::count_range(const T& lo, const T& hi) const {
+  return data.count_range(lo, hi);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::union_with(const Set& other) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.union_with(copy);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::union_with(Set&& other) {
+  data.union_with(other.data);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::intersect_with(const Set& other) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.intersect_with(copy);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::intersect_with(Set&& other) {
+  data.intersect_with(other.data);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::difference_with(const Set& other) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.difference_with(copy);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::difference_with(Set&& other) {
+  data.difference_with(other.data);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::symmetric_difference_with(const Set& other) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.symmetric_difference_with(copy);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::symmetric_difference_with(Set&& other) {
+  data.symmetric_difference_with(other.data);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::union_with(const Set& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.union_with(copy, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::union_with(Set&& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  data.union_with(other.data, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::intersect_with(const Set& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.intersect_with(copy, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::intersect_with(Set&& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  data.intersect_with(other.data, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::difference_with(const Set& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.difference_with(copy, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::difference_with(Set&& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  data.difference_with(other.data, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::symmetric_difference_with(const Set& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  Tree<T, std::less<T>, Alloc> copy(data.get_allocator());
+  copy.assign_sorted(other.begin(), other.end());
+  data.symmetric_difference_with(copy, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+void Set<T, Tree, Alloc>::symmetric_difference_with(Set&& other, ForkJoinPool& pool,
+                       std::size_t grain) {
+  data.symmetric_difference_with(other.data, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class InputIt>
+void Set<T, Tree, Alloc>::insert_batch(InputIt first, InputIt last) {
+  data.insert_batch(first, last);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class InputIt>
+void Set<T, Tree, Alloc>::insert_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                       std::size_t grain) {
+  data.insert_batch(first, last, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class InputIt>
+void Set<T, Tree, Alloc>::erase_batch(InputIt first, InputIt last) {
+  data.erase_batch(first, last);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+template <class InputIt>
+void Set<T, Tree, Alloc>::erase_batch(InputIt first, InputIt last, ForkJoinPool& pool,
+                       std::size_t grain) {
+  data.erase_batch(first, last, pool, grain);
+}
+
+template <class T, template <class...> class Tree, class Alloc>
+std::vector<bool> Set<T, Tree, Alloc>::apply_batch(
+    const std::vector<BatchOp<T>>& ops) {
+  return data.apply_batch(ops);
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "map.hpp"
+#include "pool.hpp"
+
+/**
+ * @brief Mapa associativo para uso concorrente, dividido em `N` partes
+ * (shards) independentes.
+ *
+ * Cada chave pertence a uma única parte, escolhida pelo hash da chave. Cada
+ * parte é um `Map` com trava e alocador próprios, alinhada a uma linha de
+ * cache para que partes vizinhas não disputem a mesma linha (false sharing).
+ * Operações em chaves de partes diferentes não se bloqueiam; com `N` bem
+ * maior que o número de threads, a disputa por trava fica rara.
+ *
+ * Como um valor só pode ser usado com a trava da sua parte, nada retorna
+ * referências soltas: `operator[]` retorna um `Accessor`, que segura a
+ * trava enquanto existir, e `find` retorna uma cópia.
+ *
+ * @tparam K Tipo da chave. Deve suportar o operador '<' e `Hash`.
+ * @tparam V Tipo do valor associado à chave.
+ * @tparam N Quantidade de partes.
+ * @tparam Hash Função de hash das chaves.
+ * @tparam Alloc Alocador de cada parte. Cada parte constrói o seu, então o
+ * padrão `PoolAllocator` dá a cada uma a sua reserva de nós, sem disputa
+ * pelo alocador global.
+ */
+template <class K, class V, std::size_t N = 16, class Hash = std::hash<K>,
+          class Alloc = PoolAllocator<std::pair<const K, V>>>
+class ShardedMap {
+  static_assert(N > 0, "ShardedMap precisa de pelo menos uma parte");
+
+ public:
+  /// Tipo do mapa de cada parte.
+  using ShardMap = Map<K, V, AVL, Alloc>;
+
+  /// Quantidade de partes.
+  static constexpr std::size_t shard_count = N;
+
+  /**
+   * @brief Acesso exclusivo ao valor de uma chave.
+   *
+   * Segura a trava da parte da chave até ser destruído. Como a trava não é
+   * recursiva, a mesma thread não pode acessar outra chave do mapa enquanto
+   * o `Accessor` existir (por exemplo, `map[a] = map[b]` pode travar).
+   */
+  class Accessor {
+   public:
+    Accessor(std::unique_lock<std::mutex> lock, V& value)
+        : lock(std::move(lock)), value(&value) {}
+
+    /**
+     * @brief Atribui um novo valor.
+     */
+    template <class M>
+    Accessor& operator=(M&& other) {
+      *value = std::forward<M>(other);
+      return *this;
+    }
+
+    V& get() const { return *value; }
+    operator V&() const { return *value; }
+    V& operator*() const { return *value; }
+    V* operator->() const { return value; }
+
+   private:
+    std::unique_lock<std::mutex> lock;  ///< Trava da parte.
+    V* value;                           ///< Valor acessado.
+  };
+
+  /**
+   * @brief Construtor padrão. Cria um mapa vazio.
+   */
+  ShardedMap() = default;
+
+  ShardedMap(const ShardedMap&) = delete;
+  ShardedMap& operator=(const ShardedMap&) = delete;
+
+  /**
+   * @brief Acessa o valor de uma chave, inserindo um `V` padrão se ela não
+   * existir.
+   *
+   * @return Um `Accessor` que segura a trava da parte da chave.
+   */
+  Accessor operator[](const K& key) {
+    Shard& shard = shard_of(key);
+    std::unique_lock<std::mutex> lock(shard.mutex);
+    V& value = shard.map[key];
+    return Accessor(std::move(lock), value);
+  }
+
+  /**
+   * @brief Remove uma chave e o valor associado.
+   *
+   * @return `true` se a chave existia.
+   */
+  bool remove(const K& key) {
+    Shard& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.remove(key);
+  }
+
+  /**
+   * @brief Insere o par ou, se a chave já existir, atribui o novo valor.
+   *
+   * @return `true` se o par foi inserido, `false` se houve atribuição.
+   */
+  template <class M>
+  bool insert_or_assign(const K& key, M&& value) {
+    Shard& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.insert_or_assign(key, std::forward<M>(value));
+  }
+
+  /**
+   * @brief Chama `fn(valor)` com a trava da parte, inserindo um `V` padrão
+   * antes se a chave não existir. Útil para ler e alterar atomicamente.
+   */
+  template <class F>
+  void upsert(const K& key, F&& fn) {
+    Shard& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.map.upsert(key, std::forward<F>(fn));
+  }
+
+  /**
+   * @brief Retorna uma cópia do valor associado à chave.
+   *
+   * @return O valor, ou `std::nullopt` se a chave não existir.
+   */
+  std::optional<V> find(const K& key) const {
+    const Shard& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    const V* found = shard.map.find(key);
+    if (!found) return std::nullopt;
+    return *found;
+  }
+
+  /**
+   * @brief Chama `fn(valor)` com a trava da parte, se a chave existir.
+   *
+   * @return `true` se a chave existia (e `fn` foi chamada).
+   */
+  template <class F>
+  bool visit(const K& key, F&& fn) {
+    Shard& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    V* found = shard.map.find(key);
+    if (!found) return false;
+    fn(*found);
+    return true;
+  }
+
+  /**
+   * @brief Verifica se uma chave está presente.
+   */
+  bool contain(const K& key) const {
+    const Shard& shard = shard_of(key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.map.contain(key);
+  }
+
+  /**
+   * @brief Quantidade de pares.
+   *
+   * As partes são contadas uma de cada vez: com escritas simultâneas, o
+   * resultado pode não corresponder a nenhum instante exato.
+   */
+  std::size_t size() const {
+    std::size_t total = 0;
+    for (const Shard& shard : shards) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      total += shard.map.size();
+    }
+    return total;
+  }
+
+  /**
+   * @brief Verifica se o mapa está vazio.
+   */
+  bool empty() const { return size() == 0; }
+
+  /**
+   * @brief Chama `fn(key, value)` para cada par, parte por parte.
+   *
+   * Só a parte sendo visitada fica travada, então as demais continuam
+   * disponíveis. A ordem das chaves só é crescente dentro de cada parte.
+   */
+  template <class F>
+  void for_each(F&& fn) {
+    for (Shard& shard : shards) {
+      std::lock_guard<std::mutex> lock(shard.mutex);
+      for (auto [key, value] : shard.map) fn(key, value);
+    }
+  }
+
+  /**
+   * @brief Chama `fn(key, value)` para cada par em ordem crescente de chave.
+   *
+   * Trava todas as partes (sempre na mesma ordem) e intercala os pares
+   * delas, em O(n log N). O mapa fica bloqueado durante toda a travessia,
+   * que vê um único instante dele.
+   */
+  template <class F>
+  void for_each_ordered(F&& fn);
+
+ private:
+  /**
+   * @brief Uma parte do mapa, em linhas de cache próprias.
+   */
+  struct alignas(64) Shard {
+    mutable std::mutex mutex;  ///< Trava da parte.
+    ShardMap map;              ///< Pares da parte, com alocador próprio.
+  };
+
+  Shard& shard_of(const K& key) { return shards[hash(key) % N]; }
+  const Shard& shard_of(const K& key) const { return shards[hash(key) % N]; }
+
+  std::array<Shard, N> shards;  ///< As partes.
+  Hash hash;                    ///< Escolhe a parte de cada chave.
+};
+
+template <class K, class V, std::size_t N, class Hash, class Alloc>
+template <class F>
+void ShardedMap<K, V, N, Hash, Alloc>::for_each_ordered(F&& fn) {
+  using Iterator = typename ShardMap::iterator;
+  std::array<std::unique_lock<std::mutex>, N> locks;
+  for (std::size_t i = 0; i < N; ++i) {
+    locks[i] = std::unique_lock<std::mutex>(shards[i].mutex);
+  }
+
+  // Heap de mínimo com a posição atual de cada parte não esgotada
+  std::vector<std::pair<Iterator, Iterator>> cursors;
+  cursors.reserve(N);
+  for (Shard& shard : shards) {
+    if (!shard.map.empty()) {
+      cursors.emplace_back(shard.map.begin(), shard.map.end());
+    }
+  }
+  auto greater = [](const std::pair<Iterator, Iterator>& a,
+                    const std::pair<Iterator, Iterator>& b) {
+    return (*b.first).first < (*a.first).first;
+  };
+  std::make_heap(cursors.begin(), cursors.end(), greater);
+  while (!cursors.empty()) {
+    std::pop_heap(cursors.begin(), cursors.end(), greater);
+    auto& [it, end] = cursors.back();
+    auto [key, value] = *it;
+    fn(key, value);
+    if (++it == end) {
+      cursors.pop_back();
+    } else {
+      std::push_heap(cursors.begin(), cursors.end(), greater);
+    }
+  }
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define SIMD_SEARCH_X86 1
+#else
+#define SIMD_SEARCH_X86 0
+#endif
+
+/**
+ * @brief Busca em blocos ordenados de inteiros com instruções vetoriais.
+ *
+ * Em vez de uma comparação escalar (e um desvio) por passo de uma busca
+ * binária, cada instrução compara a chave com 4 a 8 elementos do bloco de
+ * uma vez (compare-and-movemask). Em x86-64 usa AVX2 quando o processador
+ * tem (detectado na execução) e, sem AVX2, SSE2 para inteiros de 32 bits e
+ * a busca escalar para os de 64 bits. Em outras arquiteturas usa sempre a
+ * busca escalar.
+ */
+namespace simd {
+
+/**
+ * @brief Verdadeiro para os tipos com busca vetorial: inteiros de 32 ou 64
+ * bits, com ou sem sinal.
+ */
+template <class T>
+constexpr bool is_key = std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                        (sizeof(T) == 4 || sizeof(T) == 8);
+
+/**
+ * @brief Quantidade de elementos de `keys[0, n)` (em ordem crescente)
+ * menores que `key`, por busca binária.
+ */
+template <class T>
+std::size_t count_less_scalar(const T* keys, std::size_t n, T key) {
+  std::size_t lo = 0, hi = n;
+  while (lo < hi) {
+    std::size_t mid = (lo + hi) / 2;
+    if (keys[mid] < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+#if SIMD_SEARCH_X86
+namespace detail {
+
+/// Valor que, somado por XOR, leva a ordem sem sinal para a ordem com sinal
+/// das instruções de comparação.
+template <class T>
+constexpr std::make_signed_t<T> sign_flip =
+    std::is_signed_v<T> ? 0
+                        : static_cast<std::make_signed_t<T>>(
+                              std::make_unsigned_t<T>(1) << (sizeof(T) * 8 - 1));
+
+/**
+ * @brief `count_less` com AVX2: 8 elementos de 32 bits ou 4 de 64 por
+ * comparação. Como o bloco está ordenado, para no primeiro vetor que tem
+ * algum elemento maior ou igual a `key`.
+ */
+template <class T>
+__attribute__((target("avx2"))) std::size_t count_less_avx2(const T* keys,
+                                                            std::size_t n,
+                                                            T key) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  constexpr int full = (1 << lanes) - 1;
+  __m256i flip, pivot;
+  if constexpr (sizeof(T) == 4) {
+    flip = _mm256_set1_epi32(sign_flip<T>);
+    pivot = _mm256_xor_si256(_mm256_set1_epi32(static_cast<std::int32_t>(key)),
+                             flip);
+  } else {
+    flip = _mm256_set1_epi64x(sign_flip<T>);
+    pivot = _mm256_xor_si256(
+        _mm256_set1_epi64x(static_cast<std::int64_t>(key)), flip);
+  }
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    __m256i block = _mm256_xor_si256(
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i)), flip);
+    int mask;
+    if constexpr (sizeof(T) == 4) {
+      mask = _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpgt_epi32(pivot, block)));
+    } else {
+      mask = _mm256_movemask_pd(
+          _mm256_castsi256_pd(_mm256_cmpgt_epi64(pivot, block)));
+    }
+    if (mask != full) return i + __builtin_popcount(mask);
+  }
+  while (i < n && keys[i] < key) ++i;
+  return i;
+}
+
+/**
+ * @brief `count_less` com SSE2 (presente em todo x86-64), para inteiros de
+ * 32 bits: 4 elementos por comparação.
+ */
+template <class T>
+std::size_t count_less_sse2(const T* keys, std::size_t n, T key) {
+  static_assert(sizeof(T) == 4, "SSE2 não compara inteiros de 64 bits");
+  const __m128i flip = _mm_set1_epi32(sign_flip<T>);
+  const __m128i pivot =
+      _mm_xor_si128(_mm_set1_epi32(static_cast<std::int32_t>(key)), flip);
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    __m128i block = _mm_xor_si128(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i)), flip);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(pivot, block)));
+    if (mask != 0xF) return i + __builtin_popcount(mask);
+  }
+  while (i < n && keys[i] < key) ++i;
+  return i;
+}
+
+inline bool detect_avx2() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+}
+
+}  // namespace detail
+
+/// `true` se o processador tem AVX2 (verificado uma vez, na inicialização).
+inline const bool has_avx2 = detail::detect_avx2();
+#else
+inline const bool has_avx2 = false;
+#endif
+
+/**
+ * @brief Quantidade de elementos de `keys[0, n)` (em ordem crescente)
+ * menores que `key`, isto é, a posição de `std::lower_bound`.
+ *
+ * Para os tipos de `is_key`, usa a melhor variante vetorial disponível no
+ * processador; para os demais, a busca binária.
+ */
+template <class T>
+std::size_t count_less(const T* keys, std::size_t n, T key) {
+#if SIMD_SEARCH_X86
+  if constexpr (is_key<T>) {
+    if (has_avx2) return detail::count_less_avx2(keys, n, key);
+    if constexpr (sizeof(T) == 4) return detail::count_less_sse2(keys, n, key);
+  }
+#endif
+  return count_less_scalar(keys, n, key);
+}
+
+}  // namespace simd
@@ -1,5 +1,16 @@
 #include "../include/avl.hpp"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <random>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <new>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <vector>
 
 using IntAVL = AVL<int>;
@@ -134,3 +145,682 @@ TEST(AVLRotationTest, RightLeftRotation) {
     EXPECT_EQ(tree.in_order(), expected);
     EXPECT_TRUE(tree.is_balanced());
 }
+
+TEST(AVLTest, SortedInsertionStaysBalanced) {
+    IntAVL tree;
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert(i);
+    }
+    EXPECT_TRUE(tree.is_balanced());
+    for (int i = 0; i < 1000; i += 3) {
+        EXPECT_TRUE(tree.remove(i));
+    }
+    EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(AVLTest, TryEmplace) {
+    IntAVL tree;
+    for (int i = 0; i < 100; ++i) {
+        auto [value, inserted] = tree.try_emplace(i, i);
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(*value, i);
+    }
+    auto [value, inserted] = tree.try_emplace(50, 50);
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(value, tree.search(50));
+    EXPECT_TRUE(tree.is_balanced());
+}
+
+struct AbsLess {
+    using is_transparent = void;
+    bool operator()(int a, int b) const { return std::abs(a) < std::abs(b); }
+    bool operator()(int a, long b) const { return std::abs(a) < std::labs(b); }
+    bool operator()(long a, int b) const { return std::labs(a) < std::abs(b); }
+};
+
+TEST(AVLTest, CustomTransparentComparator) {
+    AVL<int, AbsLess> tree;
+    EXPECT_TRUE(tree.insert(-5));
+    EXPECT_FALSE(tree.insert(5));  // Equivalente a -5 pelo comparador
+    EXPECT_TRUE(tree.insert(3));
+    EXPECT_TRUE(tree.contain(-3));
+    EXPECT_TRUE(tree.contain(5L));
+    ASSERT_NE(tree.search(5L), nullptr);
+    EXPECT_EQ(*tree.search(5L), -5);
+    EXPECT_TRUE(tree.remove(-5L));
+    EXPECT_EQ(tree.in_order(), std::vector<int>({3}));
+}
+
+TEST(AVLTest, RandomOperationsMatchStdSet) {
+    IntAVL tree;
+    std::set<int> reference;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> key(0, 2000);
+    for (int i = 0; i < 20000; ++i) {
+        int k = key(rng);
+        if (rng() % 3 == 0) {
+            EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(k), reference.insert(k).second);
+        }
+    }
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.in_order(),
+              std::vector<int>(reference.begin(), reference.end()));
+}
+
+TEST(AVLIteratorTest, IteratesInOrderBothWays) {
+    IntAVL tree;
+    EXPECT_TRUE(tree.begin() == tree.end());
+
+    std::mt19937 rng(3);
+    for (int i = 0; i < 500; ++i) tree.insert(rng() % 1000);
+    for (int i = 0; i < 200; ++i) tree.remove(rng() % 1000);
+
+    std::vector<int> expected = tree.in_order();
+    EXPECT_EQ(std::vector<int>(tree.begin(), tree.end()), expected);
+    EXPECT_EQ(std::vector<int>(tree.rbegin(), tree.rend()),
+              std::vector<int>(expected.rbegin(), expected.rend()));
+    EXPECT_EQ(*--tree.end(), expected.back());
+    EXPECT_EQ(std::distance(tree.begin(), tree.end()),
+              static_cast<std::ptrdiff_t>(expected.size()));
+}
+
+TEST(AVLIteratorTest, WorksWithAlgorithms) {
+    IntAVL tree;
+    for (int i : {5, 1, 9, 3, 7}) tree.insert(i);
+    auto it = std::find(tree.begin(), tree.end(), 7);
+    ASSERT_TRUE(it != tree.end());
+    EXPECT_EQ(*++it, 9);
+    EXPECT_EQ(std::count_if(tree.begin(), tree.end(),
+                            [](int v) { return v > 4; }),
+              3);
+}
+
+TEST(AVLTest, ForEachMatchesVectorTraversals) {
+    IntAVL tree;
+    std::mt19937 rng(11);
+    for (int i = 0; i < 300; ++i) tree.insert(rng() % 1000);
+    for (int i = 0; i < 100; ++i) tree.remove(rng() % 1000);
+
+    std::vector<int> in, pre, post;
+    EXPECT_TRUE(tree.for_each_in_order([&](const int& v) { in.push_back(v); }));
+    EXPECT_TRUE(tree.for_each_pre_order([&](const int& v) { pre.push_back(v); }));
+    EXPECT_TRUE(tree.for_each_post_order([&](const int& v) { post.push_back(v); }));
+    EXPECT_EQ(in, tree.in_order());
+    EXPECT_EQ(pre, tree.pre_order());
+    EXPECT_EQ(post, tree.post_order());
+    EXPECT_EQ(pre.size(), in.size());
+    EXPECT_EQ(post.size(), in.size());
+}
+
+TEST(AVLTest, ForEachStopsEarly) {
+    IntAVL tree;
+    for (int i = 1; i <= 10; ++i) tree.insert(i);
+
+    int visited = 0;
+    bool completed = tree.for_each_in_order([&](int v) {
+        ++visited;
+        return v < 4;
+    });
+    EXPECT_FALSE(completed);
+    EXPECT_EQ(visited, 4);
+
+    visited = 0;
+    EXPECT_FALSE(tree.for_each_post_order([&](int) { return ++visited < 2; }));
+    EXPECT_EQ(visited, 2);
+    EXPECT_TRUE(IntAVL().for_each_pre_order([](int) { return false; }));
+}
+
+TEST(AVLTest, OrderStatisticsMatchStdSet) {
+    IntAVL tree;
+    std::set<int> reference;
+    std::mt19937 rng(5);
+    for (int i = 0; i < 2000; ++i) {
+        int v = rng() % 500;
+        if (rng() % 3 == 0) {
+            EXPECT_EQ(tree.remove(v), reference.erase(v) == 1);
+        } else {
+            EXPECT_EQ(tree.insert(v), reference.insert(v).second);
+        }
+        ASSERT_EQ(tree.size(), reference.size());
+    }
+
+    std::vector<int> sorted(reference.begin(), reference.end());
+    for (std::size_t k = 0; k < sorted.size(); ++k) {
+        EXPECT_EQ(tree.select(k), sorted[k]);
+        EXPECT_EQ(*tree.nth(k), sorted[k]);
+        EXPECT_EQ(tree.rank(sorted[k]), k);
+    }
+    for (int v = -1; v <= 501; v += 7) {
+        auto expected = std::distance(reference.begin(), reference.lower_bound(v));
+        EXPECT_EQ(tree.rank(v), static_cast<std::size_t>(expected));
+    }
+    EXPECT_TRUE(tree.nth(sorted.size()) == tree.end());
+    EXPECT_THROW(tree.select(sorted.size()), std::out_of_range);
+}
+
+TEST(AVLTest, RankWithTransparentComparator) {
+    AVL<std::string, std::less<>> tree;
+    for (const char* s : {"delta", "alpha", "charlie", "bravo"}) tree.insert(s);
+    EXPECT_EQ(tree.rank(std::string_view("c")), 2u);
+    EXPECT_EQ(tree.select(3), "delta");
+    EXPECT_FALSE(tree.empty());
+}
+
+TEST(AVLTest, RangeQueriesMatchStdSet) {
+    IntAVL tree;
+    std::set<int> reference;
+    std::mt19937 rng(9);
+    for (int i = 0; i < 500; ++i) {
+        int v = rng() % 1000;
+        tree.insert(v);
+        reference.insert(v);
+    }
+
+    for (int x = -5; x <= 1005; x += 3) {
+        auto lb = reference.lower_bound(x);
+        auto ub = reference.upper_bound(x);
+        if (lb == reference.end()) {
+            EXPECT_TRUE(tree.lower_bound(x) == tree.end());
+            EXPECT_EQ(tree.ceiling(x), nullptr);
+        } else {
+            EXPECT_EQ(*tree.lower_bound(x), *lb);
+            EXPECT_EQ(*tree.ceiling(x), *lb);
+        }
+        if (ub == reference.end()) {
+            EXPECT_EQ(tree.successor(x), nullptr);
+        } else {
+            EXPECT_EQ(*tree.upper_bound(x), *ub);
+            EXPECT_EQ(*tree.successor(x), *ub);
+        }
+        if (ub == reference.begin()) {
+            EXPECT_EQ(tree.floor(x), nullptr);
+        } else {
+            EXPECT_EQ(*tree.floor(x), *std::prev(ub));
+        }
+        if (lb == reference.begin()) {
+            EXPECT_EQ(tree.predecessor(x), nullptr);
+        } else {
+            EXPECT_EQ(*tree.predecessor(x), *std::prev(lb));
+        }
+    }
+
+    std::vector<int> seen;
+    tree.range(100, 400, [&](const int& v) { seen.push_back(v); });
+    std::vector<int> expected(reference.lower_bound(100), reference.lower_bound(400));
+    EXPECT_EQ(seen, expected);
+    EXPECT_EQ(tree.count_range(100, 400), expected.size());
+}
+
+TEST(AVLTest, AssignSortedBuildsBalancedTree) {
+    std::vector<int> sorted(1000);
+    for (int i = 0; i < 1000; ++i) sorted[i] = i * 2;
+
+    IntAVL tree;
+    tree.insert(-7);  // conteúdo anterior é descartado
+    tree.assign_sorted(sorted.begin(), sorted.end());
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.in_order(), sorted);
+    EXPECT_EQ(tree.size(), sorted.size());
+    EXPECT_EQ(tree.select(500), 1000);
+    EXPECT_FALSE(tree.contain(-7));
+
+    // As alturas precisam estar corretas para que as operações seguintes
+    // continuem balanceando a árvore
+    std::mt19937 rng(3);
+    for (int i = 0; i < 500; ++i) {
+        tree.insert(rng() % 3000);
+        tree.remove(rng() % 3000);
+    }
+    EXPECT_TRUE(tree.is_balanced());
+    std::vector<int> values = tree.in_order();
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+    EXPECT_EQ(tree.size(), values.size());
+}
+
+TEST(AVLTest, AssignSortedAcceptsUnsortedInput) {
+    std::vector<int> input = {5, 3, 9, 3, 1, 9, 7};
+    IntAVL tree;
+    tree.assign_sorted(input.begin(), input.end());
+    EXPECT_EQ(tree.in_order(), std::vector<int>({1, 3, 5, 7, 9}));
+    EXPECT_TRUE(tree.is_balanced());
+
+    tree.assign_sorted(input.end(), input.end());
+    EXPECT_TRUE(tree.empty());
+}
+
+// Verifica as invariantes de uma AVL através da interface pública
+static void ExpectValidTree(const IntAVL& tree, const std::set<int>& expected) {
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.size(), expected.size());
+    EXPECT_EQ(tree.in_order(), std::vector<int>(expected.begin(), expected.end()));
+    std::vector<int> backward(tree.rbegin(), tree.rend());
+    EXPECT_TRUE(std::equal(backward.begin(), backward.end(), expected.rbegin()));
+    for (std::size_t k = 0; k < expected.size(); k += 17) {
+        EXPECT_EQ(tree.rank(tree.select(k)), k);
+    }
+}
+
+TEST(AVLTest, JoinAndSplit) {
+    IntAVL small, large, joined;
+    for (int i = 0; i < 3; ++i) small.insert(i);
+    for (int i = 100; i < 1100; ++i) large.insert(i);
+
+    joined.join(small, 50, large);
+    EXPECT_TRUE(small.empty());
+    EXPECT_TRUE(large.empty());
+    std::set<int> expected = {0, 1, 2, 50};
+    for (int i = 100; i < 1100; ++i) expected.insert(i);
+    ExpectValidTree(joined, expected);
+
+    IntAVL left, right;
+    EXPECT_TRUE(joined.split(500, left, right));
+    EXPECT_TRUE(joined.empty());
+    ExpectValidTree(left, std::set<int>(expected.begin(), expected.find(500)));
+    ExpectValidTree(right, std::set<int>(std::next(expected.find(500)), expected.end()));
+
+    EXPECT_FALSE(left.split(75, left, right));  // divide no próprio lugar
+    ExpectValidTree(left, {0, 1, 2, 50});
+    EXPECT_EQ(right.size(), 400u);
+
+    IntAVL bad;
+    bad.insert(10);
+    EXPECT_THROW(left.join(bad, 5, right), std::invalid_argument);
+    EXPECT_EQ(bad.size(), 1u);
+    left.join(left, 70, right);  // a própria árvore como operando
+    EXPECT_TRUE(right.empty());
+    std::set<int> rejoined = {0, 1, 2, 50, 70};
+    for (int i = 100; i < 500; ++i) rejoined.insert(i);
+    ExpectValidTree(left, rejoined);
+}
+
+TEST(AVLTest, SetAlgebraMatchesStdSet) {
+    std::mt19937 rng(17);
+    for (int round = 0; round < 20; ++round) {
+        std::set<int> a, b;
+        int na = rng() % 400, nb = round % 2 ? rng() % 20 : rng() % 400;
+        for (int i = 0; i < na; ++i) a.insert(rng() % 1000);
+        for (int i = 0; i < nb; ++i) b.insert(rng() % 1000);
+
+        std::set<int> uni, inter, diff, sym;
+        std::set_union(a.begin(), a.end(), b.begin(), b.end(), std::inserter(uni, uni.end()));
+        std::set_intersection(a.begin(), a.end(), b.begin(), b.end(), std::inserter(inter, inter.end()));
+        std::set_difference(a.begin(), a.end(), b.begin(), b.end(), std::inserter(diff, diff.end()));
+        std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(), std::inserter(sym, sym.end()));
+
+        IntAVL ta, tb;
+        const std::pair<void (IntAVL::*)(IntAVL&), const std::set<int>*> ops[] = {
+            {&IntAVL::union_with, &uni},
+            {&IntAVL::intersect_with, &inter},
+            {&IntAVL::difference_with, &diff},
+            {&IntAVL::symmetric_difference_with, &sym}};
+        for (const auto& [op, expected] : ops) {
+            for (int v : a) ta.insert(v);
+            for (int v : b) tb.insert(v);
+            (ta.*op)(tb);
+            EXPECT_TRUE(tb.empty());
+            ExpectValidTree(ta, *expected);
+            ta.difference_with(ta);
+            ASSERT_TRUE(ta.empty());
+        }
+    }
+}
+
+TEST(AVLTest, ParallelSetAlgebraMatchesSerial) {
+    ForkJoinPool pool(4);
+    std::mt19937 rng(23);
+    std::vector<int> a(20000), b(5000);
+    for (int& v : a) v = rng() % 50000;
+    for (int& v : b) v = rng() % 50000;
+
+    using Op = void (IntAVL::*)(IntAVL&);
+    using ParallelOp = void (IntAVL::*)(IntAVL&, ForkJoinPool&, std::size_t);
+    const std::pair<Op, ParallelOp> ops[] = {
+        {&IntAVL::union_with, &IntAVL::union_with},
+        {&IntAVL::intersect_with, &IntAVL::intersect_with},
+        {&IntAVL::difference_with, &IntAVL::difference_with},
+        {&IntAVL::symmetric_difference_with, &IntAVL::symmetric_difference_with}};
+    for (const auto& [serial, parallel] : ops) {
+        IntAVL sa, sb, pa, pb;
+        sa.assign_sorted(a.begin(), a.end());
+        sb.assign_sorted(b.begin(), b.end());
+        pa.assign_sorted(a.begin(), a.end());
+        pb.assign_sorted(b.begin(), b.end());
+        (sa.*serial)(sb);
+        (pa.*parallel)(pb, pool, 64);
+        EXPECT_TRUE(pb.empty());
+        EXPECT_TRUE(pa.is_balanced());
+        // Mesmo algoritmo: mesmos valores e mesmo formato de árvore
+        EXPECT_EQ(pa.in_order(), sa.in_order());
+        EXPECT_EQ(pa.pre_order(), sa.pre_order());
+        EXPECT_EQ(pa.size(), sa.size());
+    }
+}
+
+TEST(AVLTest, BatchInsertAndErase) {
+    ForkJoinPool pool(3);
+    IntAVL serial, parallel;
+    std::set<int> reference;
+    std::mt19937 rng(29);
+    for (int round = 0; round < 10; ++round) {
+        std::vector<int> batch(1000);
+        for (int& v : batch) v = rng() % 20000;
+        if (round % 3 == 2) {
+            serial.erase_batch(batch.begin(), batch.end());
+            parallel.erase_batch(batch.begin(), batch.end(), pool, 32);
+            for (int v : batch) reference.erase(v);
+        } else {
+            serial.insert_batch(batch.begin(), batch.end());
+            parallel.insert_batch(batch.begin(), batch.end(), pool, 32);
+            reference.insert(batch.begin(), batch.end());
+        }
+        ExpectValidTree(serial, reference);
+        EXPECT_EQ(parallel.pre_order(), serial.pre_order());
+    }
+}
+
+// Pares comparados só pelo primeiro campo: o segundo mostra qual operação
+// forneceu o valor guardado
+struct FirstLess {
+    bool operator()(const std::pair<int, int>& a, const std::pair<int, int>& b) const {
+        return a.first < b.first;
+    }
+};
+
+TEST(AVLTest, ApplyBatchMatchesSequentialOps) {
+    using PairAVL = AVL<std::pair<int, int>, FirstLess>;
+    PairAVL tree;
+    std::map<int, int> reference;
+    std::mt19937 rng(31);
+    for (int i = 0; i < 3000; ++i) {
+        int key = rng() % 6000;
+        tree.insert({key, -1});
+        reference.emplace(key, -1);
+    }
+    for (int round = 0; round < 8; ++round) {
+        std::vector<BatchOp<std::pair<int, int>>> ops;
+        std::vector<bool> expected;
+        for (int i = 0; i < 2000; ++i) {
+            // Chaves repetidas no lote são aplicadas na ordem do lote
+            int key = rng() % (round < 4 ? 6000 : 300);
+            BatchKind kind = static_cast<BatchKind>(rng() % 3);
+            ops.push_back({kind, {key, round * 10000 + i}});
+            if (kind == BatchKind::insert) {
+                expected.push_back(reference.emplace(key, round * 10000 + i).second);
+            } else if (kind == BatchKind::assign) {
+                expected.push_back(reference.insert_or_assign(key, round * 10000 + i).second);
+            } else {
+                expected.push_back(reference.erase(key) == 1);
+            }
+        }
+        EXPECT_EQ(tree.apply_batch(ops), expected);
+        EXPECT_TRUE(tree.is_balanced());
+        EXPECT_EQ(tree.size(), reference.size());
+        std::vector<std::pair<int, int>> pairs(reference.begin(), reference.end());
+        EXPECT_EQ(tree.in_order(), pairs);
+    }
+    EXPECT_TRUE(tree.apply_batch({}).empty());
+
+    PairAVL empty;
+    std::vector<BatchOp<std::pair<int, int>>> ops = {{BatchKind::erase, {1, 0}},
+                                                     {BatchKind::assign, {1, 5}}};
+    EXPECT_EQ(empty.apply_batch(ops), std::vector<bool>({false, true}));
+    ASSERT_EQ(empty.size(), 1u);
+    EXPECT_EQ(empty.in_order().front(), std::make_pair(1, 5));
+}
+
+// Valor cuja cópia lança exceção quando `fail` é verdadeiro
+struct FragileCopy {
+    static inline bool fail = false;
+    int value;
+    explicit FragileCopy(int v) : value(v) {}
+    FragileCopy(const FragileCopy& other) : value(other.value) {
+        if (fail) throw std::runtime_error("copy");
+    }
+    FragileCopy& operator=(const FragileCopy&) = default;
+    bool operator<(const FragileCopy& other) const { return value < other.value; }
+};
+
+// Alocador com estado que se propaga na atribuição por cópia: cópias e
+// rebinds são iguais entre si, mas cada um construído por padrão é diferente.
+// Lança `std::bad_alloc` quando `failing_budget` chega a zero (-1: sem limite).
+inline int failing_budget = -1;
+
+template <class T>
+struct FailingAllocator {
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    std::shared_ptr<int> id = std::make_shared<int>();
+
+    FailingAllocator() = default;
+    template <class U>
+    FailingAllocator(const FailingAllocator<U>& other) noexcept : id(other.id) {}
+
+    T* allocate(std::size_t n) {
+        if (failing_budget == 0) throw std::bad_alloc();
+        if (failing_budget > 0) --failing_budget;
+        return std::allocator<T>().allocate(n);
+    }
+    void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+    template <class U>
+    bool operator==(const FailingAllocator<U>& other) const { return id == other.id; }
+    template <class U>
+    bool operator!=(const FailingAllocator<U>& other) const { return id != other.id; }
+};
+
+using FailingAVL = AVL<int, std::less<int>, FailingAllocator<int>>;
+
+TEST(AVLTest, ApplyBatchLeavesTreeIntactOnException) {
+    AVL<FragileCopy> tree;
+    for (int i = 0; i < 100; ++i) tree.insert(FragileCopy(i * 2));
+    std::vector<BatchOp<FragileCopy>> ops;
+    for (int i = 0; i < 50; ++i) {
+        ops.push_back({BatchKind::erase, FragileCopy(i * 4)});
+        ops.push_back({BatchKind::insert, FragileCopy(i * 4 + 1)});
+    }
+    FragileCopy::fail = true;
+    EXPECT_THROW(tree.apply_batch(ops), std::runtime_error);
+    FragileCopy::fail = false;
+    EXPECT_EQ(tree.size(), 100u);
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.in_order().front().value, 0);
+}
+
+// Comparador de ponteiros pelo valor apontado, para testar tipos só movíveis
+struct PointeeLess {
+    bool operator()(const std::unique_ptr<int>& a, const std::unique_ptr<int>& b) const {
+        return *a < *b;
+    }
+};
+
+TEST(AVLTest, MoveOnlyValues) {
+    AVL<std::unique_ptr<int>, PointeeLess> tree;
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_TRUE(tree.insert(std::make_unique<int>((i * 37) % 100)));
+    }
+    EXPECT_FALSE(tree.emplace(new int(5)));
+    EXPECT_TRUE(tree.emplace(new int(100)));
+
+    auto probe = std::make_unique<int>(42);
+    EXPECT_TRUE(tree.contain(probe));
+    EXPECT_TRUE(tree.remove(probe));  // remoções com dois filhos religam nós
+    for (int i = 0; i < 100; i += 3) {
+        *probe = i;
+        tree.remove(probe);
+    }
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.size(), 101u - 34);  // 42 também é múltiplo de 3
+
+    int expected = 0, checked = 0;
+    for (const auto& value : tree) {
+        while (expected == 42 || expected % 3 == 0) ++expected;
+        EXPECT_EQ(*value, expected++);
+        ++checked;
+    }
+    EXPECT_EQ(checked, 67);
+}
+
+// Comparador que lança exceção quando `fail` é verdadeiro
+struct FragileLess {
+    static inline bool fail = false;
+    bool operator()(const std::shared_ptr<int>& a, const std::shared_ptr<int>& b) const {
+        if (fail) throw std::runtime_error("compare");
+        return *a < *b;
+    }
+};
+
+TEST(AVLTest, EmplaceReleasesNodeOnException) {
+    AVL<std::shared_ptr<int>, FragileLess> tree;
+    for (int i = 0; i < 10; ++i) tree.insert(std::make_shared<int>(i));
+    auto value = std::make_shared<int>(42);
+    FragileLess::fail = true;
+    EXPECT_THROW(tree.emplace(value), std::runtime_error);
+    FragileLess::fail = false;
+    EXPECT_EQ(value.use_count(), 1);  // o nó criado foi liberado
+    EXPECT_EQ(tree.size(), 10u);
+    EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(AVLTest, RemoveKeepsOtherValuesInPlace) {
+    IntAVL tree;
+    std::mt19937 rng(31);
+    std::vector<int> values(500);
+    for (int i = 0; i < 500; ++i) values[i] = i;
+    std::shuffle(values.begin(), values.end(), rng);
+    for (int v : values) tree.insert(v);
+
+    std::vector<const int*> addresses(500);
+    for (int v = 0; v < 500; ++v) addresses[v] = tree.search(v);
+    for (int v = 0; v < 500; v += 2) tree.remove(v);
+    for (int v = 1; v < 500; v += 2) EXPECT_EQ(tree.search(v), addresses[v]);
+    EXPECT_TRUE(tree.is_balanced());
+    EXPECT_EQ(tree.size(), 250u);
+}
+
+TEST(AVLTest, CopyClonesStructure) {
+    IntAVL original;
+    std::mt19937 rng(37);
+    for (int i = 0; i < 1000; ++i) original.insert(rng() % 5000);
+    for (int i = 0; i < 300; ++i) original.remove(rng() % 5000);
+
+    IntAVL copy(original);
+    EXPECT_EQ(copy.pre_order(), original.pre_order());  // mesmo formato
+    EXPECT_EQ(copy.size(), original.size());
+    EXPECT_NE(copy.search(copy.select(0)), original.search(original.select(0)));
+
+    // As alturas copiadas continuam corretas nas operações seguintes
+    for (int i = 0; i < 500; ++i) {
+        copy.insert(rng() % 5000);
+        copy.remove(rng() % 5000);
+    }
+    EXPECT_TRUE(copy.is_balanced());
+    EXPECT_EQ(copy.rank(copy.select(100)), 100u);
+
+    IntAVL assigned;
+    assigned.insert(-1);
+    assigned = original;
+    EXPECT_EQ(assigned.pre_order(), original.pre_order());
+    assigned = assigned;  // auto-atribuição
+    EXPECT_EQ(assigned.size(), original.size());
+}
+
+TEST(AVLTest, CopyAssignmentLeavesTreeIntactOnException) {
+    FailingAVL x, y;  // alocadores diferentes, que se propagam na cópia
+    for (int i = 0; i < 100; ++i) x.insert(i);
+    for (int i = 0; i < 50; ++i) y.insert(-i);
+
+    failing_budget = 10;
+    EXPECT_THROW(x = y, std::bad_alloc);
+    failing_budget = -1;
+    EXPECT_EQ(x.size(), 100u);
+    EXPECT_TRUE(x.is_balanced());
+    EXPECT_TRUE(x.get_allocator() != y.get_allocator());
+
+    x = y;
+    EXPECT_EQ(x.pre_order(), y.pre_order());
+    EXPECT_TRUE(x.get_allocator() == y.get_allocator());
+}
+
+TEST(AVLTest, JoinLeavesTreesIntactOnException) {
+    FailingAVL a, b, c;  // três alocadores diferentes
+    for (int i = 0; i < 100; ++i) a.insert(i);
+    for (int i = 200; i < 300; ++i) c.insert(i);
+    b.insert(1000);
+
+    // falha na cópia de `a`, na de `c` e, por fim, na do pivô
+    for (int budget : {50, 150, 200}) {
+        failing_budget = budget;
+        EXPECT_THROW(b.join(a, 150, c), std::bad_alloc);
+        failing_budget = -1;
+        EXPECT_EQ(a.size(), 100u);
+        EXPECT_EQ(c.size(), 100u);
+        EXPECT_EQ(b.in_order(), std::vector<int>({1000}));
+        EXPECT_TRUE(a.is_balanced());
+        EXPECT_TRUE(c.is_balanced());
+    }
+
+    // com o mesmo alocador os nós de `same` não saem dela antes do fim
+    FailingAVL same(b.get_allocator());
+    for (int i = 0; i < 100; ++i) same.insert(i);
+    const int* first = same.search(0);
+    failing_budget = 100;
+    EXPECT_THROW(b.join(same, 150, c), std::bad_alloc);
+    failing_budget = -1;
+    EXPECT_EQ(same.search(0), first);
+    EXPECT_EQ(same.size(), 100u);
+
+    b.join(a, 150, c);
+    EXPECT_EQ(b.size(), 201u);
+    EXPECT_TRUE(a.empty());
+    EXPECT_TRUE(c.empty());
+    EXPECT_TRUE(b.is_balanced());
+}
+
+TEST(AVLTest, SplitLeavesTreesIntactOnException) {
+    FailingAVL tree, left, right;  // três alocadores diferentes
+    for (int i = 0; i < 200; ++i) tree.insert(i);
+    left.insert(-1);
+    right.insert(1000);
+
+    // falha na cópia da metade esquerda e na da direita
+    for (int budget : {50, 150}) {
+        failing_budget = budget;
+        EXPECT_THROW(tree.split(100, left, right), std::bad_alloc);
+        failing_budget = -1;
+        EXPECT_EQ(tree.size(), 200u);
+        EXPECT_EQ(tree.rank(100), 100u);
+        EXPECT_TRUE(tree.is_balanced());
+        EXPECT_EQ(left.in_order(), std::vector<int>({-1}));
+        EXPECT_EQ(right.in_order(), std::vector<int>({1000}));
+    }
+
+    EXPECT_TRUE(tree.split(100, left, right));
+    EXPECT_TRUE(tree.empty());
+    EXPECT_EQ(left.size(), 100u);
+    EXPECT_EQ(right.size(), 99u);
+    EXPECT_EQ(right.select(0), 101);
+}
+
+TEST(AVLTest, MoveAndSwapAreConstantTime) {
+    IntAVL a, b;
+    for (int i = 0; i < 100; ++i) a.insert(i);
+    const int* first = a.search(0);
+
+    IntAVL moved(std::move(a));
+    EXPECT_TRUE(a.empty());  // NOLINT: o original continua utilizável
+    EXPECT_EQ(moved.search(0), first);  // os nós foram tomados, não copiados
+    a.insert(7);
+    EXPECT_EQ(a.size(), 1u);
+
+    b = std::move(moved);
+    EXPECT_EQ(b.search(0), first);
+    EXPECT_TRUE(moved.empty());  // NOLINT
+
+    swap(a, b);
+    EXPECT_EQ(a.size(), 100u);
+    EXPECT_EQ(b.in_order(), std::vector<int>({7}));
+    EXPECT_EQ(a.search(0), first);
+    EXPECT_EQ(*--a.end(), 99);
+}
@@ -0,0 +1,297 @@
+#include "../include/avl.hpp"
+#include "../include/map.hpp"
+#include "../include/set.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <climits>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+// As mesmas verificações para cada política de balanceamento
+template <class Tree>
+void expect_valid(const Tree& tree, const std::set<int>& expected) {
+  EXPECT_TRUE(tree.is_balanced());
+  ASSERT_EQ(tree.size(), expected.size());
+  EXPECT_TRUE(std::equal(tree.begin(), tree.end(), expected.begin()));
+  EXPECT_TRUE(std::equal(tree.rbegin(), tree.rend(), expected.rbegin()));
+  std::size_t i = 0;
+  for (int v : expected) {
+    if (i % 97 == 0) {
+      EXPECT_EQ(tree.select(i), v);
+      EXPECT_EQ(tree.rank(v), i);
+    }
+    ++i;
+  }
+}
+
+template <class Tree>
+void random_operations_match_std_set(unsigned seed) {
+  Tree tree;
+  std::set<int> reference;
+  std::mt19937 rng(seed);
+  for (int i = 0; i < 40000; ++i) {
+    int k = rng() % 5000;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+    } else {
+      EXPECT_EQ(tree.insert(k), reference.insert(k).second);
+    }
+    if (i % 5000 == 0) {
+      EXPECT_TRUE(tree.is_balanced());
+    }
+  }
+  expect_valid(tree, reference);
+
+  std::vector<int> keys(reference.begin(), reference.end());
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(tree.remove(keys[i]));
+    if (i % 500 == 0) {
+      EXPECT_TRUE(tree.is_balanced());
+    }
+  }
+  EXPECT_TRUE(tree.empty());
+
+  // Chaves em ordem, o pior caso das árvores sem balanceamento
+  for (int i = 0; i < 10000; ++i) tree.insert(i);
+  for (int i = 0; i < 10000; i += 3) tree.remove(i);
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), 6666u);
+}
+
+TEST(BalanceTest, RandomOperationsMatchStdSet) {
+  random_operations_match_std_set<AVL<int>>(1);
+  random_operations_match_std_set<RedBlackTree<int>>(2);
+  random_operations_match_std_set<WAVLTree<int>>(3);
+  random_operations_match_std_set<Treap<int>>(4);
+}
+
+template <class Tree>
+void assign_sorted_is_balanced() {
+  for (int n = 0; n <= 300; ++n) {
+    std::vector<int> values(n);
+    for (int i = 0; i < n; ++i) values[i] = 2 * i;
+    Tree tree;
+    tree.assign_sorted(values.begin(), values.end());
+    EXPECT_TRUE(tree.is_balanced()) << "n = " << n;
+    // A árvore construída continua válida depois de atualizações
+    tree.insert(-1);
+    tree.insert(2 * n + 1);
+    tree.remove(n);
+    EXPECT_TRUE(tree.is_balanced()) << "n = " << n;
+  }
+}
+
+TEST(BalanceTest, AssignSortedIsBalanced) {
+  assign_sorted_is_balanced<AVL<int>>();
+  assign_sorted_is_balanced<RedBlackTree<int>>();
+  assign_sorted_is_balanced<WAVLTree<int>>();
+  assign_sorted_is_balanced<Treap<int>>();
+}
+
+template <class Tree>
+void join_split_and_set_algebra() {
+  std::mt19937 rng(11);
+  for (int round = 0; round < 30; ++round) {
+    // Lados de tamanhos bem diferentes, para descer pela espinha
+    std::set<int> small, large;
+    int na = rng() % (round % 2 ? 10 : 2000);
+    int nb = rng() % (round % 3 ? 2000 : 10);
+    Tree left, right, joined;
+    for (int i = 0; i < na; ++i) {
+      int v = rng() % 10000;
+      left.insert(v);
+      small.insert(v);
+    }
+    for (int i = 0; i < nb; ++i) {
+      int v = 10001 + rng() % 10000;
+      right.insert(v);
+      large.insert(v);
+    }
+    joined.join(left, 10000, right);
+    std::set<int> expected(small);
+    expected.insert(large.begin(), large.end());
+    expected.insert(10000);
+    expect_valid(joined, expected);
+
+    int key = rng() % 20000;
+    Tree lower, upper;
+    EXPECT_EQ(joined.split(key, lower, upper), expected.count(key) == 1);
+    expect_valid(lower, std::set<int>(expected.begin(), expected.lower_bound(key)));
+    expect_valid(upper, std::set<int>(expected.upper_bound(key), expected.end()));
+
+    std::set<int> a(lower.begin(), lower.end()), b(large);
+    std::set<int> uni, sym;
+    std::set_union(a.begin(), a.end(), b.begin(), b.end(),
+                   std::inserter(uni, uni.end()));
+    std::set_symmetric_difference(a.begin(), a.end(), b.begin(), b.end(),
+                                  std::inserter(sym, sym.end()));
+    Tree ta, tb;
+    ta.assign_sorted(a.begin(), a.end());
+    for (int v : b) tb.insert(v);
+    Tree tc(ta), td(tb);
+    ta.union_with(tb);
+    expect_valid(ta, uni);
+    tc.symmetric_difference_with(td);
+    expect_valid(tc, sym);
+  }
+}
+
+TEST(BalanceTest, JoinSplitAndSetAlgebra) {
+  join_split_and_set_algebra<AVL<int>>();
+  join_split_and_set_algebra<RedBlackTree<int>>();
+  join_split_and_set_algebra<WAVLTree<int>>();
+  join_split_and_set_algebra<Treap<int>>();
+}
+
+template <class Tree>
+void apply_batch_matches_sequential_ops() {
+  Tree tree;
+  std::set<int> reference;
+  std::mt19937 rng(29);
+  for (int round = 0; round < 6; ++round) {
+    std::vector<BatchOp<int>> ops;
+    for (int i = 0; i < 3000; ++i) {
+      int key = rng() % 5000;
+      BatchKind kind = rng() % 3 ? BatchKind::insert : BatchKind::erase;
+      ops.push_back({kind, key});
+      if (kind == BatchKind::insert) {
+        reference.insert(key);
+      } else {
+        reference.erase(key);
+      }
+    }
+    tree.apply_batch(ops);
+    expect_valid(tree, reference);
+  }
+}
+
+TEST(BalanceTest, ApplyBatch) {
+  apply_batch_matches_sequential_ops<AVL<int>>();
+  apply_batch_matches_sequential_ops<RedBlackTree<int>>();
+  apply_batch_matches_sequential_ops<WAVLTree<int>>();
+  apply_batch_matches_sequential_ops<Treap<int>>();
+}
+
+TEST(BalanceTest, SetAndMapBackends) {
+  Set<int, RedBlackTree> set;
+  for (int i = 0; i < 1000; ++i) set.insert(i * 7 % 1000);
+  EXPECT_TRUE(set.remove(500));
+  EXPECT_EQ(set.size(), 999u);
+  EXPECT_EQ(*set.begin(), 0);
+
+  Map<int, std::string, WAVLTree> wavlMap;
+  Map<int, std::string, Treap> treapMap;
+  for (int i = 0; i < 1000; ++i) {
+    wavlMap[i] = std::to_string(i);
+    treapMap[i] = std::to_string(i);
+  }
+  EXPECT_TRUE(wavlMap.remove(500));
+  EXPECT_TRUE(treapMap.remove(500));
+  EXPECT_FALSE(treapMap.contain(500));
+  EXPECT_EQ(wavlMap[499], "499");
+  EXPECT_EQ(treapMap[501], "501");
+  EXPECT_EQ(treapMap.size(), 999u);
+}
+
+// Treap em que cada nó novo tem prioridade menor que a de todos os
+// anteriores: chaves crescentes formam uma lista à direita
+struct DescendingTreap : TreapBalance {
+  static inline int next = INT_MAX;
+  static int initial_rank() { return next--; }
+};
+
+TEST(BalanceTest, TreapDeeperThanStackPath) {
+  // Caminhos mais longos que `max_height` passam da pilha para o heap
+  AVL<int, std::less<int>, std::allocator<int>, DescendingTreap> tree;
+  std::set<int> reference;
+  const int n = 4 * TreapBalance::max_height;
+  for (int i = 0; i < n; ++i) {
+    EXPECT_TRUE(tree.insert(2 * i));
+    reference.insert(2 * i);
+  }
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_FALSE(tree.insert(2 * n - 2));
+  EXPECT_TRUE(tree.try_emplace(2 * n, 2 * n).second);
+  reference.insert(2 * n);
+
+  // Folhas à esquerda no fundo da lista, e remoções de nós com dois filhos
+  // e com um só
+  for (int i = n - 10; i < n; ++i) {
+    EXPECT_TRUE(tree.insert(2 * i + 1));
+    reference.insert(2 * i + 1);
+  }
+  for (int key : {2 * n - 8, 2 * n - 4, 2 * n - 40, 2 * n}) {
+    EXPECT_TRUE(tree.remove(key));
+    reference.erase(key);
+  }
+  EXPECT_FALSE(tree.remove(2 * n + 2));
+  expect_valid(tree, reference);
+}
+
+// Rotações por operação no pior caso e trabalho médio da correção, que
+// para onde o posto da subárvore deixa de mudar
+template <class Policy>
+void rebalancing_work_is_bounded(std::size_t max_insert_rotations,
+                                 std::size_t max_remove_rotations) {
+  AVL<int, std::less<int>, std::allocator<int>, CountingBalance<Policy>> tree;
+  std::mt19937 rng(13);
+  std::vector<int> keys(20000);
+  for (std::size_t i = 0; i < keys.size(); ++i) keys[i] = static_cast<int>(i);
+  std::shuffle(keys.begin(), keys.end(), rng);
+  BalanceStats& stats = BalanceStats::current();
+  stats = BalanceStats();
+  for (int key : keys) {
+    std::size_t rotations = stats.rotations;
+    tree.insert(key);
+    EXPECT_LE(stats.rotations - rotations, max_insert_rotations);
+  }
+  EXPECT_LT(stats.fixups, 4 * keys.size());
+  std::shuffle(keys.begin(), keys.end(), rng);
+  stats = BalanceStats();
+  for (int key : keys) {
+    std::size_t rotations = stats.rotations;
+    tree.remove(key);
+    EXPECT_LE(stats.rotations - rotations, max_remove_rotations);
+  }
+  EXPECT_LT(stats.fixups, 4 * keys.size());
+  EXPECT_TRUE(tree.empty());
+}
+
+TEST(BalanceTest, AVLRotationRecomputesOnlyDemotedHeights) {
+  AVL<int, std::less<int>, std::allocator<int>, CountingBalance<AVLBalance>>
+      tree;
+  BalanceStats& stats = BalanceStats::current();
+  tree.insert(1);
+  tree.insert(2);
+  stats = BalanceStats();
+  tree.insert(3);  // rotação simples em 1
+  EXPECT_EQ(stats.rotations, 1u);
+  std::size_t single = stats.rank_updates;
+
+  tree.insert(5);
+  stats = BalanceStats();
+  tree.insert(4);  // rotação dupla em 3
+  EXPECT_EQ(stats.rotations, 2u);
+  // A dupla recalcula um nó rebaixado a mais que a simples
+  EXPECT_EQ(stats.rank_updates, single + 1);
+  EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(BalanceTest, RebalancingStopsEarly) {
+  // A remoção da AVL pode girar em cada nível (rotações duplas, altura
+  // abaixo de 20 aqui)
+  rebalancing_work_is_bounded<AVLBalance>(2, 2 * 20);
+  rebalancing_work_is_bounded<RedBlackBalance>(2, 3);
+  rebalancing_work_is_bounded<WAVLBalance>(2, 2);
+
+  // Sem `CountingBalance`, a mesma política não conta nada
+  BalanceStats& stats = BalanceStats::current();
+  stats = BalanceStats();
+  AVL<int> plain;
+  for (int i = 0; i < 1000; ++i) plain.insert(i);
+  EXPECT_EQ(stats.fixups + stats.rank_updates + stats.rotations, 0u);
+}
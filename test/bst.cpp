@@ -2,6 +2,14 @@
 
 #include <gtest/gtest.h>
 
+#include <functional>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
 // ---------- Casos Gerais ----------
 
 TEST(BSTTest, InserirEEncontrarElementos) {
@@ -180,4 +188,264 @@ TEST(BSTTest, PostOrderTraversal) {
   std::vector<int> expected = {3, 7, 5, 15, 10};
 
   EXPECT_EQ(result, expected);
-}
\ No newline at end of file
+}
+TEST(BSTTest, TryEmplace) {
+  BST<int> tree;
+  auto [value, inserted] = tree.try_emplace(10, 10);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(*value, 10);
+  auto [same, inserted_again] = tree.try_emplace(10, 10);
+  EXPECT_FALSE(inserted_again);
+  EXPECT_EQ(same, value);
+  EXPECT_EQ(tree.search(10), value);
+}
+
+TEST(BSTTest, ComparadorTransparente) {
+  BST<std::string, std::less<>> tree;
+  tree.insert("abc");
+  tree.insert("def");
+  EXPECT_TRUE(tree.contain(std::string_view("def")));
+  EXPECT_FALSE(tree.contain(std::string_view("de")));
+  ASSERT_NE(tree.search(std::string_view("abc")), nullptr);
+  EXPECT_TRUE(tree.remove(std::string_view("abc")));
+  EXPECT_FALSE(tree.contain(std::string("abc")));
+}
+
+TEST(BSTTest, ArvoreDegeneradaProfunda) {
+  // Chaves em ordem formam uma "lista"; nada pode depender de recursão
+  const int n = 20000;
+  BST<int> tree;
+  for (int i = 0; i < n; ++i) {
+    ASSERT_TRUE(tree.insert(i));
+  }
+  EXPECT_TRUE(tree.contain(n - 1));
+  EXPECT_FALSE(tree.contain(n));
+  EXPECT_EQ(tree.in_order().size(), static_cast<std::size_t>(n));
+  EXPECT_EQ(tree.pre_order().front(), 0);
+  EXPECT_EQ(tree.post_order().front(), n - 1);
+  EXPECT_TRUE(tree.remove(n - 1));
+  EXPECT_TRUE(tree.remove(0));
+  EXPECT_FALSE(tree.contain(n - 1));
+}
+
+TEST(BSTTest, Iteradores) {
+  BST<int> tree;
+  for (int i : {10, 5, 15, 3, 7, 12, 18}) tree.insert(i);
+  tree.remove(10);
+
+  std::vector<int> forward(tree.begin(), tree.end());
+  EXPECT_EQ(forward, tree.in_order());
+  std::vector<int> backward(tree.rbegin(), tree.rend());
+  EXPECT_EQ(backward, std::vector<int>({18, 15, 12, 7, 5, 3}));
+
+  auto it = tree.end();
+  --it;
+  EXPECT_EQ(*it, 18);
+  it = tree.begin();
+  it++;
+  EXPECT_EQ(*it, 5);
+}
+
+TEST(BSTTest, ForEachComParadaAntecipada) {
+  BST<int> tree;
+  for (int i : {10, 5, 15, 3, 7, 12, 18}) tree.insert(i);
+
+  std::vector<int> pre;
+  EXPECT_TRUE(tree.for_each_pre_order([&](const int& v) { pre.push_back(v); }));
+  EXPECT_EQ(pre, std::vector<int>({10, 5, 3, 7, 15, 12, 18}));
+
+  std::vector<int> post;
+  EXPECT_TRUE(tree.for_each_post_order([&](const int& v) { post.push_back(v); }));
+  EXPECT_EQ(post, std::vector<int>({3, 7, 5, 12, 18, 15, 10}));
+
+  std::vector<int> in;
+  EXPECT_FALSE(tree.for_each_in_order([&](const int& v) {
+    in.push_back(v);
+    return v != 10;
+  }));
+  EXPECT_EQ(in, std::vector<int>({3, 5, 7, 10}));
+}
+
+TEST(BSTTest, TamanhoRankESelect) {
+  BST<int> tree;
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.size(), 0u);
+  EXPECT_THROW(tree.select(0), std::out_of_range);
+
+  for (int v : {50, 30, 70, 20, 40, 60, 80, 30}) tree.insert(v);
+  EXPECT_FALSE(tree.empty());
+  EXPECT_EQ(tree.size(), 7u);
+  EXPECT_EQ(tree.rank(20), 0u);
+  EXPECT_EQ(tree.rank(45), 3u);
+  EXPECT_EQ(tree.rank(100), 7u);
+  EXPECT_EQ(tree.select(0), 20);
+  EXPECT_EQ(tree.select(3), 50);
+  EXPECT_EQ(tree.select(6), 80);
+  EXPECT_THROW(tree.select(7), std::out_of_range);
+
+  tree.remove(50);  // dois filhos: o sucessor é religado
+  tree.remove(20);  // folha
+  tree.remove(99);  // inexistente
+  EXPECT_EQ(tree.size(), 5u);
+  EXPECT_EQ(tree.select(2), 60);
+  EXPECT_EQ(tree.rank(60), 2u);
+
+  auto it = tree.nth(1);
+  EXPECT_EQ(*it, 40);
+  EXPECT_EQ(*++it, 60);
+  EXPECT_TRUE(tree.nth(5) == tree.end());
+}
+
+TEST(BSTTest, ConsultasPorIntervalo) {
+  BST<int> tree;
+  for (int v : {50, 30, 70, 20, 40, 60, 80}) tree.insert(v);
+
+  EXPECT_EQ(*tree.lower_bound(40), 40);
+  EXPECT_EQ(*tree.lower_bound(41), 50);
+  EXPECT_EQ(*tree.upper_bound(40), 50);
+  EXPECT_TRUE(tree.lower_bound(81) == tree.end());
+  EXPECT_TRUE(tree.upper_bound(80) == tree.end());
+
+  EXPECT_EQ(*tree.floor(45), 40);
+  EXPECT_EQ(*tree.floor(40), 40);
+  EXPECT_EQ(tree.floor(19), nullptr);
+  EXPECT_EQ(*tree.ceiling(45), 50);
+  EXPECT_EQ(tree.ceiling(81), nullptr);
+  EXPECT_EQ(*tree.predecessor(40), 30);
+  EXPECT_EQ(tree.predecessor(20), nullptr);
+  EXPECT_EQ(*tree.successor(40), 50);
+  EXPECT_EQ(tree.successor(80), nullptr);
+
+  std::vector<int> seen;
+  EXPECT_TRUE(tree.range(30, 70, [&](int v) { seen.push_back(v); }));
+  EXPECT_EQ(seen, std::vector<int>({30, 40, 50, 60}));
+  EXPECT_EQ(tree.count_range(30, 70), 4u);
+  EXPECT_EQ(tree.count_range(70, 30), 0u);
+  EXPECT_FALSE(tree.range(0, 100, [](int v) { return v < 40; }));
+}
+
+TEST(BSTTest, AssignSortedMontaArvoreDeAlturaMinima) {
+  std::vector<int> input = {4, 1, 3, 1, 2, 7, 6, 5};
+  BST<int> tree;
+  tree.assign_sorted(input.begin(), input.end());
+  EXPECT_EQ(tree.in_order(), std::vector<int>({1, 2, 3, 4, 5, 6, 7}));
+  EXPECT_EQ(tree.pre_order(), std::vector<int>({4, 2, 1, 3, 6, 5, 7}));
+  EXPECT_EQ(tree.size(), 7u);
+
+  tree.insert(8);
+  tree.remove(4);
+  EXPECT_EQ(tree.in_order(), std::vector<int>({1, 2, 3, 5, 6, 7, 8}));
+  EXPECT_EQ(tree.rank(6), 4u);
+}
+
+TEST(BSTTest, RemocaoReligaOSucessorSemCopiar) {
+  BST<int> tree;
+  for (int v : {50, 30, 70, 60, 80, 65}) tree.insert(v);
+  const int* successor = tree.search(60);
+  ASSERT_NE(successor, nullptr);
+
+  EXPECT_TRUE(tree.remove(50));  // dois filhos: 60 sobe para o lugar do 50
+  EXPECT_EQ(tree.search(60), successor);
+  EXPECT_EQ(tree.pre_order(), std::vector<int>({60, 30, 70, 65, 80}));
+  EXPECT_EQ(tree.size(), 5u);
+  EXPECT_EQ(tree.select(1), 60);
+}
+
+TEST(BSTTest, InsercaoPorMovimentoEEmplace) {
+  BST<std::string, std::less<>> tree;
+  std::string value = "abc";
+  EXPECT_TRUE(tree.insert(std::move(value)));
+  EXPECT_TRUE(value.empty());  // NOLINT: movido para o nó
+
+  std::string repeated = "abc";
+  EXPECT_FALSE(tree.insert(std::move(repeated)));
+  EXPECT_EQ(repeated, "abc");  // não inserido, então não foi movido
+
+  EXPECT_TRUE(tree.emplace(3, 'x'));
+  EXPECT_FALSE(tree.emplace("abc"));
+  EXPECT_EQ(tree.in_order(), std::vector<std::string>({"abc", "xxx"}));
+}
+
+// Comparador que lança exceção quando `fail` é verdadeiro
+struct FragileLess {
+  static inline bool fail = false;
+  bool operator()(const std::shared_ptr<int>& a, const std::shared_ptr<int>& b) const {
+    if (fail) throw std::runtime_error("compare");
+    return *a < *b;
+  }
+};
+
+TEST(BSTTest, EmplaceComFalhaLiberaONo) {
+  BST<std::shared_ptr<int>, FragileLess> tree;
+  for (int v : {5, 3, 8}) tree.insert(std::make_shared<int>(v));
+  auto value = std::make_shared<int>(42);
+  FragileLess::fail = true;
+  EXPECT_THROW(tree.emplace(value), std::runtime_error);
+  FragileLess::fail = false;
+  EXPECT_EQ(value.use_count(), 1);  // o nó criado foi liberado
+  EXPECT_EQ(tree.size(), 3u);
+}
+
+TEST(BSTTest, CopiaMovimentoETroca) {
+  BST<int> original;
+  for (int v : {50, 30, 70, 20, 40, 60, 80}) original.insert(v);
+
+  BST<int> copy = original;
+  EXPECT_EQ(copy.pre_order(), original.pre_order());
+  copy.remove(50);
+  EXPECT_TRUE(original.contain(50));
+  EXPECT_EQ(original.size(), 7u);
+
+  BST<int> moved = std::move(copy);
+  EXPECT_EQ(moved.size(), 6u);
+  EXPECT_TRUE(copy.empty());  // NOLINT
+
+  original.swap(moved);
+  EXPECT_FALSE(original.contain(50));
+  EXPECT_TRUE(moved.contain(50));
+  moved = original;
+  EXPECT_EQ(moved.in_order(), original.in_order());
+}
+
+// Alocador que se propaga na atribuição por cópia e lança `std::bad_alloc`
+// quando `failing_budget` chega a zero (-1: sem limite). Cada alocador
+// construído por padrão é diferente dos demais.
+inline int failing_budget = -1;
+
+template <class T>
+struct FailingAllocator {
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  std::shared_ptr<int> id = std::make_shared<int>();
+
+  FailingAllocator() = default;
+  template <class U>
+  FailingAllocator(const FailingAllocator<U>& other) noexcept : id(other.id) {}
+
+  T* allocate(std::size_t n) {
+    if (failing_budget == 0) throw std::bad_alloc();
+    if (failing_budget > 0) --failing_budget;
+    return std::allocator<T>().allocate(n);
+  }
+  void deallocate(T* p, std::size_t n) { std::allocator<T>().deallocate(p, n); }
+
+  template <class U>
+  bool operator==(const FailingAllocator<U>& other) const { return id == other.id; }
+  template <class U>
+  bool operator!=(const FailingAllocator<U>& other) const { return id != other.id; }
+};
+
+TEST(BSTTest, AtribuicaoPorCopiaComFalhaNaoAlteraAArvore) {
+  BST<int, std::less<int>, FailingAllocator<int>> x, y;
+  for (int v : {50, 30, 70, 20, 40, 60, 80}) x.insert(v);
+  for (int v = 0; v < 20; ++v) y.insert(v);
+
+  failing_budget = 5;
+  EXPECT_THROW(x = y, std::bad_alloc);
+  failing_budget = -1;
+  EXPECT_EQ(x.size(), 7u);
+  EXPECT_EQ(x.pre_order(), std::vector<int>({50, 30, 20, 40, 70, 60, 80}));
+
+  x = y;
+  EXPECT_EQ(x.in_order(), y.in_order());
+}
@@ -0,0 +1,361 @@
+#include "../include/btree.hpp"
+#include "../include/map.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using IntBTree = BTree<int>;
+
+// Nós de uma linha de cache (12 inteiros), para árvores mais altas
+using SmallBTree = BTree<int, std::less<int>, std::allocator<int>,
+                         BTreeNodeSize<64>>;
+
+TEST(BTreeTest, NodeCapacityFollowsNodeSize) {
+  EXPECT_EQ(IntBTree::capacity, (256 - 16) / sizeof(int));
+  EXPECT_EQ(SmallBTree::capacity, (64 - 16) / sizeof(int));
+  // Elementos grandes ainda ficam pelo menos 3 por nó
+  EXPECT_EQ((BTree<std::string, std::less<std::string>,
+                   std::allocator<std::string>, BTreeNodeSize<64>>::capacity),
+            3u);
+}
+
+TEST(BTreeTest, InsertAndContain) {
+  IntBTree tree;
+  EXPECT_TRUE(tree.empty());
+  EXPECT_EQ(tree.height(), -1);
+  EXPECT_TRUE(tree.insert(10));
+  EXPECT_TRUE(tree.insert(5));
+  EXPECT_TRUE(tree.insert(15));
+  EXPECT_FALSE(tree.insert(10));  // Duplicado
+
+  EXPECT_TRUE(tree.contain(10));
+  EXPECT_TRUE(tree.contain(5));
+  EXPECT_FALSE(tree.contain(20));
+  EXPECT_EQ(tree.size(), 3u);
+  EXPECT_EQ(tree.height(), 0);
+  EXPECT_EQ(tree.in_order(), std::vector<int>({5, 10, 15}));
+  EXPECT_TRUE(tree.is_balanced());
+}
+
+template <class Tree>
+void random_operations_match_std_set(unsigned seed) {
+  Tree tree;
+  std::set<int> reference;
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> key(0, 5000);
+  for (int i = 0; i < 40000; ++i) {
+    int k = key(rng);
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+    } else {
+      EXPECT_EQ(tree.insert(k), reference.insert(k).second);
+    }
+  }
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), reference.size());
+  EXPECT_EQ(tree.in_order(),
+            std::vector<int>(reference.begin(), reference.end()));
+
+  // Esvazia a árvore, passando por todas as fusões até a raiz
+  std::vector<int> keys(reference.begin(), reference.end());
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(tree.remove(keys[i]));
+    if (i % 500 == 0) {
+      EXPECT_TRUE(tree.is_balanced());
+    }
+  }
+  EXPECT_TRUE(tree.empty());
+  EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(BTreeTest, RandomOperationsMatchStdSet) {
+  random_operations_match_std_set<IntBTree>(7);
+  random_operations_match_std_set<SmallBTree>(8);
+}
+
+TEST(BTreeTest, SequentialKeysStayBalanced) {
+  SmallBTree tree;
+  for (int i = 0; i < 10000; ++i) EXPECT_TRUE(tree.insert(i));
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_LE(tree.height(), 5);
+  for (int i = 9999; i >= 0; i -= 2) EXPECT_TRUE(tree.remove(i));
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), 5000u);
+  EXPECT_TRUE(tree.contain(0));
+  EXPECT_FALSE(tree.contain(9999));
+}
+
+TEST(BTreeIteratorTest, IteratesInOrderBothWays) {
+  SmallBTree tree;
+  EXPECT_TRUE(tree.begin() == tree.end());
+
+  std::mt19937 rng(3);
+  for (int i = 0; i < 2000; ++i) tree.insert(rng() % 4000);
+  for (int i = 0; i < 800; ++i) tree.remove(rng() % 4000);
+
+  std::vector<int> expected = tree.in_order();
+  EXPECT_TRUE(std::is_sorted(expected.begin(), expected.end()));
+  EXPECT_EQ(std::vector<int>(tree.rbegin(), tree.rend()),
+            std::vector<int>(expected.rbegin(), expected.rend()));
+  EXPECT_EQ(*--tree.end(), expected.back());
+  EXPECT_EQ(std::distance(tree.begin(), tree.end()),
+            static_cast<std::ptrdiff_t>(expected.size()));
+}
+
+TEST(BTreeTest, OrderedQueriesMatchStdSet) {
+  SmallBTree tree;
+  std::set<int> reference;
+  std::mt19937 rng(5);
+  for (int i = 0; i < 1000; ++i) {
+    int k = static_cast<int>(rng() % 3000);
+    tree.insert(k);
+    reference.insert(k);
+  }
+  auto value_or = [](const int* p) { return p ? *p : -1; };
+  for (int k = -1; k <= 3001; ++k) {
+    auto lower = reference.lower_bound(k);
+    auto upper = reference.upper_bound(k);
+    EXPECT_EQ(tree.lower_bound(k) == tree.end(), lower == reference.end());
+    if (lower != reference.end()) {
+      EXPECT_EQ(*tree.lower_bound(k), *lower);
+    }
+    EXPECT_EQ(tree.upper_bound(k) == tree.end(), upper == reference.end());
+    if (upper != reference.end()) {
+      EXPECT_EQ(*tree.upper_bound(k), *upper);
+    }
+    EXPECT_EQ(value_or(tree.ceiling(k)),
+              lower == reference.end() ? -1 : *lower);
+    EXPECT_EQ(value_or(tree.successor(k)),
+              upper == reference.end() ? -1 : *upper);
+    EXPECT_EQ(value_or(tree.floor(k)),
+              upper == reference.begin() ? -1 : *std::prev(upper));
+    EXPECT_EQ(value_or(tree.predecessor(k)),
+              lower == reference.begin() ? -1 : *std::prev(lower));
+  }
+}
+
+TEST(BTreeTest, TransparentLookupsAndTryEmplace) {
+  BTree<std::string, std::less<>> tree;
+  for (const char* fruit : {"kiwi", "banana", "uva", "maçã", "pera"}) {
+    tree.insert(fruit);
+  }
+  EXPECT_TRUE(tree.contain(std::string_view("uva")));
+  ASSERT_NE(tree.search("pera"), nullptr);
+  EXPECT_EQ(*tree.search("pera"), "pera");
+  EXPECT_EQ(*tree.lower_bound("c"), "kiwi");
+
+  auto [found, inserted] = tree.try_emplace("kiwi", "kiwi");
+  EXPECT_FALSE(inserted);
+  EXPECT_EQ(*found, "kiwi");
+  std::tie(found, inserted) = tree.try_emplace("figo", "figo");
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(*found, "figo");
+
+  EXPECT_TRUE(tree.remove(std::string_view("kiwi")));
+  EXPECT_FALSE(tree.contain("kiwi"));
+  EXPECT_EQ(tree.size(), 5u);
+}
+
+// Comparador de ponteiros pelo valor apontado, para testar tipos só movíveis
+struct PointeeLess {
+  bool operator()(const std::unique_ptr<int>& a,
+                  const std::unique_ptr<int>& b) const {
+    return *a < *b;
+  }
+};
+
+TEST(BTreeTest, MoveOnlyValues) {
+  BTree<std::unique_ptr<int>, PointeeLess, std::allocator<std::unique_ptr<int>>,
+        BTreeNodeSize<64>>
+      tree;
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_TRUE(tree.insert(std::make_unique<int>((i * 37) % 200)));
+  }
+  EXPECT_FALSE(tree.emplace(new int(5)));
+  EXPECT_TRUE(tree.remove(std::make_unique<int>(5)));
+  EXPECT_EQ(tree.size(), 199u);
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(**tree.begin(), 0);
+}
+
+TEST(BTreeTest, AssignSorted) {
+  SmallBTree tree;
+  tree.insert(-1);
+  std::vector<int> values;
+  for (int i = 0; i < 5000; ++i) values.push_back(i);
+  tree.assign_sorted(values.begin(), values.end());
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.in_order(), values);
+
+  tree.assign_sorted(std::vector<int>({5, 3, 5, 1, 3}));
+  EXPECT_EQ(tree.in_order(), std::vector<int>({1, 3, 5}));
+}
+
+TEST(BTreeTest, CopyMoveAndSwap) {
+  SmallBTree tree;
+  for (int i = 0; i < 1000; ++i) tree.insert(i * 3);
+  SmallBTree copy(tree);
+  EXPECT_TRUE(copy.is_balanced());
+  copy.remove(0);
+  EXPECT_TRUE(tree.contain(0));
+  EXPECT_EQ(copy.size() + 1, tree.size());
+
+  SmallBTree moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved.size(), 999u);
+
+  SmallBTree other;
+  other.insert(42);
+  swap(moved, other);
+  EXPECT_EQ(moved.in_order(), std::vector<int>({42}));
+  EXPECT_EQ(other.size(), 999u);
+
+  other = moved;
+  EXPECT_EQ(other.in_order(), std::vector<int>({42}));
+}
+
+struct FragileCopy {
+  static inline bool fail = false;
+  int value;
+  explicit FragileCopy(int v) : value(v) {}
+  FragileCopy(const FragileCopy& other) : value(other.value) {
+    if (fail) throw std::runtime_error("copy");
+  }
+  FragileCopy(FragileCopy&&) noexcept = default;
+  bool operator<(const FragileCopy& other) const {
+    return value < other.value;
+  }
+};
+
+TEST(BTreeTest, FailedInsertLeavesTreeIntact) {
+  BTree<FragileCopy, std::less<FragileCopy>, std::allocator<FragileCopy>,
+        BTreeNodeSize<64>>
+      tree;
+  for (int i = 0; i < 100; ++i) tree.insert(FragileCopy(i * 2));
+  FragileCopy::fail = true;
+  for (int i = 0; i < 100; ++i) {
+    const FragileCopy value(i * 2 + 1);
+    EXPECT_THROW(tree.insert(value), std::runtime_error);
+  }
+  FragileCopy::fail = false;
+  EXPECT_EQ(tree.size(), 100u);
+  EXPECT_TRUE(tree.is_balanced());
+
+  // Uma cópia que falha no meio libera os nós já clonados
+  FragileCopy::fail = true;
+  EXPECT_THROW(decltype(tree) copy(tree), std::runtime_error);
+  FragileCopy::fail = false;
+}
+
+TEST(BTreeTest, IntegralKeysWithVectorSearch) {
+  // Busca nos nós por `simd::count_less`, inclusive chaves sem sinal acima
+  // do maior valor com sinal
+  BTree<std::uint64_t> tree;
+  std::set<std::uint64_t> reference;
+  std::mt19937_64 rng(21);
+  for (int i = 0; i < 20000; ++i) {
+    std::uint64_t key = rng() % 4000 * 0x0100000000000001ull;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(key), reference.erase(key) == 1);
+    } else {
+      EXPECT_EQ(tree.insert(key), reference.insert(key).second);
+    }
+  }
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.in_order(), std::vector<std::uint64_t>(reference.begin(),
+                                                        reference.end()));
+  for (std::uint64_t key : reference) EXPECT_TRUE(tree.contain(key));
+}
+
+// Elemento com chave inteira e um valor, ordenado pela chave
+struct KeyedValue {
+  std::uint64_t key;
+  int value;
+};
+
+// Comparador que expõe a chave, como o de `Map`
+struct KeyedCompare {
+  using is_transparent = void;
+  using key_type = std::uint64_t;
+  static const std::uint64_t& key(const KeyedValue& e) { return e.key; }
+
+  bool operator()(const KeyedValue& a, const KeyedValue& b) const {
+    return a.key < b.key;
+  }
+  bool operator()(const KeyedValue& a, std::uint64_t k) const {
+    return a.key < k;
+  }
+  bool operator()(std::uint64_t k, const KeyedValue& b) const {
+    return k < b.key;
+  }
+};
+
+TEST(BTreeTest, KeyedElementsWithVectorSearch) {
+  // A cópia das chaves tira espaço dos elementos: 8 + 16 bytes por elemento
+  using KeyedBTree = BTree<KeyedValue, KeyedCompare>;
+  EXPECT_EQ(KeyedBTree::capacity, (256 - 16) / (8 + sizeof(KeyedValue)));
+
+  // A cópia acompanha divisões, rotações e fusões
+  KeyedBTree tree;
+  std::map<std::uint64_t, int> reference;
+  std::mt19937_64 rng(22);
+  for (int i = 0; i < 20000; ++i) {
+    std::uint64_t key = rng() % 4000 * 0x0100000000000001ull;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(key), reference.erase(key) == 1);
+    } else {
+      int value = static_cast<int>(i);
+      EXPECT_EQ(tree.insert(KeyedValue{key, value}),
+                reference.emplace(key, value).second);
+    }
+  }
+  EXPECT_TRUE(tree.is_balanced());
+  KeyedBTree copy(tree);
+  EXPECT_TRUE(copy.is_balanced());
+  for (const auto& [key, value] : reference) {
+    const KeyedValue* found = copy.search(key);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(found->value, value);
+    EXPECT_EQ(tree.lower_bound(key)->key, key);
+  }
+  EXPECT_FALSE(tree.contain(std::uint64_t{1}));
+}
+
+TEST(BTreeTest, MapWithIntegralKeys) {
+  // `Map` expõe a chave ao comparador, então a árvore busca por
+  // `simd::count_less` nas chaves de cada nó
+  Map<std::uint64_t, int, BTree> map;
+  std::map<std::uint64_t, int> reference;
+  std::mt19937_64 rng(23);
+  for (int i = 0; i < 20000; ++i) {
+    std::uint64_t key = rng() % 4000 * 0x0100000000000001ull;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(map.remove(key), reference.erase(key) == 1);
+    } else {
+      map.insert_or_assign(key, i);
+      reference[key] = i;
+    }
+  }
+  ASSERT_EQ(map.size(), reference.size());
+  auto expected = reference.begin();
+  for (auto [key, value] : map) {
+    EXPECT_EQ(key, expected->first);
+    EXPECT_EQ(value, expected->second);
+    ++expected;
+  }
+  for (const auto& [key, value] : reference) {
+    const int* found = map.find(key);
+    ASSERT_NE(found, nullptr);
+    EXPECT_EQ(*found, value);
+  }
+}
@@ -0,0 +1,126 @@
+#include "../include/compact_avl.hpp"
+#include "../include/set.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using IntCompactAVL = CompactAVL<std::uint32_t>;
+
+TEST(CompactAVLTest, RandomOperationsMatchStdSet) {
+  IntCompactAVL tree;
+  std::set<std::uint32_t> reference;
+  std::mt19937 rng(7);
+  for (int i = 0; i < 40000; ++i) {
+    std::uint32_t k = rng() % 5000;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(k), reference.erase(k) == 1);
+    } else {
+      EXPECT_EQ(tree.insert(k), reference.insert(k).second);
+    }
+  }
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), reference.size());
+  EXPECT_EQ(tree.in_order(), std::vector<std::uint32_t>(reference.begin(),
+                                                        reference.end()));
+
+  std::vector<std::uint32_t> keys(reference.begin(), reference.end());
+  std::shuffle(keys.begin(), keys.end(), rng);
+  for (std::size_t i = 0; i < keys.size(); ++i) {
+    EXPECT_TRUE(tree.remove(keys[i]));
+    if (i % 500 == 0) {
+      EXPECT_TRUE(tree.is_balanced());
+    }
+  }
+  EXPECT_TRUE(tree.empty());
+}
+
+TEST(CompactAVLTest, SequentialKeysStayBalanced) {
+  IntCompactAVL tree;
+  for (std::uint32_t i = 0; i < 100000; ++i) EXPECT_TRUE(tree.insert(i));
+  EXPECT_TRUE(tree.is_balanced());
+  for (std::uint32_t i = 0; i < 100000; i += 2) EXPECT_TRUE(tree.remove(i));
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), 50000u);
+  // Índices liberados são reaproveitados: a arena não cresce
+  std::size_t memory = tree.memory_usage();
+  for (std::uint32_t i = 0; i < 100000; i += 2) EXPECT_TRUE(tree.insert(i));
+  EXPECT_EQ(tree.memory_usage(), memory);
+}
+
+TEST(CompactAVLTest, NodesArePacked) {
+  // 12 bytes por nó de uint32_t, 5 por linha de cache
+  IntCompactAVL tree;
+  std::vector<std::uint32_t> values(1000000);
+  for (std::uint32_t i = 0; i < values.size(); ++i) values[i] = i;
+  tree.assign_sorted(values.begin(), values.end());
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), values.size());
+  EXPECT_LT(tree.memory_usage(), values.size() * 64 / 5 * 2);
+  EXPECT_TRUE(tree.contain(999999));
+}
+
+TEST(CompactAVLIteratorTest, IteratesAndSeeksBothWays) {
+  IntCompactAVL tree;
+  EXPECT_TRUE(tree.begin() == tree.end());
+  std::set<std::uint32_t> reference;
+  std::mt19937 rng(3);
+  for (int i = 0; i < 2000; ++i) {
+    std::uint32_t k = rng() % 4000;
+    tree.insert(k);
+    reference.insert(k);
+  }
+  std::vector<std::uint32_t> expected(reference.begin(), reference.end());
+  EXPECT_EQ(std::vector<std::uint32_t>(tree.begin(), tree.end()), expected);
+  EXPECT_EQ(std::vector<std::uint32_t>(tree.rbegin(), tree.rend()),
+            std::vector<std::uint32_t>(expected.rbegin(), expected.rend()));
+  for (std::uint32_t k = 0; k <= 4001; k += 7) {
+    auto lower = reference.lower_bound(k);
+    auto upper = reference.upper_bound(k);
+    EXPECT_EQ(tree.lower_bound(k) == tree.end(), lower == reference.end());
+    if (lower != reference.end()) {
+      EXPECT_EQ(*tree.lower_bound(k), *lower);
+    }
+    if (upper != reference.end()) {
+      EXPECT_EQ(*tree.upper_bound(k), *upper);
+    }
+    if (lower != reference.begin() && lower != reference.end()) {
+      EXPECT_EQ(*--tree.lower_bound(k), *std::prev(lower));
+    }
+  }
+}
+
+TEST(CompactAVLTest, NonTrivialValuesAndTransparentLookups) {
+  CompactAVL<std::string, std::less<>> tree;
+  for (int i = 0; i < 1000; ++i) tree.insert(std::to_string(i));
+  EXPECT_TRUE(tree.contain(std::string_view("500")));
+  EXPECT_TRUE(tree.remove(std::string_view("500")));
+  EXPECT_EQ(tree.search("501")->size(), 3u);
+  auto [found, inserted] = tree.try_emplace("x", "x");
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(*found, "x");
+
+  CompactAVL<std::string, std::less<>> copy(tree);
+  tree.clear();
+  EXPECT_EQ(copy.size(), 1000u);
+  EXPECT_TRUE(copy.is_balanced());
+  CompactAVL<std::string, std::less<>> moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved.size(), 1000u);
+}
+
+TEST(CompactAVLTest, WorksAsSetBackend) {
+  Set<std::uint32_t, CompactAVL> set;
+  for (std::uint32_t v : {30u, 10u, 20u, 50u, 40u}) set.insert(v);
+  EXPECT_FALSE(set.insert(20));
+  EXPECT_TRUE(set.remove(10));
+  EXPECT_TRUE(set.search(40));
+  EXPECT_EQ(set.size(), 4u);
+  EXPECT_EQ(std::vector<std::uint32_t>(set.begin(), set.end()),
+            std::vector<std::uint32_t>({20, 30, 40, 50}));
+}
@@ -0,0 +1,124 @@
+#include "../include/concurrent_avl.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using IntConcurrentAVL = ConcurrentAVL<int>;
+
+TEST(ConcurrentAVLTest, SingleThreadMatchesStdSet) {
+  IntConcurrentAVL tree;
+  std::set<int> expected;
+  std::mt19937 rng(17);
+  for (int i = 0; i < 20000; ++i) {
+    int value = rng() % 2000;
+    if (rng() % 3 == 0) {
+      EXPECT_EQ(tree.remove(value), expected.erase(value) == 1);
+    } else {
+      EXPECT_EQ(tree.insert(value), expected.insert(value).second);
+    }
+  }
+  EXPECT_EQ(tree.size(), expected.size());
+  EXPECT_EQ(tree.in_order(), std::vector<int>(expected.begin(), expected.end()));
+  for (int value = 0; value < 2000; ++value) {
+    EXPECT_EQ(tree.contain(value), expected.count(value) == 1);
+  }
+  EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(ConcurrentAVLTest, SequentialKeysStayBalanced) {
+  IntConcurrentAVL tree;
+  for (int i = 0; i < 10000; ++i) EXPECT_TRUE(tree.insert(i));
+  EXPECT_TRUE(tree.is_balanced());
+  for (int i = 0; i < 10000; i += 2) EXPECT_TRUE(tree.remove(i));
+  EXPECT_TRUE(tree.is_balanced());
+  EXPECT_EQ(tree.size(), 5000u);
+  EXPECT_FALSE(tree.contain(0));
+  EXPECT_TRUE(tree.contain(9999));
+}
+
+TEST(ConcurrentAVLTest, RoutingNodesAreReused) {
+  IntConcurrentAVL tree;
+  for (int v : {50, 30, 70, 20, 40, 60, 80}) tree.insert(v);
+  EXPECT_TRUE(tree.remove(50));  // Dois filhos: vira nó de roteamento
+  EXPECT_FALSE(tree.contain(50));
+  EXPECT_FALSE(tree.remove(50));
+  EXPECT_TRUE(tree.insert(50));  // Reaproveita o nó
+  EXPECT_TRUE(tree.contain(50));
+  EXPECT_EQ(tree.in_order(), std::vector<int>({20, 30, 40, 50, 60, 70, 80}));
+}
+
+TEST(ConcurrentAVLTest, TransparentLookups) {
+  ConcurrentAVL<std::string, std::less<>> tree;
+  tree.insert("kiwi");
+  EXPECT_TRUE(tree.contain(std::string_view("kiwi")));
+  EXPECT_TRUE(tree.remove("kiwi"));
+  EXPECT_TRUE(tree.empty());
+}
+
+TEST(ConcurrentAVLTest, ConcurrentWritersOnDisjointKeys) {
+  // Cada thread insere e remove as suas próprias chaves, entrelaçadas com as
+  // das outras; no fim fica só a metade de cada uma.
+  IntConcurrentAVL tree;
+  const int threads = 4, per_thread = 5000;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      std::mt19937 rng(t);
+      std::vector<int> keys;
+      for (int i = 0; i < per_thread; ++i) keys.push_back(i * threads + t);
+      std::shuffle(keys.begin(), keys.end(), rng);
+      for (int key : keys) EXPECT_TRUE(tree.insert(key));
+      for (int key : keys) {
+        if (key % 2 == 0) {
+          EXPECT_TRUE(tree.remove(key));
+        }
+      }
+      for (int key : keys) EXPECT_EQ(tree.contain(key), key % 2 == 1);
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  EXPECT_EQ(tree.size(), static_cast<std::size_t>(threads * per_thread / 2));
+  std::vector<int> values = tree.in_order();
+  EXPECT_EQ(values.size(), tree.size());
+  EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+  EXPECT_TRUE(std::all_of(values.begin(), values.end(),
+                          [](int v) { return v % 2 == 1; }));
+  EXPECT_TRUE(tree.is_balanced());
+}
+
+TEST(ConcurrentAVLTest, ContendedKeysKeepInvariants) {
+  // Todas as threads disputam as mesmas chaves; os contadores de sucesso
+  // de inserção e remoção precisam bater com o que sobrou na árvore.
+  IntConcurrentAVL tree;
+  std::atomic<long> inserted(0), removed(0);
+  std::vector<std::thread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([&, t] {
+      std::mt19937 rng(100 + t);
+      for (int i = 0; i < 20000; ++i) {
+        int key = rng() % 256;
+        if (rng() % 2) {
+          inserted += tree.insert(key);
+        } else {
+          removed += tree.remove(key);
+        }
+        tree.contain(rng() % 256);
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  std::vector<int> values = tree.in_order();
+  EXPECT_EQ(static_cast<long>(values.size()), inserted - removed);
+  EXPECT_EQ(values.size(), tree.size());
+  EXPECT_TRUE(std::adjacent_find(values.begin(), values.end(),
+                                 std::greater_equal<int>()) == values.end());
+  EXPECT_TRUE(tree.is_balanced());
+}
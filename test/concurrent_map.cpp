@@ -0,0 +1,68 @@
+#include "../include/concurrent_map.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentMapTest, InsertAssignAndFind) {
+  ConcurrentMap<std::string, int> map;
+  EXPECT_TRUE(map.insert_or_assign("one", 1));
+  EXPECT_TRUE(map.try_emplace("two", 2));
+  EXPECT_FALSE(map.try_emplace("two", 20));
+  EXPECT_FALSE(map.insert_or_assign("one", 10));
+
+  EXPECT_EQ(map.find("one"), 10);
+  EXPECT_EQ(map.find(std::string_view("two")), 2);
+  EXPECT_FALSE(map.find("three").has_value());
+  EXPECT_EQ(map.size(), 2u);
+
+  EXPECT_TRUE(map.remove("one"));
+  EXPECT_FALSE(map.remove("one"));
+  EXPECT_FALSE(map.contain("one"));
+}
+
+TEST(ConcurrentMapTest, VisitAndForEach) {
+  ConcurrentMap<int, std::vector<int>> map;
+  map.try_emplace(1, 3, 7);  // vector com três 7
+  map.try_emplace(2);
+
+  std::size_t length = 0;
+  EXPECT_TRUE(map.visit(1, [&](const std::vector<int>& v) { length = v.size(); }));
+  EXPECT_EQ(length, 3u);
+  EXPECT_FALSE(map.visit(3, [](const std::vector<int>&) {}));
+
+  std::vector<int> keys;
+  map.for_each([&](int key, const std::vector<int>&) { keys.push_back(key); });
+  EXPECT_EQ(keys, std::vector<int>({1, 2}));
+}
+
+TEST(ConcurrentMapTest, ReadersSeeWholeValues) {
+  // O primeiro campo do valor é sempre a chave; o segundo, a geração escrita
+  ConcurrentMap<int, std::pair<int, int>> map;
+  for (int i = 0; i < 500; ++i) map.insert_or_assign(i, std::make_pair(i, 0));
+
+  std::atomic<bool> stop(false), failed(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (int i = 0; i < 500; ++i) {
+          auto value = map.find(i);
+          if (!value || value->first != i) failed = true;
+        }
+      }
+    });
+  }
+  for (int generation = 1; generation <= 20; ++generation) {
+    for (int i = 0; i < 500; ++i) {
+      map.insert_or_assign(i, std::make_pair(i, generation));
+    }
+  }
+  stop = true;
+  for (std::thread& reader : readers) reader.join();
+
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(map.find(42)->second, 20);
+}
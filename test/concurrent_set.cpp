@@ -0,0 +1,89 @@
+#include "../include/concurrent_set.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+TEST(ConcurrentSetTest, BasicOperations) {
+  ConcurrentSet<int> set;
+  EXPECT_TRUE(set.empty());
+  EXPECT_TRUE(set.insert(10));
+  EXPECT_TRUE(set.insert(5));
+  EXPECT_FALSE(set.insert(10));
+  EXPECT_TRUE(set.contain(5));
+  EXPECT_TRUE(set.search(10));
+  EXPECT_EQ(set.size(), 2u);
+
+  EXPECT_TRUE(set.remove(5));
+  EXPECT_FALSE(set.remove(5));
+  EXPECT_FALSE(set.contain(5));
+  EXPECT_EQ(set.size(), 1u);
+}
+
+TEST(ConcurrentSetTest, SnapshotIsIsolatedFromWriters) {
+  ConcurrentSet<int> set;
+  for (int i = 0; i < 100; ++i) set.insert(i);
+  auto snapshot = set.snapshot();
+  for (int i = 0; i < 100; i += 2) set.remove(i);
+
+  EXPECT_EQ(snapshot.size(), 100u);
+  EXPECT_TRUE(snapshot.contain(0));
+  EXPECT_EQ(set.size(), 50u);
+
+  int count = 0;
+  set.for_each_in_order([&](int v) {
+    EXPECT_EQ(v % 2, 1);
+    ++count;
+  });
+  EXPECT_EQ(count, 50);
+}
+
+TEST(ConcurrentSetTest, TransparentLookups) {
+  ConcurrentSet<std::string, std::less<>> set;
+  set.insert("alpha");
+  EXPECT_TRUE(set.contain(std::string_view("alpha")));
+  EXPECT_TRUE(set.remove("alpha"));
+  EXPECT_TRUE(set.empty());
+}
+
+TEST(ConcurrentSetTest, ReadersRunAlongsideWriters) {
+  // Os pares 2k são fixos; os ímpares entram e saem durante o teste
+  ConcurrentSet<int> set;
+  for (int i = 0; i < 2000; i += 2) set.insert(i);
+
+  std::atomic<bool> stop(false), failed(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 3; ++t) {
+    readers.emplace_back([&] {
+      while (!stop) {
+        for (int i = 0; i < 2000; i += 2) {
+          if (!set.contain(i)) failed = true;
+        }
+        // Cada travessia vê uma única versão, em ordem
+        int last = -1;
+        set.for_each_in_order([&](int v) {
+          if (v <= last) failed = true;
+          last = v;
+        });
+      }
+    });
+  }
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 2; ++t) {
+    writers.emplace_back([&, t] {
+      for (int round = 0; round < 20; ++round) {
+        for (int i = 1 + 2 * t; i < 2000; i += 4) set.insert(i);
+        for (int i = 1 + 2 * t; i < 2000; i += 4) set.remove(i);
+      }
+    });
+  }
+  for (std::thread& writer : writers) writer.join();
+  stop = true;
+  for (std::thread& reader : readers) reader.join();
+
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(set.size(), 1000u);
+  EXPECT_TRUE(set.snapshot().is_balanced());
+}
@@ -0,0 +1,118 @@
+#include "../include/epoch.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct Tracked {
+  explicit Tracked(std::atomic<int>& freed) : freed(freed) {}
+  ~Tracked() { ++freed; }
+  std::atomic<int>& freed;
+};
+
+}  // namespace
+
+TEST(EpochDomainTest, CollectFreesWithoutReaders) {
+  std::atomic<int> freed(0);
+  EpochDomain domain;
+  for (int i = 0; i < 10; ++i) domain.retire(new Tracked(freed));
+  EXPECT_EQ(freed, 0);
+  EXPECT_EQ(domain.pending(), 10u);
+
+  domain.collect();
+  EXPECT_EQ(freed, 10);
+  EXPECT_EQ(domain.pending(), 0u);
+}
+
+TEST(EpochDomainTest, ActiveGuardDelaysReclamation) {
+  std::atomic<int> freed(0);
+  EpochDomain domain;
+  {
+    EpochDomain::Guard guard(domain);
+    domain.retire(new Tracked(freed));
+    domain.collect();
+    domain.collect();
+    EXPECT_EQ(freed, 0);  // O leitor ainda pode estar usando o objeto
+  }
+  domain.collect();
+  EXPECT_EQ(freed, 1);
+}
+
+TEST(EpochDomainTest, GuardFromOtherThreadDelaysReclamation) {
+  std::atomic<int> freed(0);
+  std::atomic<bool> pinned(false), release(false);
+  EpochDomain domain;
+
+  std::thread reader([&] {
+    EpochDomain::Guard guard(domain);
+    pinned = true;
+    while (!release) std::this_thread::yield();
+  });
+  while (!pinned) std::this_thread::yield();
+
+  domain.retire(new Tracked(freed));
+  domain.collect();
+  EXPECT_EQ(freed, 0);
+
+  release = true;
+  reader.join();
+  domain.collect();
+  EXPECT_EQ(freed, 1);
+}
+
+TEST(EpochDomainTest, DestructorFreesPending) {
+  std::atomic<int> freed(0);
+  {
+    EpochDomain domain;
+    EpochDomain::Guard* guard = new EpochDomain::Guard(domain);
+    domain.retire(new Tracked(freed));
+    delete guard;
+  }
+  EXPECT_EQ(freed, 1);
+}
+
+TEST(EpochDomainTest, NestedGuardsKeepOuterAnnouncement) {
+  std::atomic<int> freed(0);
+  EpochDomain domain;
+  {
+    EpochDomain::Guard outer(domain);
+    domain.retire(new Tracked(freed));
+    { EpochDomain::Guard inner(domain); }
+    domain.collect();
+    EXPECT_EQ(freed, 0);  // Sair do interno não libera o externo
+  }
+  domain.collect();
+  EXPECT_EQ(freed, 1);
+}
+
+TEST(EpochDomainTest, ManySimultaneousReaders) {
+  // Cada thread tem um slot próprio: não há limite de leitores ativos
+  constexpr int readers = 300;
+  std::atomic<int> freed(0), pinned(0);
+  std::atomic<bool> release(false);
+  EpochDomain domain;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < readers; ++i) {
+    threads.emplace_back([&] {
+      EpochDomain::Guard guard(domain);
+      ++pinned;
+      while (!release) std::this_thread::yield();
+    });
+  }
+  while (pinned < readers) std::this_thread::yield();
+
+  domain.retire(new Tracked(freed));
+  domain.collect();
+  EXPECT_EQ(freed, 0);
+
+  release = true;
+  for (std::thread& thread : threads) thread.join();
+  domain.collect();
+  EXPECT_EQ(freed, 1);
+
+  // Os slots das threads que terminaram são reaproveitados
+  std::thread([&] { EpochDomain::Guard guard(domain); }).join();
+}
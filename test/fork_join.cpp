@@ -0,0 +1,56 @@
+#include "../include/fork_join.hpp"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+
+// Soma de [lo, hi) por divisão e conquista, com fork_join em cada nível
+static std::uint64_t Sum(ForkJoinPool& pool, std::uint64_t lo, std::uint64_t hi) {
+  if (hi - lo <= 64) {
+    std::uint64_t total = 0;
+    for (std::uint64_t i = lo; i < hi; ++i) total += i;
+    return total;
+  }
+  std::uint64_t mid = lo + (hi - lo) / 2, left = 0, right = 0;
+  pool.fork_join([&] { left = Sum(pool, lo, mid); },
+                 [&] { right = Sum(pool, mid, hi); });
+  return left + right;
+}
+
+TEST(ForkJoinPoolTest, ChamadasAninhadas) {
+  for (unsigned threads : {1u, 2u, 4u, 8u}) {
+    ForkJoinPool pool(threads);
+    EXPECT_EQ(pool.size(), threads);
+    EXPECT_EQ(Sum(pool, 0, 1000000), 999999ull * 1000000 / 2);
+  }
+}
+
+TEST(ForkJoinPoolTest, ExecutaAsDuasFuncoes) {
+  ForkJoinPool pool(4);
+  std::atomic<int> calls{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.fork_join([&] { ++calls; }, [&] { ++calls; });
+  }
+  EXPECT_EQ(calls.load(), 2000);
+}
+
+TEST(ForkJoinPoolTest, VariasThreadsDeFora) {
+  ForkJoinPool pool(4);
+  std::uint64_t a = 0, b = 0;
+  std::thread other([&] { a = Sum(pool, 0, 200000); });
+  b = Sum(pool, 0, 200000);
+  other.join();
+  EXPECT_EQ(a, b);
+}
+
+TEST(ForkJoinPoolTest, PropagaExcecoes) {
+  ForkJoinPool pool(2);
+  EXPECT_THROW(pool.fork_join([] {}, [] { throw std::runtime_error("g"); }),
+               std::runtime_error);
+  EXPECT_THROW(pool.fork_join([] { throw std::logic_error("f"); }, [] {}),
+               std::logic_error);
+  EXPECT_EQ(Sum(pool, 0, 1000), 999ull * 1000 / 2);  // o pool continua usável
+}
@@ -0,0 +1,65 @@
+#include "../include/frozen_set.hpp"
+#include "../include/set.hpp"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(FrozenSetTest, EmptySet) {
+  FrozenSet<int> frozen = Set<int>().freeze();
+  EXPECT_TRUE(frozen.empty());
+  EXPECT_FALSE(frozen.search(0));
+  EXPECT_EQ(frozen.lower_bound(0), nullptr);
+}
+
+TEST(FrozenSetTest, MatchesSetForEverySize) {
+  // Tamanhos de árvores completas e incompletas
+  for (int n = 1; n <= 130; ++n) {
+    Set<int> set;
+    for (int i = 0; i < n; ++i) set.insert(3 * i);
+    FrozenSet<int> frozen = set.freeze();
+    EXPECT_EQ(frozen.size(), static_cast<std::size_t>(n));
+    for (int key = -2; key <= 3 * n + 1; ++key) {
+      EXPECT_EQ(frozen.search(key), set.search(key)) << n << " " << key;
+      const int* lower = frozen.lower_bound(key);
+      if (set.lower_bound(key) == set.end()) {
+        EXPECT_EQ(lower, nullptr);
+      } else {
+        ASSERT_NE(lower, nullptr);
+        EXPECT_EQ(*lower, *set.lower_bound(key));
+      }
+    }
+  }
+}
+
+TEST(FrozenSetTest, WideKeysAndSnapshotIndependence) {
+  Set<std::int64_t> set;
+  std::mt19937_64 rng(9);
+  std::vector<std::int64_t> keys;
+  for (int i = 0; i < 10000; ++i) {
+    std::int64_t key = static_cast<std::int64_t>(rng());
+    set.insert(key);
+    keys.push_back(key);
+  }
+  FrozenSet<std::int64_t> frozen = set.freeze();
+  set.remove(keys[0]);
+  EXPECT_TRUE(frozen.search(keys[0]));
+  EXPECT_EQ(frozen.size(), set.size() + 1);
+  for (std::int64_t key : keys) EXPECT_TRUE(frozen.search(key));
+  for (int i = 0; i < 1000; ++i) {
+    std::int64_t key = static_cast<std::int64_t>(rng());
+    EXPECT_EQ(frozen.search(key), set.search(key));
+  }
+}
+
+TEST(FrozenSetTest, Strings) {
+  Set<std::string> set;
+  for (const char* fruit : {"kiwi", "banana", "uva", "pera", "figo"}) {
+    set.insert(fruit);
+  }
+  FrozenSet<std::string> frozen = set.freeze();
+  EXPECT_TRUE(frozen.search("uva"));
+  EXPECT_FALSE(frozen.search("manga"));
+  EXPECT_EQ(*frozen.lower_bound("c"), "figo");
+}
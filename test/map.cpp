@@ -4,6 +4,8 @@
 
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
 
 
 struct MyValue {
@@ -217,3 +219,275 @@ TEST_F(MapTest, ScopeAndDestruction) {
   }
   SUCCEED();
 }
+
+TEST(MapBackendTest, BSTBackend) {
+  Map<int, int, BST> bstMap;
+  bstMap[2] = 20;
+  bstMap[1] = 10;
+  bstMap[3] = 30;
+  EXPECT_EQ(bstMap[1], 10);
+  EXPECT_TRUE(bstMap.remove(2));
+  const auto& constMap = bstMap;
+  ASSERT_THROW(constMap[2], std::out_of_range);
+  EXPECT_EQ(constMap[3], 30);
+}
+
+TEST(MapBackendTest, SortedKeysWithDefaultBackend) {
+  Map<int, int> sortedMap;
+  for (int i = 0; i < 100000; ++i) {
+    sortedMap[i] = 2 * i;
+  }
+  for (int i = 0; i < 100000; i += 997) {
+    EXPECT_EQ(sortedMap[i], 2 * i);
+  }
+  EXPECT_TRUE(sortedMap.remove(500));
+  EXPECT_FALSE(sortedMap.remove(500));
+}
+
+struct CountedValue {
+  static int constructions;
+  int value;
+
+  CountedValue() : value(0) { ++constructions; }
+  explicit CountedValue(int v) : value(v) { ++constructions; }
+};
+
+int CountedValue::constructions = 0;
+
+TEST(MapTryEmplaceTest, BuildsValueOnlyWhenMissing) {
+  Map<int, CountedValue> map;
+  CountedValue::constructions = 0;
+
+  auto [value, inserted] = map.try_emplace(1, 10);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(value->value, 10);
+  EXPECT_EQ(CountedValue::constructions, 1);
+
+  auto [again, inserted_again] = map.try_emplace(1, 20);
+  EXPECT_FALSE(inserted_again);
+  EXPECT_EQ(again, value);
+  EXPECT_EQ(again->value, 10);
+  EXPECT_EQ(CountedValue::constructions, 1);
+
+  map[1].value = 11;
+  EXPECT_EQ(CountedValue::constructions, 1);
+  map[2];
+  EXPECT_EQ(CountedValue::constructions, 2);
+}
+
+TEST_F(MapTest, InsertOrAssign) {
+  EXPECT_TRUE(intStringMap.insert_or_assign(1, "one"));
+  EXPECT_EQ(intStringMap[1], "one");
+  EXPECT_FALSE(intStringMap.insert_or_assign(1, "uno"));
+  EXPECT_EQ(intStringMap[1], "uno");
+}
+
+TEST_F(MapTest, Upsert) {
+  auto increment = [](int& v) { ++v; };
+  EXPECT_EQ(intIntMap.upsert(7, increment), 1);
+  EXPECT_EQ(intIntMap.upsert(7, increment), 2);
+  EXPECT_EQ(intIntMap[7], 2);
+
+  stringMyValueMap.upsert("k", [](MyValue& v) { v.data += "!"; });
+  EXPECT_EQ(stringMyValueMap["k"].data, "default!");
+}
+
+TEST(MapKeyLookupTest, LookupsDoNotBuildValues) {
+  Map<int, CountedValue> map;
+  map.try_emplace(1, 10);
+  map.try_emplace(2, 20);
+  CountedValue::constructions = 0;
+
+  const auto& constMap = map;
+  EXPECT_EQ(constMap[1].value, 10);
+  ASSERT_THROW(constMap[3], std::out_of_range);
+  EXPECT_EQ(map.find(2)->value, 20);
+  EXPECT_EQ(map.find(3), nullptr);
+  EXPECT_TRUE(map.contain(1));
+  EXPECT_FALSE(map.remove(3));
+  EXPECT_TRUE(map.remove(1));
+  EXPECT_EQ(CountedValue::constructions, 0);
+}
+
+TEST(MapKeyLookupTest, HeterogeneousStringViewLookup) {
+  Map<std::string, int> map;
+  map["alpha"] = 1;
+  map["beta"] = 2;
+
+  std::string_view beta = "beta";
+  ASSERT_NE(map.find(beta), nullptr);
+  EXPECT_EQ(*map.find(beta), 2);
+  EXPECT_TRUE(map.contain(std::string_view("alpha")));
+  EXPECT_FALSE(map.contain(std::string_view("gamma")));
+  EXPECT_TRUE(map.remove(beta));
+  EXPECT_FALSE(map.contain(beta));
+}
+
+TEST_F(MapTest, IteratesInKeyOrder) {
+  intIntMap[3] = 30;
+  intIntMap[1] = 10;
+  intIntMap[2] = 20;
+
+  std::vector<int> keys;
+  for (auto [key, value] : intIntMap) {
+    keys.push_back(key);
+    value += 1;  // O valor pode ser alterado pelo iterador
+  }
+  EXPECT_EQ(keys, std::vector<int>({1, 2, 3}));
+  EXPECT_EQ(intIntMap[2], 21);
+
+  const auto& constMap = intIntMap;
+  auto it = constMap.begin();
+  EXPECT_EQ(it->first, 1);
+  EXPECT_EQ(it->second, 11);
+  Map<int, int>::const_iterator converted = intIntMap.begin();
+  EXPECT_TRUE(converted == constMap.begin());
+
+  auto rit = intIntMap.rbegin();
+  EXPECT_EQ(rit->first, 3);
+  EXPECT_EQ((*rit).second, 31);
+  EXPECT_TRUE(++rit != intIntMap.rend());
+}
+
+TEST_F(MapTest, SizeRankAndNth) {
+  EXPECT_TRUE(intIntMap.empty());
+  for (int k : {40, 10, 30, 20}) intIntMap[k] = k + 1;
+  intIntMap.remove(30);
+
+  EXPECT_EQ(intIntMap.size(), 3u);
+  EXPECT_FALSE(intIntMap.empty());
+  EXPECT_EQ(intIntMap.rank(25), 2u);
+  EXPECT_EQ(intIntMap.nth(1)->first, 20);
+  intIntMap.nth(2)->second = 99;
+  EXPECT_EQ(intIntMap[40], 99);
+  EXPECT_TRUE(intIntMap.nth(3) == intIntMap.end());
+
+  stringMyValueMap["b"];
+  stringMyValueMap["a"];
+  EXPECT_EQ(stringMyValueMap.rank(std::string_view("b")), 1u);
+}
+
+TEST_F(MapTest, OrderedRangeQueries) {
+  for (int k : {10, 20, 30, 40}) intIntMap[k] = k * 2;
+
+  EXPECT_EQ(intIntMap.lower_bound(15)->first, 20);
+  EXPECT_EQ(intIntMap.upper_bound(20)->first, 30);
+  EXPECT_EQ(intIntMap.floor(25)->second, 40);
+  EXPECT_TRUE(intIntMap.floor(5) == intIntMap.end());
+  EXPECT_EQ(intIntMap.ceiling(40)->first, 40);
+  EXPECT_EQ(intIntMap.predecessor(20)->first, 10);
+  EXPECT_TRUE(intIntMap.predecessor(10) == intIntMap.end());
+  EXPECT_EQ(intIntMap.successor(20)->first, 30);
+  EXPECT_TRUE(intIntMap.successor(40) == intIntMap.end());
+
+  intIntMap.range(20, 40, [](const int&, int& value) { value = -value; });
+  EXPECT_EQ(intIntMap[20], -40);
+  EXPECT_EQ(intIntMap[30], -60);
+  EXPECT_EQ(intIntMap[40], 80);
+
+  const auto& constMap = intIntMap;
+  std::vector<int> keys;
+  EXPECT_FALSE(constMap.range(0, 100, [&](const int& key, const int&) {
+    keys.push_back(key);
+    return key < 20;
+  }));
+  EXPECT_EQ(keys, std::vector<int>({10, 20}));
+  EXPECT_EQ(constMap.count_range(15, 35), 2u);
+  EXPECT_EQ(constMap.floor(35)->first, 30);
+
+  stringMyValueMap["apple"];
+  stringMyValueMap["banana"];
+  EXPECT_EQ(stringMyValueMap.ceiling(std::string_view("b"))->first, "banana");
+}
+
+TEST_F(MapTest, ConstructFromRange) {
+  std::vector<std::pair<int, std::string>> rows = {
+      {3, "c"}, {1, "a"}, {2, "b"}, {1, "duplicate"}};
+  Map<int, std::string> fromRows(rows.begin(), rows.end());
+  EXPECT_EQ(fromRows.size(), 3u);
+  EXPECT_EQ(fromRows[1], "a");  // vale o primeiro par de cada chave
+  EXPECT_EQ(fromRows[3], "c");
+
+  std::vector<std::pair<int, int>> sorted;
+  for (int i = 0; i < 100; ++i) sorted.emplace_back(i, i * i);
+  intIntMap[-1] = 0;
+  intIntMap.assign_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(intIntMap.size(), 100u);
+  EXPECT_FALSE(intIntMap.contain(-1));
+  EXPECT_EQ(intIntMap[9], 81);
+  EXPECT_EQ(intIntMap.nth(50)->second, 2500);
+}
+
+TEST_F(MapTest, MovesKeysOnlyWhenInserting) {
+  std::string key = "a long key that does not fit in the small buffer";
+  stringMyValueMap[std::move(key)];
+  EXPECT_TRUE(key.empty());  // NOLINT: movida para o novo par
+
+  std::string existing = "a long key that does not fit in the small buffer";
+  stringMyValueMap[std::move(existing)];
+  EXPECT_FALSE(existing.empty());  // já existia: a chave não foi movida
+
+  std::string other = "another long key that does not fit in the buffer";
+  EXPECT_TRUE(intStringMap.insert_or_assign(1, std::string(40, 'x')));
+  auto [value, inserted] = stringMyValueMap.try_emplace(std::move(other));
+  EXPECT_TRUE(inserted);
+  EXPECT_NE(value, nullptr);
+  EXPECT_EQ(stringMyValueMap.size(), 2u);
+}
+
+TEST_F(MapTest, CopyMoveAndSwap) {
+  stringMyValueMap["a"].id = 1;
+  stringMyValueMap["b"].id = 2;
+
+  Map<std::string, MyValue> copy = stringMyValueMap;
+  copy["a"].id = 10;
+  EXPECT_EQ(stringMyValueMap["a"].id, 1);
+  EXPECT_EQ(copy["a"].id, 10);
+
+  Map<std::string, MyValue> moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());  // NOLINT
+  EXPECT_EQ(moved["a"].id, 10);
+
+  moved.swap(stringMyValueMap);
+  EXPECT_EQ(stringMyValueMap["a"].id, 10);
+  EXPECT_EQ(moved["a"].id, 1);
+}
+
+TEST_F(MapTest, ApplyBatch) {
+  using Op = Map<int, std::string>::BatchOp;
+  intStringMap[1] = "one";
+  intStringMap[2] = "two";
+  std::vector<Op> ops = {{BatchKind::insert, 1, "uno"},
+                         {BatchKind::assign, 2, "dos"},
+                         {BatchKind::insert, 3, "tres"},
+                         {BatchKind::erase, 1},
+                         {BatchKind::erase, 9},
+                         {BatchKind::assign, 4, "cuatro"}};
+  EXPECT_EQ(intStringMap.apply_batch(ops),
+            std::vector<bool>({false, false, true, true, false, true}));
+  EXPECT_FALSE(intStringMap.contain(1));
+  EXPECT_EQ(intStringMap[2], "dos");
+  EXPECT_EQ(intStringMap[3], "tres");
+  EXPECT_EQ(intStringMap[4], "cuatro");
+  EXPECT_EQ(intStringMap.size(), 3u);
+}
+
+TEST(MapBackendTest, BTreeBackend) {
+  Map<int, std::string, BTree> btreeMap;
+  for (int i = 0; i < 1000; ++i) btreeMap[i] = std::to_string(i);
+  EXPECT_EQ(btreeMap[500], "500");
+  EXPECT_TRUE(btreeMap.remove(500));
+  EXPECT_FALSE(btreeMap.contain(500));
+  EXPECT_EQ(btreeMap.size(), 999u);
+  EXPECT_EQ((*btreeMap.floor(500)).first, 499);
+
+  int expected = 0;
+  for (auto [key, value] : btreeMap) {
+    if (expected == 500) ++expected;
+    EXPECT_EQ(key, expected);
+    EXPECT_EQ(value, std::to_string(expected));
+    ++expected;
+  }
+  const auto& constMap = btreeMap;
+  ASSERT_THROW(constMap[500], std::out_of_range);
+}
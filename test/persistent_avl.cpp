@@ -0,0 +1,170 @@
+#include "../include/persistent_avl.hpp"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using IntPAVL = PersistentAVL<int>;
+
+TEST(PersistentAVLTest, InsertReturnsNewVersion) {
+  IntPAVL empty;
+  IntPAVL one = empty.insert(10);
+  IntPAVL two = one.insert(5);
+
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(one.in_order(), std::vector<int>({10}));
+  EXPECT_EQ(two.in_order(), std::vector<int>({5, 10}));
+
+  IntPAVL same = two.insert(5);  // Duplicado: mesma versão
+  EXPECT_EQ(same.search(5), two.search(5));
+  EXPECT_EQ(same.size(), 2u);
+}
+
+TEST(PersistentAVLTest, VersionsShareUntouchedNodes) {
+  IntPAVL tree;
+  for (int i = 0; i < 1024; ++i) tree = tree.insert(i);
+  ASSERT_TRUE(tree.is_balanced());
+
+  IntPAVL next = tree.insert(2000);
+  // Só o caminho até o maior valor foi copiado
+  EXPECT_EQ(next.search(0), tree.search(0));
+  EXPECT_EQ(next.search(100), tree.search(100));
+  EXPECT_NE(next.search(1023), tree.search(1023));
+  EXPECT_FALSE(tree.contain(2000));
+  EXPECT_TRUE(next.contain(2000));
+
+  IntPAVL removed = next.remove(0);
+  EXPECT_TRUE(next.contain(0));
+  EXPECT_FALSE(removed.contain(0));
+  EXPECT_EQ(removed.search(1000), next.search(1000));
+}
+
+TEST(PersistentAVLTest, MatchesStdSetAcrossVersions) {
+  std::mt19937 rng(15);
+  std::vector<IntPAVL> versions(1);
+  std::vector<std::set<int>> expected(1);
+  for (int step = 0; step < 3000; ++step) {
+    int value = rng() % 500;
+    std::set<int> reference = expected.back();
+    if (rng() % 3 == 0) {
+      reference.erase(value);
+      versions.push_back(versions.back().remove(value));
+    } else {
+      reference.insert(value);
+      versions.push_back(versions.back().insert(value));
+    }
+    expected.push_back(reference);
+  }
+  // Todas as versões antigas continuam intactas
+  for (std::size_t i = 0; i < versions.size(); i += 97) {
+    const IntPAVL& version = versions[i];
+    ASSERT_TRUE(version.is_balanced());
+    EXPECT_EQ(version.size(), expected[i].size());
+    EXPECT_EQ(version.in_order(),
+              std::vector<int>(expected[i].begin(), expected[i].end()));
+  }
+}
+
+TEST(PersistentAVLTest, RankSelectAndIteration) {
+  IntPAVL tree;
+  for (int v : {50, 30, 70, 20, 40, 60, 80}) tree = tree.insert(v);
+  EXPECT_EQ(tree.rank(45), 3u);
+  EXPECT_EQ(tree.select(0), 20);
+  EXPECT_EQ(tree.select(6), 80);
+  EXPECT_THROW(tree.select(7), std::out_of_range);
+
+  std::vector<int> seen(tree.begin(), tree.end());
+  EXPECT_EQ(seen, tree.in_order());
+
+  int visited = 0;
+  EXPECT_FALSE(tree.for_each_in_order([&](int v) {
+    ++visited;
+    return v < 40;
+  }));
+  EXPECT_EQ(visited, 3);
+}
+
+TEST(PersistentAVLTest, TransparentLookups) {
+  PersistentAVL<std::string, std::less<>> tree;
+  tree = tree.insert("banana").insert("apple").insert("cherry");
+  EXPECT_TRUE(tree.contain(std::string_view("apple")));
+  ASSERT_NE(tree.search("cherry"), nullptr);
+  EXPECT_EQ(tree.remove("apple").in_order(),
+            std::vector<std::string>({"banana", "cherry"}));
+}
+
+TEST(PersistentAVLTest, ReleasesNodesOfDroppedVersions) {
+  struct Counted {
+    explicit Counted(int value, std::shared_ptr<int> live)
+        : value(value), live(std::move(live)) {
+      ++*this->live;
+    }
+    Counted(const Counted& other) : value(other.value), live(other.live) {
+      ++*live;
+    }
+    ~Counted() { --*live; }
+    bool operator<(const Counted& other) const { return value < other.value; }
+    int value;
+    std::shared_ptr<int> live;
+  };
+
+  auto live = std::make_shared<int>(0);
+  {
+    PersistentAVL<Counted> tree;
+    for (int i = 0; i < 200; ++i) tree = tree.insert(Counted(i, live));
+    PersistentAVL<Counted> snapshot = tree;
+    for (int i = 0; i < 200; i += 2) tree = tree.remove(Counted(i, live));
+    EXPECT_EQ(snapshot.size(), 200u);
+    EXPECT_EQ(tree.size(), 100u);
+  }
+  EXPECT_EQ(*live, 0);
+}
+
+TEST(PersistentAVLTest, ReadersSeeConsistentSnapshots) {
+  IntPAVL tree;
+  for (int i = 0; i < 1000; ++i) tree = tree.insert(i);
+
+  std::atomic<bool> failed(false);
+  std::vector<std::thread> readers;
+  for (int t = 0; t < 4; ++t) {
+    readers.emplace_back([snapshot = tree, &failed] {
+      for (int round = 0; round < 20; ++round) {
+        long long sum = 0;
+        for (int v : snapshot) sum += v;
+        if (sum != 999LL * 1000 / 2 || snapshot.size() != 1000) {
+          failed = true;
+        }
+      }
+    });
+  }
+  // Enquanto isso, novas versões são criadas e descartadas
+  for (int i = 0; i < 1000; ++i) tree = tree.remove(i).insert(i + 1000);
+  for (std::thread& reader : readers) reader.join();
+
+  EXPECT_FALSE(failed);
+  EXPECT_EQ(tree.size(), 1000u);
+  EXPECT_EQ(tree.select(0), 1000);
+}
+
+TEST(PersistentAVLTest, InsertOrAssignReplacesEquivalent) {
+  struct Entry {
+    int key;
+    int value;
+    bool operator<(const Entry& other) const { return key < other.key; }
+  };
+  PersistentAVL<Entry> tree;
+  tree = tree.insert_or_assign({1, 10}).insert_or_assign({2, 20});
+  PersistentAVL<Entry> updated = tree.insert_or_assign({1, 11});
+
+  EXPECT_EQ(updated.size(), 2u);
+  EXPECT_EQ(updated.search({1, 0})->value, 11);
+  EXPECT_EQ(tree.search({1, 0})->value, 10);  // A versão antiga não muda
+  EXPECT_EQ(updated.search({2, 0}), tree.search({2, 0}));
+  EXPECT_TRUE(updated.is_balanced());
+}
@@ -0,0 +1,150 @@
+#include "../include/pool.hpp"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "../include/avl.hpp"
+#include "../include/bst.hpp"
+#include "../include/map.hpp"
+#include "../include/set.hpp"
+
+TEST(NodePoolTest, ReusaBlocosLiberados) {
+  NodePool pool(24);
+  void* a = pool.allocate();
+  void* b = pool.allocate();
+  EXPECT_NE(a, b);
+  pool.deallocate(a);
+  EXPECT_EQ(pool.allocate(), a);
+  EXPECT_EQ(pool.slab_count(), 1u);
+}
+
+TEST(NodePoolTest, CresceEmSlabs) {
+  NodePool pool(16);
+  std::vector<void*> blocks;
+  for (int i = 0; i < 1000; ++i) {
+    blocks.push_back(pool.allocate());
+  }
+  EXPECT_GT(pool.slab_count(), 1u);
+  EXPECT_LT(pool.slab_count(), 10u);
+  EXPECT_GE(pool.block_size(), 16u);
+}
+
+TEST(PoolAllocatorTest, RebindCompartilhaReserva) {
+  PoolAllocator<int> ints;
+  PoolAllocator<double> doubles(ints);
+  PoolAllocator<int> back(doubles);
+  EXPECT_TRUE(ints == doubles);
+  EXPECT_TRUE(back == ints);
+  EXPECT_TRUE(ints != PoolAllocator<int>());
+
+  int* p = ints.allocate(1);
+  *p = 42;
+  ints.deallocate(p, 1);
+  EXPECT_EQ(back.allocate(1), p);
+
+  int* many = ints.allocate(10);  // Vai direto ao alocador global
+  ints.deallocate(many, 10);
+}
+
+TEST(PoolAllocatorTest, ArvoresComPool) {
+  AVL<int, std::less<int>, PoolAllocator<int>> avl;
+  BST<int, std::less<int>, PoolAllocator<int>> bst;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_TRUE(avl.insert((i * 37) % 1000));
+    EXPECT_TRUE(bst.insert((i * 37) % 1000));
+  }
+  for (int i = 0; i < 1000; i += 2) {
+    EXPECT_TRUE(avl.remove(i));
+    EXPECT_TRUE(bst.remove(i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(avl.contain(i), i % 2 == 1);
+    EXPECT_EQ(bst.contain(i), i % 2 == 1);
+  }
+  EXPECT_TRUE(avl.is_balanced());
+}
+
+TEST(PoolAllocatorTest, SetEMapComPool) {
+  PoolAllocator<int> shared;
+  Set<int, AVL, PoolAllocator<int>> a(shared);
+  Set<int, AVL, PoolAllocator<int>> b(shared);
+  for (int i = 0; i < 100; ++i) {
+    a.insert(i);
+    b.insert(-i);
+  }
+  EXPECT_TRUE(a.search(99));
+  EXPECT_TRUE(b.search(-99));
+  EXPECT_TRUE(a.remove(50));
+  EXPECT_FALSE(a.search(50));
+
+  Map<std::string, std::string, AVL, PoolAllocator<int>> map;
+  map["a"] = "1";
+  map["b"] = "2";
+  EXPECT_EQ(map["a"], "1");
+  EXPECT_TRUE(map.remove("a"));
+  EXPECT_FALSE(map.contain("a"));
+}
+
+TEST(PoolAllocatorTest, AlgebraEntreReservasDiferentes) {
+  // Reservas diferentes: os nós do outro operando são copiados, não religados
+  Set<int, AVL, PoolAllocator<int>> a, b;
+  for (int i = 0; i < 100; ++i) {
+    a.insert(i);
+    b.insert(i + 50);
+  }
+  a.union_with(std::move(b));
+  EXPECT_TRUE(b.empty());
+  EXPECT_EQ(a.size(), 150u);
+
+  Set<int, AVL, PoolAllocator<int>> c(a.begin(), a.end(), PoolAllocator<int>());
+  a.intersect_with(c);
+  EXPECT_EQ(a.size(), 150u);
+  EXPECT_EQ(c.size(), 150u);
+}
+
+TEST(PoolAllocatorTest, AlgebraParalela) {
+  // Com o PoolAllocator os nós descartados só são liberados no fim, pela
+  // thread que chamou
+  ForkJoinPool pool(4);
+  PoolAllocator<int> shared;
+  AVL<int, std::less<int>, PoolAllocator<int>> a(shared), b(shared);
+  std::vector<int> evens, odds;
+  for (int i = 0; i < 20000; i += 2) evens.push_back(i);
+  for (int i = 0; i < 20000; i += 4) odds.push_back(i + 1);
+  a.assign_sorted(evens.begin(), evens.end());
+  b.assign_sorted(evens.begin(), evens.begin() + 5000);
+  a.difference_with(b, pool, 16);
+  EXPECT_EQ(a.size(), 5000u);
+  EXPECT_EQ(a.select(0), 10000);
+
+  a.insert_batch(odds.begin(), odds.end(), pool, 16);
+  EXPECT_EQ(a.size(), 10000u);
+  a.erase_batch(odds.begin(), odds.end(), pool, 16);
+  EXPECT_EQ(a.in_order(), std::vector<int>(evens.begin() + 5000, evens.end()));
+  EXPECT_TRUE(a.is_balanced());
+}
+
+TEST(PoolAllocatorTest, CopiaEMovimentoComPool) {
+  using PoolAVL = AVL<int, std::less<int>, PoolAllocator<int>>;
+  PoolAVL original;
+  for (int i = 0; i < 500; ++i) original.insert(i);
+
+  PoolAVL copy(original);  // mesma reserva: a cópia aloca do mesmo pool
+  EXPECT_TRUE(copy.get_allocator() == original.get_allocator());
+  EXPECT_EQ(copy.pre_order(), original.pre_order());
+
+  PoolAVL other;  // reserva diferente
+  other.insert(-1);
+  other = std::move(copy);  // propaga o alocador: O(1)
+  EXPECT_TRUE(other.get_allocator() == original.get_allocator());
+  EXPECT_EQ(other.size(), 500u);
+  EXPECT_TRUE(copy.empty());  // NOLINT
+  copy.insert(3);  // o original movido continua utilizável
+  EXPECT_TRUE(copy.contain(3));
+
+  other.swap(original);
+  EXPECT_EQ(other.size(), 500u);
+  EXPECT_TRUE(other.is_balanced());
+}
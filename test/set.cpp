@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <string>
+#include <vector>
+
 class SetTest : public ::testing::Test {
  protected:
   Set<int> intSet;
@@ -138,3 +141,168 @@ TEST_F(SetTest, ComplexSequenceOfOperations) {
   EXPECT_FALSE(intSet.search(5));
   EXPECT_FALSE(intSet.remove(10));
 }
+
+TEST_F(SetTest, IteratesInOrder) {
+  for (int v : {30, 10, 20, 50, 40}) intSet.insert(v);
+
+  std::vector<int> forward(intSet.begin(), intSet.end());
+  EXPECT_EQ(forward, std::vector<int>({10, 20, 30, 40, 50}));
+  std::vector<int> backward(intSet.rbegin(), intSet.rend());
+  EXPECT_EQ(backward, std::vector<int>({50, 40, 30, 20, 10}));
+
+  // Parada antecipada, sem cópia
+  int visited = 0;
+  for (int v : intSet) {
+    ++visited;
+    if (v == 20) break;
+  }
+  EXPECT_EQ(visited, 2);
+}
+
+TEST_F(SetTest, SizeRankAndSelect) {
+  EXPECT_TRUE(intSet.empty());
+  for (int v : {30, 10, 20, 50, 40}) intSet.insert(v);
+  intSet.insert(20);
+  intSet.remove(10);
+
+  EXPECT_EQ(intSet.size(), 4u);
+  EXPECT_FALSE(intSet.empty());
+  EXPECT_EQ(intSet.rank(35), 2u);
+  EXPECT_EQ(intSet.select(0), 20);
+  EXPECT_EQ(intSet.select(3), 50);
+  EXPECT_EQ(*intSet.nth(2), 40);
+  EXPECT_TRUE(intSet.nth(4) == intSet.end());
+}
+
+TEST_F(SetTest, OrderedRangeQueries) {
+  for (int v : {10, 20, 30, 40, 50}) intSet.insert(v);
+
+  EXPECT_EQ(*intSet.lower_bound(25), 30);
+  EXPECT_EQ(*intSet.upper_bound(30), 40);
+  EXPECT_EQ(*intSet.floor(25), 20);
+  EXPECT_EQ(*intSet.ceiling(30), 30);
+  EXPECT_EQ(*intSet.predecessor(30), 20);
+  EXPECT_EQ(*intSet.successor(30), 40);
+  EXPECT_EQ(intSet.successor(50), nullptr);
+
+  std::vector<int> seen;
+  intSet.range(20, 50, [&](int v) { seen.push_back(v); });
+  EXPECT_EQ(seen, std::vector<int>({20, 30, 40}));
+  EXPECT_EQ(intSet.count_range(15, 45), 3u);
+}
+
+TEST_F(SetTest, ConstructFromRange) {
+  std::vector<std::string> words = {"pear", "apple", "fig", "apple"};
+  Set<std::string> fromWords(words.begin(), words.end());
+  EXPECT_EQ(std::vector<std::string>(fromWords.begin(), fromWords.end()),
+            std::vector<std::string>({"apple", "fig", "pear"}));
+
+  std::vector<int> sorted = {1, 2, 3, 4, 5, 6};
+  intSet.insert(42);
+  intSet.assign_sorted(sorted.begin(), sorted.end());
+  EXPECT_EQ(intSet.size(), 6u);
+  EXPECT_FALSE(intSet.search(42));
+  EXPECT_TRUE(intSet.search(4));
+}
+
+TEST_F(SetTest, SetAlgebra) {
+  for (int v : {1, 2, 3, 4, 5}) intSet.insert(v);
+  Set<int> other;
+  for (int v : {4, 5, 6, 7}) other.insert(v);
+
+  Set<int> unionSet(intSet.begin(), intSet.end());
+  unionSet.union_with(other);
+  EXPECT_EQ(std::vector<int>(unionSet.begin(), unionSet.end()),
+            std::vector<int>({1, 2, 3, 4, 5, 6, 7}));
+  EXPECT_EQ(other.size(), 4u);  // a versão const& não altera o operando
+
+  Set<int> inter(intSet.begin(), intSet.end());
+  inter.intersect_with(other);
+  EXPECT_EQ(std::vector<int>(inter.begin(), inter.end()),
+            std::vector<int>({4, 5}));
+
+  Set<int> diff(intSet.begin(), intSet.end());
+  diff.difference_with(other);
+  EXPECT_EQ(std::vector<int>(diff.begin(), diff.end()),
+            std::vector<int>({1, 2, 3}));
+
+  intSet.symmetric_difference_with(std::move(other));
+  EXPECT_TRUE(other.empty());
+  EXPECT_EQ(std::vector<int>(intSet.begin(), intSet.end()),
+            std::vector<int>({1, 2, 3, 6, 7}));
+}
+
+TEST_F(SetTest, ParallelAlgebraAndBatches) {
+  ForkJoinPool pool(4);
+  std::vector<int> evens, multiplesOfThree;
+  for (int i = 0; i < 3000; i += 2) evens.push_back(i);
+  for (int i = 0; i < 3000; i += 3) multiplesOfThree.push_back(i);
+
+  Set<int> a(evens.begin(), evens.end());
+  Set<int> b(multiplesOfThree.begin(), multiplesOfThree.end());
+  a.intersect_with(b, pool, 16);
+  EXPECT_EQ(b.size(), 1000u);  // const&: b não é consumido
+  EXPECT_EQ(a.size(), 500u);   // múltiplos de 6
+  EXPECT_EQ(a.select(1), 6);
+
+  a.union_with(std::move(b), pool, 16);
+  EXPECT_TRUE(b.empty());
+  EXPECT_EQ(a.size(), 1000u);
+
+  a.erase_batch(multiplesOfThree.begin(), multiplesOfThree.end(), pool, 16);
+  EXPECT_TRUE(a.empty());
+  a.insert_batch(evens.begin(), evens.end());
+  EXPECT_EQ(a.size(), evens.size());
+}
+
+TEST_F(SetTest, ApplyBatch) {
+  for (int v : {1, 2, 3}) intSet.insert(v);
+  std::vector<BatchOp<int>> ops = {{BatchKind::insert, 2},
+                                   {BatchKind::insert, 4},
+                                   {BatchKind::erase, 1},
+                                   {BatchKind::erase, 7},
+                                   {BatchKind::assign, 3},
+                                   {BatchKind::erase, 4}};
+  EXPECT_EQ(intSet.apply_batch(ops),
+            std::vector<bool>({false, true, true, false, false, true}));
+  EXPECT_FALSE(intSet.search(1));
+  EXPECT_FALSE(intSet.search(4));
+  EXPECT_EQ(intSet.size(), 2u);
+}
+
+TEST_F(SetTest, InsertByMoveAndEmplace) {
+  std::string word = "tree";
+  EXPECT_TRUE(stringSet.insert(std::move(word)));
+  EXPECT_TRUE(stringSet.emplace(4, 'a'));
+  EXPECT_FALSE(stringSet.emplace("tree"));
+  EXPECT_TRUE(stringSet.search("aaaa"));
+  EXPECT_EQ(stringSet.size(), 2u);
+}
+
+TEST_F(SetTest, CopyIsIndependentSnapshot) {
+  for (int v : {1, 2, 3}) intSet.insert(v);
+  Set<int> snapshot = intSet;
+  intSet.remove(2);
+  EXPECT_TRUE(snapshot.search(2));
+  EXPECT_FALSE(intSet.search(2));
+
+  Set<int> moved = std::move(snapshot);
+  EXPECT_EQ(moved.size(), 3u);
+  swap(moved, intSet);
+  EXPECT_EQ(moved.size(), 2u);
+  EXPECT_EQ(intSet.size(), 3u);
+}
+
+TEST(SetBackendTest, BTreeBackend) {
+  Set<int, BTree> btreeSet;
+  for (int v = 0; v < 1000; ++v) EXPECT_TRUE(btreeSet.insert((v * 7) % 1000));
+  EXPECT_FALSE(btreeSet.insert(7));
+  for (int v = 0; v < 1000; v += 2) EXPECT_TRUE(btreeSet.remove(v));
+  EXPECT_EQ(btreeSet.size(), 500u);
+  EXPECT_TRUE(btreeSet.search(999));
+  EXPECT_FALSE(btreeSet.search(998));
+  EXPECT_EQ(*btreeSet.begin(), 1);
+  EXPECT_EQ(*btreeSet.rbegin(), 999);
+  EXPECT_EQ(*btreeSet.lower_bound(500), 501);
+  EXPECT_EQ(*btreeSet.floor(500), 499);
+}
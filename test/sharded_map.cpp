@@ -0,0 +1,113 @@
+#include "../include/sharded_map.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ShardedMapTest, BasicOperations) {
+  ShardedMap<std::string, int, 4> map;
+  map["one"] = 1;
+  map["two"] = 2;
+  EXPECT_TRUE(map.insert_or_assign("three", 3));
+  EXPECT_FALSE(map.insert_or_assign("three", 30));
+
+  EXPECT_EQ(map.find("one"), 1);
+  EXPECT_EQ(map.find("three"), 30);
+  EXPECT_FALSE(map.find("four").has_value());
+  EXPECT_EQ(static_cast<int&>(map["two"]), 2);
+  EXPECT_EQ(map.size(), 3u);
+
+  map.upsert("one", [](int& value) { value += 10; });
+  EXPECT_EQ(map.find("one"), 11);
+  EXPECT_TRUE(map.visit("two", [](int& value) { value = 20; }));
+  EXPECT_FALSE(map.visit("four", [](int&) {}));
+  EXPECT_EQ(map.find("two"), 20);
+
+  EXPECT_TRUE(map.remove("one"));
+  EXPECT_FALSE(map.remove("one"));
+  EXPECT_FALSE(map.contain("one"));
+  EXPECT_EQ(map.size(), 2u);
+}
+
+TEST(ShardedMapTest, AccessorDefaultConstructsAndExposesValue) {
+  ShardedMap<int, std::vector<int>, 8> map;
+  map[5]->push_back(1);
+  map[5].get().push_back(2);
+  (*map[6]).push_back(3);
+  EXPECT_EQ(map.find(5), std::vector<int>({1, 2}));
+  EXPECT_EQ(map.find(6), std::vector<int>({3}));
+  EXPECT_TRUE(map[7]->empty());
+  EXPECT_EQ(map.size(), 3u);
+}
+
+TEST(ShardedMapTest, ForEachVisitsEveryShard) {
+  ShardedMap<int, int, 8> map;
+  std::map<int, int> expected;
+  std::mt19937 rng(11);
+  for (int i = 0; i < 2000; ++i) {
+    int key = static_cast<int>(rng() % 5000);
+    map[key] = i;
+    expected[key] = i;
+  }
+
+  std::vector<std::pair<int, int>> seen;
+  map.for_each([&](int key, int value) { seen.emplace_back(key, value); });
+  std::sort(seen.begin(), seen.end());
+  std::vector<std::pair<int, int>> pairs(expected.begin(), expected.end());
+  EXPECT_EQ(seen, pairs);
+
+  map.for_each([](int, int& value) { value = -value; });
+  EXPECT_EQ(map.find(expected.begin()->first), -expected.begin()->second);
+}
+
+TEST(ShardedMapTest, OrderedIterationMergesShards) {
+  ShardedMap<int, int, 16> map;
+  std::map<int, int> expected;
+  std::mt19937 rng(5);
+  for (int i = 0; i < 3000; ++i) {
+    int key = static_cast<int>(rng() % 100000) - 50000;
+    map.insert_or_assign(key, i);
+    expected[key] = i;
+  }
+
+  std::vector<std::pair<int, int>> seen;
+  map.for_each_ordered(
+      [&](int key, int value) { seen.emplace_back(key, value); });
+  std::vector<std::pair<int, int>> pairs(expected.begin(), expected.end());
+  EXPECT_EQ(seen, pairs);
+
+  ShardedMap<int, int, 4> empty;
+  bool called = false;
+  empty.for_each_ordered([&](int, int) { called = true; });
+  EXPECT_FALSE(called);
+}
+
+TEST(ShardedMapTest, ConcurrentCounters) {
+  ShardedMap<int, int, 16> map;
+  const int threads = 4, rounds = 5000, keys = 64;
+  std::vector<std::thread> workers;
+  for (int t = 0; t < threads; ++t) {
+    workers.emplace_back([&, t] {
+      for (int i = 0; i < rounds; ++i) {
+        int key = (i + t) % keys;
+        if (i % 2 == 0) {
+          map.upsert(key, [](int& value) { ++value; });
+        } else {
+          ++map[key].get();
+        }
+        // Chaves de outra faixa, inseridas e removidas por cada thread
+        map.insert_or_assign(keys + t * rounds + i, i);
+        EXPECT_TRUE(map.remove(keys + t * rounds + i));
+      }
+    });
+  }
+  for (std::thread& worker : workers) worker.join();
+
+  int total = 0;
+  map.for_each([&](int, int value) { total += value; });
+  EXPECT_EQ(total, threads * rounds);
+  EXPECT_EQ(map.size(), static_cast<std::size_t>(keys));
+}
@@ -0,0 +1,57 @@
+#include "../include/simd_search.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <type_traits>
+#include <vector>
+
+// Blocos ordenados de vários tamanhos (inclusive com sobras que não enchem
+// um vetor) com os extremos do tipo, comparados com std::lower_bound.
+template <class T, class F>
+void check_against_lower_bound(F count_less) {
+  std::mt19937_64 rng(5);
+  for (std::size_t n = 0; n <= 70; ++n) {
+    std::vector<T> keys(n);
+    for (T& key : keys) key = static_cast<T>(rng());
+    if (n > 0) keys[0] = std::numeric_limits<T>::min();
+    if (n > 1) keys[1] = std::numeric_limits<T>::max();
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<T> probes = {std::numeric_limits<T>::min(),
+                             std::numeric_limits<T>::max(), 0, T(1), T(-1)};
+    for (T key : keys) {
+      probes.push_back(key);
+      // Soma sem sinal: `max() + 1` daria para o menor valor sem estouro
+      probes.push_back(
+          static_cast<T>(static_cast<std::make_unsigned_t<T>>(key) + 1));
+    }
+    for (int i = 0; i < 20; ++i) probes.push_back(static_cast<T>(rng()));
+    for (T probe : probes) {
+      std::size_t expected =
+          std::lower_bound(keys.begin(), keys.end(), probe) - keys.begin();
+      EXPECT_EQ(count_less(keys.data(), n, probe), expected)
+          << "n = " << n << ", key = " << probe;
+    }
+  }
+}
+
+template <class T>
+void check_all_variants() {
+  check_against_lower_bound<T>(simd::count_less<T>);
+  check_against_lower_bound<T>(simd::count_less_scalar<T>);
+#if SIMD_SEARCH_X86
+  if (simd::has_avx2) {
+    check_against_lower_bound<T>(simd::detail::count_less_avx2<T>);
+  }
+  if constexpr (sizeof(T) == 4) {
+    check_against_lower_bound<T>(simd::detail::count_less_sse2<T>);
+  }
+#endif
+}
+
+TEST(SimdSearchTest, Int32) { check_all_variants<std::int32_t>(); }
+TEST(SimdSearchTest, UInt32) { check_all_variants<std::uint32_t>(); }
+TEST(SimdSearchTest, Int64) { check_all_variants<std::int64_t>(); }
+TEST(SimdSearchTest, UInt64) { check_all_variants<std::uint64_t>(); }